@@ -0,0 +1,488 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "../GenTLHelpers.h"
+
+#include <iostream>
+#include <vector>
+#include <list>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Acquisition: Adaptive Buffers
+//    This example demonstrates sizing the buffer pool at runtime instead of
+//    fixing it when the stream starts. Arena::IDevice::StartStream allocates a
+//    set number of buffers (Arena::CalculateMaximumNumberOfBuffers or the
+//    'StreamBufferHandlingMode' defaults), which must cover the worst consumer
+//    stall and so is idle most of the time. The GenTL producer underneath Arena
+//    accepts new buffers while acquiring (GenTL::DSAnnounceBuffer) and lets a
+//    consumer take back any buffer it holds (GenTL::DSRevokeBuffer). This
+//    example grows the pool when the input pool runs low or the consumer slows
+//    down, shrinks it again when buffers sit unused, and reports each decision
+//    alongside the stream's own statistics.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// bounds of the buffer pool
+//    The pool never shrinks below the minimum, which must be at least what the
+//    producer needs to start (STREAM_INFO_BUF_ANNOUNCE_MIN), and never grows
+//    beyond the maximum, which caps memory use.
+#define MIN_BUFFERS 4
+#define MAX_BUFFERS 64
+
+// number of buffers added at a time
+#define GROW_STEP 4
+
+// free buffer watermark
+//    The pool grows whenever fewer buffers than this are left in the input
+//    pool, waiting to be filled.
+#define LOW_WATERMARK 2
+
+// buffers kept beyond the number needed to ride out the slowest recent frame
+#define HEADROOM_BUFFERS 2
+
+// Latency decay
+//    The slowest recent consumer latency decays by this factor every frame, so
+//    the pool shrinks a while after a stall rather than straight away.
+#define LATENCY_DECAY 0.99
+
+// number of frames between two shrink steps
+#define SHRINK_INTERVAL 10
+
+// number of images to grab
+#define NUM_IMAGES 500
+
+// Simulated consumer stall
+//    Every STALL_EVERY frames the consumer takes STALL_MS milliseconds, as a
+//    pipeline might when it flushes a file or waits on another thread.
+#define STALL_EVERY 150
+#define STALL_MS 300
+
+// alignment of user buffers
+#define BUFFER_ALIGNMENT 4096
+
+// discovery timeout
+#define DISCOVERY_TIMEOUT 100
+
+// image timeout
+#define IMAGE_TIMEOUT 2000
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// allocates aligned memory
+//    Stands in for an application allocator (hugepages, DMA-capable memory,
+//    shared memory, etc.). Any block of at least the payload size works.
+uint8_t* AllocateAligned(size_t size, size_t alignment)
+{
+#ifdef _WIN32
+	return static_cast<uint8_t*>(_aligned_malloc(size, alignment));
+#else
+	void* pMemory = NULL;
+	if (posix_memalign(&pMemory, alignment, size) != 0)
+		return NULL;
+	return static_cast<uint8_t*>(pMemory);
+#endif
+}
+
+void FreeAligned(uint8_t* pMemory)
+{
+#ifdef _WIN32
+	_aligned_free(pMemory);
+#else
+	free(pMemory);
+#endif
+}
+
+// user buffer
+struct UserBuffer
+{
+	uint8_t* pData;
+	size_t size;
+	GenTL::BUFFER_HANDLE hBuffer;
+};
+
+// pool statistics
+//    Decisions made by the pool, reported next to the producer's own counters
+//    so that memory saved can be weighed against frames lost.
+struct PoolStatistics
+{
+	uint64_t grows;
+	uint64_t shrinks;
+	size_t minAnnounced;
+	size_t maxAnnounced;
+	uint64_t underruns;
+	uint64_t incomplete;
+};
+
+// Adaptive buffer pool
+//    Owns the user buffers announced to a data stream and decides, after each
+//    frame, whether to requeue the frame's buffer or revoke it. A buffer can
+//    only be revoked while the consumer holds it, so the pool shrinks one
+//    delivered buffer at a time; it grows by announcing and queueing new
+//    buffers, which the producer accepts while acquiring.
+//
+//    The target size is the number of frames that arrive during the slowest
+//    recent consumer latency, plus some headroom. The pool also grows when the
+//    input pool falls below the low watermark, which catches bursts the
+//    latency estimate has not seen yet.
+class AdaptivePool
+{
+public:
+	AdaptivePool(GenTL::DS_HANDLE hDataStream, size_t bufferSize, size_t alignment) :
+		m_hDataStream(hDataStream),
+		m_bufferSize(bufferSize),
+		m_alignment(alignment),
+		m_peakLatencyNs(0.0),
+		m_framesSinceShrink(0)
+	{
+		memset(&m_statistics, 0, sizeof(m_statistics));
+	}
+
+	// Destructor
+	//    Buffers are still announced if acquisition ended early on an
+	//    exception, and the producer may fill any of them until it stops.
+	//    Acquisition is stopped and the queues flushed before each buffer is
+	//    revoked, and a buffer is only freed once the producer has let go of
+	//    it; one that fails to revoke is leaked rather than freed under the
+	//    producer. Errors from stopping an already stopped stream are ignored.
+	~AdaptivePool()
+	{
+		if (m_buffers.empty())
+			return;
+
+		GenTL::DSStopAcquisition(m_hDataStream, GenTL::ACQ_STOP_FLAGS_KILL);
+		GenTL::DSFlushQueue(m_hDataStream, GenTL::ACQ_QUEUE_ALL_DISCARD);
+
+		for (std::list<UserBuffer>::iterator it = m_buffers.begin(); it != m_buffers.end(); it++)
+		{
+			if (GenTL::DSRevokeBuffer(m_hDataStream, it->hBuffer, NULL, NULL) == GenTL::GC_ERR_SUCCESS)
+				FreeAligned(it->pData);
+		}
+	}
+
+	// announces and queues buffers
+	void Grow(size_t count)
+	{
+		for (size_t i = 0; i < count && m_buffers.size() < MAX_BUFFERS; i++)
+		{
+			UserBuffer buffer;
+			buffer.size = m_bufferSize;
+			buffer.pData = AllocateAligned(m_bufferSize, m_alignment);
+			buffer.hBuffer = NULL;
+			if (!buffer.pData)
+				throw GenICam::GenericException("Failed to allocate user buffer", __FILE__, __LINE__);
+
+			// the list keeps addresses stable, so each buffer's user pointer stays valid
+			m_buffers.push_back(buffer);
+			UserBuffer& added = m_buffers.back();
+			CheckGC(GenTL::DSAnnounceBuffer(m_hDataStream, added.pData, added.size, &added, &added.hBuffer), "DSAnnounceBuffer");
+			CheckGC(GenTL::DSQueueBuffer(m_hDataStream, added.hBuffer), "DSQueueBuffer");
+		}
+
+		m_statistics.maxAnnounced = std::max(m_statistics.maxAnnounced, m_buffers.size());
+		if (m_statistics.minAnnounced == 0)
+			m_statistics.minAnnounced = m_buffers.size();
+	}
+
+	// Return a delivered buffer
+	//    Updates the latency estimate, then requeues the buffer, revokes it to
+	//    shrink the pool, or requeues it and grows the pool.
+	// (1) decays slowest recent latency
+	// (2) computes target pool size
+	// (3) shrinks or requeues
+	// (4) grows if running low
+	void Return(UserBuffer* pBuffer, double latencyNs, double framePeriodNs)
+	{
+		// decay slowest recent latency
+		m_peakLatencyNs = std::max(latencyNs, m_peakLatencyNs * LATENCY_DECAY);
+
+		// compute target
+		size_t target = HEADROOM_BUFFERS + MIN_BUFFERS;
+		if (framePeriodNs > 0.0)
+			target = HEADROOM_BUFFERS + static_cast<size_t>(m_peakLatencyNs / framePeriodNs + 1.0);
+		target = std::min(std::max(target, static_cast<size_t>(MIN_BUFFERS)), static_cast<size_t>(MAX_BUFFERS));
+
+		size_t announced = m_buffers.size();
+		size_t free = GetStreamInfo<size_t>(m_hDataStream, GenTL::STREAM_INFO_NUM_QUEUED);
+
+		// Shrink or requeue
+		//    Shrinking waits until a full grow step is free above the
+		//    watermark, so that the pool does not flip between growing and
+		//    shrinking around it.
+		m_framesSinceShrink++;
+		if (announced > target && free >= LOW_WATERMARK + GROW_STEP && m_framesSinceShrink >= SHRINK_INTERVAL)
+		{
+			Revoke(pBuffer);
+			m_framesSinceShrink = 0;
+			m_statistics.shrinks++;
+			m_statistics.minAnnounced = std::min(m_statistics.minAnnounced, m_buffers.size());
+
+			std::cout << TAB2 << "Shrink to " << m_buffers.size() << " buffers (target " << target << ", " << free << " free)\n";
+			return;
+		}
+
+		CheckGC(GenTL::DSQueueBuffer(m_hDataStream, pBuffer->hBuffer), "DSQueueBuffer");
+
+		// grow
+		if ((free < LOW_WATERMARK || announced < target) && announced < MAX_BUFFERS)
+		{
+			Grow(std::max(static_cast<size_t>(GROW_STEP), target > announced ? target - announced : 0));
+			m_statistics.grows++;
+
+			std::cout << TAB2 << "Grow to " << m_buffers.size() << " buffers (target " << target << ", " << free << " free, "
+					  << static_cast<uint64_t>(m_peakLatencyNs / 1000000.0) << " ms peak latency)\n";
+		}
+	}
+
+	// revokes and frees all buffers; acquisition must be stopped and the queue flushed
+	void RevokeAll()
+	{
+		while (!m_buffers.empty())
+			Revoke(&m_buffers.front());
+	}
+
+	size_t GetAnnounced() const { return m_buffers.size(); }
+
+	PoolStatistics GetStatistics()
+	{
+		m_statistics.underruns = GetStreamInfo<uint64_t>(m_hDataStream, GenTL::STREAM_INFO_NUM_UNDERRUN);
+		return m_statistics;
+	}
+
+	void CountIncomplete() { m_statistics.incomplete++; }
+
+private:
+	void Revoke(UserBuffer* pBuffer)
+	{
+		CheckGC(GenTL::DSRevokeBuffer(m_hDataStream, pBuffer->hBuffer, NULL, NULL), "DSRevokeBuffer");
+		FreeAligned(pBuffer->pData);
+
+		for (std::list<UserBuffer>::iterator it = m_buffers.begin(); it != m_buffers.end(); it++)
+		{
+			if (&*it == pBuffer)
+			{
+				m_buffers.erase(it);
+				break;
+			}
+		}
+	}
+
+	GenTL::DS_HANDLE m_hDataStream;
+	size_t m_bufferSize;
+	size_t m_alignment;
+	std::list<UserBuffer> m_buffers;
+	double m_peakLatencyNs;
+	size_t m_framesSinceShrink;
+	PoolStatistics m_statistics;
+};
+
+// demonstrates an adaptive buffer pool
+// (1) opens first device found through the GenTL producer
+// (2) announces the minimum pool
+// (3) starts the stream
+// (4) consumes frames with occasional stalls, letting the pool adapt
+// (5) stops the stream and reports pool and stream statistics
+void AcquireWithAdaptivePool()
+{
+	// open device
+	std::cout << TAB1 << "Discover devices\n";
+
+	GenTLDevice device;
+	if (!OpenFirstDevice(device, DISCOVERY_TIMEOUT))
+	{
+		std::cout << TAB1 << "No camera connected\n";
+		return;
+	}
+
+	std::cout << TAB2 << "Open " << device.deviceId << "\n";
+
+	RemotePort remotePort(device.hRemotePort);
+	GenApi::CNodeMapRef nodeMap;
+	LoadRemoteNodeMap(device.hRemotePort, remotePort, nodeMap);
+
+	GenTL::DS_HANDLE hDataStream = OpenFirstDataStream(device.hDevice);
+
+	// determine buffer size and alignment
+	size_t payloadSize = GetPayloadSize(hDataStream, nodeMap);
+
+	size_t alignment = BUFFER_ALIGNMENT;
+	size_t producerAlignment = 0;
+	if (TryGetStreamInfo(hDataStream, GenTL::STREAM_INFO_BUF_ALIGNMENT, producerAlignment) && producerAlignment > alignment)
+		alignment = producerAlignment;
+
+	size_t bufferSize = ((payloadSize + alignment - 1) / alignment) * alignment;
+
+	// Announce minimum pool
+	//    Some producers need more buffers than the minimum to start; the
+	//    larger of the two is announced.
+	size_t initialBuffers = MIN_BUFFERS;
+	size_t announceMin = 0;
+	if (TryGetStreamInfo(hDataStream, GenTL::STREAM_INFO_BUF_ANNOUNCE_MIN, announceMin) && announceMin > initialBuffers)
+		initialBuffers = announceMin;
+
+	std::cout << TAB1 << "Announce " << initialBuffers << " buffers (" << bufferSize << " bytes each, bounds " << MIN_BUFFERS << " to " << MAX_BUFFERS << ")\n";
+
+	AdaptivePool pool(hDataStream, bufferSize, alignment);
+	pool.Grow(initialBuffers);
+
+	// start stream
+	std::cout << TAB1 << "Start stream\n";
+
+	GenTL::EVENT_HANDLE hNewBufferEvent = NULL;
+	CheckGC(GenTL::GCRegisterEvent(hDataStream, GenTL::EVENT_NEW_BUFFER, &hNewBufferEvent), "GCRegisterEvent");
+	CheckGC(GenTL::DSStartAcquisition(hDataStream, GenTL::ACQ_START_FLAGS_DEFAULT, GENTL_INFINITE), "DSStartAcquisition");
+
+	GenApi::CIntegerPtr pTLParamsLocked = nodeMap._GetNode("TLParamsLocked");
+	if (pTLParamsLocked && GenApi::IsWritable(pTLParamsLocked))
+		pTLParamsLocked->SetValue(1);
+
+	GenApi::CCommandPtr pAcquisitionStart = nodeMap._GetNode("AcquisitionStart");
+	pAcquisitionStart->Execute();
+
+	// Acquire images
+	//    Consumer latency is the time spent on a frame before its buffer is
+	//    returned. The frame period is averaged over the whole run from the
+	//    delivered count, which is unaffected by the consumer catching up
+	//    after a stall.
+	std::cout << TAB1 << "Acquire " << NUM_IMAGES << " images\n";
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < NUM_IMAGES; i++)
+	{
+		GenTL::EVENT_NEW_BUFFER_DATA newBuffer;
+		size_t newBufferSize = sizeof(newBuffer);
+		CheckGC(GenTL::EventGetData(hNewBufferEvent, &newBuffer, &newBufferSize, IMAGE_TIMEOUT), "EventGetData");
+
+		std::chrono::steady_clock::time_point received = std::chrono::steady_clock::now();
+		UserBuffer* pBuffer = static_cast<UserBuffer*>(newBuffer.pUserPointer);
+
+		if (GetBufferInfo<bool8_t>(hDataStream, newBuffer.BufferHandle, GenTL::BUFFER_INFO_IS_INCOMPLETE))
+			pool.CountIncomplete();
+
+		// consume frame, stalling now and then
+		if (i > 0 && i % STALL_EVERY == 0)
+		{
+			std::cout << TAB2 << "Consumer stalls for " << STALL_MS << " ms at image " << i << " (" << pool.GetAnnounced() << " buffers)\n";
+			std::this_thread::sleep_for(std::chrono::milliseconds(STALL_MS));
+		}
+
+		// return buffer
+		std::chrono::steady_clock::time_point done = std::chrono::steady_clock::now();
+		double latencyNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(done - received).count());
+		double elapsedNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(done - start).count());
+		uint64_t delivered = GetStreamInfo<uint64_t>(hDataStream, GenTL::STREAM_INFO_NUM_DELIVERED);
+
+		pool.Return(pBuffer, latencyNs, delivered > 1 ? elapsedNs / static_cast<double>(delivered) : 0.0);
+	}
+
+	// stop stream
+	std::cout << TAB1 << "Stop stream\n";
+
+	GenApi::CCommandPtr pAcquisitionStop = nodeMap._GetNode("AcquisitionStop");
+	pAcquisitionStop->Execute();
+
+	if (pTLParamsLocked && GenApi::IsWritable(pTLParamsLocked))
+		pTLParamsLocked->SetValue(0);
+
+	CheckGC(GenTL::DSStopAcquisition(hDataStream, GenTL::ACQ_STOP_FLAGS_DEFAULT), "DSStopAcquisition");
+	CheckGC(GenTL::DSFlushQueue(hDataStream, GenTL::ACQ_QUEUE_ALL_DISCARD), "DSFlushQueue");
+	CheckGC(GenTL::GCUnregisterEvent(hDataStream, GenTL::EVENT_NEW_BUFFER), "GCUnregisterEvent");
+
+	// Report statistics
+	//    Underruns are frames the producer dropped because no buffer was free;
+	//    a static pool of the peak size would have used the peak memory for
+	//    the whole run.
+	PoolStatistics statistics = pool.GetStatistics();
+
+	std::cout << TAB1 << "Statistics\n";
+	std::cout << TAB2 << "Grows: " << statistics.grows << ", shrinks: " << statistics.shrinks << "\n";
+	std::cout << TAB2 << "Pool size: " << statistics.minAnnounced << " to " << statistics.maxAnnounced << " buffers ("
+			  << statistics.maxAnnounced * bufferSize / (1024 * 1024) << " MB at peak, " << pool.GetAnnounced() << " at end)\n";
+	std::cout << TAB2 << "Underruns: " << statistics.underruns << ", incomplete: " << statistics.incomplete << "\n";
+
+	// revoke and free buffers
+	std::cout << TAB1 << "Revoke and free buffers\n";
+
+	pool.RevokeAll();
+
+	// clean up
+	CheckGC(GenTL::DSClose(hDataStream), "DSClose");
+	CloseFirstDevice(device);
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_Acquisition_AdaptiveBuffers\n";
+
+	try
+	{
+		// prepare example
+		CheckGC(GenTL::GCInitLib(), "GCInitLib");
+
+		// run example
+		std::cout << "Commence example\n\n";
+		AcquireWithAdaptivePool();
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		GenTL::GCCloseLib();
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
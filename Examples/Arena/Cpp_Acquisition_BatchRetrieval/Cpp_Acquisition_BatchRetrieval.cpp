@@ -0,0 +1,241 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+#include <vector>
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Acquisition: Batch Retrieval
+//    This example demonstrates retrieving and requeuing buffers in batches. At
+//    small regions of interest and high frame rates, many buffers complete
+//    between two calls to Arena::IDevice::GetBuffer. Rather than waiting once
+//    per buffer, the example waits for the first buffer only and then drains
+//    every buffer already sitting in the output queue. The number of waiting
+//    buffers is read from the stream node map ('StreamOutputBufferCount'), so
+//    draining never waits and never times out. Buffers are requeued together
+//    once the batch has been processed. Note that the batch helper is a
+//    convenience wrapper: each buffer is still retrieved and requeued by its
+//    own call, so it saves neither locks nor system calls, only the
+//    bookkeeping of processing whatever has already arrived as one group.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// number of images to grab
+#define NUM_IMAGES 500
+
+// number of buffers
+//    Batching only helps if buffers are free to complete while a batch is being
+//    processed, so use several times the batch size.
+#define NUM_BUFFERS 100
+
+// maximum number of buffers per batch
+#define MAX_BATCH_SIZE 16
+
+// system timeout
+#define SYSTEM_TIMEOUT 100
+
+// image timeout
+#define IMAGE_TIMEOUT 2000
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// batch retrieval helper
+//    Resolves the output queue counter once and reuses it for every batch.
+class BatchRetriever
+{
+public:
+	BatchRetriever(Arena::IDevice* pDevice) :
+		m_pDevice(pDevice),
+		m_pStreamOutputBufferCount(pDevice->GetTLStreamNodeMap()->GetNode("StreamOutputBufferCount"))
+	{
+		if (!m_pStreamOutputBufferCount || !GenApi::IsReadable(m_pStreamOutputBufferCount))
+		{
+			throw GenICam::GenericException("StreamOutputBufferCount node not found/readable", __FILE__, __LINE__);
+		}
+	}
+
+	// gets up to maxCount buffers
+	// (1) waits for first buffer
+	// (2) checks how many more are already complete
+	// (3) retrieves them without waiting
+	size_t GetBuffers(size_t maxCount, uint64_t timeout, std::vector<Arena::IBuffer*>& buffers)
+	{
+		buffers.clear();
+
+		if (maxCount == 0)
+			return 0;
+
+		// Wait for first buffer
+		//    This is the only call that blocks. It throws on timeout just like
+		//    Arena::IDevice::GetBuffer.
+		buffers.push_back(m_pDevice->GetBuffer(timeout));
+
+		// Drain output queue
+		//    Every buffer counted here is already in the output queue, so the
+		//    zero timeout is never reached. Should a call throw anyway, the
+		//    buffers already taken are requeued before the exception moves on,
+		//    so that none are lost to the stream.
+		try
+		{
+			int64_t waiting = m_pStreamOutputBufferCount->GetValue();
+			while (waiting-- > 0 && buffers.size() < maxCount)
+			{
+				buffers.push_back(m_pDevice->GetBuffer(0));
+			}
+		}
+		catch (...)
+		{
+			RequeueBuffers(buffers);
+			throw;
+		}
+
+		return buffers.size();
+	}
+
+	// requeues a batch of buffers
+	void RequeueBuffers(std::vector<Arena::IBuffer*>& buffers)
+	{
+		for (size_t i = 0; i < buffers.size(); i++)
+		{
+			m_pDevice->RequeueBuffer(buffers[i]);
+		}
+		buffers.clear();
+	}
+
+private:
+	Arena::IDevice* m_pDevice;
+	GenApi::CIntegerPtr m_pStreamOutputBufferCount;
+};
+
+// demonstrates batch retrieval
+// (1) starts stream
+// (2) gets buffers in batches
+// (3) processes each batch
+// (4) requeues each batch
+// (5) stops stream
+void AcquireImagesInBatches(Arena::IDevice* pDevice)
+{
+	// start stream
+	std::cout << TAB1 << "Start stream with " << NUM_BUFFERS << " buffers\n";
+
+	BatchRetriever retriever(pDevice);
+	pDevice->StartStream(NUM_BUFFERS);
+
+	// get buffers in batches
+	std::cout << TAB1 << "Get " << NUM_IMAGES << " images in batches of up to " << MAX_BATCH_SIZE << "\n";
+
+	std::vector<Arena::IBuffer*> batch;
+	batch.reserve(MAX_BATCH_SIZE);
+
+	size_t numRetrieved = 0;
+	size_t numBatches = 0;
+	size_t numIncomplete = 0;
+
+	while (numRetrieved < NUM_IMAGES)
+	{
+		size_t remaining = NUM_IMAGES - numRetrieved;
+		size_t numInBatch = retriever.GetBuffers(remaining < MAX_BATCH_SIZE ? remaining : MAX_BATCH_SIZE, IMAGE_TIMEOUT, batch);
+
+		// process batch
+		for (size_t i = 0; i < numInBatch; i++)
+		{
+			if (batch[i]->IsIncomplete())
+				numIncomplete++;
+		}
+
+		std::cout << TAB2 << "Batch " << numBatches << ": " << numInBatch << " buffers (frame IDs "
+				  << batch.front()->GetFrameId() << " to " << batch.back()->GetFrameId() << ")\n";
+
+		// requeue batch
+		retriever.RequeueBuffers(batch);
+
+		numRetrieved += numInBatch;
+		numBatches++;
+	}
+
+	std::cout << TAB1 << "Retrieved " << numRetrieved << " buffers in " << numBatches << " batches ("
+			  << static_cast<double>(numRetrieved) / numBatches << " per batch, " << numIncomplete << " incomplete)\n";
+
+	// stop stream
+	std::cout << TAB1 << "Stop stream\n";
+
+	pDevice->StopStream();
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_Acquisition_BatchRetrieval\n";
+
+	try
+	{
+		// prepare example
+		Arena::ISystem* pSystem = Arena::OpenSystem();
+		pSystem->UpdateDevices(SYSTEM_TIMEOUT);
+		std::vector<Arena::DeviceInfo> deviceInfos = pSystem->GetDevices();
+		if (deviceInfos.size() == 0)
+		{
+			std::cout << "\nNo camera connected\nPress enter to complete\n";
+			std::getchar();
+			return 0;
+		}
+		Arena::IDevice* pDevice = pSystem->CreateDevice(deviceInfos[0]);
+
+		// run example
+		std::cout << "Commence example\n\n";
+		AcquireImagesInBatches(pDevice);
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		pSystem->DestroyDevice(pDevice);
+		Arena::CloseSystem(pSystem);
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
@@ -0,0 +1,441 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "../GenTLHelpers.h"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Acquisition: Busy Wait
+//    This example demonstrates trading a core for lower and steadier image
+//    wake-up latency. Arena::IDevice::GetImage sleeps until an image arrives,
+//    and the time the scheduler takes to wake the thread adds jitter that
+//    closed-loop control can feel. The GenTL producer underneath Arena
+//    reports a new buffer without waiting when asked with a zero timeout
+//    (GenTL::EventGetData), which makes a non-blocking TryGetImage and a
+//    hybrid wait possible: poll for a while, then park. The example acquires
+//    with the thread parked, with a hybrid wait and with a pure spin, and
+//    prints the latency distribution of each.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// Spin time
+//    Time the hybrid wait polls before parking, in microseconds. It pays off
+//    when it covers most of the gap between frames; a longer spin only burns
+//    the core to the same effect.
+#define SPIN_US 200
+
+// number of images to grab per wait mode
+#define NUM_IMAGES 500
+
+// number of buffers to announce
+#define NUM_BUFFERS 8
+
+// discovery timeout
+#define DISCOVERY_TIMEOUT 100
+
+// image timeout
+#define IMAGE_TIMEOUT 2000
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// host time in nanoseconds
+int64_t HostNs()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Image waiter
+//    Waits for new buffers in one of three ways: parked in the producer until
+//    a buffer arrives, spinning on non-blocking checks for a set time before
+//    parking, or spinning until the image timeout. A spin time of zero parks
+//    straight away; a negative one never parks.
+class ImageWaiter
+{
+public:
+	ImageWaiter(GenTL::EVENT_HANDLE hNewBufferEvent, int64_t spinNs) :
+		m_hNewBufferEvent(hNewBufferEvent),
+		m_spinNs(spinNs),
+		m_spun(0),
+		m_parked(0)
+	{
+	}
+
+	// Try get image
+	//    Returns immediately, with false if no buffer is ready. A timeout is
+	//    the expected outcome, so it is not an error.
+	bool TryGetImage(GenTL::EVENT_NEW_BUFFER_DATA& newBuffer)
+	{
+		size_t size = sizeof(newBuffer);
+		GenTL::GC_ERROR err = GenTL::EventGetData(m_hNewBufferEvent, &newBuffer, &size, 0);
+		if (err == GenTL::GC_ERR_TIMEOUT)
+			return false;
+
+		CheckGC(err, "EventGetData");
+		return true;
+	}
+
+	// Get image
+	// (1) spins on non-blocking checks until the spin time runs out
+	// (2) parks for the rest of the timeout
+	void GetImage(GenTL::EVENT_NEW_BUFFER_DATA& newBuffer, uint64_t timeoutMs)
+	{
+		int64_t start = HostNs();
+		int64_t spinNs = m_spinNs < 0 ? static_cast<int64_t>(timeoutMs) * 1000000 : m_spinNs;
+
+		// spin
+		if (spinNs > 0)
+		{
+			do
+			{
+				if (TryGetImage(newBuffer))
+				{
+					m_spun++;
+					return;
+				}
+			} while (HostNs() - start < spinNs);
+
+			if (m_spinNs < 0)
+				CheckGC(GenTL::GC_ERR_TIMEOUT, "EventGetData");
+		}
+
+		// park
+		uint64_t spentMs = static_cast<uint64_t>((HostNs() - start) / 1000000);
+		size_t size = sizeof(newBuffer);
+		CheckGC(GenTL::EventGetData(m_hNewBufferEvent, &newBuffer, &size, timeoutMs > spentMs ? timeoutMs - spentMs : 0), "EventGetData");
+		m_parked++;
+	}
+
+	uint64_t GetSpun() const { return m_spun; }
+	uint64_t GetParked() const { return m_parked; }
+
+private:
+	GenTL::EVENT_HANDLE m_hNewBufferEvent;
+	int64_t m_spinNs;
+	uint64_t m_spun;
+	uint64_t m_parked;
+};
+
+// Device clock
+//    Maps device timestamps to host time. Device timestamps, both latched and
+//    stamped on buffers, count ticks of the device clock, which are converted
+//    to nanoseconds with the tick frequency the producer reports
+//    (GenTL::DEVICE_INFO_TIMESTAMP_FREQUENCY). Latching the device clock
+//    between two host readings gives the offset to within half the round
+//    trip; the round trip is kept as the offset's uncertainty.
+class DeviceClock
+{
+public:
+	DeviceClock(GenTL::DEV_HANDLE hDevice, GenApi::CNodeMapRef& nodeMap) :
+		m_pTimestampLatch(nodeMap._GetNode("TimestampLatch")),
+		m_pTimestampLatchValue(nodeMap._GetNode("TimestampLatchValue")),
+		m_frequency(0),
+		m_offsetNs(0),
+		m_uncertaintyNs(0)
+	{
+		GenTL::INFO_DATATYPE type = GenTL::INFO_DATATYPE_UNKNOWN;
+		size_t size = sizeof(m_frequency);
+		if (GenTL::DevGetInfo(hDevice, GenTL::DEVICE_INFO_TIMESTAMP_FREQUENCY, &type, &m_frequency, &size) != GenTL::GC_ERR_SUCCESS)
+			m_frequency = 0;
+	}
+
+	bool IsAvailable() const
+	{
+		return m_pTimestampLatch && m_pTimestampLatchValue && m_frequency > 0;
+	}
+
+	void Synchronize()
+	{
+		int64_t before = HostNs();
+		m_pTimestampLatch->Execute();
+		uint64_t ticks = static_cast<uint64_t>(m_pTimestampLatchValue->GetValue());
+		int64_t after = HostNs();
+
+		m_offsetNs = before + (after - before) / 2 - ToNs(ticks);
+		m_uncertaintyNs = after - before;
+	}
+
+	int64_t ToHostNs(uint64_t ticks) const { return ToNs(ticks) + m_offsetNs; }
+	int64_t GetUncertaintyNs() const { return m_uncertaintyNs; }
+
+private:
+	// whole seconds and the remainder are scaled apart so that the product does not overflow
+	int64_t ToNs(uint64_t ticks) const
+	{
+		return static_cast<int64_t>(ticks / m_frequency * 1000000000 + ticks % m_frequency * 1000000000 / m_frequency);
+	}
+
+	GenApi::CCommandPtr m_pTimestampLatch;
+	GenApi::CIntegerPtr m_pTimestampLatchValue;
+	uint64_t m_frequency;
+	int64_t m_offsetNs;
+	int64_t m_uncertaintyNs;
+};
+
+// Wake-up latency
+//    Collects samples and reports percentiles. Latencies are measured from
+//    the device timestamp, so they include transfer as well as wake-up; the
+//    modes share the transfer part, and the differences between them are the
+//    wake-up cost. Without a usable device clock, latencies are measured from
+//    the start of each wait instead, which shows jitter but not its source.
+//    Frames without a timestamp are skipped and counted.
+class LatencyStatistics
+{
+public:
+	LatencyStatistics() :
+		m_skipped(0)
+	{
+	}
+
+	void Add(int64_t latencyNs)
+	{
+		m_samples.push_back(latencyNs);
+	}
+
+	void Skip()
+	{
+		m_skipped++;
+	}
+
+	void Print(const char* mode, const ImageWaiter& waiter)
+	{
+		if (m_samples.empty())
+		{
+			std::cout << TAB2 << std::left << std::setw(8) << mode << std::right << " no samples (" << m_skipped << " skipped)\n";
+			return;
+		}
+
+		std::sort(m_samples.begin(), m_samples.end());
+
+		std::cout << TAB2 << std::left << std::setw(8) << mode << std::right
+				  << " p50 " << std::setw(7) << Percentile(0.50)
+				  << " us, p90 " << std::setw(7) << Percentile(0.90)
+				  << " us, p99 " << std::setw(7) << Percentile(0.99)
+				  << " us, max " << std::setw(7) << m_samples.back() / 1000
+				  << " us (" << waiter.GetSpun() << " spun, " << waiter.GetParked() << " parked, " << m_skipped << " skipped)\n";
+	}
+
+private:
+	int64_t Percentile(double fraction) const
+	{
+		size_t index = static_cast<size_t>(fraction * static_cast<double>(m_samples.size() - 1));
+		return m_samples[index] / 1000;
+	}
+
+	std::vector<int64_t> m_samples;
+	uint64_t m_skipped;
+};
+
+// demonstrates busy waiting for images
+// (1) opens first device found through the GenTL producer
+// (2) announces buffers and starts the stream
+// (3) acquires with each wait mode, collecting latencies
+// (4) prints the latency distribution of each mode
+// (5) stops the stream and revokes buffers
+void CompareWaitModes()
+{
+	// open device
+	std::cout << TAB1 << "Discover devices\n";
+
+	GenTLDevice device;
+	if (!OpenFirstDevice(device, DISCOVERY_TIMEOUT))
+	{
+		std::cout << TAB1 << "No camera connected\n";
+		return;
+	}
+
+	std::cout << TAB2 << "Open " << device.deviceId << "\n";
+
+	RemotePort remotePort(device.hRemotePort);
+	GenApi::CNodeMapRef nodeMap;
+	LoadRemoteNodeMap(device.hRemotePort, remotePort, nodeMap);
+
+	GenTL::DS_HANDLE hDataStream = OpenFirstDataStream(device.hDevice);
+
+	// Allocate and announce buffers
+	//    The producer allocates these itself (GenTL::DSAllocAndAnnounceBuffer);
+	//    where they live does not matter here.
+	size_t payloadSize = GetPayloadSize(hDataStream, nodeMap);
+
+	std::vector<GenTL::BUFFER_HANDLE> buffers(NUM_BUFFERS);
+	for (size_t i = 0; i < buffers.size(); i++)
+	{
+		CheckGC(GenTL::DSAllocAndAnnounceBuffer(hDataStream, payloadSize, NULL, &buffers[i]), "DSAllocAndAnnounceBuffer");
+		CheckGC(GenTL::DSQueueBuffer(hDataStream, buffers[i]), "DSQueueBuffer");
+	}
+
+	// start stream
+	std::cout << TAB1 << "Start stream\n";
+
+	GenTL::EVENT_HANDLE hNewBufferEvent = NULL;
+	CheckGC(GenTL::GCRegisterEvent(hDataStream, GenTL::EVENT_NEW_BUFFER, &hNewBufferEvent), "GCRegisterEvent");
+	CheckGC(GenTL::DSStartAcquisition(hDataStream, GenTL::ACQ_START_FLAGS_DEFAULT, GENTL_INFINITE), "DSStartAcquisition");
+
+	GenApi::CIntegerPtr pTLParamsLocked = nodeMap._GetNode("TLParamsLocked");
+	if (pTLParamsLocked && GenApi::IsWritable(pTLParamsLocked))
+		pTLParamsLocked->SetValue(1);
+
+	GenApi::CCommandPtr pAcquisitionStart = nodeMap._GetNode("AcquisitionStart");
+	pAcquisitionStart->Execute();
+
+	// Acquire with each wait mode
+	//    The clock latencies are measured against is chosen once, so that
+	//    every sample of every mode is measured the same way. The device
+	//    clock is resynchronized before each mode so that drift between the
+	//    clocks does not favour one mode over another.
+	DeviceClock deviceClock(device.hDevice, nodeMap);
+	const bool useDeviceClock = deviceClock.IsAvailable();
+
+	struct WaitMode
+	{
+		const char* name;
+		int64_t spinNs;
+	};
+
+	const WaitMode modes[] = {
+		{ "park", 0 },
+		{ "hybrid", static_cast<int64_t>(SPIN_US) * 1000 },
+		{ "spin", -1 },
+	};
+
+	std::cout << TAB1 << "Acquire " << NUM_IMAGES << " images per wait mode\n";
+
+	std::vector<LatencyStatistics> statistics(sizeof(modes) / sizeof(modes[0]));
+	std::vector<ImageWaiter> waiters;
+
+	for (size_t m = 0; m < statistics.size(); m++)
+	{
+		ImageWaiter waiter(hNewBufferEvent, modes[m].spinNs);
+
+		// Drain
+		//    Buffers filled while the previous mode was wrapping up would
+		//    report a stale latency, so they are requeued unmeasured.
+		GenTL::EVENT_NEW_BUFFER_DATA newBuffer;
+		while (waiter.TryGetImage(newBuffer))
+			CheckGC(GenTL::DSQueueBuffer(hDataStream, newBuffer.BufferHandle), "DSQueueBuffer");
+
+		if (useDeviceClock)
+			deviceClock.Synchronize();
+
+		for (int i = 0; i < NUM_IMAGES; i++)
+		{
+			int64_t waitStart = HostNs();
+			waiter.GetImage(newBuffer, IMAGE_TIMEOUT);
+			int64_t received = HostNs();
+
+			uint64_t timestamp = 0;
+			if (!useDeviceClock)
+				statistics[m].Add(received - waitStart);
+			else if (TryGetBufferInfo(hDataStream, newBuffer.BufferHandle, GenTL::BUFFER_INFO_TIMESTAMP, timestamp))
+				statistics[m].Add(received - deviceClock.ToHostNs(timestamp));
+			else
+				statistics[m].Skip();
+
+			CheckGC(GenTL::DSQueueBuffer(hDataStream, newBuffer.BufferHandle), "DSQueueBuffer");
+		}
+
+		waiters.push_back(waiter);
+	}
+
+	// report
+	std::cout << TAB1 << "Wake-up latency";
+	if (useDeviceClock)
+		std::cout << " from device timestamp (clock offset within " << deviceClock.GetUncertaintyNs() / 1000 << " us)\n";
+	else
+		std::cout << " from start of wait\n";
+
+	for (size_t m = 0; m < statistics.size(); m++)
+		statistics[m].Print(modes[m].name, waiters[m]);
+
+	// stop stream
+	std::cout << TAB1 << "Stop stream\n";
+
+	GenApi::CCommandPtr pAcquisitionStop = nodeMap._GetNode("AcquisitionStop");
+	pAcquisitionStop->Execute();
+
+	if (pTLParamsLocked && GenApi::IsWritable(pTLParamsLocked))
+		pTLParamsLocked->SetValue(0);
+
+	CheckGC(GenTL::DSStopAcquisition(hDataStream, GenTL::ACQ_STOP_FLAGS_DEFAULT), "DSStopAcquisition");
+	CheckGC(GenTL::DSFlushQueue(hDataStream, GenTL::ACQ_QUEUE_ALL_DISCARD), "DSFlushQueue");
+	CheckGC(GenTL::GCUnregisterEvent(hDataStream, GenTL::EVENT_NEW_BUFFER), "GCUnregisterEvent");
+
+	for (size_t i = 0; i < buffers.size(); i++)
+		CheckGC(GenTL::DSRevokeBuffer(hDataStream, buffers[i], NULL, NULL), "DSRevokeBuffer");
+
+	// clean up
+	CheckGC(GenTL::DSClose(hDataStream), "DSClose");
+	CloseFirstDevice(device);
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_Acquisition_BusyWait\n";
+
+	try
+	{
+		// prepare example
+		CheckGC(GenTL::GCInitLib(), "GCInitLib");
+
+		// run example
+		std::cout << "Commence example\n\n";
+		CompareWaitModes();
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		GenTL::GCCloseLib();
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
@@ -0,0 +1,614 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "../GenTLHelpers.h"
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/memfd.h>
+#endif
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Acquisition: Hugepage Buffers
+//    This example demonstrates acquiring into buffers backed by hugepages and
+//    locked in memory. Large payloads (24 MP Mono16, Helios Coord3D_ABCY16)
+//    span thousands of 4 KB pages, so both the acquisition engine scattering
+//    packets into them and the processing that follows spend time on TLB
+//    misses and, under memory pressure, page faults. Buffers allocated by
+//    Arena::IDevice::StartStream use ordinary pages; the GenTL producer
+//    underneath Arena accepts memory from the application instead
+//    (GenTL::DSAnnounceBuffer), so this example allocates the whole pool from
+//    one hugepage-backed block, announces buffers carved from it and reports
+//    which allocation policy was used and how much of the pool it covers.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// Try 1 GB pages
+//    1 GB pages must be reserved at boot (hugepagesz=1G hugepages=N) and are
+//    only tried for pools of a gigabyte or more, since a smaller pool would
+//    still take a whole page; otherwise 2 MB pages are tried first.
+#define USE_1GB_PAGES 1
+
+// lock buffers resident so that they are never paged out
+#define LOCK_BUFFERS 1
+
+// number of buffers to announce
+#define NUM_BUFFERS 10
+
+// number of images to grab
+#define NUM_IMAGES 25
+
+// alignment of buffers within the pool
+#define BUFFER_ALIGNMENT 4096
+
+// discovery timeout
+#define DISCOVERY_TIMEOUT 100
+
+// image timeout
+#define IMAGE_TIMEOUT 2000
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// allocation policies, from most to least preferred
+enum AllocationPolicy
+{
+	POLICY_HUGE_1GB,
+	POLICY_HUGE_2MB,
+	POLICY_TRANSPARENT_HUGE,
+	POLICY_STANDARD
+};
+
+const char* PolicyName(AllocationPolicy policy)
+{
+	switch (policy)
+	{
+	case POLICY_HUGE_1GB:
+		return "1 GB hugepages";
+	case POLICY_HUGE_2MB:
+		return "2 MB hugepages";
+	case POLICY_TRANSPARENT_HUGE:
+		return "transparent hugepages";
+	default:
+		return "standard pages";
+	}
+}
+
+// Buffer arena
+//    One block of memory that all user buffers are carved from, so that a
+//    single hugepage mapping covers the whole pool. Allocation tries each
+//    policy in turn and settles on the first that succeeds:
+//    - 1 GB and 2 MB hugepages come from the kernel's reserved hugetlb pool
+//      (vm.nr_hugepages, or hugepagesz=1G at boot for 1 GB pages) through an
+//      anonymous memfd. On Windows, large pages need the 'Lock pages in
+//      memory' privilege.
+//    - Transparent hugepages need no reservation; the kernel backs the block
+//      with 2 MB pages when it can, which is checked afterwards.
+//    - Standard pages always work.
+//    Hugetlb pages are never swapped; other policies are locked resident with
+//    mlock (VirtualLock on Windows) if LOCK_BUFFERS is set, which may need a
+//    higher RLIMIT_MEMLOCK.
+//
+//    The arena also announces the buffers carved from it, so that it knows
+//    which buffers the producer may still write into and never unmaps the
+//    block under them.
+class BufferArena
+{
+public:
+	BufferArena() :
+		m_pBase(NULL),
+		m_size(0),
+		m_pageSize(0),
+		m_policy(POLICY_STANDARD),
+		m_locked(false),
+		m_hDataStream(NULL)
+	{
+	}
+
+	// Destructor
+	//    Buffers are still announced if acquisition ended early on an
+	//    exception, and the producer may fill any of them until it stops.
+	//    Acquisition is stopped and the queues flushed before the buffers are
+	//    revoked, and the block is only released once every buffer is; if one
+	//    fails to revoke, the block is leaked rather than unmapped under the
+	//    producer. Errors from stopping an already stopped stream are ignored.
+	~BufferArena()
+	{
+		if (!m_buffers.empty())
+		{
+			GenTL::DSStopAcquisition(m_hDataStream, GenTL::ACQ_STOP_FLAGS_KILL);
+			GenTL::DSFlushQueue(m_hDataStream, GenTL::ACQ_QUEUE_ALL_DISCARD);
+
+			bool revoked = true;
+			for (size_t i = 0; i < m_buffers.size(); i++)
+				revoked = GenTL::DSRevokeBuffer(m_hDataStream, m_buffers[i], NULL, NULL) == GenTL::GC_ERR_SUCCESS && revoked;
+
+			if (!revoked)
+				return;
+		}
+
+		Release();
+	}
+
+	// Allocate
+	//    Allocates at least size bytes with the best available policy. 1 GB
+	//    pages are skipped for pools smaller than a page.
+	void Allocate(size_t size)
+	{
+		const size_t gigabyte = static_cast<size_t>(1) << 30;
+		int first = USE_1GB_PAGES && size >= gigabyte ? POLICY_HUGE_1GB : POLICY_HUGE_2MB;
+
+		for (int policy = first; policy <= POLICY_STANDARD; policy++)
+		{
+			if (TryAllocate(static_cast<AllocationPolicy>(policy), size))
+			{
+				m_policy = static_cast<AllocationPolicy>(policy);
+				break;
+			}
+		}
+
+		if (!m_pBase)
+			throw GenICam::GenericException("Failed to allocate buffer arena", __FILE__, __LINE__);
+
+		if (LOCK_BUFFERS)
+			m_locked = Lock();
+	}
+
+	// announces and queues buffers carved from the arena
+	void Announce(GenTL::DS_HANDLE hDataStream, size_t bufferSize, size_t count)
+	{
+		if (bufferSize * count > m_size)
+			throw GenICam::GenericException("Buffers do not fit in buffer arena", __FILE__, __LINE__);
+
+		m_hDataStream = hDataStream;
+		for (size_t i = 0; i < count; i++)
+		{
+			GenTL::BUFFER_HANDLE hBuffer = NULL;
+			CheckGC(GenTL::DSAnnounceBuffer(hDataStream, m_pBase + i * bufferSize, bufferSize, NULL, &hBuffer), "DSAnnounceBuffer");
+			m_buffers.push_back(hBuffer);
+			CheckGC(GenTL::DSQueueBuffer(hDataStream, hBuffer), "DSQueueBuffer");
+		}
+	}
+
+	// revokes all buffers; acquisition must be stopped and the queue flushed
+	void RevokeAll()
+	{
+		while (!m_buffers.empty())
+		{
+			CheckGC(GenTL::DSRevokeBuffer(m_hDataStream, m_buffers.back(), NULL, NULL), "DSRevokeBuffer");
+			m_buffers.pop_back();
+		}
+	}
+
+	uint8_t* GetBase() const { return m_pBase; }
+	size_t GetSize() const { return m_size; }
+	size_t GetPageSize() const { return m_pageSize; }
+	AllocationPolicy GetPolicy() const { return m_policy; }
+	bool IsLocked() const { return m_locked; }
+
+private:
+	static size_t RoundUp(size_t size, size_t multiple)
+	{
+		return ((size + multiple - 1) / multiple) * multiple;
+	}
+
+#ifdef _WIN32
+	bool TryAllocate(AllocationPolicy policy, size_t size)
+	{
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+
+		// Windows offers one large page size and no transparent variant
+		if (policy == POLICY_HUGE_2MB)
+		{
+			size_t largePage = GetLargePageMinimum();
+			if (largePage == 0 || !EnableLockMemoryPrivilege())
+				return false;
+
+			m_size = RoundUp(size, largePage);
+			m_pBase = static_cast<uint8_t*>(VirtualAlloc(NULL, m_size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE));
+			m_pageSize = largePage;
+		}
+		else if (policy == POLICY_STANDARD)
+		{
+			m_size = RoundUp(size, info.dwPageSize);
+			m_pBase = static_cast<uint8_t*>(VirtualAlloc(NULL, m_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+			m_pageSize = info.dwPageSize;
+		}
+
+		return m_pBase != NULL;
+	}
+
+	// large pages need SeLockMemoryPrivilege held and enabled on the process token
+	static bool EnableLockMemoryPrivilege()
+	{
+		HANDLE hToken = NULL;
+		if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &hToken))
+			return false;
+
+		TOKEN_PRIVILEGES privileges;
+		privileges.PrivilegeCount = 1;
+		privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+		bool enabled = LookupPrivilegeValue(NULL, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid) &&
+					   AdjustTokenPrivileges(hToken, FALSE, &privileges, 0, NULL, NULL) &&
+					   GetLastError() == ERROR_SUCCESS;
+
+		CloseHandle(hToken);
+		return enabled;
+	}
+
+	bool Lock()
+	{
+		if (m_policy != POLICY_STANDARD)
+			return true;
+
+		// the working set must be large enough to hold the locked pages
+		SIZE_T minimum = 0;
+		SIZE_T maximum = 0;
+		GetProcessWorkingSetSize(GetCurrentProcess(), &minimum, &maximum);
+		SetProcessWorkingSetSize(GetCurrentProcess(), minimum + m_size, maximum + m_size);
+
+		return VirtualLock(m_pBase, m_size) != 0;
+	}
+
+	void Release()
+	{
+		if (m_pBase)
+			VirtualFree(m_pBase, 0, MEM_RELEASE);
+		m_pBase = NULL;
+	}
+#else
+	bool TryAllocate(AllocationPolicy policy, size_t size)
+	{
+		void* pMemory = MAP_FAILED;
+
+		if (policy == POLICY_HUGE_1GB || policy == POLICY_HUGE_2MB)
+		{
+#ifdef MFD_HUGETLB
+			int shift = policy == POLICY_HUGE_1GB ? 30 : 21;
+			m_pageSize = static_cast<size_t>(1) << shift;
+			m_size = RoundUp(size, m_pageSize);
+
+			// the requested page size is encoded in the flags' upper bits
+			int fd = static_cast<int>(syscall(SYS_memfd_create, "arena_buffers", MFD_CLOEXEC | MFD_HUGETLB | (shift << MFD_HUGE_SHIFT)));
+			if (fd < 0)
+				return false;
+
+			// hugetlb pages are reserved when mapped, so a short pool fails here rather than at first touch
+			if (ftruncate(fd, static_cast<off_t>(m_size)) == 0)
+				pMemory = mmap(NULL, m_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+			close(fd);
+#endif
+		}
+		else if (policy == POLICY_TRANSPARENT_HUGE)
+		{
+			// Align to 2 MB
+			//    Only whole, aligned 2 MB ranges can be backed by a hugepage,
+			//    so the mapping is over-allocated and trimmed to a boundary.
+			m_pageSize = static_cast<size_t>(1) << 21;
+			m_size = RoundUp(size, m_pageSize);
+
+			void* pReserved = mmap(NULL, m_size + m_pageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (pReserved == MAP_FAILED)
+				return false;
+
+			uintptr_t start = reinterpret_cast<uintptr_t>(pReserved);
+			uintptr_t aligned = RoundUp(start, m_pageSize);
+			if (aligned > start)
+				munmap(pReserved, aligned - start);
+			munmap(reinterpret_cast<void*>(aligned + m_size), start + m_pageSize - aligned);
+			pMemory = reinterpret_cast<void*>(aligned);
+
+			if (madvise(pMemory, m_size, MADV_HUGEPAGE) != 0)
+			{
+				munmap(pMemory, m_size);
+				return false;
+			}
+
+			// touch each 2 MB range so the kernel faults in a hugepage now
+			for (size_t offset = 0; offset < m_size; offset += m_pageSize)
+				static_cast<uint8_t*>(pMemory)[offset] = 0;
+
+			// accept the policy only if the kernel actually used hugepages
+			m_pBase = static_cast<uint8_t*>(pMemory);
+			if (GetHugePageBytes() == 0)
+			{
+				munmap(pMemory, m_size);
+				m_pBase = NULL;
+				return false;
+			}
+			return true;
+		}
+		else
+		{
+			m_pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+			m_size = RoundUp(size, m_pageSize);
+			pMemory = mmap(NULL, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		}
+
+		if (pMemory == MAP_FAILED)
+			return false;
+
+		m_pBase = static_cast<uint8_t*>(pMemory);
+		return true;
+	}
+
+	bool Lock()
+	{
+		return mlock(m_pBase, m_size) == 0;
+	}
+
+	void Release()
+	{
+		if (m_pBase)
+			munmap(m_pBase, m_size);
+		m_pBase = NULL;
+	}
+
+public:
+	// Get hugepage bytes
+	//    Reads the arena's entry in /proc/self/smaps and returns how much of it
+	//    is backed by hugepages, hugetlb or transparent.
+	size_t GetHugePageBytes() const
+	{
+		std::ifstream smaps("/proc/self/smaps");
+		std::string line;
+		bool inArena = false;
+		size_t bytes = 0;
+
+		while (std::getline(smaps, line))
+		{
+			// mapping headers start with an address range; fields start with a name
+			unsigned long start = 0;
+			unsigned long end = 0;
+			if (sscanf(line.c_str(), "%lx-%lx ", &start, &end) == 2)
+			{
+				uintptr_t base = reinterpret_cast<uintptr_t>(m_pBase);
+				inArena = start <= base && base < end;
+				continue;
+			}
+
+			if (!inArena)
+				continue;
+
+			unsigned long kilobytes = 0;
+			if (sscanf(line.c_str(), "AnonHugePages: %lu kB", &kilobytes) == 1 ||
+				sscanf(line.c_str(), "Private_Hugetlb: %lu kB", &kilobytes) == 1 ||
+				sscanf(line.c_str(), "Shared_Hugetlb: %lu kB", &kilobytes) == 1)
+			{
+				bytes += kilobytes * 1024;
+			}
+		}
+
+		return bytes;
+	}
+#endif
+
+private:
+	uint8_t* m_pBase;
+	size_t m_size;
+	size_t m_pageSize;
+	AllocationPolicy m_policy;
+	bool m_locked;
+	GenTL::DS_HANDLE m_hDataStream;
+	std::vector<GenTL::BUFFER_HANDLE> m_buffers;
+};
+
+// Sum columns
+//    Walks the image column by column, touching one line per step. Each step
+//    lands on a different 4 KB page for any image wider than a few thousand
+//    bytes, which is where hugepages make the largest difference.
+uint64_t SumColumns(const uint8_t* pData, size_t stride, size_t height)
+{
+	uint64_t sum = 0;
+	for (size_t x = 0; x < stride; x += 64)
+	{
+		for (size_t y = 0; y < height; y++)
+			sum += pData[y * stride + x];
+	}
+	return sum;
+}
+
+// demonstrates acquisition into hugepage buffers
+// (1) opens first device found through the GenTL producer
+// (2) allocates the pool with the best available policy
+// (3) announces buffers carved from the pool
+// (4) acquires images, timing a page-heavy pass over each
+// (5) stops the stream and revokes buffers
+void AcquireIntoHugePageBuffers()
+{
+	// open device
+	std::cout << TAB1 << "Discover devices\n";
+
+	GenTLDevice device;
+	if (!OpenFirstDevice(device, DISCOVERY_TIMEOUT))
+	{
+		std::cout << TAB1 << "No camera connected\n";
+		return;
+	}
+
+	std::cout << TAB2 << "Open " << device.deviceId << "\n";
+
+	RemotePort remotePort(device.hRemotePort);
+	GenApi::CNodeMapRef nodeMap;
+	LoadRemoteNodeMap(device.hRemotePort, remotePort, nodeMap);
+
+	GenTL::DS_HANDLE hDataStream = OpenFirstDataStream(device.hDevice);
+
+	// determine buffer size
+	size_t payloadSize = GetPayloadSize(hDataStream, nodeMap);
+
+	size_t alignment = BUFFER_ALIGNMENT;
+	size_t producerAlignment = 0;
+	if (TryGetStreamInfo(hDataStream, GenTL::STREAM_INFO_BUF_ALIGNMENT, producerAlignment) && producerAlignment > alignment)
+		alignment = producerAlignment;
+
+	size_t bufferSize = ((payloadSize + alignment - 1) / alignment) * alignment;
+
+	// Allocate pool
+	//    The policy is reported here rather than through the stream node map,
+	//    which belongs to the producer.
+	std::cout << TAB1 << "Allocate pool of " << NUM_BUFFERS << " buffers (" << bufferSize << " bytes each)\n";
+
+	BufferArena arena;
+	arena.Allocate(bufferSize * NUM_BUFFERS);
+
+	std::cout << TAB2 << "Policy: " << PolicyName(arena.GetPolicy()) << " (" << arena.GetPageSize() / 1024 << " KB pages)\n";
+	std::cout << TAB2 << "Locked: " << (arena.IsLocked() ? "yes" : "no (raise RLIMIT_MEMLOCK or grant the privilege)") << "\n";
+#ifdef __linux__
+	std::cout << TAB2 << "Hugepage coverage: " << arena.GetHugePageBytes() / 1024 << " of " << arena.GetSize() / 1024 << " KB\n";
+#endif
+
+	// announce buffers carved from the pool
+	arena.Announce(hDataStream, bufferSize, NUM_BUFFERS);
+
+	// start stream
+	std::cout << TAB1 << "Start stream\n";
+
+	GenTL::EVENT_HANDLE hNewBufferEvent = NULL;
+	CheckGC(GenTL::GCRegisterEvent(hDataStream, GenTL::EVENT_NEW_BUFFER, &hNewBufferEvent), "GCRegisterEvent");
+	CheckGC(GenTL::DSStartAcquisition(hDataStream, GenTL::ACQ_START_FLAGS_DEFAULT, GENTL_INFINITE), "DSStartAcquisition");
+
+	GenApi::CIntegerPtr pTLParamsLocked = nodeMap._GetNode("TLParamsLocked");
+	if (pTLParamsLocked && GenApi::IsWritable(pTLParamsLocked))
+		pTLParamsLocked->SetValue(1);
+
+	GenApi::CCommandPtr pAcquisitionStart = nodeMap._GetNode("AcquisitionStart");
+	pAcquisitionStart->Execute();
+
+	// Acquire images
+	//    Running the example once with hugepages reserved and once without
+	//    (or with USE_1GB_PAGES off and vm.nr_hugepages at 0 and transparent
+	//    hugepages disabled) shows the difference in the processing pass.
+	std::cout << TAB1 << "Acquire " << NUM_IMAGES << " images\n";
+
+	double totalUs = 0.0;
+	uint64_t checksum = 0;
+
+	for (int i = 0; i < NUM_IMAGES; i++)
+	{
+		GenTL::EVENT_NEW_BUFFER_DATA newBuffer;
+		size_t newBufferSize = sizeof(newBuffer);
+		CheckGC(GenTL::EventGetData(hNewBufferEvent, &newBuffer, &newBufferSize, IMAGE_TIMEOUT), "EventGetData");
+
+		const uint8_t* pData = GetBufferInfo<uint8_t*>(hDataStream, newBuffer.BufferHandle, GenTL::BUFFER_INFO_BASE) +
+							   GetBufferInfo<size_t>(hDataStream, newBuffer.BufferHandle, GenTL::BUFFER_INFO_IMAGEOFFSET);
+		size_t height = GetBufferInfo<size_t>(hDataStream, newBuffer.BufferHandle, GenTL::BUFFER_INFO_HEIGHT);
+		size_t filled = GetBufferInfo<size_t>(hDataStream, newBuffer.BufferHandle, GenTL::BUFFER_INFO_SIZE_FILLED);
+		size_t stride = height ? filled / height : 0;
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		checksum += SumColumns(pData, stride, height);
+		double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+		totalUs += us;
+
+		std::cout << TAB2 << "Image " << i << " (" << stride << " bytes x " << height << " lines): column pass " << static_cast<uint64_t>(us) << " us\n";
+
+		CheckGC(GenTL::DSQueueBuffer(hDataStream, newBuffer.BufferHandle), "DSQueueBuffer");
+	}
+
+	std::cout << TAB1 << "Average column pass: " << static_cast<uint64_t>(totalUs / NUM_IMAGES) << " us with " << PolicyName(arena.GetPolicy())
+			  << " (checksum " << checksum << ")\n";
+
+	// stop stream
+	std::cout << TAB1 << "Stop stream\n";
+
+	GenApi::CCommandPtr pAcquisitionStop = nodeMap._GetNode("AcquisitionStop");
+	pAcquisitionStop->Execute();
+
+	if (pTLParamsLocked && GenApi::IsWritable(pTLParamsLocked))
+		pTLParamsLocked->SetValue(0);
+
+	CheckGC(GenTL::DSStopAcquisition(hDataStream, GenTL::ACQ_STOP_FLAGS_DEFAULT), "DSStopAcquisition");
+	CheckGC(GenTL::DSFlushQueue(hDataStream, GenTL::ACQ_QUEUE_ALL_DISCARD), "DSFlushQueue");
+	CheckGC(GenTL::GCUnregisterEvent(hDataStream, GenTL::EVENT_NEW_BUFFER), "GCUnregisterEvent");
+
+	// Revoke buffers
+	//    The pool is released when the arena goes out of scope, after every
+	//    buffer carved from it has been revoked.
+	std::cout << TAB1 << "Revoke buffers\n";
+
+	arena.RevokeAll();
+
+	// clean up
+	CheckGC(GenTL::DSClose(hDataStream), "DSClose");
+	CloseFirstDevice(device);
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_Acquisition_HugePageBuffers\n";
+
+	try
+	{
+		// prepare example
+		CheckGC(GenTL::GCInitLib(), "GCInitLib");
+
+		// run example
+		std::cout << "Commence example\n\n";
+		AcquireIntoHugePageBuffers();
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		GenTL::GCCloseLib();
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
@@ -0,0 +1,402 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <chrono>
+#include <iomanip>
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Acquisition: Parallel Start
+//    This example demonstrates bringing up several devices at once instead of
+//    one after another. Most of the time spent preparing a device and
+//    starting its stream (Arena::IDevice::StartStream) is spent waiting on
+//    the device, e.g. while the packet size is negotiated with test packets.
+//    Doing this for each device on its own thread overlaps the waiting, so
+//    this part of bring-up takes as long as the slowest device rather than
+//    the sum of all of them. Opening devices (Arena::ISystem::CreateDevice)
+//    changes the system's shared state and is not made safe to call from
+//    several threads, so devices are still created one at a time. The example
+//    opens, prepares, starts and stops all discovered devices as a group,
+//    once serially and once in parallel, and compares the two.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// number of images to grab per device
+#define NUM_IMAGES 10
+
+// image timeout
+#define IMAGE_TIMEOUT 2000
+
+// system timeout
+#define SYSTEM_TIMEOUT 100
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// Device group
+//    Runs each step on all devices of the group, with one thread per device
+//    or one device after another. Creating devices goes through the system
+//    and is serialized in either case. A failure on one device does not stop the
+//    step on the others; once every device is done, the failures are thrown
+//    together, naming each device. A group that fails to open destroys the
+//    devices that did open, and one that fails to start stops the streams
+//    that did start, so a failed step leaves no device half set up.
+class DeviceGroup
+{
+public:
+	DeviceGroup(Arena::ISystem* pSystem, bool parallel) :
+		m_pSystem(pSystem),
+		m_parallel(parallel)
+	{
+	}
+
+	// opens all devices
+	void Open(std::vector<Arena::DeviceInfo> deviceInfos)
+	{
+		m_devices.assign(deviceInfos.size(), NULL);
+		m_streaming.assign(deviceInfos.size(), 0);
+		m_names.clear();
+		for (auto& deviceInfo : deviceInfos)
+			m_names.push_back(std::string(deviceInfo.ModelName().c_str()) + " " + deviceInfo.SerialNumber().c_str());
+
+		std::vector<std::string> errors = Run([&](size_t i) {
+			std::lock_guard<std::mutex> lock(m_createMutex);
+			m_devices[i] = m_pSystem->CreateDevice(deviceInfos[i]);
+		});
+
+		if (HasErrors(errors))
+		{
+			Close();
+			Throw("open", errors);
+		}
+	}
+
+	// runs a step on every device, e.g. to configure it
+	void ForEach(const char* step, const std::function<void(Arena::IDevice*)>& function)
+	{
+		std::vector<std::string> errors = Run([&](size_t i) {
+			function(m_devices[i]);
+		});
+
+		if (HasErrors(errors))
+			Throw(step, errors);
+	}
+
+	// starts the streams of all devices
+	void StartStreams()
+	{
+		std::vector<std::string> errors = Run([&](size_t i) {
+			m_devices[i]->StartStream();
+			m_streaming[i] = 1;
+		});
+
+		if (HasErrors(errors))
+		{
+			StopStreams();
+			Throw("start", errors);
+		}
+	}
+
+	// stops the streams of all devices that are streaming
+	void StopStreams()
+	{
+		std::vector<std::string> errors = Run([&](size_t i) {
+			if (m_streaming[i])
+			{
+				m_streaming[i] = 0;
+				m_devices[i]->StopStream();
+			}
+		});
+
+		if (HasErrors(errors))
+			Throw("stop", errors);
+	}
+
+	// Close
+	//    Devices are destroyed one after another; this only releases
+	//    resources and takes little time.
+	void Close()
+	{
+		for (auto& pDevice : m_devices)
+		{
+			if (pDevice)
+				m_pSystem->DestroyDevice(pDevice);
+			pDevice = NULL;
+		}
+	}
+
+	const std::vector<Arena::IDevice*>& GetDevices() const
+	{
+		return m_devices;
+	}
+
+private:
+	// runs a function for every device, collecting errors
+	std::vector<std::string> Run(const std::function<void(size_t)>& function)
+	{
+		std::vector<std::string> errors(m_devices.size());
+
+		auto step = [&](size_t i) {
+			try
+			{
+				function(i);
+			}
+			catch (GenICam::GenericException& ge)
+			{
+				errors[i] = ge.what();
+			}
+			catch (std::exception& ex)
+			{
+				errors[i] = ex.what();
+			}
+			catch (...)
+			{
+				errors[i] = "Unexpected exception";
+			}
+		};
+
+		if (!m_parallel)
+		{
+			for (size_t i = 0; i < m_devices.size(); i++)
+				step(i);
+			return errors;
+		}
+
+		// threads can not be copied, only moved
+		std::vector<std::thread> threads;
+		for (size_t i = 0; i < m_devices.size(); i++)
+			threads.push_back(std::thread(step, i));
+
+		for (auto& thread : threads)
+			thread.join();
+
+		return errors;
+	}
+
+	static bool HasErrors(const std::vector<std::string>& errors)
+	{
+		for (const auto& error : errors)
+		{
+			if (!error.empty())
+				return true;
+		}
+		return false;
+	}
+
+	void Throw(const char* step, const std::vector<std::string>& errors) const
+	{
+		std::string description = std::string("Failed to ") + step + " device group:";
+		for (size_t i = 0; i < errors.size(); i++)
+		{
+			if (!errors[i].empty())
+				description += "\n" TAB1 + m_names[i] + ": " + errors[i];
+		}
+
+		throw GenICam::GenericException(description.c_str(), __FILE__, __LINE__);
+	}
+
+	Arena::ISystem* m_pSystem;
+	bool m_parallel;
+	std::mutex m_createMutex;
+	std::vector<Arena::IDevice*> m_devices;
+	std::vector<std::string> m_names;
+	std::vector<uint8_t> m_streaming;
+};
+
+// prepares a device for streaming
+//    Packet size negotiation and packet resend are set before starting the
+//    stream, as in Cpp_Acquisition_MultiDevice.
+void PrepareDevice(Arena::IDevice* pDevice)
+{
+	Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetTLStreamNodeMap(), "StreamBufferHandlingMode", "NewestOnly");
+	Arena::SetNodeValue<bool>(pDevice->GetTLStreamNodeMap(), "StreamAutoNegotiatePacketSize", true);
+	Arena::SetNodeValue<bool>(pDevice->GetTLStreamNodeMap(), "StreamPacketResendEnable", true);
+}
+
+// grabs images to check that the stream runs
+void GrabImages(Arena::IDevice* pDevice)
+{
+	for (int i = 0; i < NUM_IMAGES; i++)
+	{
+		Arena::IImage* pImage = pDevice->GetImage(IMAGE_TIMEOUT);
+		pDevice->RequeueBuffer(pImage);
+	}
+}
+
+// milliseconds since a point in time
+double MsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Bring-up statistics
+//    Time to open all devices, to prepare them and start their streams, and
+//    to stop their streams and destroy them. Opening is serialized either
+//    way, so only the start time shows the gain of running in parallel.
+struct BringUpStatistics
+{
+	double openMs;
+	double startMs;
+	double stopMs;
+};
+
+// demonstrates bringing up a group of devices
+// (1) opens all devices
+// (2) prepares all devices and starts their streams
+// (3) grabs images from all devices
+// (4) stops all streams and destroys all devices
+BringUpStatistics BringUp(Arena::ISystem* pSystem, const std::vector<Arena::DeviceInfo>& deviceInfos, bool parallel)
+{
+	BringUpStatistics statistics;
+	DeviceGroup group(pSystem, parallel);
+
+	// open devices
+	std::cout << TAB2 << "Open " << deviceInfos.size() << " device" << (deviceInfos.size() == 1 ? "" : "s") << "\n";
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	group.Open(deviceInfos);
+	statistics.openMs = MsSince(start);
+
+	// Start streams
+	//    From here on, a failure must still destroy the devices, so the group
+	//    is closed before the exception moves on.
+	try
+	{
+		std::cout << TAB2 << "Prepare devices and start streams\n";
+
+		start = std::chrono::steady_clock::now();
+		group.ForEach("prepare", PrepareDevice);
+		group.StartStreams();
+		statistics.startMs = MsSince(start);
+
+		// grab images
+		std::cout << TAB2 << "Grab " << NUM_IMAGES << " images per device\n";
+
+		group.ForEach("grab images from", GrabImages);
+
+		// stop streams
+		std::cout << TAB2 << "Stop streams and destroy devices\n";
+
+		start = std::chrono::steady_clock::now();
+		group.StopStreams();
+		group.Close();
+		statistics.stopMs = MsSince(start);
+	}
+	catch (...)
+	{
+		group.Close();
+		throw;
+	}
+
+	return statistics;
+}
+
+void PrintStatistics(const char* mode, const BringUpStatistics& statistics)
+{
+	std::cout << TAB2 << std::left << std::setw(10) << mode << std::right << std::fixed << std::setprecision(1)
+			  << " open " << std::setw(8) << statistics.openMs << " ms, start " << std::setw(8) << statistics.startMs
+			  << " ms, stop " << std::setw(8) << statistics.stopMs << " ms\n";
+	std::cout.unsetf(std::ios::fixed);
+}
+
+// demonstrates serial and parallel bring-up
+// (1) brings up all devices one after another
+// (2) brings up all devices in parallel
+// (3) compares the two
+void CompareBringUp(Arena::ISystem* pSystem, const std::vector<Arena::DeviceInfo>& deviceInfos)
+{
+	std::cout << TAB1 << "Bring up devices one after another\n";
+
+	BringUpStatistics serial = BringUp(pSystem, deviceInfos, false);
+
+	std::cout << TAB1 << "Bring up devices in parallel\n";
+
+	BringUpStatistics parallel = BringUp(pSystem, deviceInfos, true);
+
+	std::cout << TAB1 << "Compare\n";
+
+	PrintStatistics("Serial", serial);
+	PrintStatistics("Parallel", parallel);
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_Acquisition_ParallelStart\n";
+
+	try
+	{
+		// prepare example
+		Arena::ISystem* pSystem = Arena::OpenSystem();
+		pSystem->UpdateDevices(SYSTEM_TIMEOUT);
+		std::vector<Arena::DeviceInfo> deviceInfos = pSystem->GetDevices();
+		if (deviceInfos.size() == 0)
+		{
+			std::cout << "\nNo camera connected\nPress enter to complete\n";
+			std::getchar();
+			return 0;
+		}
+		if (deviceInfos.size() < 2)
+		{
+			std::cout << "\nThis example is recommended to run with more than one device to show the difference clearly\n";
+		}
+
+		// run example
+		std::cout << "Commence example\n\n";
+		CompareBringUp(pSystem, deviceInfos);
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		Arena::CloseSystem(pSystem);
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
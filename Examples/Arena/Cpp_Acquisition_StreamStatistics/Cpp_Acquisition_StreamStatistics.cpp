@@ -0,0 +1,599 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Acquisition: Stream Statistics
+//    This example demonstrates collecting per-stream runtime statistics that a
+//    monitoring thread can read at a high rate without slowing acquisition
+//    down. Stream nodes are resolved once up front instead of being looked up
+//    by name on every poll, a sampler thread mirrors their values into atomic
+//    counters, and the acquisition thread publishes its own counters (images,
+//    bytes, held buffers, time spent waiting in GetImage and frame-to-delivery
+//    latency) the same way. A telemetry thread then takes a snapshot every
+//    millisecond using nothing but atomic loads.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// number of images to grab
+#define NUM_IMAGES 500
+
+// number of stream buffers
+#define NUM_BUFFERS 10
+
+// Sample interval
+//    Interval (in milliseconds) at which the sampler thread reads the stream
+//    node map. Node reads go through the node map and take its lock, so they
+//    are kept off both the acquisition and the telemetry thread.
+#define SAMPLE_INTERVAL_MS 100
+
+// Latch interval
+//    Interval (in milliseconds) at which the device timestamp is re-latched to
+//    correct the host/device clock offset used for latency measurements.
+#define LATCH_INTERVAL_MS 1000
+
+// Telemetry period
+//    Period (in microseconds) at which the telemetry thread takes snapshots;
+//    1000 microseconds is a 1 kHz reader.
+#define TELEMETRY_PERIOD_US 1000
+
+// image timeout
+#define IMAGE_TIMEOUT 2000
+
+// system timeout
+#define SYSTEM_TIMEOUT 100
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- HELPERS =-=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// host monotonic time in nanoseconds
+static int64_t HostNowNs()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+// raises an atomic maximum without a lock
+static void UpdateMax(std::atomic<uint64_t>& max, uint64_t value)
+{
+	uint64_t current = max.load(std::memory_order_relaxed);
+	while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+	{
+	}
+}
+
+// lowers an atomic minimum without a lock
+static void UpdateMin(std::atomic<uint64_t>& min, uint64_t value)
+{
+	uint64_t current = min.load(std::memory_order_relaxed);
+	while (value < current && !min.compare_exchange_weak(current, value, std::memory_order_relaxed))
+	{
+	}
+}
+
+// Stream statistics snapshot
+//    Plain copy of every counter at the moment of the snapshot. Each field is
+//    read atomically, but fields are not read as one transaction: a snapshot
+//    taken while an image is being recorded may count it in one field and not
+//    yet in another. Node-backed fields are as fresh as the last sample.
+struct StreamStatisticsSnapshot
+{
+	// host-side counters, updated by the acquisition thread
+	uint64_t images;
+	uint64_t bytes;
+	uint64_t incompleteImages;
+	uint64_t heldBuffers;
+	uint64_t heldBuffersHighWater;
+	uint64_t getImageWaitNs;
+	uint64_t latencyLastNs;
+	uint64_t latencyMinNs;
+	uint64_t latencyMaxNs;
+	uint64_t latencyMeanNs;
+
+	// stream node map counters, updated by the sampler thread
+	uint64_t deliveredFrames;
+	uint64_t lostFrames;
+	uint64_t missedImages;
+	uint64_t missedPackets;
+	uint64_t cumulativeMissedImages;
+	uint64_t cumulativeIncompleteImages;
+	uint64_t inputQueue;
+	uint64_t outputQueue;
+	uint64_t samples;
+
+	// Output queue high-water mark
+	//    Deepest output queue seen by the sampler. Buffers are queued inside
+	//    the acquisition engine, where they cannot be counted, so this is
+	//    sampled every SAMPLE_INTERVAL_MS and misses peaks shorter than that.
+	uint64_t outputQueueHighWater;
+};
+
+// Stream statistics
+//    Collects statistics for one device's stream. RecordImage and
+//    RecordRequeue are called only from the acquisition thread, Sample and
+//    Latch only from the sampler thread, and Snapshot from any number of
+//    readers. Writers and readers share nothing but relaxed atomics; the two
+//    groups of counters sit on separate cache lines so that the acquisition
+//    thread and the sampler thread do not invalidate each other's lines.
+class StreamStatistics
+{
+public:
+	StreamStatistics(Arena::IDevice* pDevice) :
+		m_clockOffsetNs(0),
+		m_images(0),
+		m_bytes(0),
+		m_incompleteImages(0),
+		m_heldBuffers(0),
+		m_heldBuffersHighWater(0),
+		m_getImageWaitNs(0),
+		m_latencyCount(0),
+		m_latencySumNs(0),
+		m_latencyLastNs(0),
+		m_latencyMinNs(UINT64_MAX),
+		m_latencyMaxNs(0),
+		m_deliveredFrames(0),
+		m_lostFrames(0),
+		m_missedImages(0),
+		m_missedPackets(0),
+		m_cumulativeMissedImages(0),
+		m_cumulativeIncompleteImages(0),
+		m_inputQueue(0),
+		m_outputQueue(0),
+		m_outputQueueHighWater(0),
+		m_samples(0)
+	{
+		// Resolve nodes once
+		//    Looking a node up by name walks the node map's dictionary and is
+		//    by far the most expensive part of reading a counter. Resolving
+		//    every node once here leaves only the value read on the sample
+		//    path. Nodes a transport layer does not provide stay null and are
+		//    skipped.
+		GenApi::INodeMap* pTLStreamNodeMap = pDevice->GetTLStreamNodeMap();
+
+		m_pDeliveredFrameCount = pTLStreamNodeMap->GetNode("StreamDeliveredFrameCount");
+		m_pLostFrameCount = pTLStreamNodeMap->GetNode("StreamLostFrameCount");
+		m_pMissedImageCount = pTLStreamNodeMap->GetNode("StreamMissedImageCount");
+		m_pMissedPacketCount = pTLStreamNodeMap->GetNode("StreamMissedPacketCount");
+		m_pCumulativeMissedImageCount = pTLStreamNodeMap->GetNode("StreamCumulativeMissedImageCount");
+		m_pCumulativeIncompleteImageCount = pTLStreamNodeMap->GetNode("StreamCumulativeIncompleteImageCount");
+		m_pInputBufferCount = pTLStreamNodeMap->GetNode("StreamInputBufferCount");
+		m_pOutputBufferCount = pTLStreamNodeMap->GetNode("StreamOutputBufferCount");
+
+		GenApi::INodeMap* pNodeMap = pDevice->GetNodeMap();
+
+		m_pTimestampLatch = pNodeMap->GetNode("TimestampLatch");
+		m_pTimestampLatchValue = pNodeMap->GetNode("TimestampLatchValue");
+	}
+
+	// latches the device timestamp and derives the host/device clock offset
+	// (1) reads host time
+	// (2) latches device timestamp
+	// (3) reads host time again
+	// (4) maps device time to the midpoint of the two host reads
+	bool Latch()
+	{
+		if (!m_pTimestampLatch || !GenApi::IsWritable(m_pTimestampLatch) ||
+			!m_pTimestampLatchValue || !GenApi::IsReadable(m_pTimestampLatchValue))
+			return false;
+
+		int64_t before = HostNowNs();
+		m_pTimestampLatch->Execute();
+		int64_t after = HostNowNs();
+
+		int64_t deviceNs = m_pTimestampLatchValue->GetValue();
+		m_clockOffsetNs.store(before + (after - before) / 2 - deviceNs, std::memory_order_relaxed);
+		return true;
+	}
+
+	// records a retrieved image
+	// (1) counts image, bytes and incomplete images
+	// (2) tracks buffers held by the application
+	// (3) accumulates time spent waiting in GetImage
+	// (4) computes frame-to-delivery latency from the device timestamp
+	void RecordImage(Arena::IImage* pImage, int64_t receivedNs, int64_t waitNs, bool latched)
+	{
+		m_images.fetch_add(1, std::memory_order_relaxed);
+		m_bytes.fetch_add(pImage->GetSizeFilled(), std::memory_order_relaxed);
+		if (pImage->IsIncomplete())
+			m_incompleteImages.fetch_add(1, std::memory_order_relaxed);
+
+		uint64_t held = m_heldBuffers.fetch_add(1, std::memory_order_relaxed) + 1;
+		UpdateMax(m_heldBuffersHighWater, held);
+
+		m_getImageWaitNs.fetch_add(static_cast<uint64_t>(waitNs), std::memory_order_relaxed);
+
+		// Frame-to-delivery latency
+		//    The image timestamp is taken by the device when the frame starts.
+		//    Mapping it onto the host clock through the latched offset and
+		//    subtracting it from the time GetImage returned gives the time
+		//    from frame start to delivery, including exposure, readout,
+		//    transfer and reassembly.
+		if (!latched)
+			return;
+
+		int64_t frameNs = static_cast<int64_t>(pImage->GetTimestampNs()) + m_clockOffsetNs.load(std::memory_order_relaxed);
+		int64_t latencyNs = receivedNs - frameNs;
+		if (latencyNs < 0)
+			latencyNs = 0;
+
+		uint64_t latency = static_cast<uint64_t>(latencyNs);
+		m_latencyLastNs.store(latency, std::memory_order_relaxed);
+		m_latencySumNs.fetch_add(latency, std::memory_order_relaxed);
+		m_latencyCount.fetch_add(1, std::memory_order_relaxed);
+		UpdateMin(m_latencyMinNs, latency);
+		UpdateMax(m_latencyMaxNs, latency);
+	}
+
+	// records a requeued buffer
+	void RecordRequeue()
+	{
+		m_heldBuffers.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	// samples stream node map counters
+	// (1) reads each resolved node
+	// (2) publishes values
+	// (3) raises sampled output queue high-water mark
+	void Sample()
+	{
+		Publish(m_pDeliveredFrameCount, m_deliveredFrames);
+		Publish(m_pLostFrameCount, m_lostFrames);
+		Publish(m_pMissedImageCount, m_missedImages);
+		Publish(m_pMissedPacketCount, m_missedPackets);
+		Publish(m_pCumulativeMissedImageCount, m_cumulativeMissedImages);
+		Publish(m_pCumulativeIncompleteImageCount, m_cumulativeIncompleteImages);
+		Publish(m_pInputBufferCount, m_inputQueue);
+		Publish(m_pOutputBufferCount, m_outputQueue);
+
+		UpdateMax(m_outputQueueHighWater, m_outputQueue.load(std::memory_order_relaxed));
+		m_samples.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// takes a snapshot of every counter; safe from any thread, never blocks
+	StreamStatisticsSnapshot Snapshot() const
+	{
+		StreamStatisticsSnapshot snapshot;
+
+		snapshot.images = m_images.load(std::memory_order_relaxed);
+		snapshot.bytes = m_bytes.load(std::memory_order_relaxed);
+		snapshot.incompleteImages = m_incompleteImages.load(std::memory_order_relaxed);
+		snapshot.heldBuffers = m_heldBuffers.load(std::memory_order_relaxed);
+		snapshot.heldBuffersHighWater = m_heldBuffersHighWater.load(std::memory_order_relaxed);
+		snapshot.getImageWaitNs = m_getImageWaitNs.load(std::memory_order_relaxed);
+
+		uint64_t latencyCount = m_latencyCount.load(std::memory_order_relaxed);
+		uint64_t latencySum = m_latencySumNs.load(std::memory_order_relaxed);
+		snapshot.latencyLastNs = m_latencyLastNs.load(std::memory_order_relaxed);
+		snapshot.latencyMinNs = latencyCount ? m_latencyMinNs.load(std::memory_order_relaxed) : 0;
+		snapshot.latencyMaxNs = m_latencyMaxNs.load(std::memory_order_relaxed);
+		snapshot.latencyMeanNs = latencyCount ? latencySum / latencyCount : 0;
+
+		snapshot.deliveredFrames = m_deliveredFrames.load(std::memory_order_relaxed);
+		snapshot.lostFrames = m_lostFrames.load(std::memory_order_relaxed);
+		snapshot.missedImages = m_missedImages.load(std::memory_order_relaxed);
+		snapshot.missedPackets = m_missedPackets.load(std::memory_order_relaxed);
+		snapshot.cumulativeMissedImages = m_cumulativeMissedImages.load(std::memory_order_relaxed);
+		snapshot.cumulativeIncompleteImages = m_cumulativeIncompleteImages.load(std::memory_order_relaxed);
+		snapshot.inputQueue = m_inputQueue.load(std::memory_order_relaxed);
+		snapshot.outputQueue = m_outputQueue.load(std::memory_order_relaxed);
+		snapshot.outputQueueHighWater = m_outputQueueHighWater.load(std::memory_order_relaxed);
+		snapshot.samples = m_samples.load(std::memory_order_relaxed);
+
+		return snapshot;
+	}
+
+	// reports whether counters are implemented without locks on this platform
+	bool IsLockFree() const
+	{
+		return m_images.is_lock_free() && m_clockOffsetNs.is_lock_free();
+	}
+
+private:
+	static void Publish(GenApi::CIntegerPtr& pNode, std::atomic<uint64_t>& counter)
+	{
+		if (pNode && GenApi::IsReadable(pNode))
+			counter.store(static_cast<uint64_t>(pNode->GetValue()), std::memory_order_relaxed);
+	}
+
+	// resolved nodes, used by the sampler thread only
+	GenApi::CIntegerPtr m_pDeliveredFrameCount;
+	GenApi::CIntegerPtr m_pLostFrameCount;
+	GenApi::CIntegerPtr m_pMissedImageCount;
+	GenApi::CIntegerPtr m_pMissedPacketCount;
+	GenApi::CIntegerPtr m_pCumulativeMissedImageCount;
+	GenApi::CIntegerPtr m_pCumulativeIncompleteImageCount;
+	GenApi::CIntegerPtr m_pInputBufferCount;
+	GenApi::CIntegerPtr m_pOutputBufferCount;
+	GenApi::CCommandPtr m_pTimestampLatch;
+	GenApi::CIntegerPtr m_pTimestampLatchValue;
+
+	std::atomic<int64_t> m_clockOffsetNs;
+
+	// written by the acquisition thread
+	alignas(64) std::atomic<uint64_t> m_images;
+	std::atomic<uint64_t> m_bytes;
+	std::atomic<uint64_t> m_incompleteImages;
+	std::atomic<uint64_t> m_heldBuffers;
+	std::atomic<uint64_t> m_heldBuffersHighWater;
+	std::atomic<uint64_t> m_getImageWaitNs;
+	std::atomic<uint64_t> m_latencyCount;
+	std::atomic<uint64_t> m_latencySumNs;
+	std::atomic<uint64_t> m_latencyLastNs;
+	std::atomic<uint64_t> m_latencyMinNs;
+	std::atomic<uint64_t> m_latencyMaxNs;
+
+	// written by the sampler thread
+	alignas(64) std::atomic<uint64_t> m_deliveredFrames;
+	std::atomic<uint64_t> m_lostFrames;
+	std::atomic<uint64_t> m_missedImages;
+	std::atomic<uint64_t> m_missedPackets;
+	std::atomic<uint64_t> m_cumulativeMissedImages;
+	std::atomic<uint64_t> m_cumulativeIncompleteImages;
+	std::atomic<uint64_t> m_inputQueue;
+	std::atomic<uint64_t> m_outputQueue;
+	std::atomic<uint64_t> m_outputQueueHighWater;
+	std::atomic<uint64_t> m_samples;
+};
+
+// prints a snapshot
+void PrintSnapshot(const StreamStatisticsSnapshot& s)
+{
+	std::cout << TAB2 << "images " << s.images << " (" << s.incompleteImages << " incomplete), " << s.bytes << " bytes\n";
+	std::cout << TAB2 << "delivered " << s.deliveredFrames << ", lost " << s.lostFrames << ", missed images " << s.missedImages << " (cumulative " << s.cumulativeMissedImages << "), missed packets " << s.missedPackets << ", cumulative incomplete " << s.cumulativeIncompleteImages << "\n";
+	std::cout << TAB2 << "queues: input " << s.inputQueue << ", output " << s.outputQueue << " (sampled high-water " << s.outputQueueHighWater << "), held by application " << s.heldBuffers << " (high-water " << s.heldBuffersHighWater << ")\n";
+	std::cout << TAB2 << "waiting in GetImage " << s.getImageWaitNs / 1000000 << " ms\n";
+	std::cout << TAB2 << "frame-to-delivery latency (us): last " << s.latencyLastNs / 1000 << ", min " << s.latencyMinNs / 1000 << ", mean " << s.latencyMeanNs / 1000 << ", max " << s.latencyMaxNs / 1000 << "\n";
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// demonstrates stream statistics
+// (1) prepares acquisition and stream settings
+// (2) resolves statistics nodes and latches device clock
+// (3) starts sampler and telemetry threads
+// (4) acquires images, recording each one
+// (5) stops threads and prints final statistics
+void AcquireImagesWithStatistics(Arena::IDevice* pDevice)
+{
+	GenApi::INodeMap* pNodeMap = pDevice->GetNodeMap();
+	GenApi::INodeMap* pTLStreamNodeMap = pDevice->GetTLStreamNodeMap();
+
+	// get node values that will be changed in order to return their values at
+	// the end of the example
+	GenICam::gcstring acquisitionModeInitial = Arena::GetNodeValue<GenICam::gcstring>(pNodeMap, "AcquisitionMode");
+
+	// prepare acquisition and stream settings
+	std::cout << TAB1 << "Prepare acquisition and stream settings\n";
+
+	Arena::SetNodeValue<GenICam::gcstring>(pNodeMap, "AcquisitionMode", "Continuous");
+	Arena::SetNodeValue<bool>(pTLStreamNodeMap, "StreamAutoNegotiatePacketSize", true);
+	Arena::SetNodeValue<bool>(pTLStreamNodeMap, "StreamPacketResendEnable", true);
+
+	// Resolve statistics nodes
+	//    Creating the statistics object resolves every node it reads. Latching
+	//    the device timestamp gives the offset between device and host clocks
+	//    used to turn image timestamps into frame-to-delivery latency. Devices
+	//    without a timestamp latch still report every other statistic.
+	std::cout << TAB1 << "Resolve statistics nodes and latch device clock\n";
+
+	StreamStatistics statistics(pDevice);
+	bool latched = statistics.Latch();
+
+	std::cout << TAB2 << "counters " << (statistics.IsLockFree() ? "are" : "are not") << " lock-free\n";
+	std::cout << TAB2 << "latency " << (latched ? "measured from device timestamp latch" : "unavailable (no timestamp latch)") << "\n";
+
+	// Start sampler and telemetry threads
+	//    The sampler thread reads the stream node map every SAMPLE_INTERVAL_MS
+	//    and re-latches the device clock every LATCH_INTERVAL_MS to keep clock
+	//    drift out of the latency figures. The telemetry thread stands in for
+	//    a monitoring client polling at 1 kHz; it only ever calls Snapshot, so
+	//    it cannot stall acquisition however often it reads.
+	std::cout << TAB1 << "Start sampler and telemetry threads\n";
+
+	std::atomic<bool> running(true);
+	std::atomic<uint64_t> telemetryReads(0);
+	std::atomic<uint64_t> telemetryMaxReadNs(0);
+	std::atomic<uint64_t> samplerErrors(0);
+
+	// Sampler thread
+	//    Node reads and the latch command can throw, e.g. when the device
+	//    drops off the network. An exception escaping a thread terminates the
+	//    program, so errors are counted here and sampling carries on.
+	std::thread sampler([&]() {
+		auto nextLatch = std::chrono::steady_clock::now() + std::chrono::milliseconds(LATCH_INTERVAL_MS);
+		while (running.load(std::memory_order_relaxed))
+		{
+			try
+			{
+				statistics.Sample();
+
+				if (latched && std::chrono::steady_clock::now() >= nextLatch)
+				{
+					nextLatch += std::chrono::milliseconds(LATCH_INTERVAL_MS);
+					statistics.Latch();
+				}
+			}
+			catch (GenICam::GenericException&)
+			{
+				samplerErrors.fetch_add(1, std::memory_order_relaxed);
+			}
+			catch (std::exception&)
+			{
+				samplerErrors.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(SAMPLE_INTERVAL_MS));
+		}
+	});
+
+	std::thread telemetry([&]() {
+		auto next = std::chrono::steady_clock::now();
+		auto nextPrint = next + std::chrono::seconds(1);
+		while (running.load(std::memory_order_relaxed))
+		{
+			int64_t before = HostNowNs();
+			StreamStatisticsSnapshot snapshot = statistics.Snapshot();
+			int64_t after = HostNowNs();
+
+			telemetryReads.fetch_add(1, std::memory_order_relaxed);
+			UpdateMax(telemetryMaxReadNs, static_cast<uint64_t>(after - before));
+
+			if (std::chrono::steady_clock::now() >= nextPrint)
+			{
+				std::cout << TAB1 << "Telemetry\n";
+				PrintSnapshot(snapshot);
+				nextPrint += std::chrono::seconds(1);
+			}
+
+			next += std::chrono::microseconds(TELEMETRY_PERIOD_US);
+			std::this_thread::sleep_until(next);
+		}
+	});
+
+	// Stop threads
+	//    Threads that are still joinable when they go out of scope terminate
+	//    the program, so they are stopped and joined on every path out of
+	//    acquisition, including exceptions.
+	auto stopThreads = [&]() {
+		running.store(false, std::memory_order_relaxed);
+		if (sampler.joinable())
+			sampler.join();
+		if (telemetry.joinable())
+			telemetry.join();
+	};
+
+	try
+	{
+		// start stream
+		std::cout << TAB1 << "Start stream with " << NUM_BUFFERS << " buffers\n";
+
+		pDevice->StartStream(NUM_BUFFERS);
+
+		// Acquire images
+		//    Time spent blocked in GetImage is the acquisition thread's idle time;
+		//    a value near zero means the application, not the camera, is the
+		//    bottleneck. The receive time is taken as soon as GetImage returns so
+		//    that the latency excludes application processing.
+		std::cout << TAB1 << "Acquire " << NUM_IMAGES << " images\n";
+
+		for (int i = 0; i < NUM_IMAGES; i++)
+		{
+			int64_t waitStart = HostNowNs();
+			Arena::IImage* pImage = pDevice->GetImage(IMAGE_TIMEOUT);
+			int64_t receivedNs = HostNowNs();
+
+			statistics.RecordImage(pImage, receivedNs, receivedNs - waitStart, latched);
+
+			pDevice->RequeueBuffer(pImage);
+			statistics.RecordRequeue();
+		}
+
+		// stop stream
+		std::cout << TAB1 << "Stop stream\n";
+
+		pDevice->StopStream();
+	}
+	catch (...)
+	{
+		stopThreads();
+		throw;
+	}
+
+	// stop threads
+	stopThreads();
+
+	// take one last sample so node counters reflect the whole run
+	statistics.Sample();
+
+	std::cout << TAB1 << "Final statistics\n";
+	PrintSnapshot(statistics.Snapshot());
+	std::cout << TAB2 << "telemetry took " << telemetryReads.load() << " snapshots (slowest " << telemetryMaxReadNs.load() << " ns), sampler hit " << samplerErrors.load() << " error(s)\n";
+
+	// return nodes to their initial values
+	Arena::SetNodeValue<GenICam::gcstring>(pNodeMap, "AcquisitionMode", acquisitionModeInitial);
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_Acquisition_StreamStatistics\n";
+
+	try
+	{
+		// prepare example
+		Arena::ISystem* pSystem = Arena::OpenSystem();
+		pSystem->UpdateDevices(SYSTEM_TIMEOUT);
+		std::vector<Arena::DeviceInfo> deviceInfos = pSystem->GetDevices();
+		if (deviceInfos.size() == 0)
+		{
+			std::cout << "\nNo camera connected\nPress enter to complete\n";
+			std::getchar();
+			return 0;
+		}
+		Arena::IDevice* pDevice = pSystem->CreateDevice(deviceInfos[0]);
+
+		// run example
+		std::cout << "Commence example\n\n";
+		AcquireImagesWithStatistics(pDevice);
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		pSystem->DestroyDevice(pDevice);
+		Arena::CloseSystem(pSystem);
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
@@ -0,0 +1,580 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+#include <vector>
+#include <set>
+#include <map>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <algorithm>
+#include <iomanip>
+#include <cstring>
+#include <cerrno>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+#define TAB1 "  "
+#define TAB2 "    "
+#define TAB3 "      "
+
+// Acquisition: Thread Placement
+//    This example demonstrates placing the threads that serve each device on
+//    chosen cores, raising the priority of its stream threads and keeping its
+//    buffers on the memory node of those cores. Arena creates its threads
+//    internally, so they are found by listing the process's threads before
+//    and after each step that creates them: opening the system, creating a
+//    device and starting its stream. The image callback thread is identified
+//    from inside the callback. On big.LITTLE systems the example prefers the
+//    cores with the highest capacity, and on NUMA systems it starts the stream
+//    from a thread bound to the target node so that the stream's buffers are
+//    allocated there. This example requires Linux.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// Stream priority
+//    SCHED_FIFO priority (1 to 99) given to each device's stream threads, or
+//    0 to leave them under the default scheduler. Real-time priority needs
+//    CAP_SYS_NICE or an RLIMIT_RTPRIO allowance; without either the example
+//    reports the failure and carries on.
+#define STREAM_PRIORITY 20
+
+// time to stream (in seconds)
+#define STREAM_TIME_SEC 5
+
+// system timeout
+#define SYSTEM_TIMEOUT 100
+
+#ifdef __linux__
+
+// set_mempolicy mode; from linux/mempolicy.h, which C libraries do not wrap
+#define MPOL_PREFERRED 1
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- HELPERS =-=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// CPU description
+struct CpuInfo
+{
+	int cpu;
+	int capacity;
+	int node;
+};
+
+// reads the first line of a small file, or returns an empty string
+static std::string ReadLine(const std::string& path)
+{
+	std::ifstream file(path.c_str());
+	std::string line;
+	std::getline(file, line);
+	return line;
+}
+
+// Get CPUs
+//    Lists the CPUs the process may run on with their relative capacity and
+//    memory node. ARM kernels publish cpu_capacity, which separates big and
+//    LITTLE cores; elsewhere the maximum frequency stands in for it, and if
+//    neither is available all cores are treated as equal.
+std::vector<CpuInfo> GetCpus()
+{
+	std::vector<CpuInfo> cpus;
+
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	sched_getaffinity(0, sizeof(allowed), &allowed);
+
+	for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+	{
+		if (!CPU_ISSET(cpu, &allowed))
+			continue;
+
+		std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+
+		CpuInfo info;
+		info.cpu = cpu;
+		info.capacity = 1;
+		info.node = 0;
+
+		std::string capacity = ReadLine(base + "/cpu_capacity");
+		if (capacity.empty())
+			capacity = ReadLine(base + "/cpufreq/cpuinfo_max_freq");
+		if (!capacity.empty())
+			info.capacity = std::stoi(capacity);
+
+		// the node of a CPU shows up as a nodeN entry in its directory
+		DIR* pDir = opendir(base.c_str());
+		if (pDir)
+		{
+			struct dirent* pEntry;
+			while ((pEntry = readdir(pDir)) != NULL)
+			{
+				if (strncmp(pEntry->d_name, "node", 4) == 0 && isdigit(static_cast<unsigned char>(pEntry->d_name[4])))
+					info.node = std::stoi(pEntry->d_name + 4);
+			}
+			closedir(pDir);
+		}
+
+		cpus.push_back(info);
+	}
+
+	return cpus;
+}
+
+// lists the IDs of the process's threads
+std::set<pid_t> ListThreads()
+{
+	std::set<pid_t> threads;
+
+	DIR* pDir = opendir("/proc/self/task");
+	if (!pDir)
+		return threads;
+
+	struct dirent* pEntry;
+	while ((pEntry = readdir(pDir)) != NULL)
+	{
+		if (isdigit(static_cast<unsigned char>(pEntry->d_name[0])))
+			threads.insert(static_cast<pid_t>(std::stoi(pEntry->d_name)));
+	}
+	closedir(pDir);
+
+	return threads;
+}
+
+// lists threads in after that are not in before
+std::vector<pid_t> NewThreads(const std::set<pid_t>& before, const std::set<pid_t>& after)
+{
+	std::vector<pid_t> threads;
+	std::set_difference(after.begin(), after.end(), before.begin(), before.end(), std::back_inserter(threads));
+	return threads;
+}
+
+// gets a thread's name
+std::string ThreadName(pid_t tid)
+{
+	return ReadLine("/proc/self/task/" + std::to_string(tid) + "/comm");
+}
+
+// gets the CPU a thread last ran on (field 39 of its stat file)
+int ThreadLastCpu(pid_t tid)
+{
+	std::string stat = ReadLine("/proc/self/task/" + std::to_string(tid) + "/stat");
+
+	// the name field may contain spaces, so count fields after its ')'
+	size_t end = stat.rfind(')');
+	if (end == std::string::npos)
+		return -1;
+
+	std::istringstream fields(stat.substr(end + 2));
+	std::string field;
+	for (int i = 3; i <= 39 && fields >> field; i++)
+	{
+		if (i == 39)
+			return std::stoi(field);
+	}
+	return -1;
+}
+
+// pins a thread to a set of CPUs; tid 0 is the calling thread
+bool PinThread(pid_t tid, const std::vector<int>& cpus)
+{
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (size_t i = 0; i < cpus.size(); i++)
+		CPU_SET(cpus[i], &set);
+
+	return sched_setaffinity(tid, sizeof(set), &set) == 0;
+}
+
+// gives a thread a SCHED_FIFO priority
+bool SetFifoPriority(pid_t tid, int priority)
+{
+	struct sched_param param;
+	memset(&param, 0, sizeof(param));
+	param.sched_priority = priority;
+
+	return sched_setscheduler(tid, SCHED_FIFO, &param) == 0;
+}
+
+// Prefer a memory node
+//    Sets the calling thread's memory policy so that pages it faults in come
+//    from the given node while it has free memory. The system call is used
+//    directly so the example does not depend on libnuma.
+bool PreferMemoryNode(int node)
+{
+	// the mask has one bit per node
+	if (node < 0 || node >= static_cast<int>(sizeof(unsigned long) * 8))
+	{
+		errno = EINVAL;
+		return false;
+	}
+
+	unsigned long mask = 1UL << node;
+	return syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, sizeof(mask) * 8) == 0;
+}
+
+// gets the memory node holding a page, or -1 if unknown
+int PageNode(const void* pAddress)
+{
+	void* pPage = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(pAddress) & ~static_cast<uintptr_t>(sysconf(_SC_PAGESIZE) - 1));
+	int status = -1;
+
+	// with no target nodes, move_pages only reports where pages are
+	if (syscall(SYS_move_pages, 0, 1UL, &pPage, NULL, &status, 0) != 0)
+		return -1;
+	return status;
+}
+
+// formats a list of CPUs
+std::string CpuList(const std::vector<int>& cpus)
+{
+	std::ostringstream list;
+	for (size_t i = 0; i < cpus.size(); i++)
+		list << (i ? "," : "") << cpus[i];
+	return list.str();
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// placement of one device's threads and buffers
+struct DevicePlacement
+{
+	std::vector<int> streamCpus;
+	std::vector<int> callbackCpus;
+	int node;
+};
+
+// Image callback
+//    Counts images and, on the first image, moves its own thread to the
+//    callback cores. Arena may run several devices' callbacks on one thread;
+//    in that case the last device to see its first image wins. It also records
+//    where the callback ran and which memory node held the image.
+class PlacementCallback : public Arena::IImageCallback
+{
+public:
+	explicit PlacementCallback(const DevicePlacement& placement) :
+		m_placement(placement),
+		m_images(0),
+		m_incomplete(0),
+		m_tid(0),
+		m_cpu(-1),
+		m_bufferNode(-1),
+		m_pinned(false)
+	{
+	}
+
+	void OnImage(Arena::IImage* pImage)
+	{
+		if (m_images.load(std::memory_order_relaxed) == 0)
+		{
+			m_tid = static_cast<pid_t>(syscall(SYS_gettid));
+			m_pinned = PinThread(0, m_placement.callbackCpus);
+		}
+
+		if (pImage->IsIncomplete())
+			m_incomplete++;
+
+		m_cpu = sched_getcpu();
+		m_bufferNode = PageNode(pImage->GetData());
+		m_images++;
+	}
+
+	uint64_t GetImages() const { return m_images; }
+	uint64_t GetIncomplete() const { return m_incomplete; }
+	pid_t GetTid() const { return m_tid; }
+	int GetCpu() const { return m_cpu; }
+	int GetBufferNode() const { return m_bufferNode; }
+	bool IsPinned() const { return m_pinned; }
+
+private:
+	const DevicePlacement& m_placement;
+	std::atomic<uint64_t> m_images;
+	std::atomic<uint64_t> m_incomplete;
+	std::atomic<pid_t> m_tid;
+	std::atomic<int> m_cpu;
+	std::atomic<int> m_bufferNode;
+	std::atomic<bool> m_pinned;
+};
+
+// Plan placement
+//    Picks the cores with the highest capacity and hands them out to devices
+//    in turn, two per device where there are enough: one for the stream
+//    threads and one for the callback. The memory node is the node of the
+//    stream core, so that received data is written to local memory.
+std::vector<DevicePlacement> PlanPlacement(const std::vector<CpuInfo>& cpus, size_t numDevices)
+{
+	int maxCapacity = 0;
+	for (size_t i = 0; i < cpus.size(); i++)
+		maxCapacity = std::max(maxCapacity, cpus[i].capacity);
+
+	std::vector<CpuInfo> fast;
+	for (size_t i = 0; i < cpus.size(); i++)
+	{
+		if (cpus[i].capacity == maxCapacity)
+			fast.push_back(cpus[i]);
+	}
+
+	std::vector<DevicePlacement> placements(numDevices);
+	for (size_t i = 0; i < numDevices; i++)
+	{
+		const CpuInfo& stream = fast[(2 * i) % fast.size()];
+		const CpuInfo& callback = fast[(2 * i + 1) % fast.size()];
+
+		placements[i].streamCpus.push_back(stream.cpu);
+		placements[i].callbackCpus.push_back(callback.cpu);
+		placements[i].node = stream.node;
+	}
+
+	return placements;
+}
+
+// Start stream on node
+//    Starts the stream from a short-lived thread bound to the stream cores
+//    and preferring the device's memory node, so that buffers allocated and
+//    touched by StartStream come from that node. Pages first touched later by
+//    the stream threads land there too, as those threads are pinned to the
+//    same node.
+void StartStreamOnNode(Arena::IDevice* pDevice, const DevicePlacement& placement)
+{
+	std::exception_ptr error;
+
+	std::thread starter([&]() {
+		PinThread(0, placement.streamCpus);
+		PreferMemoryNode(placement.node);
+		try
+		{
+			pDevice->StartStream();
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+		}
+	});
+	starter.join();
+
+	if (error)
+		std::rethrow_exception(error);
+}
+
+// places a list of threads and reports the result
+void PlaceThreads(const std::vector<pid_t>& threads, const std::vector<int>& cpus, int priority, const char* role)
+{
+	for (size_t i = 0; i < threads.size(); i++)
+	{
+		// each call may overwrite errno, so keep it for the report
+		bool pinned = PinThread(threads[i], cpus);
+		int pinError = errno;
+		bool prioritized = priority == 0 || SetFifoPriority(threads[i], priority);
+		int priorityError = errno;
+
+		std::cout << TAB3 << std::setw(7) << threads[i] << " " << std::setw(16) << std::left << ThreadName(threads[i]) << std::right
+				  << " " << role << ": " << (pinned ? "pinned to " + CpuList(cpus) : std::string("pinning failed: ") + strerror(pinError));
+		if (priority != 0)
+			std::cout << (prioritized ? ", SCHED_FIFO " + std::to_string(priority) : std::string(", SCHED_FIFO failed: ") + strerror(priorityError));
+		std::cout << "\n";
+	}
+}
+
+// demonstrates thread placement
+// (1) lists CPUs and plans placement
+// (2) creates devices, finding the threads each one adds
+// (3) starts each stream on its node, finding and placing stream threads
+// (4) streams and reports where threads ran and where buffers live
+// (5) stops streams
+void PlaceDeviceThreads(Arena::ISystem* pSystem, std::vector<Arena::DeviceInfo>& deviceInfos, const std::set<pid_t>& systemThreads)
+{
+	// list CPUs and plan placement
+	std::cout << TAB1 << "CPUs\n";
+
+	std::vector<CpuInfo> cpus = GetCpus();
+	for (size_t i = 0; i < cpus.size(); i++)
+		std::cout << TAB2 << "cpu" << cpus[i].cpu << ": capacity " << cpus[i].capacity << ", node " << cpus[i].node << "\n";
+
+	std::vector<DevicePlacement> placements = PlanPlacement(cpus, deviceInfos.size());
+
+	std::cout << TAB1 << "Threads created by the system: " << systemThreads.size() << "\n";
+
+	// create devices
+	std::vector<Arena::IDevice*> devices;
+	std::vector<PlacementCallback*> callbacks;
+	std::vector<std::vector<pid_t>> streamThreads;
+
+	for (size_t i = 0; i < deviceInfos.size(); i++)
+	{
+		std::cout << TAB1 << "Device " << deviceInfos[i].SerialNumber() << ": stream on cpu " << CpuList(placements[i].streamCpus)
+				  << ", callback on cpu " << CpuList(placements[i].callbackCpus) << ", memory on node " << placements[i].node << "\n";
+
+		// Find device threads
+		//    Threads that appear while a device is created (heartbeat,
+		//    message channel) serve that device only and follow its stream
+		//    threads' placement, without real-time priority.
+		std::set<pid_t> before = ListThreads();
+		Arena::IDevice* pDevice = pSystem->CreateDevice(deviceInfos[i]);
+		PlaceThreads(NewThreads(before, ListThreads()), placements[i].streamCpus, 0, "device");
+
+		Arena::SetNodeValue<bool>(pDevice->GetTLStreamNodeMap(), "StreamAutoNegotiatePacketSize", true);
+		Arena::SetNodeValue<bool>(pDevice->GetTLStreamNodeMap(), "StreamPacketResendEnable", true);
+
+		PlacementCallback* pCallback = new PlacementCallback(placements[i]);
+		pDevice->RegisterImageCallback(pCallback);
+
+		devices.push_back(pDevice);
+		callbacks.push_back(pCallback);
+	}
+
+	// Start streams and place stream threads
+	//    Threads that appear while a stream starts receive, reassemble and
+	//    resend for that stream, and get real-time priority. Streams are
+	//    started one at a time so that each device's threads can be told
+	//    apart.
+	std::cout << TAB1 << "Start streams\n";
+
+	for (size_t i = 0; i < devices.size(); i++)
+	{
+		std::cout << TAB2 << "Device " << deviceInfos[i].SerialNumber() << "\n";
+
+		std::set<pid_t> before = ListThreads();
+		StartStreamOnNode(devices[i], placements[i]);
+		streamThreads.push_back(NewThreads(before, ListThreads()));
+		PlaceThreads(streamThreads[i], placements[i].streamCpus, STREAM_PRIORITY, "stream");
+	}
+
+	// stream
+	std::cout << TAB1 << "Stream for " << STREAM_TIME_SEC << " seconds\n";
+
+	std::this_thread::sleep_for(std::chrono::seconds(STREAM_TIME_SEC));
+
+	// Report
+	//    The CPU a thread last ran on confirms the pinning took effect; the
+	//    node of the last image's first page confirms where buffers live.
+	std::cout << TAB1 << "Results\n";
+
+	for (size_t i = 0; i < devices.size(); i++)
+	{
+		const PlacementCallback* pCallback = callbacks[i];
+
+		std::cout << TAB2 << "Device " << deviceInfos[i].SerialNumber() << ": " << pCallback->GetImages() << " images ("
+				  << pCallback->GetIncomplete() << " incomplete)\n";
+		std::cout << TAB3 << "callback thread " << pCallback->GetTid() << " " << (pCallback->IsPinned() ? "pinned" : "not pinned")
+				  << ", last ran on cpu " << pCallback->GetCpu() << "\n";
+		for (size_t j = 0; j < streamThreads[i].size(); j++)
+		{
+			std::cout << TAB3 << "stream thread " << streamThreads[i][j] << " " << ThreadName(streamThreads[i][j])
+					  << " last ran on cpu " << ThreadLastCpu(streamThreads[i][j]) << " (wanted " << CpuList(placements[i].streamCpus) << ")\n";
+		}
+		std::cout << TAB3 << "last image buffer on node " << pCallback->GetBufferNode() << " (wanted " << placements[i].node << ")\n";
+	}
+
+	// stop streams
+	std::cout << TAB1 << "Stop streams\n";
+
+	for (size_t i = 0; i < devices.size(); i++)
+	{
+		devices[i]->StopStream();
+		devices[i]->DeregisterImageCallback(callbacks[i]);
+		delete callbacks[i];
+		pSystem->DestroyDevice(devices[i]);
+	}
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_Acquisition_ThreadPlacement\n";
+
+	try
+	{
+		// prepare example
+		//    Threads created while opening the system are shared by all
+		//    devices and are left where the kernel puts them.
+		std::set<pid_t> before = ListThreads();
+		Arena::ISystem* pSystem = Arena::OpenSystem();
+		std::vector<pid_t> created = NewThreads(before, ListThreads());
+		std::set<pid_t> systemThreads(created.begin(), created.end());
+
+		pSystem->UpdateDevices(SYSTEM_TIMEOUT);
+		std::vector<Arena::DeviceInfo> deviceInfos = pSystem->GetDevices();
+		if (deviceInfos.size() == 0)
+		{
+			std::cout << "\nNo camera connected\nPress enter to complete\n";
+			std::getchar();
+			return 0;
+		}
+
+		// run example
+		std::cout << "Commence example\n\n";
+		PlaceDeviceThreads(pSystem, deviceInfos, systemThreads);
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		Arena::CloseSystem(pSystem);
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
+
+#else
+
+int main()
+{
+	std::cout << "Cpp_Acquisition_ThreadPlacement\n";
+	std::cout << "\nThis example requires Linux\nPress enter to complete\n";
+	std::getchar();
+	return -1;
+}
+
+#endif
@@ -0,0 +1,416 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "../GenTLHelpers.h"
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Acquisition: User-Supplied Buffers
+//    This example demonstrates acquiring images into memory owned by the
+//    application rather than by the acquisition engine. Arena::IDevice::StartStream
+//    allocates its own buffers, so images that must outlive a requeue have to be
+//    copied out (Arena::ImageFactory::Copy). The GenTL producer underneath Arena
+//    (GenTL.h, libgentl) allows a consumer to announce its own memory instead
+//    (GenTL::DSAnnounceBuffer). This example allocates aligned blocks from its
+//    own allocator, announces them to the data stream, and hands filled frames to
+//    a downstream stage that keeps them for a while without copying. A buffer is
+//    only given back to the acquisition engine once the downstream stage is done
+//    with it.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// number of user buffers to announce
+#define NUM_BUFFERS 10
+
+// number of images to grab
+#define NUM_IMAGES 25
+
+// number of frames the downstream stage holds on to before releasing them
+//    Must be less than the number of buffers; otherwise the acquisition engine
+//    runs out of buffers and starts dropping frames.
+#define NUM_FRAMES_HELD 4
+
+// alignment of user buffers
+//    The producer reports its own minimum alignment (STREAM_INFO_BUF_ALIGNMENT);
+//    the larger of the two is used. Page alignment keeps buffers usable for DMA
+//    engines and memory that is locked or mapped elsewhere.
+#define BUFFER_ALIGNMENT 4096
+
+// discovery timeout
+#define DISCOVERY_TIMEOUT 100
+
+// image timeout
+#define IMAGE_TIMEOUT 2000
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// allocates aligned memory
+//    Stands in for an application allocator (hugepages, DMA-capable memory,
+//    shared memory, etc.). Any block of at least the payload size works.
+uint8_t* AllocateAligned(size_t size, size_t alignment)
+{
+#ifdef _WIN32
+	return static_cast<uint8_t*>(_aligned_malloc(size, alignment));
+#else
+	void* pMemory = NULL;
+	if (posix_memalign(&pMemory, alignment, size) != 0)
+		return NULL;
+	return static_cast<uint8_t*>(pMemory);
+#endif
+}
+
+void FreeAligned(uint8_t* pMemory)
+{
+#ifdef _WIN32
+	_aligned_free(pMemory);
+#else
+	free(pMemory);
+#endif
+}
+
+// user buffer
+//    Memory owned by the application. The acquisition engine only borrows it
+//    between announcement and revocation.
+struct UserBuffer
+{
+	uint8_t* pData;
+	size_t size;
+	GenTL::BUFFER_HANDLE hBuffer;
+};
+
+// frame
+//    A view of a filled user buffer. It points directly into the user buffer,
+//    so passing it downstream costs nothing regardless of image size.
+struct Frame
+{
+	UserBuffer* pBuffer;
+	const uint8_t* pData;
+	size_t width;
+	size_t height;
+	uint64_t pixelFormat;
+	uint64_t frameId;
+	bool incomplete;
+};
+
+// User buffers
+//    Allocates user buffers, announces them to a data stream and queues them,
+//    and revokes and frees them again. The memory must stay valid until its
+//    buffer is revoked, so buffers still announced when the set is destroyed
+//    (e.g. after an exception) are only freed once acquisition is stopped,
+//    the queues are flushed and the buffer is revoked; a buffer that fails to
+//    revoke is leaked rather than freed under the producer.
+class UserBufferSet
+{
+public:
+	UserBufferSet(GenTL::DS_HANDLE hDataStream) :
+		m_hDataStream(hDataStream)
+	{
+	}
+
+	~UserBufferSet()
+	{
+		if (m_buffers.empty())
+			return;
+
+		GenTL::DSStopAcquisition(m_hDataStream, GenTL::ACQ_STOP_FLAGS_KILL);
+		GenTL::DSFlushQueue(m_hDataStream, GenTL::ACQ_QUEUE_ALL_DISCARD);
+
+		for (size_t i = 0; i < m_buffers.size(); i++)
+		{
+			if (GenTL::DSRevokeBuffer(m_hDataStream, m_buffers[i].hBuffer, NULL, NULL) == GenTL::GC_ERR_SUCCESS)
+				FreeAligned(m_buffers[i].pData);
+		}
+	}
+
+	// Announce
+	//    Each buffer's address is its user pointer, so the vector is reserved
+	//    up front and never reallocated.
+	void Announce(size_t count, size_t size, size_t alignment)
+	{
+		m_buffers.reserve(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			UserBuffer buffer;
+			buffer.size = size;
+			buffer.pData = AllocateAligned(size, alignment);
+			buffer.hBuffer = NULL;
+			if (!buffer.pData)
+				throw GenICam::GenericException("Failed to allocate user buffer", __FILE__, __LINE__);
+
+			m_buffers.push_back(buffer);
+			UserBuffer& added = m_buffers.back();
+			GenTL::GC_ERROR err = GenTL::DSAnnounceBuffer(m_hDataStream, added.pData, added.size, &added, &added.hBuffer);
+			if (err != GenTL::GC_ERR_SUCCESS)
+			{
+				FreeAligned(added.pData);
+				m_buffers.pop_back();
+				CheckGC(err, "DSAnnounceBuffer");
+			}
+			CheckGC(GenTL::DSQueueBuffer(m_hDataStream, added.hBuffer), "DSQueueBuffer");
+		}
+	}
+
+	// revokes and frees all buffers; acquisition must be stopped and the queue flushed
+	void RevokeAll()
+	{
+		while (!m_buffers.empty())
+		{
+			CheckGC(GenTL::DSRevokeBuffer(m_hDataStream, m_buffers.back().hBuffer, NULL, NULL), "DSRevokeBuffer");
+			FreeAligned(m_buffers.back().pData);
+			m_buffers.pop_back();
+		}
+	}
+
+private:
+	UserBufferSet(const UserBufferSet&) = delete;
+	UserBufferSet& operator=(const UserBufferSet&) = delete;
+
+	GenTL::DS_HANDLE m_hDataStream;
+	std::vector<UserBuffer> m_buffers;
+};
+
+// downstream stage
+//    Keeps a few frames before releasing them, standing in for a processing
+//    pipeline that works on frames after the acquisition loop has moved on.
+//    Because frames point into user memory, nothing is copied; releasing a frame
+//    simply hands its buffer back to the acquisition engine.
+class DownstreamStage
+{
+public:
+	DownstreamStage(GenTL::DS_HANDLE hDataStream) :
+		m_hDataStream(hDataStream)
+	{
+	}
+
+	void Push(const Frame& frame)
+	{
+		// do something with the frame in place
+		uint64_t sum = 0;
+		size_t sampleCount = 0;
+		for (size_t i = 0; i < frame.width * frame.height && i < frame.pBuffer->size; i += 64, sampleCount++)
+			sum += frame.pData[i];
+
+		std::cout << TAB2 << "Frame " << frame.frameId << " (" << frame.width << "x" << frame.height
+				  << (frame.incomplete ? ", incomplete" : "") << ") at " << static_cast<const void*>(frame.pData)
+				  << ", sampled mean " << (sampleCount ? sum / sampleCount : 0) << "\n";
+
+		m_frames.push_back(frame);
+
+		// release oldest frame once enough are held
+		if (m_frames.size() > NUM_FRAMES_HELD)
+			ReleaseOldest();
+	}
+
+	void ReleaseAll()
+	{
+		while (!m_frames.empty())
+			ReleaseOldest();
+	}
+
+private:
+	void ReleaseOldest()
+	{
+		Frame frame = m_frames.front();
+		m_frames.pop_front();
+
+		CheckGC(GenTL::DSQueueBuffer(m_hDataStream, frame.pBuffer->hBuffer), "DSQueueBuffer");
+	}
+
+	GenTL::DS_HANDLE m_hDataStream;
+	std::deque<Frame> m_frames;
+};
+
+// demonstrates acquisition into user-supplied buffers
+// (1) opens first device found through the GenTL producer
+// (2) allocates and announces user buffers
+// (3) starts the stream
+// (4) passes frames downstream without copying
+// (5) stops the stream and revokes buffers
+// (6) frees user buffers
+void AcquireIntoUserBuffers()
+{
+	// open device
+	std::cout << TAB1 << "Discover devices\n";
+
+	GenTLDevice device;
+	if (!OpenFirstDevice(device, DISCOVERY_TIMEOUT))
+	{
+		std::cout << TAB1 << "No camera connected\n";
+		return;
+	}
+
+	std::cout << TAB2 << "Open " << device.deviceId << "\n";
+
+	// load device node map
+	RemotePort remotePort(device.hRemotePort);
+	GenApi::CNodeMapRef nodeMap;
+	LoadRemoteNodeMap(device.hRemotePort, remotePort, nodeMap);
+
+	// open data stream
+	GenTL::DS_HANDLE hDataStream = OpenFirstDataStream(device.hDevice);
+
+	// determine buffer size
+	size_t payloadSize = GetPayloadSize(hDataStream, nodeMap);
+
+	size_t alignment = BUFFER_ALIGNMENT;
+	size_t producerAlignment = 0;
+	if (TryGetStreamInfo(hDataStream, GenTL::STREAM_INFO_BUF_ALIGNMENT, producerAlignment) && producerAlignment > alignment)
+		alignment = producerAlignment;
+
+	// round the size up to the alignment so that every block ends on a boundary
+	size_t bufferSize = ((payloadSize + alignment - 1) / alignment) * alignment;
+
+	// Allocate and announce user buffers
+	//    Announcing a buffer registers its memory with the acquisition engine.
+	//    The memory stays owned by the application, which must keep it valid
+	//    until the buffer is revoked.
+	std::cout << TAB1 << "Announce " << NUM_BUFFERS << " user buffers (" << bufferSize << " bytes, " << alignment << "-byte aligned)\n";
+
+	UserBufferSet buffers(hDataStream);
+	buffers.Announce(NUM_BUFFERS, bufferSize, alignment);
+
+	// start stream
+	std::cout << TAB1 << "Start stream\n";
+
+	GenTL::EVENT_HANDLE hNewBufferEvent = NULL;
+	CheckGC(GenTL::GCRegisterEvent(hDataStream, GenTL::EVENT_NEW_BUFFER, &hNewBufferEvent), "GCRegisterEvent");
+	CheckGC(GenTL::DSStartAcquisition(hDataStream, GenTL::ACQ_START_FLAGS_DEFAULT, GENTL_INFINITE), "DSStartAcquisition");
+
+	GenApi::CIntegerPtr pTLParamsLocked = nodeMap._GetNode("TLParamsLocked");
+	if (pTLParamsLocked && GenApi::IsWritable(pTLParamsLocked))
+		pTLParamsLocked->SetValue(1);
+
+	GenApi::CCommandPtr pAcquisitionStart = nodeMap._GetNode("AcquisitionStart");
+	pAcquisitionStart->Execute();
+
+	// Acquire images
+	//    Each new buffer event carries the handle and the user pointer given at
+	//    announcement, so the filled user buffer is found without a lookup.
+	std::cout << TAB1 << "Acquire " << NUM_IMAGES << " images\n";
+
+	DownstreamStage downstream(hDataStream);
+
+	for (int i = 0; i < NUM_IMAGES; i++)
+	{
+		GenTL::EVENT_NEW_BUFFER_DATA newBuffer;
+		size_t newBufferSize = sizeof(newBuffer);
+		CheckGC(GenTL::EventGetData(hNewBufferEvent, &newBuffer, &newBufferSize, IMAGE_TIMEOUT), "EventGetData");
+
+		Frame frame;
+		frame.pBuffer = static_cast<UserBuffer*>(newBuffer.pUserPointer);
+		frame.pData = frame.pBuffer->pData + GetBufferInfo<size_t>(hDataStream, newBuffer.BufferHandle, GenTL::BUFFER_INFO_IMAGEOFFSET);
+		frame.width = GetBufferInfo<size_t>(hDataStream, newBuffer.BufferHandle, GenTL::BUFFER_INFO_WIDTH);
+		frame.height = GetBufferInfo<size_t>(hDataStream, newBuffer.BufferHandle, GenTL::BUFFER_INFO_HEIGHT);
+		frame.pixelFormat = GetBufferInfo<uint64_t>(hDataStream, newBuffer.BufferHandle, GenTL::BUFFER_INFO_PIXELFORMAT);
+		frame.frameId = GetBufferInfo<uint64_t>(hDataStream, newBuffer.BufferHandle, GenTL::BUFFER_INFO_FRAMEID);
+		frame.incomplete = GetBufferInfo<bool8_t>(hDataStream, newBuffer.BufferHandle, GenTL::BUFFER_INFO_IS_INCOMPLETE) != 0;
+
+		downstream.Push(frame);
+	}
+
+	// stop stream
+	std::cout << TAB1 << "Stop stream\n";
+
+	GenApi::CCommandPtr pAcquisitionStop = nodeMap._GetNode("AcquisitionStop");
+	pAcquisitionStop->Execute();
+
+	if (pTLParamsLocked && GenApi::IsWritable(pTLParamsLocked))
+		pTLParamsLocked->SetValue(0);
+
+	CheckGC(GenTL::DSStopAcquisition(hDataStream, GenTL::ACQ_STOP_FLAGS_DEFAULT), "DSStopAcquisition");
+	downstream.ReleaseAll();
+	CheckGC(GenTL::DSFlushQueue(hDataStream, GenTL::ACQ_QUEUE_ALL_DISCARD), "DSFlushQueue");
+	CheckGC(GenTL::GCUnregisterEvent(hDataStream, GenTL::EVENT_NEW_BUFFER), "GCUnregisterEvent");
+
+	// Revoke and free user buffers
+	//    Once revoked, the acquisition engine no longer references the memory
+	//    and it can be returned to the application allocator.
+	std::cout << TAB1 << "Revoke and free user buffers\n";
+
+	buffers.RevokeAll();
+
+	// clean up
+	CheckGC(GenTL::DSClose(hDataStream), "DSClose");
+	CloseFirstDevice(device);
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_Acquisition_UserBuffers\n";
+
+	bool libraryOpen = false;
+
+	try
+	{
+		// prepare example
+		CheckGC(GenTL::GCInitLib(), "GCInitLib");
+		libraryOpen = true;
+
+		// run example
+		std::cout << "Commence example\n\n";
+		AcquireIntoUserBuffers();
+		std::cout << "\nExample complete\n";
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	// Clean up example
+	//    Closing the library also closes handles an exception left open.
+	if (libraryOpen)
+		GenTL::GCCloseLib();
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
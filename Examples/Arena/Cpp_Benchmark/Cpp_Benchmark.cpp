@@ -0,0 +1,780 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+#include "SaveApi.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Benchmark: Acquisition and Processing
+//    This example measures what the SDK costs per frame, so that releases can
+//    be compared on the same machine. Each operation is timed call by call and
+//    recorded into a latency histogram; throughput is taken from the total
+//    time. Results are printed as a table and written as JSON for regression
+//    tracking. Streaming, RequeueBuffer and image callbacks are measured on the
+//    first device found; conversions for every supported pixel format pair,
+//    CRC calculation, image encoders and video recording use synthetic images
+//    and also run without a device.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// number of images to stream
+#define NUM_IMAGES 1000
+
+// number of buffers
+#define NUM_BUFFERS 25
+
+// number of timed iterations for processing benchmarks
+#define NUM_ITERATIONS 200
+
+// number of timed iterations for encoders and video
+//    PNG and TIFF encoding of a full image can take tens of milliseconds.
+#define NUM_ENCODER_ITERATIONS 30
+
+// number of untimed iterations before each benchmark
+#define NUM_WARMUP 5
+
+// number of stream start and stop cycles
+#define NUM_STREAM_CYCLES 10
+
+// size of synthetic images
+#define WIDTH 2448
+#define HEIGHT 2048
+
+// output
+#define JSON_FILE "Cpp_Benchmark.json"
+#define IMAGE_DIRECTORY "Images/Cpp_Benchmark/"
+
+// image timeout
+#define IMAGE_TIMEOUT 2000
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- HISTOGRAM -=-
+// =-=-=-=-=-=-=-=-=-
+
+// latency histogram
+//    Log-linear buckets: every power of two is split into 16 sub-buckets, so
+//    a percentile is read back within 1/16 (6.25%) of the true value. Memory
+//    is fixed, so recording does not allocate inside timed sections.
+class LatencyHistogram
+{
+public:
+	LatencyHistogram() :
+		m_buckets(NUM_BUCKETS, 0),
+		m_count(0),
+		m_sum(0),
+		m_min(UINT64_MAX),
+		m_max(0)
+	{
+	}
+
+	void Record(uint64_t ns)
+	{
+		m_buckets[BucketIndex(ns)]++;
+		m_count++;
+		m_sum += ns;
+		m_min = std::min(m_min, ns);
+		m_max = std::max(m_max, ns);
+	}
+
+	uint64_t Count() const
+	{
+		return m_count;
+	}
+
+	uint64_t Min() const
+	{
+		return m_count ? m_min : 0;
+	}
+
+	uint64_t Max() const
+	{
+		return m_max;
+	}
+
+	double Mean() const
+	{
+		return m_count ? static_cast<double>(m_sum) / m_count : 0.0;
+	}
+
+	// gets the value below which the given fraction of samples lies
+	uint64_t Percentile(double fraction) const
+	{
+		if (m_count == 0)
+			return 0;
+
+		uint64_t rank = static_cast<uint64_t>(std::ceil(fraction * m_count));
+		rank = std::max<uint64_t>(1, std::min(rank, m_count));
+
+		uint64_t cumulative = 0;
+		for (size_t i = 0; i < m_buckets.size(); i++)
+		{
+			cumulative += m_buckets[i];
+			if (cumulative >= rank)
+				return std::min(BucketUpperBound(i), m_max);
+		}
+		return m_max;
+	}
+
+	// gets (upper bound, count) for every non-empty bucket
+	std::vector<std::pair<uint64_t, uint64_t>> Buckets() const
+	{
+		std::vector<std::pair<uint64_t, uint64_t>> buckets;
+		for (size_t i = 0; i < m_buckets.size(); i++)
+		{
+			if (m_buckets[i])
+				buckets.push_back(std::make_pair(BucketUpperBound(i), m_buckets[i]));
+		}
+		return buckets;
+	}
+
+private:
+	static const size_t SUB_BUCKET_BITS = 4;
+	static const size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+	static const size_t NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+	static size_t FloorLog2(uint64_t value)
+	{
+		size_t log = 0;
+		while (value >>= 1)
+			log++;
+		return log;
+	}
+
+	static size_t BucketIndex(uint64_t ns)
+	{
+		if (ns < SUB_BUCKETS)
+			return static_cast<size_t>(ns);
+
+		size_t exponent = FloorLog2(ns);
+		size_t subBucket = static_cast<size_t>(ns >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+		return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + subBucket;
+	}
+
+	static uint64_t BucketUpperBound(size_t index)
+	{
+		size_t group = index / SUB_BUCKETS;
+		uint64_t subBucket = index % SUB_BUCKETS;
+		if (group == 0)
+			return subBucket;
+
+		size_t shift = group - 1;
+		return ((SUB_BUCKETS + subBucket + 1) << shift) - 1;
+	}
+
+	std::vector<uint64_t> m_buckets;
+	uint64_t m_count;
+	uint64_t m_sum;
+	uint64_t m_min;
+	uint64_t m_max;
+};
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- RUNNER -=-=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// result of one benchmark
+struct BenchmarkResult
+{
+	std::string group;
+	std::string name;
+	uint64_t bytesPerIteration;
+	double seconds;
+	LatencyHistogram latency;
+	std::string skipped;
+
+	BenchmarkResult(const std::string& group_, const std::string& name_, uint64_t bytesPerIteration_) :
+		group(group_),
+		name(name_),
+		bytesPerIteration(bytesPerIteration_),
+		seconds(0.0)
+	{
+	}
+};
+
+typedef std::chrono::steady_clock Clock;
+
+static uint64_t ElapsedNs(Clock::time_point start, Clock::time_point end)
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+// runs an operation untimed, then timed call by call
+//    An operation that throws during warm up is reported as skipped with the
+//    exception text, which is how unsupported pixel format pairs show up.
+template<typename Operation>
+BenchmarkResult RunBenchmark(const std::string& group, const std::string& name, uint64_t bytesPerIteration, size_t numIterations, Operation operation)
+{
+	BenchmarkResult result(group, name, bytesPerIteration);
+
+	try
+	{
+		for (size_t i = 0; i < NUM_WARMUP; i++)
+			operation();
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		result.skipped = ge.GetDescription();
+		return result;
+	}
+
+	Clock::time_point begin = Clock::now();
+	for (size_t i = 0; i < numIterations; i++)
+	{
+		Clock::time_point start = Clock::now();
+		operation();
+		result.latency.Record(ElapsedNs(start, Clock::now()));
+	}
+	result.seconds = ElapsedNs(begin, Clock::now()) / 1e9;
+
+	return result;
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// creates a synthetic image filled with a repeating pattern
+//    The pattern is not constant so that encoders and the CRC do real work.
+Arena::IImage* CreateSyntheticImage(std::vector<uint8_t>& buffer, size_t width, size_t height, PfncFormat pixelFormat)
+{
+	size_t bitsPerPixel = Arena::GetBitsPerPixel(pixelFormat);
+	buffer.resize(width * height * bitsPerPixel / 8);
+	for (size_t i = 0; i < buffer.size(); i++)
+		buffer[i] = static_cast<uint8_t>((i * 2654435761u) >> 24);
+	return Arena::ImageFactory::Create(&buffer[0], buffer.size(), width, height, pixelFormat);
+}
+
+// image callback recording the interval between deliveries
+class BenchmarkCallback : public Arena::IImageCallback
+{
+public:
+	BenchmarkCallback(BenchmarkResult& result, size_t numImages) :
+		m_result(result),
+		m_numImages(numImages),
+		m_received(0)
+	{
+	}
+
+	void OnImage(Arena::IImage* /*pImage*/)
+	{
+		Clock::time_point now = Clock::now();
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_received == 0)
+			m_begin = now;
+		else if (m_received <= m_numImages)
+			m_result.latency.Record(ElapsedNs(m_last, now));
+		m_last = now;
+
+		if (++m_received == m_numImages + 1)
+		{
+			m_result.seconds = ElapsedNs(m_begin, now) / 1e9;
+			m_done.notify_all();
+		}
+	}
+
+	bool WaitDone(std::chrono::milliseconds timeout)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		return m_done.wait_for(lock, timeout, [this]() { return m_received > m_numImages; });
+	}
+
+private:
+	BenchmarkResult& m_result;
+	size_t m_numImages;
+	size_t m_received;
+	Clock::time_point m_begin;
+	Clock::time_point m_last;
+	std::mutex m_mutex;
+	std::condition_variable m_done;
+};
+
+// benchmarks streaming from a device
+// (1) starts and stops the stream repeatedly
+// (2) times GetImage and RequeueBuffer for each image
+// (3) times the interval between image callbacks
+void BenchmarkStream(Arena::IDevice* pDevice, size_t numImages, std::vector<BenchmarkResult>& results)
+{
+	GenApi::INodeMap* pNodeMap = pDevice->GetNodeMap();
+	GenApi::INodeMap* pTLStreamNodeMap = pDevice->GetTLStreamNodeMap();
+
+	uint64_t payloadSize = static_cast<uint64_t>(Arena::GetNodeValue<int64_t>(pNodeMap, "PayloadSize"));
+
+	// Start and stop stream
+	std::cout << TAB1 << "Start and stop stream\n";
+
+	results.push_back(RunBenchmark("stream", "StartStream+StopStream", 0, NUM_STREAM_CYCLES, [&]() {
+		pDevice->StartStream(NUM_BUFFERS);
+		pDevice->StopStream();
+	}));
+
+	// Get and requeue images
+	//    GetImage latency includes waiting for the next frame, so its median
+	//    tracks the frame period; the tail shows delivery jitter.
+	std::cout << TAB1 << "Get and requeue " << numImages << " images\n";
+
+	Arena::SetNodeValue<GenICam::gcstring>(pTLStreamNodeMap, "StreamBufferHandlingMode", "OldestFirst");
+
+	BenchmarkResult getImage("stream", "GetImage", payloadSize);
+	BenchmarkResult requeueBuffer("stream", "RequeueBuffer", payloadSize);
+	size_t numIncomplete = 0;
+
+	pDevice->StartStream(NUM_BUFFERS);
+	for (size_t i = 0; i < NUM_WARMUP; i++)
+		pDevice->RequeueBuffer(pDevice->GetImage(IMAGE_TIMEOUT));
+
+	Clock::time_point begin = Clock::now();
+	for (size_t i = 0; i < numImages; i++)
+	{
+		Clock::time_point start = Clock::now();
+		Arena::IImage* pImage = pDevice->GetImage(IMAGE_TIMEOUT);
+		Clock::time_point got = Clock::now();
+		if (pImage->IsIncomplete())
+			numIncomplete++;
+		pDevice->RequeueBuffer(pImage);
+		Clock::time_point requeued = Clock::now();
+
+		getImage.latency.Record(ElapsedNs(start, got));
+		requeueBuffer.latency.Record(ElapsedNs(got, requeued));
+	}
+	getImage.seconds = ElapsedNs(begin, Clock::now()) / 1e9;
+	requeueBuffer.seconds = getImage.seconds;
+	pDevice->StopStream();
+
+	if (numIncomplete)
+		std::cout << TAB2 << numIncomplete << " incomplete images\n";
+
+	results.push_back(getImage);
+	results.push_back(requeueBuffer);
+
+	// Image callbacks
+	std::cout << TAB1 << "Receive " << numImages << " images through a callback\n";
+
+	BenchmarkResult callback("stream", "ImageCallback", payloadSize);
+	BenchmarkCallback handler(callback, numImages);
+
+	pDevice->RegisterImageCallback(&handler);
+	pDevice->StartStream(NUM_BUFFERS);
+	bool done = handler.WaitDone(std::chrono::milliseconds(IMAGE_TIMEOUT * (numImages + 1)));
+	pDevice->StopStream();
+	pDevice->DeregisterImageCallback(&handler);
+
+	if (!done)
+		callback.skipped = "timed out waiting for images";
+	results.push_back(callback);
+}
+
+// benchmarks conversions between all pixel format pairs
+//    Pairs the image factory does not support are reported as skipped.
+void BenchmarkConvert(size_t width, size_t height, size_t numIterations, std::vector<BenchmarkResult>& results)
+{
+	static const PfncFormat sources[] = {
+		Mono8, Mono10p, Mono12p, Mono16,
+		BayerRG8, BayerRG10p, BayerRG12p, BayerRG16,
+		RGB8, BGR8, YUV411_8_UYYVYY, YUV422_8_UYVY, YCbCr8
+	};
+	static const PfncFormat destinations[] = {
+		Mono8, Mono16, RGB8, BGR8, RGBa8, BGRa8, RGB16
+	};
+
+	std::cout << TAB1 << "Convert " << width << "x" << height << " images\n";
+
+	std::vector<uint8_t> buffer;
+	for (size_t s = 0; s < sizeof(sources) / sizeof(sources[0]); s++)
+	{
+		Arena::IImage* pSource = CreateSyntheticImage(buffer, width, height, sources[s]);
+		bool bayer = std::string(GetPixelFormatName(sources[s])).compare(0, 5, "Bayer") == 0;
+
+		for (size_t d = 0; d < sizeof(destinations) / sizeof(destinations[0]); d++)
+		{
+			if (sources[s] == destinations[d])
+				continue;
+
+			std::string name = std::string(GetPixelFormatName(sources[s])) + "->" + GetPixelFormatName(destinations[d]);
+			uint64_t bytes = width * height * Arena::GetBitsPerPixel(destinations[d]) / 8;
+
+			results.push_back(RunBenchmark("convert", name, bytes, numIterations, [&]() {
+				Arena::ImageFactory::Destroy(Arena::ImageFactory::Convert(pSource, destinations[d]));
+			}));
+
+			if (!results.back().skipped.empty())
+			{
+				std::cout << TAB2 << name << " not supported\n";
+				continue;
+			}
+
+			// demosaicing also runs with the slower, higher quality algorithm
+			if (bayer && Arena::GetBitsPerPixel(destinations[d]) >= 24)
+			{
+				results.push_back(RunBenchmark("convert", name + " (AHD)", bytes, numIterations, [&]() {
+					Arena::ImageFactory::Destroy(Arena::ImageFactory::Convert(pSource, destinations[d], Arena::AdaptiveHomogeneityDirected));
+				}));
+			}
+		}
+
+		Arena::ImageFactory::Destroy(pSource);
+	}
+}
+
+// benchmarks CRC calculation over an image
+void BenchmarkCRC(size_t width, size_t height, size_t numIterations, std::vector<BenchmarkResult>& results)
+{
+	std::cout << TAB1 << "Calculate CRC32\n";
+
+	std::vector<uint8_t> buffer;
+	Arena::IImage* pImage = CreateSyntheticImage(buffer, width, height, BayerRG8);
+	volatile int64_t crc = 0;
+
+	results.push_back(RunBenchmark("crc", "CalculateCRC32", buffer.size(), numIterations, [&]() {
+		crc = Arena::CalculateCRC32(pImage->GetData(), pImage->GetSizeFilled());
+	}));
+
+	Arena::ImageFactory::Destroy(pImage);
+}
+
+// benchmarks image encoders and video recording
+//    Every iteration overwrites the same file, so the numbers include writing
+//    to the page cache but not necessarily to disk.
+void BenchmarkSave(size_t width, size_t height, size_t numIterations, std::vector<BenchmarkResult>& results)
+{
+	std::vector<uint8_t> buffer;
+	Arena::IImage* pImage = CreateSyntheticImage(buffer, width, height, BGR8);
+	uint64_t bytes = buffer.size();
+
+	// Image encoders
+	std::cout << TAB1 << "Save images\n";
+
+	static const char* extensions[] = { ".raw", ".bmp", ".jpg", ".png", ".tiff" };
+	for (size_t i = 0; i < sizeof(extensions) / sizeof(extensions[0]); i++)
+	{
+		Save::ImageParams params(width, height, pImage->GetBitsPerPixel());
+		Save::ImageWriter writer(params, (std::string(IMAGE_DIRECTORY) + "image" + extensions[i]).c_str());
+
+		results.push_back(RunBenchmark("save", std::string("ImageWriter") + extensions[i], bytes, numIterations, [&]() {
+			writer.Save(pImage->GetData());
+		}));
+	}
+
+	// Video recorder
+	//    Opening and closing the video happen outside the timed section.
+	std::cout << TAB1 << "Record video\n";
+
+	for (int h264 = 0; h264 < 2; h264++)
+	{
+		Save::VideoParams params(width, height, 25.0);
+		Save::VideoRecorder recorder(params, (std::string(IMAGE_DIRECTORY) + (h264 ? "video.mp4" : "video.avi")).c_str());
+		if (h264)
+			recorder.SetH264Mp4BGR8();
+		else
+			recorder.SetRawAviBGR8();
+
+		recorder.Open();
+		results.push_back(RunBenchmark("save", h264 ? "VideoRecorder H264 MP4" : "VideoRecorder raw AVI", bytes, numIterations, [&]() {
+			recorder.AppendImage(pImage->GetData());
+		}));
+		recorder.Close();
+	}
+
+	Arena::ImageFactory::Destroy(pImage);
+}
+
+// writes a string as a JSON string
+std::string JsonString(const std::string& value)
+{
+	std::ostringstream out;
+	out << '"';
+	for (size_t i = 0; i < value.size(); i++)
+	{
+		char c = value[i];
+		if (c == '"' || c == '\\')
+			out << '\\' << c;
+		else if (static_cast<unsigned char>(c) < 0x20)
+			out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+		else
+			out << c;
+	}
+	out << '"';
+	return out.str();
+}
+
+// writes all results as JSON
+//    Latencies are in nanoseconds. Histogram buckets are [upper bound, count]
+//    pairs for non-empty buckets only.
+void WriteJson(const std::string& fileName, const std::string& deviceModel, const std::string& deviceSerial, size_t width, size_t height, const std::vector<BenchmarkResult>& results)
+{
+	std::ofstream out(fileName.c_str());
+	out << std::fixed << std::setprecision(3);
+
+	out << "{\n";
+	out << "  \"benchmark\": \"Cpp_Benchmark\",\n";
+#if defined(__aarch64__)
+	out << "  \"architecture\": \"arm64\",\n";
+#elif defined(__arm__)
+	out << "  \"architecture\": \"armhf\",\n";
+#elif defined(__x86_64__) || defined(_M_X64)
+	out << "  \"architecture\": \"x64\",\n";
+#else
+	out << "  \"architecture\": \"unknown\",\n";
+#endif
+	out << "  \"device\": { \"model\": " << JsonString(deviceModel) << ", \"serial\": " << JsonString(deviceSerial) << " },\n";
+	out << "  \"synthetic_image\": { \"width\": " << width << ", \"height\": " << height << " },\n";
+	out << "  \"results\": [\n";
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchmarkResult& r = results[i];
+		out << "    {\n";
+		out << "      \"group\": " << JsonString(r.group) << ",\n";
+		out << "      \"name\": " << JsonString(r.name) << ",\n";
+
+		if (!r.skipped.empty())
+		{
+			out << "      \"skipped\": " << JsonString(r.skipped) << "\n";
+		}
+		else
+		{
+			uint64_t count = r.latency.Count();
+			double perSecond = r.seconds > 0.0 ? count / r.seconds : 0.0;
+
+			out << "      \"iterations\": " << count << ",\n";
+			out << "      \"seconds\": " << std::setprecision(6) << r.seconds << std::setprecision(3) << ",\n";
+			out << "      \"throughput_per_second\": " << perSecond << ",\n";
+			out << "      \"megabytes_per_second\": " << perSecond * r.bytesPerIteration / 1e6 << ",\n";
+			out << "      \"latency_ns\": { \"min\": " << r.latency.Min()
+				<< ", \"mean\": " << r.latency.Mean()
+				<< ", \"p50\": " << r.latency.Percentile(0.5)
+				<< ", \"p99\": " << r.latency.Percentile(0.99)
+				<< ", \"p999\": " << r.latency.Percentile(0.999)
+				<< ", \"max\": " << r.latency.Max() << " },\n";
+			out << "      \"histogram\": [";
+
+			std::vector<std::pair<uint64_t, uint64_t>> buckets = r.latency.Buckets();
+			for (size_t b = 0; b < buckets.size(); b++)
+				out << (b ? ", " : "") << "[" << buckets[b].first << ", " << buckets[b].second << "]";
+			out << "]\n";
+		}
+
+		out << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+
+	out << "  ]\n";
+	out << "}\n";
+
+	if (!out)
+		throw GenICam::GenericException(("Failed to write " + fileName).c_str(), __FILE__, __LINE__);
+}
+
+// prints a summary table
+void PrintResults(const std::vector<BenchmarkResult>& results)
+{
+	std::cout << "\n"
+			  << std::left << std::setw(34) << "benchmark" << std::right
+			  << std::setw(10) << "per sec" << std::setw(10) << "MB/s"
+			  << std::setw(12) << "p50 us" << std::setw(12) << "p99 us" << std::setw(12) << "p999 us" << "\n";
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchmarkResult& r = results[i];
+		if (!r.skipped.empty())
+			continue;
+
+		double perSecond = r.seconds > 0.0 ? r.latency.Count() / r.seconds : 0.0;
+		std::cout << std::left << std::setw(34) << (r.group + "/" + r.name) << std::right << std::fixed
+				  << std::setprecision(1) << std::setw(10) << perSecond
+				  << std::setw(10) << perSecond * r.bytesPerIteration / 1e6
+				  << std::setw(12) << r.latency.Percentile(0.5) / 1e3
+				  << std::setw(12) << r.latency.Percentile(0.99) / 1e3
+				  << std::setw(12) << r.latency.Percentile(0.999) / 1e3 << "\n";
+	}
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+void usage(char* app)
+{
+	std::cout << "Usage:\n";
+	std::cout << app << " [-n numImages] [-i iterations] [-w width] [-h height] [-o file] [--no-device]\n";
+	std::cout << "Where:\n";
+	std::cout << "numImages:  number of images to stream. Default is " << NUM_IMAGES << ".\n";
+	std::cout << "iterations: number of iterations per processing benchmark. Default is " << NUM_ITERATIONS << ".\n";
+	std::cout << "width:      synthetic image width. Default is " << WIDTH << ".\n";
+	std::cout << "height:     synthetic image height. Default is " << HEIGHT << ".\n";
+	std::cout << "file:       JSON output file. Default is " << JSON_FILE << ".\n";
+	std::cout << "--no-device skips the streaming benchmarks.\n";
+	std::cout << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_Benchmark\n";
+
+	// Parse command line args
+	size_t numImages = NUM_IMAGES;
+	size_t numIterations = NUM_ITERATIONS;
+	size_t width = WIDTH;
+	size_t height = HEIGHT;
+	std::string jsonFile = JSON_FILE;
+	bool useDevice = true;
+
+	for (int32_t i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "-n") == 0) && (i + 1 < argc))
+		{
+			numImages = strtoul(argv[++i], NULL, 10);
+		}
+		else if ((strcmp(argv[i], "-i") == 0) && (i + 1 < argc))
+		{
+			numIterations = strtoul(argv[++i], NULL, 10);
+		}
+		else if ((strcmp(argv[i], "-w") == 0) && (i + 1 < argc))
+		{
+			width = strtoul(argv[++i], NULL, 10);
+		}
+		else if ((strcmp(argv[i], "-h") == 0) && (i + 1 < argc))
+		{
+			height = strtoul(argv[++i], NULL, 10);
+		}
+		else if ((strcmp(argv[i], "-o") == 0) && (i + 1 < argc))
+		{
+			jsonFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--no-device") == 0)
+		{
+			useDevice = false;
+		}
+		else if (strcmp(argv[i], "--help") == 0)
+		{
+			usage(argv[0]);
+			return 0;
+		}
+		else
+		{
+			std::cout << "Invalid argument [" << argv[i] << "]\n";
+			usage(argv[0]);
+			return -1;
+		}
+	}
+
+	if (numImages == 0 || numIterations == 0 || width == 0 || height == 0)
+	{
+		std::cout << "Image count, iterations, width and height must be greater than 0.\n";
+		return -1;
+	}
+
+	try
+	{
+		// prepare example
+		Arena::ISystem* pSystem = Arena::OpenSystem();
+		Arena::IDevice* pDevice = NULL;
+		std::string deviceModel;
+		std::string deviceSerial;
+
+		if (useDevice)
+		{
+			pSystem->UpdateDevices(100);
+			std::vector<Arena::DeviceInfo> deviceInfos = pSystem->GetDevices();
+			if (deviceInfos.size() == 0)
+			{
+				std::cout << "\nNo camera connected; streaming benchmarks are skipped\n";
+			}
+			else
+			{
+				pDevice = pSystem->CreateDevice(deviceInfos[0]);
+				deviceModel = deviceInfos[0].ModelName().c_str();
+				deviceSerial = deviceInfos[0].SerialNumber().c_str();
+			}
+		}
+
+		// run example
+		std::cout << "Commence example\n\n";
+
+		std::vector<BenchmarkResult> results;
+
+		if (pDevice)
+		{
+			// Store initial settings
+			GenICam::gcstring acquisitionModeInitial = Arena::GetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "AcquisitionMode");
+
+			Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "AcquisitionMode", "Continuous");
+			Arena::SetNodeValue<bool>(pDevice->GetTLStreamNodeMap(), "StreamAutoNegotiatePacketSize", true);
+			Arena::SetNodeValue<bool>(pDevice->GetTLStreamNodeMap(), "StreamPacketResendEnable", true);
+
+			BenchmarkStream(pDevice, numImages, results);
+
+			// Restore initial settings
+			Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "AcquisitionMode", acquisitionModeInitial);
+		}
+
+		BenchmarkConvert(width, height, numIterations, results);
+		BenchmarkCRC(width, height, numIterations, results);
+		BenchmarkSave(width, height, NUM_ENCODER_ITERATIONS, results);
+
+		PrintResults(results);
+		WriteJson(jsonFile, deviceModel, deviceSerial, width, height, results);
+		std::cout << "\nResults written to " << jsonFile << "\n";
+
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		if (pDevice)
+			pSystem->DestroyDevice(pDevice);
+		Arena::CloseSystem(pSystem);
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
@@ -0,0 +1,477 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+#include <vector>
+#include <string>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Callback: Thread Pool Dispatch
+//    This example demonstrates dispatching image callbacks to a pool of worker
+//    threads. Callbacks registered with Arena::IDevice::RegisterImageCallback
+//    run one after another on the internal grab thread, so a slow callback
+//    stalls delivery. Here, a single acquisition thread retrieves images and
+//    hands them to a configurable number of workers, optionally pinned to
+//    specific CPU cores. Each image is processed on a worker; its buffer is
+//    requeued only once its callback has completed. In ordered mode, completed
+//    images are released strictly in the order they arrived (i.e. by frame ID)
+//    even though they are processed concurrently; in unordered mode each image
+//    is released as soon as its own processing finishes.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// number of images to grab
+#define NUM_IMAGES 50
+
+// number of buffers
+//    Every image being processed holds on to a buffer, so there must be more
+//    buffers than workers.
+#define NUM_BUFFERS 20
+
+// number of worker threads
+#define NUM_WORKERS 4
+
+// Worker CPU affinity
+//    Worker n is pinned to core WORKER_FIRST_CORE + n. A negative value leaves
+//    scheduling to the operating system.
+#define WORKER_FIRST_CORE -1
+
+// delivery order
+//    true: images complete in frame ID order
+//    false: images complete as soon as they are processed
+#define ORDERED_DELIVERY true
+
+// system timeout
+#define SYSTEM_TIMEOUT 100
+
+// image timeout
+#define IMAGE_TIMEOUT 2000
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// callback interface
+//    OnImage runs on a worker thread and may run concurrently for different
+//    images. OnImageComplete runs once per image after OnImage has returned; it
+//    is never called concurrently and, in ordered mode, is called in frame ID
+//    order. The image must not be used once OnImageComplete returns because its
+//    buffer is requeued.
+class IPooledImageCallback
+{
+public:
+	virtual ~IPooledImageCallback() {};
+	virtual void OnImage(Arena::IImage* pImage) = 0;
+	virtual void OnImageComplete(Arena::IImage* /*pImage*/) {};
+};
+
+// pins the calling thread to a core
+void SetCurrentThreadAffinity(int core)
+{
+#if defined(__linux__)
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	CPU_SET(core, &cpuSet);
+	pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+#elif defined(_WIN32)
+	SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << core);
+#endif
+}
+
+// thread pool dispatcher
+//    Owns the worker threads, the queue of images waiting for a worker, and,
+//    in ordered mode, the set of processed images waiting for earlier images
+//    to complete.
+class ThreadPoolDispatcher
+{
+public:
+	ThreadPoolDispatcher(Arena::IDevice* pDevice, IPooledImageCallback* pCallback, size_t numWorkers, int firstCore, bool ordered) :
+		m_pDevice(pDevice),
+		m_pCallback(pCallback),
+		m_ordered(ordered),
+		m_stop(false),
+		m_nextSequence(0),
+		m_nextToComplete(0),
+		m_inFlight(0),
+		m_numFailed(0)
+	{
+		for (size_t i = 0; i < numWorkers; i++)
+		{
+			int core = firstCore < 0 ? -1 : firstCore + static_cast<int>(i);
+			m_workers.push_back(std::thread(&ThreadPoolDispatcher::WorkerThread, this, core));
+		}
+	}
+
+	~ThreadPoolDispatcher()
+	{
+		Shutdown();
+	}
+
+	// queues an image for processing
+	//    Called from the acquisition thread. Sequence numbers are assigned in
+	//    arrival order, which is frame ID order; they are used instead of frame
+	//    IDs so that a frame lost in transmission does not stall ordered
+	//    delivery.
+	void Dispatch(Arena::IImage* pImage)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			m_queue.push_back(Job(m_nextSequence++, pImage));
+			m_inFlight++;
+		}
+		m_queueCondition.notify_one();
+	}
+
+	// waits until every dispatched image has completed
+	void WaitForIdle()
+	{
+		std::unique_lock<std::mutex> lock(m_queueMutex);
+		m_idleCondition.wait(lock, [this]() { return m_inFlight == 0; });
+	}
+
+	// stops workers once queued images are done
+	void Shutdown()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			if (m_stop)
+				return;
+			m_stop = true;
+		}
+		m_queueCondition.notify_all();
+
+		for (size_t i = 0; i < m_workers.size(); i++)
+			m_workers[i].join();
+	}
+
+	// number of images whose callback or requeue threw
+	size_t NumFailed() const
+	{
+		return m_numFailed;
+	}
+
+private:
+	struct Job
+	{
+		Job(uint64_t sequence, Arena::IImage* pImage) :
+			sequence(sequence),
+			pImage(pImage),
+			failed(false)
+		{
+		}
+
+		uint64_t sequence;
+		Arena::IImage* pImage;
+		bool failed;
+	};
+
+	void WorkerThread(int core)
+	{
+		if (core >= 0)
+			SetCurrentThreadAffinity(core);
+
+		while (true)
+		{
+			// wait for job
+			std::unique_lock<std::mutex> lock(m_queueMutex);
+			m_queueCondition.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+			if (m_queue.empty())
+				return;
+
+			Job job = m_queue.front();
+			m_queue.pop_front();
+			lock.unlock();
+
+			// Process concurrently
+			//    A failed image is completed as usual: its buffer is requeued,
+			//    and ordered delivery does not stall waiting for it.
+			std::string error;
+			if (!Try([&]() { m_pCallback->OnImage(job.pImage); }, error))
+			{
+				std::lock_guard<std::mutex> completeLock(m_completeMutex);
+				ReportError(job, "process", error);
+			}
+
+			// complete
+			if (m_ordered)
+				CompleteInOrder(job);
+			else
+				Complete(job);
+		}
+	}
+
+	// Completes images in arrival order
+	//    A processed image is parked until every earlier image has completed.
+	//    Whichever worker finishes the image that is next in line completes it
+	//    and every parked image that directly follows.
+	void CompleteInOrder(const Job& job)
+	{
+		std::lock_guard<std::mutex> lock(m_completeMutex);
+
+		m_parked.insert(std::make_pair(job.sequence, job));
+
+		std::map<uint64_t, Job>::iterator it = m_parked.begin();
+		while (it != m_parked.end() && it->first == m_nextToComplete)
+		{
+			Release(it->second);
+			m_nextToComplete++;
+			it = m_parked.erase(it);
+		}
+	}
+
+	void Complete(Job job)
+	{
+		std::lock_guard<std::mutex> lock(m_completeMutex);
+
+		Release(job);
+	}
+
+	// Runs a step on a worker thread
+	//    An exception escaping a worker would terminate the program, and one
+	//    escaping the ordered drain loop would leave images in flight forever,
+	//    so each step that calls out of the dispatcher is caught here. Returns
+	//    false with the error text if the step threw.
+	template<typename Function>
+	static bool Try(Function function, std::string& error)
+	{
+		try
+		{
+			function();
+			return true;
+		}
+		catch (GenICam::GenericException& ge)
+		{
+			error = ge.what();
+		}
+		catch (std::exception& ex)
+		{
+			error = ex.what();
+		}
+		catch (...)
+		{
+			error = "Unexpected exception";
+		}
+		return false;
+	}
+
+	// Reports an image whose step threw
+	//    Called with the completion lock held. An image is counted as failed
+	//    once, however many of its steps throw.
+	void ReportError(Job& job, const char* step, const std::string& error)
+	{
+		std::cout << TAB2 << "Image failed to " << step << " (sequence " << job.sequence << "): " << error << "\n";
+		if (!job.failed)
+			m_numFailed++;
+		job.failed = true;
+	}
+
+	// Releases an image
+	//    Called with the completion lock held, so completion callbacks and
+	//    requeues never overlap. The image leaves the in-flight count even if
+	//    its completion callback or requeue throws, so that waiting for idle
+	//    never hangs.
+	void Release(Job& job)
+	{
+		std::string error;
+		if (!Try([&]() { m_pCallback->OnImageComplete(job.pImage); }, error))
+			ReportError(job, "complete", error);
+		if (!Try([&]() { m_pDevice->RequeueBuffer(job.pImage); }, error))
+			ReportError(job, "requeue", error);
+
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			m_inFlight--;
+		}
+		m_idleCondition.notify_all();
+	}
+
+	Arena::IDevice* m_pDevice;
+	IPooledImageCallback* m_pCallback;
+	const bool m_ordered;
+
+	std::vector<std::thread> m_workers;
+
+	std::mutex m_queueMutex;
+	std::condition_variable m_queueCondition;
+	std::condition_variable m_idleCondition;
+	std::deque<Job> m_queue;
+	bool m_stop;
+	uint64_t m_nextSequence;
+
+	std::mutex m_completeMutex;
+	std::map<uint64_t, Job> m_parked;
+	uint64_t m_nextToComplete;
+	size_t m_inFlight;
+	std::atomic<size_t> m_numFailed;
+};
+
+// callback implementation
+//    Processing time varies from image to image so that, with several workers,
+//    images finish out of order. In ordered mode the completion messages still
+//    appear in frame ID order.
+class MyImageCallback : public IPooledImageCallback
+{
+public:
+	MyImageCallback() :
+		m_numProcessed(0)
+	{
+	}
+
+	virtual ~MyImageCallback() {};
+
+	virtual void OnImage(Arena::IImage* pImage)
+	{
+		// do something with the image
+		const uint8_t* pData = pImage->GetData();
+		size_t size = pImage->GetSizeFilled();
+		uint64_t sum = 0;
+		for (size_t i = 0; i < size; i += 16)
+			sum += pData[i];
+
+		// simulate uneven processing time
+		std::this_thread::sleep_for(std::chrono::milliseconds(5 + (pImage->GetFrameId() * 7) % 20));
+
+		m_numProcessed++;
+	}
+
+	virtual void OnImageComplete(Arena::IImage* pImage)
+	{
+		std::cout << TAB2 << "Image complete (frame ID " << pImage->GetFrameId() << ")\n";
+	}
+
+	size_t NumProcessed() const
+	{
+		return m_numProcessed;
+	}
+
+private:
+	std::atomic<size_t> m_numProcessed;
+};
+
+// demonstrates thread pool dispatch
+// (1) prepares callback and dispatcher
+// (2) starts stream
+// (3) retrieves images and dispatches them to workers
+// (4) waits for outstanding images
+// (5) stops stream
+void AcquireImagesWithThreadPool(Arena::IDevice* pDevice)
+{
+	MyImageCallback callback;
+
+	std::cout << TAB1 << "Launch " << NUM_WORKERS << " workers (" << (ORDERED_DELIVERY ? "ordered" : "unordered") << " delivery)\n";
+
+	ThreadPoolDispatcher dispatcher(pDevice, &callback, NUM_WORKERS, WORKER_FIRST_CORE, ORDERED_DELIVERY);
+
+	std::cout << TAB1 << "Start stream with " << NUM_BUFFERS << " buffers\n";
+
+	pDevice->StartStream(NUM_BUFFERS);
+
+	// Dispatch images
+	//    The acquisition thread only retrieves and hands off; it never waits on
+	//    processing. Buffers come back to the engine from the workers.
+	for (int i = 0; i < NUM_IMAGES; i++)
+	{
+		Arena::IImage* pImage = pDevice->GetImage(IMAGE_TIMEOUT);
+		dispatcher.Dispatch(pImage);
+	}
+
+	// Wait for outstanding images
+	//    All buffers must be requeued before the stream is stopped.
+	dispatcher.WaitForIdle();
+	dispatcher.Shutdown();
+
+	std::cout << TAB1 << "Processed " << callback.NumProcessed() << " images (" << dispatcher.NumFailed() << " failed)\n";
+	std::cout << TAB1 << "Stop stream\n";
+
+	pDevice->StopStream();
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_Callback_ThreadPoolDispatch\n";
+
+	try
+	{
+		// prepare example
+		Arena::ISystem* pSystem = Arena::OpenSystem();
+		pSystem->UpdateDevices(SYSTEM_TIMEOUT);
+		std::vector<Arena::DeviceInfo> deviceInfos = pSystem->GetDevices();
+		if (deviceInfos.size() == 0)
+		{
+			std::cout << "\nNo camera connected\nPress enter to complete\n";
+			std::getchar();
+			return 0;
+		}
+		Arena::IDevice* pDevice = pSystem->CreateDevice(deviceInfos[0]);
+
+		// run example
+		std::cout << "Commence example\n\n";
+		AcquireImagesWithThreadPool(pDevice);
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		pSystem->DestroyDevice(pDevice);
+		Arena::CloseSystem(pSystem);
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
@@ -0,0 +1,750 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <winsock2.h>
+#include <Ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <net/if.h>
+#include <ifaddrs.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "ArenaApi.h"
+
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <deque>
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+#if defined(_WIN32) || defined(_WIN64)
+typedef SOCKET Socket;
+typedef int socklen_t;
+#define CloseSocket closesocket
+#else
+typedef int Socket;
+#define INVALID_SOCKET (-1)
+#define CloseSocket close
+#endif
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Enumeration: Asynchronous Discovery
+//    This example demonstrates keeping track of devices without blocking
+//    sweeps. Arena::ISystem::UpdateDevices waits out its whole timeout and
+//    rebuilds the device list, so checking for devices often costs the
+//    caller that time again and again. Here a discovery service sends GigE
+//    Vision discovery requests on every host interface from a thread of its
+//    own, keeps a table of the devices that answer, and reports devices
+//    being added, removed or changing IP address through callbacks. The
+//    application only updates Arena's device list when the service reports
+//    a change, and reconnects to its device as soon as it comes back.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// Discovery interval
+//    Time between discovery requests, in milliseconds. Each request is a
+//    single small broadcast per interface, so a short interval costs the
+//    network little.
+#define DISCOVERY_INTERVAL 500
+
+// Missed rounds
+//    Number of discovery requests in a row a device must leave unanswered
+//    to be considered removed. A device answers discovery whether or not
+//    another application controls it, so silence means it has lost power or
+//    link. More than one round rides out a lost packet.
+#define MISSED_ROUNDS 3
+
+// time to watch for devices (in seconds)
+#define RUN_TIME 30
+
+// update timeout
+#define UPDATE_TIMEOUT 100
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- PROTOCOL -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+static const uint16_t GVCP_PORT = 3956;
+static const uint8_t GVCP_KEY = 0x42;
+static const uint8_t GVCP_FLAG_ACK_REQUIRED = 0x01;
+static const uint16_t GVCP_DISCOVERY_CMD = 0x0002;
+static const uint16_t GVCP_DISCOVERY_ACK = 0x0003;
+static const uint32_t GVCP_HEADER_SIZE = 8;
+
+// discovery acknowledgement payload, a copy of the bootstrap registers
+static const uint32_t DISCOVERY_ACK_SIZE = 0x00F8;
+static const uint32_t REG_MAC_HIGH = 0x0008;
+static const uint32_t REG_MAC_LOW = 0x000C;
+static const uint32_t REG_CURRENT_IP = 0x0024;
+static const uint32_t REG_CURRENT_SUBNET = 0x0034;
+static const uint32_t REG_MODEL_NAME = 0x0068;
+static const uint32_t REG_SERIAL_NUMBER = 0x00D8;
+static const uint32_t REG_USER_NAME = 0x00E8;
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- HELPERS -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+static uint16_t Get16(const uint8_t* p)
+{
+	return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+static uint32_t Get32(const uint8_t* p)
+{
+	return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+// reads a fixed-width string register, which need not be null-terminated
+static std::string GetString(const uint8_t* p, size_t size)
+{
+	const uint8_t* pEnd = std::find(p, p + size, 0);
+	return std::string(reinterpret_cast<const char*>(p), pEnd - p);
+}
+
+static std::string AddressToString(uint32_t address)
+{
+	std::ostringstream text;
+	text << (address >> 24) << "." << ((address >> 16) & 0xFF) << "." << ((address >> 8) & 0xFF) << "." << (address & 0xFF);
+	return text.str();
+}
+
+static std::string MacToString(uint64_t mac)
+{
+	std::ostringstream text;
+	text << std::hex << std::uppercase << std::setfill('0');
+	for (int shift = 40; shift >= 0; shift -= 8)
+		text << std::setw(2) << ((mac >> shift) & 0xFF) << (shift ? ":" : "");
+	return text.str();
+}
+
+// Host interfaces
+//    IPv4 addresses of the host, with the broadcast address of each. Where
+//    interface details are not available (Windows without the IP helper
+//    library), the limited broadcast address is used on every address.
+struct HostInterface
+{
+	uint32_t address;
+	uint32_t broadcast;
+
+	bool operator==(const HostInterface& other) const
+	{
+		return address == other.address && broadcast == other.broadcast;
+	}
+};
+
+static std::vector<HostInterface> GetHostInterfaces()
+{
+	std::vector<HostInterface> interfaces;
+
+#if defined(_WIN32) || defined(_WIN64)
+	char hostName[256] = { 0 };
+	if (gethostname(hostName, sizeof(hostName)) != 0)
+		return interfaces;
+
+	struct addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+
+	struct addrinfo* pResult = NULL;
+	if (getaddrinfo(hostName, NULL, &hints, &pResult) != 0)
+		return interfaces;
+
+	for (struct addrinfo* p = pResult; p; p = p->ai_next)
+	{
+		HostInterface hostInterface;
+		hostInterface.address = ntohl(reinterpret_cast<struct sockaddr_in*>(p->ai_addr)->sin_addr.s_addr);
+		hostInterface.broadcast = INADDR_BROADCAST;
+		interfaces.push_back(hostInterface);
+	}
+	freeaddrinfo(pResult);
+#else
+	struct ifaddrs* pAddresses = NULL;
+	if (getifaddrs(&pAddresses) != 0)
+		return interfaces;
+
+	for (struct ifaddrs* p = pAddresses; p; p = p->ifa_next)
+	{
+		if (!p->ifa_addr || p->ifa_addr->sa_family != AF_INET || !p->ifa_broadaddr)
+			continue;
+		if (!(p->ifa_flags & IFF_UP) || !(p->ifa_flags & IFF_BROADCAST) || (p->ifa_flags & IFF_LOOPBACK))
+			continue;
+
+		HostInterface hostInterface;
+		hostInterface.address = ntohl(reinterpret_cast<struct sockaddr_in*>(p->ifa_addr)->sin_addr.s_addr);
+		hostInterface.broadcast = ntohl(reinterpret_cast<struct sockaddr_in*>(p->ifa_broadaddr)->sin_addr.s_addr);
+		interfaces.push_back(hostInterface);
+	}
+	freeifaddrs(pAddresses);
+#endif
+
+	std::sort(interfaces.begin(), interfaces.end(), [](const HostInterface& a, const HostInterface& b) { return a.address < b.address; });
+	return interfaces;
+}
+
+// creates a UDP socket bound to a host address, on any port
+static Socket OpenUdpSocket(uint32_t address)
+{
+	Socket s = socket(AF_INET, SOCK_DGRAM, 0);
+	if (s == INVALID_SOCKET)
+		throw std::runtime_error("Failed to create socket");
+
+	int enable = 1;
+	setsockopt(s, SOL_SOCKET, SO_BROADCAST, reinterpret_cast<const char*>(&enable), sizeof(enable));
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(address);
+	addr.sin_port = 0;
+	if (bind(s, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0)
+	{
+		CloseSocket(s);
+		throw std::runtime_error("Failed to bind to " + AddressToString(address));
+	}
+	return s;
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// discovered device
+//    An entry of the device table, taken from the discovery acknowledgement.
+struct DiscoveredDevice
+{
+	uint64_t mac;
+	uint32_t ipAddress;
+	uint32_t subnetMask;
+	uint32_t hostAddress;
+	std::string model;
+	std::string serialNumber;
+	std::string userDefinedName;
+	uint64_t lastRound;
+};
+
+// Discovery service
+//    Sends a discovery request on every host interface each interval and
+//    collects the answers on a thread of its own. Host interfaces are listed
+//    again every round, so a cable plugged into the host is picked up too.
+//    Devices are keyed by MAC address. Callbacks run on the discovery thread
+//    and must not block it for long; handing the event to another thread, as
+//    this example does, keeps discovery running on time.
+class DiscoveryService
+{
+public:
+	typedef std::function<void(const DiscoveredDevice&)> DeviceCallback;
+	typedef std::function<void(const DiscoveredDevice&, uint32_t)> IpChangeCallback;
+
+	DiscoveryService() :
+		m_running(false),
+		m_round(0)
+	{
+	}
+
+	~DiscoveryService()
+	{
+		Stop();
+	}
+
+	// callbacks are set before starting
+	void OnAdded(const DeviceCallback& callback) { m_onAdded = callback; }
+	void OnRemoved(const DeviceCallback& callback) { m_onRemoved = callback; }
+	void OnIpChanged(const IpChangeCallback& callback) { m_onIpChanged = callback; }
+
+	void Start()
+	{
+		if (m_running)
+			return;
+
+		m_running = true;
+		m_thread = std::thread(&DiscoveryService::Run, this);
+	}
+
+	void Stop()
+	{
+		if (!m_running)
+			return;
+
+		m_running = false;
+		m_thread.join();
+		CloseSockets();
+	}
+
+	// returns a snapshot of the device table
+	std::vector<DiscoveredDevice> GetDevices() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_devices;
+	}
+
+private:
+	// Run
+	// (1) lists host interfaces, opening a socket for each
+	// (2) sends a discovery request on each
+	// (3) collects acknowledgements until the next round is due
+	// (4) removes devices that have missed too many rounds
+	void Run()
+	{
+		uint16_t requestId = 0;
+
+		while (m_running)
+		{
+			m_round++;
+			requestId = static_cast<uint16_t>(requestId == 0xFFFF ? 1 : requestId + 1);
+
+			RefreshInterfaces();
+			for (size_t i = 0; i < m_sockets.size(); i++)
+				SendDiscovery(m_sockets[i], m_interfaces[i].broadcast, requestId);
+
+			std::chrono::steady_clock::time_point due = std::chrono::steady_clock::now() + std::chrono::milliseconds(DISCOVERY_INTERVAL);
+			while (m_running && std::chrono::steady_clock::now() < due)
+				Receive(std::chrono::duration_cast<std::chrono::microseconds>(due - std::chrono::steady_clock::now()));
+
+			Sweep();
+		}
+	}
+
+	void RefreshInterfaces()
+	{
+		std::vector<HostInterface> interfaces = GetHostInterfaces();
+		if (interfaces == m_interfaces)
+			return;
+
+		CloseSockets();
+		for (size_t i = 0; i < interfaces.size(); i++)
+		{
+			try
+			{
+				m_sockets.push_back(OpenUdpSocket(interfaces[i].address));
+				m_interfaces.push_back(interfaces[i]);
+			}
+			catch (std::exception&)
+			{
+				// address went away between listing and binding; retried next round
+			}
+		}
+	}
+
+	void CloseSockets()
+	{
+		for (size_t i = 0; i < m_sockets.size(); i++)
+			CloseSocket(m_sockets[i]);
+		m_sockets.clear();
+		m_interfaces.clear();
+	}
+
+	static void SendDiscovery(Socket s, uint32_t broadcast, uint16_t requestId)
+	{
+		uint8_t request[GVCP_HEADER_SIZE] = { GVCP_KEY, GVCP_FLAG_ACK_REQUIRED, 0, static_cast<uint8_t>(GVCP_DISCOVERY_CMD), 0, 0,
+			static_cast<uint8_t>(requestId >> 8), static_cast<uint8_t>(requestId) };
+
+		struct sockaddr_in addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(broadcast);
+		addr.sin_port = htons(GVCP_PORT);
+		sendto(s, reinterpret_cast<const char*>(request), sizeof(request), 0, reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr));
+	}
+
+	// Receive
+	//    Waits at most 50 ms at a time so that stopping the service never
+	//    waits out a whole interval.
+	void Receive(std::chrono::microseconds timeout)
+	{
+		if (m_sockets.empty())
+		{
+			std::this_thread::sleep_for(std::min(timeout, std::chrono::microseconds(50000)));
+			return;
+		}
+
+		fd_set readable;
+		FD_ZERO(&readable);
+		Socket maxSocket = 0;
+		for (size_t i = 0; i < m_sockets.size(); i++)
+		{
+			FD_SET(m_sockets[i], &readable);
+			maxSocket = std::max(maxSocket, m_sockets[i]);
+		}
+
+		long waitUs = static_cast<long>(std::max<int64_t>(0, std::min<int64_t>(timeout.count(), 50000)));
+		struct timeval wait = { 0, waitUs };
+		if (select(static_cast<int>(maxSocket + 1), &readable, NULL, NULL, &wait) <= 0)
+			return;
+
+		for (size_t i = 0; i < m_sockets.size(); i++)
+		{
+			if (!FD_ISSET(m_sockets[i], &readable))
+				continue;
+
+			uint8_t ack[1024];
+			int received = static_cast<int>(recv(m_sockets[i], reinterpret_cast<char*>(ack), sizeof(ack), 0));
+			if (received < static_cast<int>(GVCP_HEADER_SIZE + DISCOVERY_ACK_SIZE))
+				continue;
+			if (Get16(ack) != 0 || Get16(ack + 2) != GVCP_DISCOVERY_ACK)
+				continue;
+
+			const uint8_t* pPayload = ack + GVCP_HEADER_SIZE;
+
+			DiscoveredDevice device;
+			device.mac = (static_cast<uint64_t>(Get32(pPayload + REG_MAC_HIGH) & 0xFFFF) << 32) | Get32(pPayload + REG_MAC_LOW);
+			device.ipAddress = Get32(pPayload + REG_CURRENT_IP);
+			device.subnetMask = Get32(pPayload + REG_CURRENT_SUBNET);
+			device.hostAddress = m_interfaces[i].address;
+			device.model = GetString(pPayload + REG_MODEL_NAME, 32);
+			device.serialNumber = GetString(pPayload + REG_SERIAL_NUMBER, 16);
+			device.userDefinedName = GetString(pPayload + REG_USER_NAME, 16);
+			device.lastRound = m_round;
+
+			Update(device);
+		}
+	}
+
+	// Update
+	//    Adds a device or refreshes its entry. Callbacks are called after the
+	//    table is unlocked, so that they may read it.
+	void Update(const DiscoveredDevice& device)
+	{
+		bool added = false;
+		bool ipChanged = false;
+		uint32_t previousIp = 0;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			auto it = std::find_if(m_devices.begin(), m_devices.end(), [&](const DiscoveredDevice& entry) { return entry.mac == device.mac; });
+			if (it == m_devices.end())
+			{
+				m_devices.push_back(device);
+				added = true;
+			}
+			else
+			{
+				ipChanged = it->ipAddress != device.ipAddress;
+				previousIp = it->ipAddress;
+				*it = device;
+			}
+		}
+
+		if (added && m_onAdded)
+			m_onAdded(device);
+		if (ipChanged && m_onIpChanged)
+			m_onIpChanged(device, previousIp);
+	}
+
+	void Sweep()
+	{
+		std::vector<DiscoveredDevice> removed;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			auto missing = [&](const DiscoveredDevice& entry) { return m_round - entry.lastRound >= MISSED_ROUNDS; };
+			std::copy_if(m_devices.begin(), m_devices.end(), std::back_inserter(removed), missing);
+			m_devices.erase(std::remove_if(m_devices.begin(), m_devices.end(), missing), m_devices.end());
+		}
+
+		if (m_onRemoved)
+		{
+			for (size_t i = 0; i < removed.size(); i++)
+				m_onRemoved(removed[i]);
+		}
+	}
+
+	std::atomic<bool> m_running;
+	std::thread m_thread;
+	uint64_t m_round;
+
+	std::vector<HostInterface> m_interfaces;
+	std::vector<Socket> m_sockets;
+
+	mutable std::mutex m_mutex;
+	std::vector<DiscoveredDevice> m_devices;
+
+	DeviceCallback m_onAdded;
+	DeviceCallback m_onRemoved;
+	IpChangeCallback m_onIpChanged;
+};
+
+// Device events
+//    Callbacks queue events for the main thread, which owns the Arena
+//    device.
+enum EventType
+{
+	DeviceAdded,
+	DeviceRemoved,
+	DeviceIpChanged
+};
+
+struct DeviceEvent
+{
+	EventType type;
+	DiscoveredDevice device;
+	uint32_t previousIp;
+};
+
+class EventQueue
+{
+public:
+	void Push(const DeviceEvent& event)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_events.push_back(event);
+		}
+		m_condition.notify_one();
+	}
+
+	// waits for an event until the deadline, returning false on timeout
+	bool Pop(DeviceEvent& event, std::chrono::steady_clock::time_point deadline)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		if (!m_condition.wait_until(lock, deadline, [&] { return !m_events.empty(); }))
+			return false;
+
+		event = m_events.front();
+		m_events.pop_front();
+		return true;
+	}
+
+private:
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::deque<DeviceEvent> m_events;
+};
+
+// connects to a discovered device through Arena
+//    Arena's device list is only updated now that a device is known to be
+//    there, so a short timeout is enough.
+Arena::IDevice* Connect(Arena::ISystem* pSystem, const DiscoveredDevice& device)
+{
+	pSystem->UpdateDevices(UPDATE_TIMEOUT);
+	std::vector<Arena::DeviceInfo> deviceInfos = pSystem->GetDevices();
+
+	for (auto& deviceInfo : deviceInfos)
+	{
+		if (deviceInfo.MacAddress() == device.mac)
+			return pSystem->CreateDevice(deviceInfo);
+	}
+	return nullptr;
+}
+
+void PrintDevice(const char* prefix, const DiscoveredDevice& device)
+{
+	std::cout << TAB2 << prefix << " " << device.model << " " << device.serialNumber << " (" << MacToString(device.mac) << ") at "
+			  << AddressToString(device.ipAddress) << " on " << AddressToString(device.hostAddress) << "\n";
+}
+
+// demonstrates asynchronous discovery
+// (1) starts the discovery service, queueing its events
+// (2) connects to the first device added
+// (3) disconnects when it is removed, reconnects when it comes back
+// (4) reconnects when its IP address changes
+// (5) retries connecting while the device is present but not connected
+// (6) prints the device table
+void WatchDevices(Arena::ISystem* pSystem)
+{
+	EventQueue events;
+	DiscoveryService discovery;
+
+	discovery.OnAdded([&](const DiscoveredDevice& device) { events.Push(DeviceEvent{ DeviceAdded, device, 0 }); });
+	discovery.OnRemoved([&](const DiscoveredDevice& device) { events.Push(DeviceEvent{ DeviceRemoved, device, 0 }); });
+	discovery.OnIpChanged([&](const DiscoveredDevice& device, uint32_t previousIp) { events.Push(DeviceEvent{ DeviceIpChanged, device, previousIp }); });
+
+	// start discovery
+	std::cout << TAB1 << "Watch devices for " << RUN_TIME << " seconds; connect and disconnect devices to see events\n";
+
+	discovery.Start();
+
+	// Handle events
+	//    The device that is connected stays the one followed; others are only
+	//    reported. A device with the same MAC address coming back is connected
+	//    again straight away.
+	Arena::IDevice* pDevice = nullptr;
+	uint64_t followedMac = 0;
+
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + std::chrono::seconds(RUN_TIME);
+	std::chrono::steady_clock::time_point nextRetry = end;
+
+	auto tryConnect = [&](const DiscoveredDevice& device) {
+		try
+		{
+			pDevice = Connect(pSystem, device);
+		}
+		catch (GenICam::GenericException& ge)
+		{
+			std::cout << TAB2 << TAB1 << "Failed to connect: " << ge.what() << "\n";
+		}
+
+		if (pDevice)
+		{
+			followedMac = device.mac;
+			std::cout << TAB2 << TAB1 << "Connected to " << Arena::GetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "DeviceModelName") << "\n";
+		}
+		else
+		{
+			nextRetry = std::chrono::steady_clock::now() + std::chrono::milliseconds(DISCOVERY_INTERVAL);
+		}
+	};
+
+	while (std::chrono::steady_clock::now() < end)
+	{
+		// Retry connecting
+		//    A device that answers discovery may not accept a connection yet,
+		//    e.g. while it boots or while Arena has not seen it. As long as
+		//    the followed device (or, before one is followed, any device) is
+		//    present but not connected, connecting is tried again once per
+		//    discovery interval, whether or not events arrive in between.
+		DeviceEvent event;
+		if (!events.Pop(event, pDevice ? end : std::min(nextRetry, end)))
+		{
+			if (pDevice || std::chrono::steady_clock::now() >= end)
+				continue;
+
+			nextRetry = end;
+			std::vector<DiscoveredDevice> devices = discovery.GetDevices();
+			for (size_t i = 0; i < devices.size() && !pDevice; i++)
+			{
+				if (followedMac == 0 || devices[i].mac == followedMac)
+				{
+					std::cout << TAB2 << "Retry " << MacToString(devices[i].mac) << "\n";
+					tryConnect(devices[i]);
+				}
+			}
+			continue;
+		}
+
+		bool followed = followedMac == 0 || event.device.mac == followedMac;
+
+		switch (event.type)
+		{
+		case DeviceAdded:
+			PrintDevice("Added", event.device);
+			break;
+		case DeviceRemoved:
+			PrintDevice("Removed", event.device);
+			break;
+		case DeviceIpChanged:
+			std::cout << TAB2 << "IP changed from " << AddressToString(event.previousIp) << ":\n";
+			PrintDevice("       ", event.device);
+			break;
+		}
+
+		if (!followed)
+			continue;
+
+		// a removed device, or one at a new address, is released first
+		if (pDevice && event.type != DeviceAdded)
+		{
+			pSystem->DestroyDevice(pDevice);
+			pDevice = nullptr;
+			std::cout << TAB2 << TAB1 << "Disconnected\n";
+		}
+
+		if (!pDevice && event.type != DeviceRemoved)
+			tryConnect(event.device);
+	}
+
+	discovery.Stop();
+
+	// print table
+	std::vector<DiscoveredDevice> devices = discovery.GetDevices();
+	std::cout << TAB1 << devices.size() << " device" << (devices.size() == 1 ? "" : "s") << " present\n";
+
+	for (size_t i = 0; i < devices.size(); i++)
+		PrintDevice("", devices[i]);
+
+	if (pDevice)
+		pSystem->DestroyDevice(pDevice);
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_Enumeration_AsyncDiscovery\n";
+
+#if defined(_WIN32) || defined(_WIN64)
+	WSADATA wsaData;
+	WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+	try
+	{
+		// prepare example
+		Arena::ISystem* pSystem = Arena::OpenSystem();
+
+		// run example
+		std::cout << "Commence example\n\n";
+		WatchDevices(pSystem);
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		Arena::CloseSystem(pSystem);
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+#if defined(_WIN32) || defined(_WIN64)
+	WSACleanup();
+#endif
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
@@ -0,0 +1,443 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "../GenTLHelpers.h"
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <cctype>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Enumeration: Cached Device Files
+//    This example demonstrates opening devices without downloading and
+//    parsing their device files every time. Arena::ISystem::CreateDevice
+//    reads the device file (the GenICam XML describing every feature) from
+//    device registers and parses it on every open, which can take seconds
+//    per camera on small ARM boards. The example keeps two caches in one
+//    directory: device files keyed by their SHA-1 hash or version, so that
+//    the download is skipped, and GenApi's own cache of preprocessed device
+//    files (GenICam::SetGenICamCacheFolder), so that parsing is skipped.
+//    Cameras of the same model share one entry. The example opens every
+//    device twice, first with an empty cache and then with a filled one, and
+//    reports the time saved.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// Cache directory
+//    Must be writable. GenApi's preprocessed files go in a subdirectory.
+#define CACHE_DIRECTORY "DeviceFileCache"
+
+// discovery timeout
+#define DISCOVERY_TIMEOUT 100
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// host time in milliseconds
+double HostMs()
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// makes a directory, doing nothing if it exists already
+void MakeDirectory(const std::string& path)
+{
+#ifdef _WIN32
+	_mkdir(path.c_str());
+#else
+	mkdir(path.c_str(), 0755);
+#endif
+}
+
+// reads a string of device information, returning an empty string if the producer does not provide it
+std::string GetDeviceInfoString(GenTL::DEV_HANDLE hDevice, GenTL::DEVICE_INFO_CMD infoCmd)
+{
+	char value[512] = { 0 };
+	size_t size = sizeof(value);
+	GenTL::INFO_DATATYPE type = GenTL::INFO_DATATYPE_UNKNOWN;
+	if (GenTL::DevGetInfo(hDevice, infoCmd, &type, value, &size) != GenTL::GC_ERR_SUCCESS)
+		return "";
+	return value;
+}
+
+// reads device file information, returning false if the producer does not provide it
+template<typename T>
+bool TryGetURLInfo(GenTL::PORT_HANDLE hPort, GenTL::URL_INFO_CMD infoCmd, T& value)
+{
+	GenTL::INFO_DATATYPE type = GenTL::INFO_DATATYPE_UNKNOWN;
+	size_t size = sizeof(value);
+	return GenTL::GCGetPortURLInfo(hPort, 0, infoCmd, &type, &value, &size) == GenTL::GC_ERR_SUCCESS && size == sizeof(value);
+}
+
+// Cache key
+//    The SHA-1 hash of the device file identifies it exactly, and reading it
+//    costs a single register access. Where the device or producer does not
+//    report one, the key falls back to model, device version and device file
+//    version. Firmware that changes the device file without changing any of
+//    those then needs its entry invalidated by hand
+//    (DeviceFileCache::Invalidate).
+std::string GetCacheKey(GenTL::DEV_HANDLE hDevice, GenTL::PORT_HANDLE hPort)
+{
+	std::ostringstream key;
+
+	uint8_t hash[20] = { 0 };
+	bool hasHash = TryGetURLInfo(hPort, GenTL::URL_INFO_FILE_SHA1_HASH, hash);
+	if (hasHash && std::count(hash, hash + sizeof(hash), 0) == static_cast<std::ptrdiff_t>(sizeof(hash)))
+		hasHash = false;
+
+	if (hasHash)
+	{
+		key << "sha1_" << std::hex << std::setfill('0');
+		for (size_t i = 0; i < sizeof(hash); i++)
+			key << std::setw(2) << static_cast<int>(hash[i]);
+		return key.str();
+	}
+
+	int32_t major = 0;
+	int32_t minor = 0;
+	int32_t subminor = 0;
+	TryGetURLInfo(hPort, GenTL::URL_INFO_FILE_VER_MAJOR, major);
+	TryGetURLInfo(hPort, GenTL::URL_INFO_FILE_VER_MINOR, minor);
+	TryGetURLInfo(hPort, GenTL::URL_INFO_FILE_VER_SUBMINOR, subminor);
+
+	key << GetDeviceInfoString(hDevice, GenTL::DEVICE_INFO_MODEL) << "_" << GetDeviceInfoString(hDevice, GenTL::DEVICE_INFO_VERSION)
+		<< "_" << major << "." << minor << "." << subminor;
+
+	// keep the key usable as a file name
+	std::string result = key.str();
+	for (size_t i = 0; i < result.size(); i++)
+	{
+		if (!std::isalnum(static_cast<unsigned char>(result[i])) && result[i] != '.' && result[i] != '-')
+			result[i] = '_';
+	}
+	return result;
+}
+
+// Device file cache
+//    Keeps device files on disk, one per key, and points GenApi's cache of
+//    preprocessed device files to a subdirectory. GenApi keys preprocessed
+//    files on the content of the device file, so they never go stale; they
+//    only take up space, which ClearPreprocessed gives back.
+class DeviceFileCache
+{
+public:
+	explicit DeviceFileCache(const std::string& directory) :
+		m_directory(directory)
+	{
+		MakeDirectory(m_directory);
+		MakeDirectory(m_directory + "/Preprocessed");
+		GenICam::SetGenICamCacheFolder((m_directory + "/Preprocessed").c_str());
+	}
+
+	bool Load(const std::string& key, std::vector<uint8_t>& file, bool& zipped) const
+	{
+		for (int i = 0; i < 2; i++)
+		{
+			std::ifstream stream(Path(key, i == 0).c_str(), std::ios::binary);
+			if (!stream)
+				continue;
+
+			file.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+			zipped = i == 0;
+			return !file.empty();
+		}
+		return false;
+	}
+
+	// Store
+	//    The file is written under a temporary name and renamed into place, so
+	//    that a process opening devices at the same time never reads half a
+	//    file.
+	void Store(const std::string& key, const std::vector<uint8_t>& file, bool zipped) const
+	{
+		std::string path = Path(key, zipped);
+		std::string temporaryPath = path + ".tmp";
+		{
+			std::ofstream stream(temporaryPath.c_str(), std::ios::binary | std::ios::trunc);
+			stream.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+			if (!stream)
+				throw GenICam::GenericException(("Failed to write " + temporaryPath).c_str(), __FILE__, __LINE__);
+		}
+
+		std::remove(path.c_str());
+		if (std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+			throw GenICam::GenericException(("Failed to write " + path).c_str(), __FILE__, __LINE__);
+	}
+
+	// removes the device file stored for a key
+	void Invalidate(const std::string& key) const
+	{
+		std::remove(Path(key, true).c_str());
+		std::remove(Path(key, false).c_str());
+	}
+
+	// removes all preprocessed device files
+	void ClearPreprocessed() const
+	{
+		GenApi::CNodeMapFactory::ClearCache();
+	}
+
+private:
+	std::string Path(const std::string& key, bool zipped) const
+	{
+		return m_directory + "/" + key + (zipped ? ".zip" : ".xml");
+	}
+
+	std::string m_directory;
+};
+
+// Open statistics
+//    The file time is the download, or the read from disk on a cache hit;
+//    the node map time is parsing, or loading a preprocessed file.
+struct OpenStatistics
+{
+	std::string deviceId;
+	std::string key;
+	std::string model;
+	bool cached;
+	double fileMs;
+	double nodeMapMs;
+};
+
+// opens a device and creates its node map through the cache
+// (1) reads the cache key
+// (2) loads the device file from the cache, or downloads and stores it
+// (3) creates the node map, preprocessed if GenApi has it cached
+// (4) connects the node map and reads a feature
+// (5) closes the device
+OpenStatistics OpenDevice(GenTL::IF_HANDLE hInterface, const std::string& deviceId, DeviceFileCache& cache, bool refresh)
+{
+	OpenStatistics statistics;
+	statistics.deviceId = deviceId;
+
+	GenTL::DEV_HANDLE hDevice = NULL;
+	CheckGC(GenTL::IFOpenDevice(hInterface, deviceId.c_str(), GenTL::DEVICE_ACCESS_CONTROL, &hDevice), "IFOpenDevice");
+
+	GenTL::PORT_HANDLE hRemotePort = NULL;
+	CheckGC(GenTL::DevGetPort(hDevice, &hRemotePort), "DevGetPort");
+	RemotePort remotePort(hRemotePort);
+
+	// get device file
+	double start = HostMs();
+
+	statistics.key = GetCacheKey(hDevice, hRemotePort);
+
+	if (refresh)
+		cache.Invalidate(statistics.key);
+
+	std::vector<uint8_t> file;
+	bool zipped = false;
+	statistics.cached = cache.Load(statistics.key, file, zipped);
+
+	if (!statistics.cached)
+	{
+		DeviceFileLocation location = GetDeviceFileLocation(hRemotePort);
+		file.resize(location.length);
+		remotePort.Read(file.data(), static_cast<int64_t>(location.address), static_cast<int64_t>(location.length));
+		zipped = location.zipped;
+
+		cache.Store(statistics.key, file, zipped);
+	}
+
+	statistics.fileMs = HostMs() - start;
+
+	// create node map
+	start = HostMs();
+
+	GenApi::CNodeMapRef nodeMap;
+	if (zipped)
+		nodeMap._LoadXMLFromZIPData(file.data(), file.size());
+	else
+		nodeMap._LoadXMLFromString(GenICam::gcstring(reinterpret_cast<const char*>(file.data()), file.size()));
+
+	statistics.nodeMapMs = HostMs() - start;
+
+	// use node map
+	nodeMap._Connect(&remotePort, "Device");
+
+	GenApi::CStringPtr pDeviceModelName = nodeMap._GetNode("DeviceModelName");
+	statistics.model = pDeviceModelName ? pDeviceModelName->GetValue().c_str() : "";
+
+	CheckGC(GenTL::DevClose(hDevice), "DevClose");
+	return statistics;
+}
+
+// opens every device once, returning the total time
+double OpenAll(const std::vector<std::pair<GenTL::IF_HANDLE, std::string>>& devices, DeviceFileCache& cache, bool refresh)
+{
+	double totalMs = 0.0;
+	for (size_t i = 0; i < devices.size(); i++)
+	{
+		OpenStatistics statistics = OpenDevice(devices[i].first, devices[i].second, cache, refresh);
+		totalMs += statistics.fileMs + statistics.nodeMapMs;
+
+		std::cout << TAB2 << statistics.model << " (" << statistics.deviceId << "): device file " << (statistics.cached ? "from cache " : "downloaded ")
+				  << std::fixed << std::setprecision(1) << statistics.fileMs << " ms, node map " << statistics.nodeMapMs << " ms\n"
+				  << std::defaultfloat;
+		std::cout << TAB2 << TAB1 << "key " << statistics.key << "\n";
+	}
+	return totalMs;
+}
+
+// demonstrates opening devices through a device file cache
+// (1) discovers all devices through the GenTL producer
+// (2) opens every device, downloading device files into an emptied cache
+// (3) opens every device again, from the cache
+// (4) reports time saved
+void CompareCachedOpens()
+{
+	GenTL::TL_HANDLE hSystem = NULL;
+	CheckGC(GenTL::TLOpen(&hSystem), "TLOpen");
+
+	// find all devices
+	std::cout << TAB1 << "Discover devices\n";
+
+	bool8_t changed = 0;
+	CheckGC(GenTL::TLUpdateInterfaceList(hSystem, &changed, DISCOVERY_TIMEOUT), "TLUpdateInterfaceList");
+
+	uint32_t numInterfaces = 0;
+	CheckGC(GenTL::TLGetNumInterfaces(hSystem, &numInterfaces), "TLGetNumInterfaces");
+
+	std::vector<GenTL::IF_HANDLE> interfaces;
+	std::vector<std::pair<GenTL::IF_HANDLE, std::string>> devices;
+
+	for (uint32_t i = 0; i < numInterfaces; i++)
+	{
+		char interfaceId[512] = { 0 };
+		size_t interfaceIdSize = sizeof(interfaceId);
+		CheckGC(GenTL::TLGetInterfaceID(hSystem, i, interfaceId, &interfaceIdSize), "TLGetInterfaceID");
+
+		GenTL::IF_HANDLE hInterface = NULL;
+		CheckGC(GenTL::TLOpenInterface(hSystem, interfaceId, &hInterface), "TLOpenInterface");
+		CheckGC(GenTL::IFUpdateDeviceList(hInterface, &changed, DISCOVERY_TIMEOUT), "IFUpdateDeviceList");
+		interfaces.push_back(hInterface);
+
+		uint32_t numDevices = 0;
+		CheckGC(GenTL::IFGetNumDevices(hInterface, &numDevices), "IFGetNumDevices");
+
+		for (uint32_t j = 0; j < numDevices; j++)
+		{
+			char deviceId[512] = { 0 };
+			size_t deviceIdSize = sizeof(deviceId);
+			CheckGC(GenTL::IFGetDeviceID(hInterface, j, deviceId, &deviceIdSize), "IFGetDeviceID");
+			devices.push_back(std::make_pair(hInterface, std::string(deviceId)));
+		}
+	}
+
+	std::cout << TAB2 << devices.size() << " device" << (devices.size() == 1 ? "" : "s") << " found\n";
+
+	if (!devices.empty())
+	{
+		DeviceFileCache cache(CACHE_DIRECTORY);
+
+		// Open with empty cache
+		//    Every device file is downloaded and stored again. The first device
+		//    of each model is parsed in full; others of the same model already
+		//    find it preprocessed.
+		std::cout << TAB1 << "Open devices, refreshing cache in '" << CACHE_DIRECTORY << "'\n";
+
+		cache.ClearPreprocessed();
+		double coldMs = OpenAll(devices, cache, true);
+
+		// open from cache
+		std::cout << TAB1 << "Open devices from cache\n";
+
+		double warmMs = OpenAll(devices, cache, false);
+
+		// report
+		std::cout << TAB1 << std::fixed << std::setprecision(1) << "Device files and node maps took " << coldMs << " ms without cache, "
+				  << warmMs << " ms with cache; " << coldMs - warmMs << " ms saved (" << (coldMs - warmMs) / static_cast<double>(devices.size())
+				  << " ms per device)\n"
+				  << std::defaultfloat;
+	}
+	else
+	{
+		std::cout << TAB1 << "No camera connected\n";
+	}
+
+	// clean up
+	for (size_t i = 0; i < interfaces.size(); i++)
+		CheckGC(GenTL::IFClose(interfaces[i]), "IFClose");
+	CheckGC(GenTL::TLClose(hSystem), "TLClose");
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_Enumeration_CachedDeviceFiles\n";
+
+	try
+	{
+		// prepare example
+		CheckGC(GenTL::GCInitLib(), "GCInitLib");
+
+		// run example
+		std::cout << "Commence example\n\n";
+		CompareCachedOpens();
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		GenTL::GCCloseLib();
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
@@ -0,0 +1,243 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Exposure: Closed Loop
+//    This example demonstrates changing exposure time and gain on every frame
+//    through node references. Getting and setting nodes by name
+//    (Arena::GetNodeValue, Arena::SetNodeValue) searches the node map on every
+//    call. A node reference (Arena::NodeRef) does that search once, so a
+//    control loop that adjusts features per frame pays only for the access
+//    itself. The example first times both ways of reading a node, then runs a
+//    simple exposure loop that drives the image mean towards a target,
+//    raising gain only once exposure time has reached its limit.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// pixel format of the controlled images
+#define PIXEL_FORMAT "Mono8"
+
+// image mean the loop steers towards
+#define TARGET_MEAN 100.0
+
+// Loop gain
+//    Fraction of the error corrected on each frame. Lower values settle more
+//    slowly but do not overshoot when the scene changes.
+#define LOOP_GAIN 0.5
+
+// longest exposure time the loop may use (in microseconds)
+#define MAX_EXPOSURE_TIME 20000.0
+
+// number of reads to time each way
+#define NUM_READS 10000
+
+// number of images to grab
+#define NUM_IMAGES 100
+
+// system timeout
+#define SYSTEM_TIMEOUT 100
+
+// image timeout
+#define IMAGE_TIMEOUT 2000
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// computes the mean of a Mono8 image, sampling every fourth pixel
+double Mean(Arena::IImage* pImage)
+{
+	const uint8_t* pData = pImage->GetData();
+	size_t stride = pImage->GetWidth() + pImage->GetPaddingX();
+	uint64_t sum = 0;
+	uint64_t count = 0;
+
+	for (size_t y = 0; y < pImage->GetHeight(); y += 4)
+	{
+		for (size_t x = 0; x < pImage->GetWidth(); x += 4, count++)
+			sum += pData[y * stride + x];
+	}
+
+	return count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0;
+}
+
+// demonstrates node references in a control loop
+// (1) times reading a node by name and by reference
+// (2) disables automatic exposure and gain
+// (3) resolves exposure time and gain once
+// (4) adjusts both on every frame
+// (5) restores initial settings
+void RunClosedLoop(Arena::IDevice* pDevice)
+{
+	GenApi::INodeMap* pNodeMap = pDevice->GetNodeMap();
+
+	// Time reads
+	//    Reads of a cached value never reach the device, so the difference
+	//    between the two is the lookup alone.
+	std::cout << TAB1 << "Read ExposureTime " << NUM_READS << " times\n";
+
+	double value = 0.0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int i = 0; i < NUM_READS; i++)
+		value += Arena::GetNodeValue<double>(pNodeMap, "ExposureTime");
+	double byNameNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / NUM_READS;
+
+	Arena::NodeRef<double> exposureTime(pNodeMap, "ExposureTime");
+
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < NUM_READS; i++)
+		value += exposureTime.Get();
+	double byReferenceNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / NUM_READS;
+
+	std::cout << TAB2 << "By name:      " << static_cast<int>(byNameNs) << " ns per read\n";
+	std::cout << TAB2 << "By reference: " << static_cast<int>(byReferenceNs) << " ns per read (checksum " << value << ")\n";
+
+	// Prepare control
+	//    Automatic exposure and gain would fight the loop, so both are turned
+	//    off. Ranges are read once, outside the loop.
+	std::cout << TAB1 << "Disable automatic exposure and gain\n";
+
+	GenICam::gcstring pixelFormatInitial = Arena::GetNodeValue<GenICam::gcstring>(pNodeMap, "PixelFormat");
+	GenICam::gcstring exposureAutoInitial = Arena::GetNodeValue<GenICam::gcstring>(pNodeMap, "ExposureAuto");
+	GenICam::gcstring gainAutoInitial = Arena::GetNodeValue<GenICam::gcstring>(pNodeMap, "GainAuto");
+
+	Arena::SetNodeValue<GenICam::gcstring>(pNodeMap, "PixelFormat", PIXEL_FORMAT);
+	Arena::SetNodeValue<GenICam::gcstring>(pNodeMap, "ExposureAuto", "Off");
+	Arena::SetNodeValue<GenICam::gcstring>(pNodeMap, "GainAuto", "Off");
+
+	Arena::NodeRef<double> gain(pNodeMap, "Gain");
+
+	double exposureTimeInitial = exposureTime.Get();
+	double gainInitial = gain.Get();
+
+	double exposureMin = exposureTime->GetMin();
+	double exposureMax = std::min(exposureTime->GetMax(), MAX_EXPOSURE_TIME);
+	double gainMin = gain->GetMin();
+	double gainMax = gain->GetMax();
+
+	// start stream
+	std::cout << TAB1 << "Start stream\n";
+
+	pDevice->StartStream();
+
+	// Run loop
+	//    The loop works on total exposure, the product of exposure time and
+	//    linear gain. Exposure time takes as much of it as its limit allows,
+	//    keeping noise down; gain covers the rest.
+	std::cout << TAB1 << "Steer image mean towards " << TARGET_MEAN << " over " << NUM_IMAGES << " images\n";
+
+	for (int i = 0; i < NUM_IMAGES; i++)
+	{
+		Arena::IImage* pImage = pDevice->GetImage(IMAGE_TIMEOUT);
+		double mean = Mean(pImage);
+		pDevice->RequeueBuffer(pImage);
+
+		double currentExposure = exposureTime.Get();
+		double currentGain = gain.Get();
+		double total = currentExposure * std::pow(10.0, currentGain / 20.0);
+		double ratio = TARGET_MEAN / std::max(mean, 1.0);
+		double wanted = total * (1.0 + LOOP_GAIN * (ratio - 1.0));
+
+		double nextExposure = std::max(exposureMin, std::min(exposureMax, wanted));
+		double nextGain = std::max(gainMin, std::min(gainMax, 20.0 * std::log10(wanted / nextExposure)));
+
+		exposureTime.Set(nextExposure);
+		gain.Set(nextGain);
+
+		if (i % 10 == 0 || i == NUM_IMAGES - 1)
+			std::cout << TAB2 << "Image " << i << ": mean " << static_cast<int>(mean) << ", exposure " << static_cast<int>(nextExposure) << " us, gain " << nextGain << " dB\n";
+	}
+
+	// stop stream
+	std::cout << TAB1 << "Stop stream\n";
+
+	pDevice->StopStream();
+
+	// restore initial settings
+	exposureTime.Set(exposureTimeInitial);
+	gain.Set(gainInitial);
+	Arena::SetNodeValue<GenICam::gcstring>(pNodeMap, "GainAuto", gainAutoInitial);
+	Arena::SetNodeValue<GenICam::gcstring>(pNodeMap, "ExposureAuto", exposureAutoInitial);
+	Arena::SetNodeValue<GenICam::gcstring>(pNodeMap, "PixelFormat", pixelFormatInitial);
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_Exposure_ClosedLoop\n";
+
+	try
+	{
+		// prepare example
+		Arena::ISystem* pSystem = Arena::OpenSystem();
+		pSystem->UpdateDevices(SYSTEM_TIMEOUT);
+		std::vector<Arena::DeviceInfo> deviceInfos = pSystem->GetDevices();
+		if (deviceInfos.size() == 0)
+		{
+			std::cout << "\nNo camera connected\nPress enter to complete\n";
+			std::getchar();
+			return 0;
+		}
+		Arena::IDevice* pDevice = pSystem->CreateDevice(deviceInfos[0]);
+
+		// run example
+		std::cout << "Commence example\n\n";
+		RunClosedLoop(pDevice);
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		pSystem->DestroyDevice(pDevice);
+		Arena::CloseSystem(pSystem);
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
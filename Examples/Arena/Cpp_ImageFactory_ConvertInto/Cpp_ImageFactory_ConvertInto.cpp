@@ -0,0 +1,416 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+#include "../../BayerBilinear.h"
+#include <vector>
+#include <chrono>
+#include <cstring>
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Image Factory: Convert Into
+//    This example demonstrates converting images into storage owned by the
+//    caller. Every call to Arena::ImageFactory::Convert allocates a new image
+//    that must later be destroyed; at hundreds of frames per second this
+//    allocation shows up in profiles and fragments memory over long runs.
+//    ConvertInto writes the converted pixels to a caller-provided buffer
+//    instead, and ConvertedImage keeps its storage from one conversion to the
+//    next, growing only when an image needs more room. Common conversions are
+//    written straight into the destination; any other conversion falls back to
+//    Arena::ImageFactory::Convert followed by a copy, which still allocates a
+//    temporary image on every call. That includes Bayer images demosaiced
+//    with the image factory's algorithms, the default DirectionalInterpolation
+//    among them: they have no direct path, so the default Bayer path is not
+//    allocation-free. Only the bilinear demosaic from BayerBilinear.h, which
+//    must be selected explicitly and gives different pixels, writes Bayer
+//    images straight into the destination.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// pixel format to convert to
+#define PIXEL_FORMAT BGR8
+
+// Bayer demosaic
+//    Set to BilinearDemosaic to demosaic BayerRG8 directly into the
+//    destination. FactoryDemosaic leaves Bayer images to the image factory,
+//    which falls back and allocates on every image.
+#define BAYER_DEMOSAIC FactoryDemosaic
+
+// Bayer algorithm
+//    Used by the image factory, both for FactoryDemosaic and for reference.
+#define BAYER_ALGORITHM Arena::DirectionalInterpolation
+
+// number of images to grab
+#define NUM_IMAGES 100
+
+// system timeout
+#define SYSTEM_TIMEOUT 100
+
+// image timeout
+#define IMAGE_TIMEOUT 2000
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- HELPER =-=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// conversion kernel
+//    Converts a tightly packed source image into a tightly packed destination.
+typedef void (*ConversionKernel)(const uint8_t* pSrc, uint8_t* pDst, size_t width, size_t height);
+
+// Bayer demosaic
+//    Bilinear interpolation is not one of the image factory's Bayer
+//    algorithms, so it is selected with its own value rather than an
+//    Arena::EBayerAlgorithm.
+enum BayerDemosaic
+{
+	FactoryDemosaic,
+	BilinearDemosaic
+};
+
+// demosaics BayerRG8 with the shared bilinear kernel
+static void BayerRG8ToBGR8(const uint8_t* pSrc, uint8_t* pDst, size_t width, size_t height)
+{
+	DemosaicBayerRG8(pSrc, pDst, width, height, 2, 0);
+}
+
+static void BayerRG8ToRGB8(const uint8_t* pSrc, uint8_t* pDst, size_t width, size_t height)
+{
+	DemosaicBayerRG8(pSrc, pDst, width, height, 0, 2);
+}
+
+// replicates Mono8 into all three channels
+static void Mono8ToColor8(const uint8_t* pSrc, uint8_t* pDst, size_t width, size_t height)
+{
+	for (size_t i = 0; i < width * height; i++, pDst += 3)
+	{
+		pDst[0] = pSrc[i];
+		pDst[1] = pSrc[i];
+		pDst[2] = pSrc[i];
+	}
+}
+
+// stores a little-endian Mono16 pixel
+//    Written byte by byte, so the caller's destination needs no particular
+//    alignment.
+static inline void StoreMono16(uint8_t* pDst, unsigned int value)
+{
+	pDst[0] = static_cast<uint8_t>(value);
+	pDst[1] = static_cast<uint8_t>(value >> 8);
+}
+
+// unpacks Mono12p to MSB-aligned Mono16
+//    Mono12p packs two pixels into three bytes, least significant bits first.
+static void Mono12pToMono16(const uint8_t* pSrc, uint8_t* pDst, size_t width, size_t height)
+{
+	size_t numPixels = width * height;
+
+	for (size_t i = 0; i < numPixels; i += 2)
+	{
+		const uint8_t* pGroup = pSrc + i / 2 * 3;
+
+		StoreMono16(pDst + i * 2, (pGroup[0] | (pGroup[1] & 0x0F) << 8) << 4);
+		if (i + 1 < numPixels)
+			StoreMono16(pDst + i * 2 + 2, ((pGroup[1] >> 4) | pGroup[2] << 4) << 4);
+	}
+}
+
+// Conversions written straight into the destination
+//    Demosaicing conversions are bilinear and only used with BilinearDemosaic.
+struct DirectConversion
+{
+	uint64_t srcPixelFormat;
+	uint64_t dstPixelFormat;
+	bool bilinear;
+	ConversionKernel kernel;
+};
+
+static const DirectConversion DirectConversions[] = {
+	{ BayerRG8, BGR8, true, BayerRG8ToBGR8 },
+	{ BayerRG8, RGB8, true, BayerRG8ToRGB8 },
+	{ Mono8, BGR8, false, Mono8ToColor8 },
+	{ Mono8, RGB8, false, Mono8ToColor8 },
+	{ Mono12p, Mono16, false, Mono12pToMono16 },
+};
+
+// gets the size of an image once converted
+size_t GetConvertedSize(Arena::IImage* pImage, uint64_t pixelFormat)
+{
+	return pImage->GetWidth() * pImage->GetHeight() * Arena::GetBitsPerPixel(pixelFormat) / 8;
+}
+
+// finds the kernel for a conversion
+//    Returns NULL if the conversion falls back to Arena::ImageFactory::Convert.
+//    Converting to the same pixel format is a plain copy and needs no kernel.
+ConversionKernel FindDirectConversion(Arena::IImage* pImage, uint64_t pixelFormat, BayerDemosaic demosaic)
+{
+	if (pImage->GetPaddingX() != 0 || pImage->GetWidth() < 2 || pImage->GetHeight() < 2)
+		return NULL;
+
+	for (size_t i = 0; i < sizeof(DirectConversions) / sizeof(DirectConversions[0]); i++)
+	{
+		if (DirectConversions[i].srcPixelFormat == pImage->GetPixelFormat() && DirectConversions[i].dstPixelFormat == pixelFormat &&
+			(!DirectConversions[i].bilinear || demosaic == BilinearDemosaic))
+			return DirectConversions[i].kernel;
+	}
+
+	return NULL;
+}
+
+// checks whether a conversion avoids allocation
+//    Bayer images are only direct with BilinearDemosaic; with FactoryDemosaic,
+//    the default, they always fall back and allocate.
+bool IsDirectConversion(Arena::IImage* pImage, uint64_t pixelFormat, BayerDemosaic demosaic = FactoryDemosaic)
+{
+	return (pImage->GetPixelFormat() == pixelFormat && pImage->GetPaddingX() == 0) || FindDirectConversion(pImage, pixelFormat, demosaic) != NULL;
+}
+
+// converts an image into caller-managed storage
+//    The destination must hold at least GetConvertedSize bytes. Direct
+//    conversions allocate nothing; the fallback allocates and destroys a
+//    temporary image inside the call, using the given Bayer algorithm.
+//    BilinearDemosaic has no fallback and throws for conversions without a
+//    direct path. Returns whether the conversion was direct.
+bool ConvertInto(Arena::IImage* pSrc, uint64_t pixelFormat, uint8_t* pDst, size_t dstSize, BayerDemosaic demosaic = FactoryDemosaic, Arena::EBayerAlgorithm bayerAlgorithm = Arena::DirectionalInterpolation)
+{
+	size_t size = GetConvertedSize(pSrc, pixelFormat);
+
+	if (!pDst || dstSize < size)
+		throw GenICam::GenericException("Destination too small for converted image", __FILE__, __LINE__);
+
+	if (pSrc->GetPixelFormat() == pixelFormat && pSrc->GetPaddingX() == 0)
+	{
+		memcpy(pDst, pSrc->GetData(), size);
+		return true;
+	}
+
+	ConversionKernel kernel = FindDirectConversion(pSrc, pixelFormat, demosaic);
+	if (kernel)
+	{
+		kernel(pSrc->GetData(), pDst, pSrc->GetWidth(), pSrc->GetHeight());
+		return true;
+	}
+
+	if (demosaic == BilinearDemosaic)
+		throw GenICam::GenericException("Bilinear demosaic is only available for direct conversions", __FILE__, __LINE__);
+
+	Arena::IImage* pConverted = Arena::ImageFactory::Convert(pSrc, pixelFormat, bayerAlgorithm);
+	memcpy(pDst, pConverted->GetData(), size);
+	Arena::ImageFactory::Destroy(pConverted);
+	return false;
+}
+
+// reusable converted image
+//    Keeps its storage between conversions and only reallocates when an image
+//    needs more room than any before it, so a stream of same-sized images
+//    allocates once. Fallback conversions still allocate a temporary image
+//    inside the image factory every time; they are counted separately.
+class ConvertedImage
+{
+public:
+	ConvertedImage() :
+		m_width(0),
+		m_height(0),
+		m_pixelFormat(0),
+		m_size(0),
+		m_numAllocations(0),
+		m_numFallbacks(0)
+	{
+	}
+
+	// converts an image, replacing the previous contents
+	void ConvertFrom(Arena::IImage* pSrc, uint64_t pixelFormat, BayerDemosaic demosaic = FactoryDemosaic, Arena::EBayerAlgorithm bayerAlgorithm = Arena::DirectionalInterpolation)
+	{
+		size_t size = GetConvertedSize(pSrc, pixelFormat);
+
+		if (m_data.size() < size)
+		{
+			m_data.resize(size);
+			m_numAllocations++;
+		}
+
+		if (!ConvertInto(pSrc, pixelFormat, m_data.data(), m_data.size(), demosaic, bayerAlgorithm))
+			m_numFallbacks++;
+
+		m_width = pSrc->GetWidth();
+		m_height = pSrc->GetHeight();
+		m_pixelFormat = pixelFormat;
+		m_size = size;
+	}
+
+	const uint8_t* GetData() const { return m_data.data(); }
+	size_t GetWidth() const { return m_width; }
+	size_t GetHeight() const { return m_height; }
+	uint64_t GetPixelFormat() const { return m_pixelFormat; }
+	size_t GetBitsPerPixel() const { return Arena::GetBitsPerPixel(m_pixelFormat); }
+	size_t GetSizeFilled() const { return m_size; }
+	size_t GetCapacity() const { return m_data.size(); }
+	size_t GetNumAllocations() const { return m_numAllocations; }
+	size_t GetNumFallbacks() const { return m_numFallbacks; }
+
+private:
+	std::vector<uint8_t> m_data;
+	size_t m_width;
+	size_t m_height;
+	uint64_t m_pixelFormat;
+	size_t m_size;
+	size_t m_numAllocations;
+	size_t m_numFallbacks;
+};
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// demonstrates converting into caller storage
+// (1) starts stream
+// (2) converts each image with Arena::ImageFactory::Convert
+// (3) converts each image into a preallocated buffer
+// (4) converts each image into a reusable image
+// (5) compares results and timings
+// (6) stops stream
+void ConvertIntoCallerStorage(Arena::IDevice* pDevice)
+{
+	// start stream
+	std::cout << TAB1 << "Start stream\n";
+
+	pDevice->StartStream();
+
+	std::vector<uint8_t> buffer;
+	ConvertedImage reusable;
+	std::chrono::duration<double, std::milli> factoryTime(0);
+	std::chrono::duration<double, std::milli> intoTime(0);
+	std::chrono::duration<double, std::milli> reusableTime(0);
+	size_t numDifferent = 0;
+
+	std::cout << TAB1 << "Convert " << NUM_IMAGES << " images to " << GetPixelFormatName(PIXEL_FORMAT) << "\n";
+
+	for (size_t i = 0; i < NUM_IMAGES; i++)
+	{
+		Arena::IImage* pImage = pDevice->GetImage(IMAGE_TIMEOUT);
+
+		if (i == 0)
+		{
+			std::cout << TAB2 << GetPixelFormatName(static_cast<PfncFormat>(pImage->GetPixelFormat())) << " to "
+					  << GetPixelFormatName(PIXEL_FORMAT) << " is "
+					  << (IsDirectConversion(pImage, PIXEL_FORMAT, BAYER_DEMOSAIC) ? "direct (no allocation)" : "a fallback (Arena::ImageFactory::Convert allocates a temporary image per call, then copy)") << "\n";
+		}
+
+		// Convert with Arena::ImageFactory::Convert
+		//    Allocates and destroys an image every time.
+		auto start = std::chrono::steady_clock::now();
+		Arena::IImage* pConverted = Arena::ImageFactory::Convert(pImage, PIXEL_FORMAT, BAYER_ALGORITHM);
+		factoryTime += std::chrono::steady_clock::now() - start;
+
+		// Convert into preallocated buffer
+		//    The buffer is sized once, from the first image.
+		size_t size = GetConvertedSize(pImage, PIXEL_FORMAT);
+		if (buffer.size() < size)
+			buffer.resize(size);
+
+		start = std::chrono::steady_clock::now();
+		ConvertInto(pImage, PIXEL_FORMAT, buffer.data(), buffer.size(), BAYER_DEMOSAIC, BAYER_ALGORITHM);
+		intoTime += std::chrono::steady_clock::now() - start;
+
+		// Convert into reusable image
+		start = std::chrono::steady_clock::now();
+		reusable.ConvertFrom(pImage, PIXEL_FORMAT, BAYER_DEMOSAIC, BAYER_ALGORITHM);
+		reusableTime += std::chrono::steady_clock::now() - start;
+
+		// Compare results
+		//    With FactoryDemosaic the results should match; the bilinear demosaic
+		//    is expected to differ from the reference.
+		if (memcmp(pConverted->GetData(), buffer.data(), size) != 0)
+			numDifferent++;
+
+		Arena::ImageFactory::Destroy(pConverted);
+		pDevice->RequeueBuffer(pImage);
+	}
+
+	std::cout << TAB2 << "Convert and destroy: " << factoryTime.count() / NUM_IMAGES << " ms per image\n";
+	std::cout << TAB2 << "Convert into buffer: " << intoTime.count() / NUM_IMAGES << " ms per image\n";
+	std::cout << TAB2 << "Convert into reusable image: " << reusableTime.count() / NUM_IMAGES << " ms per image ("
+			  << reusable.GetNumAllocations() << " allocation(s), " << reusable.GetCapacity() << " bytes)\n";
+	std::cout << TAB2 << reusable.GetNumFallbacks() << " of " << NUM_IMAGES << " images fell back and allocated a temporary image in Arena::ImageFactory::Convert\n";
+	std::cout << TAB2 << numDifferent << " of " << NUM_IMAGES << " images differ from Arena::ImageFactory::Convert\n";
+
+	// stop stream
+	std::cout << TAB1 << "Stop stream\n";
+
+	pDevice->StopStream();
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_ImageFactory_ConvertInto\n";
+
+	try
+	{
+		// prepare example
+		Arena::ISystem* pSystem = Arena::OpenSystem();
+		pSystem->UpdateDevices(SYSTEM_TIMEOUT);
+		std::vector<Arena::DeviceInfo> deviceInfos = pSystem->GetDevices();
+		if (deviceInfos.size() == 0)
+		{
+			std::cout << "\nNo camera connected\nPress enter to complete\n";
+			std::getchar();
+			return 0;
+		}
+		Arena::IDevice* pDevice = pSystem->CreateDevice(deviceInfos[0]);
+
+		// run example
+		std::cout << "Commence example\n\n";
+		ConvertIntoCallerStorage(pDevice);
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		pSystem->DestroyDevice(pDevice);
+		Arena::CloseSystem(pSystem);
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
@@ -0,0 +1,522 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+#include <vector>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <memory>
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Image Factory: Image Pool
+//    This example demonstrates recycling image memory through a pool. Every
+//    image created, copied or converted by Arena::ImageFactory is allocated on
+//    the heap and freed again by Arena::ImageFactory::Destroy; with identical
+//    geometry at thousands of conversions per second, this is pure allocator
+//    traffic. ImagePool keeps released memory in size classes (powers of two)
+//    and hands it back out to the next image of a similar size. Once the pool
+//    is warm, creating and copying images no longer allocates. Converting
+//    writes into pooled memory through a conversion function; the default
+//    copies the result of Arena::ImageFactory::Convert, which keeps the images
+//    held downstream out of the heap but still allocates a short-lived
+//    temporary inside the image factory. Such conversions are counted as
+//    misses, and reported separately as fallbacks, even when the pooled
+//    memory itself was reused. A conversion that writes straight into the
+//    destination, such as a direct conversion by ConvertInto from
+//    Cpp_ImageFactory_ConvertInto, removes that as well. The pool reports
+//    hits, misses, fallbacks and the bytes it holds, and can be trimmed to
+//    return unused memory to the system. Images may outlive their pool. A pool is
+//    thread-safe; to avoid lock contention between threads, create one pool
+//    per thread.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// pixel format to convert to
+#define PIXEL_FORMAT BGR8
+
+// number of images to grab
+#define NUM_IMAGES 200
+
+// number of converted images held at once
+//    Simulates downstream processing that keeps several images alive.
+#define NUM_IMAGES_HELD 4
+
+// statistics interval
+//    Pool statistics are printed every this many images.
+#define STATS_INTERVAL 50
+
+// system timeout
+#define SYSTEM_TIMEOUT 100
+
+// image timeout
+#define IMAGE_TIMEOUT 2000
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- HELPER =-=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// gets the size of an image once converted
+size_t GetConvertedSize(Arena::IImage* pImage, uint64_t pixelFormat)
+{
+	return pImage->GetWidth() * pImage->GetHeight() * Arena::GetBitsPerPixel(pixelFormat) / 8;
+}
+
+// Conversion into pooled memory
+//    Returns whether the conversion was direct, i.e. allocated nothing. Like
+//    ConvertInto in Cpp_ImageFactory_ConvertInto, whose direct conversions
+//    can be handed to a pool to write straight into pooled memory.
+typedef bool (*ConvertIntoFunction)(Arena::IImage* pSrc, uint64_t pixelFormat, uint8_t* pDst, size_t dstSize, Arena::EBayerAlgorithm bayerAlgorithm);
+
+// converts an image through the image factory
+//    Default conversion of a pool. Converting to the same pixel format is a
+//    plain copy; anything else is converted by Arena::ImageFactory::Convert and
+//    copied, so the image factory still allocates and destroys a temporary
+//    image inside the call.
+bool FactoryConvertInto(Arena::IImage* pSrc, uint64_t pixelFormat, uint8_t* pDst, size_t dstSize, Arena::EBayerAlgorithm bayerAlgorithm)
+{
+	size_t size = GetConvertedSize(pSrc, pixelFormat);
+
+	if (!pDst || dstSize < size)
+		throw GenICam::GenericException("Destination too small for converted image", __FILE__, __LINE__);
+
+	if (pSrc->GetPixelFormat() == pixelFormat && pSrc->GetPaddingX() == 0)
+	{
+		memcpy(pDst, pSrc->GetData(), size);
+		return true;
+	}
+
+	Arena::IImage* pConverted = Arena::ImageFactory::Convert(pSrc, pixelFormat, bayerAlgorithm);
+	memcpy(pDst, pConverted->GetData(), size);
+	Arena::ImageFactory::Destroy(pConverted);
+	return false;
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =-=-=- POOL =-=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// pool statistics
+struct ImagePoolStats
+{
+	// allocations served from the pool without allocating anywhere else
+	uint64_t hits;
+
+	// allocations that went to the heap, including fallbacks
+	uint64_t misses;
+
+	// conversions that allocated a temporary image in the image factory
+	//    Counted as misses as well, whether or not the pooled memory was
+	//    reused.
+	uint64_t fallbacks;
+
+	// bytes currently held by the pool and not in use
+	size_t bytesHeld;
+
+	// bytes currently in use by images
+	size_t bytesInUse;
+};
+
+// Pool memory
+//    Shared by a pool and every image taken from it, so images may outlive
+//    their pool. Blocks released after the pool is gone are held until the
+//    last image is destroyed, which frees them all.
+struct ImagePoolBlocks
+{
+	ImagePoolBlocks()
+	{
+		memset(&stats, 0, sizeof(stats));
+	}
+
+	~ImagePoolBlocks()
+	{
+		for (auto& sizeClass : freeBlocks)
+		{
+			for (uint8_t* pBlock : sizeClass.second)
+				free(pBlock);
+		}
+	}
+
+	void Release(uint8_t* pData, size_t sizeClass)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		freeBlocks[sizeClass].push_back(pData);
+		stats.bytesInUse -= sizeClass;
+		stats.bytesHeld += sizeClass;
+	}
+
+	std::mutex mutex;
+	std::map<size_t, std::vector<uint8_t*>> freeBlocks;
+	ImagePoolStats stats;
+};
+
+// pooled image
+//    Image whose memory belongs to a pool. The memory returns to the pool when
+//    the image is destroyed, so pooled images are moved rather than copied.
+class PooledImage
+{
+public:
+	PooledImage() :
+		m_pData(NULL),
+		m_capacity(0),
+		m_width(0),
+		m_height(0),
+		m_pixelFormat(0),
+		m_size(0)
+	{
+	}
+
+	PooledImage(PooledImage&& other) :
+		PooledImage()
+	{
+		Swap(other);
+	}
+
+	PooledImage& operator=(PooledImage&& other)
+	{
+		if (this != &other)
+		{
+			Reset();
+			Swap(other);
+		}
+		return *this;
+	}
+
+	PooledImage(const PooledImage&) = delete;
+	PooledImage& operator=(const PooledImage&) = delete;
+
+	~PooledImage()
+	{
+		Reset();
+	}
+
+	// returns memory to pool
+	void Reset()
+	{
+		if (m_pBlocks)
+			m_pBlocks->Release(m_pData, m_capacity);
+
+		m_pBlocks.reset();
+		m_pData = NULL;
+		m_capacity = 0;
+		m_size = 0;
+	}
+
+	bool IsValid() const { return m_pData != NULL; }
+	const uint8_t* GetData() const { return m_pData; }
+	size_t GetWidth() const { return m_width; }
+	size_t GetHeight() const { return m_height; }
+	uint64_t GetPixelFormat() const { return m_pixelFormat; }
+	size_t GetBitsPerPixel() const { return Arena::GetBitsPerPixel(m_pixelFormat); }
+	size_t GetSizeFilled() const { return m_size; }
+
+private:
+	friend class ImagePool;
+
+	void Swap(PooledImage& other)
+	{
+		std::swap(m_pBlocks, other.m_pBlocks);
+		std::swap(m_pData, other.m_pData);
+		std::swap(m_capacity, other.m_capacity);
+		std::swap(m_width, other.m_width);
+		std::swap(m_height, other.m_height);
+		std::swap(m_pixelFormat, other.m_pixelFormat);
+		std::swap(m_size, other.m_size);
+	}
+
+	std::shared_ptr<ImagePoolBlocks> m_pBlocks;
+	uint8_t* m_pData;
+	size_t m_capacity;
+	size_t m_width;
+	size_t m_height;
+	uint64_t m_pixelFormat;
+	size_t m_size;
+};
+
+// image pool
+//    Drop-in for the image factory's Create, Copy and Convert, returning
+//    pooled images instead of images to destroy.
+class ImagePool
+{
+public:
+	ImagePool(ConvertIntoFunction convertInto = FactoryConvertInto) :
+		m_pBlocks(std::make_shared<ImagePoolBlocks>()),
+		m_convertInto(convertInto)
+	{
+	}
+
+	// creates an image from raw data
+	PooledImage Create(const uint8_t* pData, size_t dataSize, size_t width, size_t height, uint64_t pixelFormat)
+	{
+		bool reused = false;
+		PooledImage image = Allocate(dataSize, width, height, pixelFormat, reused);
+		memcpy(image.m_pData, pData, dataSize);
+		Count(reused, false);
+		return image;
+	}
+
+	// copies an image
+	PooledImage Copy(Arena::IImage* pImage)
+	{
+		return Create(pImage->GetData(), pImage->GetSizeFilled(), pImage->GetWidth(), pImage->GetHeight(), pImage->GetPixelFormat());
+	}
+
+	// converts an image
+	PooledImage Convert(Arena::IImage* pImage, uint64_t pixelFormat, Arena::EBayerAlgorithm bayerAlgorithm = Arena::DirectionalInterpolation)
+	{
+		size_t size = GetConvertedSize(pImage, pixelFormat);
+		bool reused = false;
+		PooledImage image = Allocate(size, pImage->GetWidth(), pImage->GetHeight(), pixelFormat, reused);
+		bool direct = m_convertInto(pImage, pixelFormat, image.m_pData, image.m_capacity, bayerAlgorithm);
+		Count(reused, !direct);
+		return image;
+	}
+
+	// gets statistics
+	ImagePoolStats GetStats()
+	{
+		std::lock_guard<std::mutex> lock(m_pBlocks->mutex);
+		return m_pBlocks->stats;
+	}
+
+	// returns unused memory to the system
+	//    Frees held blocks, largest first, until at most maxBytesHeld remain.
+	void Trim(size_t maxBytesHeld)
+	{
+		std::lock_guard<std::mutex> lock(m_pBlocks->mutex);
+		ImagePoolStats& stats = m_pBlocks->stats;
+
+		for (auto it = m_pBlocks->freeBlocks.rbegin(); it != m_pBlocks->freeBlocks.rend() && stats.bytesHeld > maxBytesHeld; ++it)
+		{
+			std::vector<uint8_t*>& blocks = it->second;
+			while (!blocks.empty() && stats.bytesHeld > maxBytesHeld)
+			{
+				free(blocks.back());
+				blocks.pop_back();
+				stats.bytesHeld -= it->first;
+			}
+		}
+	}
+
+private:
+	// minimum size class
+	//    Smaller requests are rounded up to this size.
+	static const size_t MIN_SIZE_CLASS = 4096;
+
+	static size_t GetSizeClass(size_t size)
+	{
+		size_t sizeClass = MIN_SIZE_CLASS;
+		while (sizeClass < size)
+			sizeClass *= 2;
+		return sizeClass;
+	}
+
+	// counts an allocation as hit or miss
+	//    Only a reused block without a fallback conversion is a hit.
+	void Count(bool reused, bool fallback)
+	{
+		std::lock_guard<std::mutex> lock(m_pBlocks->mutex);
+
+		if (reused && !fallback)
+			m_pBlocks->stats.hits++;
+		else
+			m_pBlocks->stats.misses++;
+
+		if (fallback)
+			m_pBlocks->stats.fallbacks++;
+	}
+
+	// takes a block from the pool, or from the heap if none is free
+	//    Sets reused if the block came from the pool.
+	PooledImage Allocate(size_t size, size_t width, size_t height, uint64_t pixelFormat, bool& reused)
+	{
+		size_t sizeClass = GetSizeClass(size);
+		uint8_t* pData = NULL;
+		{
+			std::lock_guard<std::mutex> lock(m_pBlocks->mutex);
+
+			std::vector<uint8_t*>& blocks = m_pBlocks->freeBlocks[sizeClass];
+			if (!blocks.empty())
+			{
+				pData = blocks.back();
+				blocks.pop_back();
+				m_pBlocks->stats.bytesHeld -= sizeClass;
+			}
+			m_pBlocks->stats.bytesInUse += sizeClass;
+		}
+		reused = pData != NULL;
+
+		if (!pData)
+		{
+			pData = static_cast<uint8_t*>(malloc(sizeClass));
+			if (!pData)
+			{
+				std::lock_guard<std::mutex> lock(m_pBlocks->mutex);
+				m_pBlocks->stats.bytesInUse -= sizeClass;
+				throw GenICam::GenericException("Failed to allocate pooled image", __FILE__, __LINE__);
+			}
+		}
+
+		PooledImage image;
+		image.m_pBlocks = m_pBlocks;
+		image.m_pData = pData;
+		image.m_capacity = sizeClass;
+		image.m_width = width;
+		image.m_height = height;
+		image.m_pixelFormat = pixelFormat;
+		image.m_size = size;
+		return image;
+	}
+
+	std::shared_ptr<ImagePoolBlocks> m_pBlocks;
+	ConvertIntoFunction m_convertInto;
+};
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// prints pool statistics
+void PrintStats(const char* label, ImagePool& pool)
+{
+	ImagePoolStats stats = pool.GetStats();
+
+	std::cout << TAB2 << label << ": " << stats.hits << " hits, " << stats.misses << " misses ("
+			  << stats.fallbacks << " image factory fallbacks), " << stats.bytesHeld << " bytes held, " << stats.bytesInUse << " bytes in use\n";
+}
+
+// demonstrates pooled conversion
+// (1) starts stream
+// (2) converts images through pool while holding several at once
+// (3) prints statistics as pool warms up
+// (4) releases held images and trims pool
+// (5) stops stream
+void ConvertThroughPool(Arena::IDevice* pDevice)
+{
+	ImagePool pool;
+
+	// start stream
+	std::cout << TAB1 << "Start stream\n";
+
+	pDevice->StartStream();
+
+	// convert images through pool
+	//    The first NUM_IMAGES_HELD + 1 conversions miss; from then on, every
+	//    conversion reuses memory released by an image that was dropped. With
+	//    the default conversion, anything but a plain copy falls back to
+	//    Arena::ImageFactory::Convert and keeps counting as a miss.
+	std::cout << TAB1 << "Convert " << NUM_IMAGES << " images to " << GetPixelFormatName(PIXEL_FORMAT) << " through pool\n";
+
+	std::deque<PooledImage> held;
+
+	for (size_t i = 1; i <= NUM_IMAGES; i++)
+	{
+		Arena::IImage* pImage = pDevice->GetImage(IMAGE_TIMEOUT);
+
+		held.push_back(pool.Convert(pImage, PIXEL_FORMAT));
+		pDevice->RequeueBuffer(pImage);
+
+		if (held.size() > NUM_IMAGES_HELD)
+			held.pop_front();
+
+		if (i % STATS_INTERVAL == 0)
+		{
+			std::string label = "After " + std::to_string(i) + " images";
+			PrintStats(label.c_str(), pool);
+		}
+	}
+
+	// release held images and trim pool
+	std::cout << TAB1 << "Release held images and trim pool\n";
+
+	held.clear();
+	PrintStats("Before trim", pool);
+
+	pool.Trim(0);
+	PrintStats("After trim", pool);
+
+	// stop stream
+	std::cout << TAB1 << "Stop stream\n";
+
+	pDevice->StopStream();
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_ImageFactory_ImagePool\n";
+
+	try
+	{
+		// prepare example
+		Arena::ISystem* pSystem = Arena::OpenSystem();
+		pSystem->UpdateDevices(SYSTEM_TIMEOUT);
+		std::vector<Arena::DeviceInfo> deviceInfos = pSystem->GetDevices();
+		if (deviceInfos.size() == 0)
+		{
+			std::cout << "\nNo camera connected\nPress enter to complete\n";
+			std::getchar();
+			return 0;
+		}
+		Arena::IDevice* pDevice = pSystem->CreateDevice(deviceInfos[0]);
+
+		// run example
+		std::cout << "Commence example\n\n";
+		ConvertThroughPool(pDevice);
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		pSystem->DestroyDevice(pDevice);
+		Arena::CloseSystem(pSystem);
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
@@ -0,0 +1,607 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+#include "../../BayerBilinear.h"
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define HAS_NEON_KERNELS
+#include <arm_neon.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Image Factory: NEON Kernels
+//    This example demonstrates hand-vectorized kernels for the pixel formats
+//    that dominate ARM pipelines: BayerRG8 to BGR8 by bilinear demosaic,
+//    Mono12p to Mono16, and YUV422_8_UYVY to RGB8. Each kernel has a scalar
+//    and a NEON version that produce bit-identical output. The path is
+//    selected once at runtime from the CPU's hardware capabilities, falls
+//    back to scalar where NEON is unavailable, and can be queried. Only the
+//    bilinear demosaic is vectorized for Bayer images: the image factory's
+//    own algorithms, including the default DirectionalInterpolation, have no
+//    kernel here and still run in Arena::ImageFactory::Convert. The example
+//    times each path on a synthetic 20 MP frame, checks that NEON and scalar
+//    agree, and compares the results to Arena::ImageFactory::Convert.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// image width
+//    Must be even; Bayer tiles and YUV422 pixel pairs are two pixels wide.
+#define WIDTH 5472
+
+// image height
+#define HEIGHT 3648
+
+// number of conversions to time per path
+#define NUM_ITERATIONS 10
+
+// force scalar kernels
+//    Disables runtime selection of the NEON kernels, e.g. to compare both
+//    paths in a running pipeline.
+#define FORCE_SCALAR false
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- KERNELS -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// conversion kernel
+//    Converts a tightly packed source image into a tightly packed destination
+//    large enough for the destination pixel format.
+typedef void (*ConversionKernel)(const uint8_t* pSrc, uint8_t* pDst, size_t width, size_t height);
+
+// unpacks Mono12p pixels [begin, end) to MSB-aligned Mono16
+//    Mono12p packs two pixels into three bytes, least significant bits first.
+//    Begin must be even so that it falls on a three byte group.
+static void UnpackMono12pSpan(const uint8_t* pSrc, uint16_t* pDst, size_t begin, size_t end)
+{
+	for (size_t i = begin; i < end; i += 2)
+	{
+		const uint8_t* pGroup = pSrc + i / 2 * 3;
+
+		pDst[i] = static_cast<uint16_t>((pGroup[0] | (pGroup[1] & 0x0F) << 8) << 4);
+		if (i + 1 < end)
+			pDst[i + 1] = static_cast<uint16_t>(((pGroup[1] >> 4) | pGroup[2] << 4) << 4);
+	}
+}
+
+// BT.601 coefficients in Q6 fixed point
+//    R = Y + 1.402 V, G = Y - 0.344 U - 0.714 V, B = Y + 1.772 U, with U and V
+//    centred on 128. Q6 keeps every intermediate within a signed 16-bit lane.
+#define YUV_RV 90
+#define YUV_GU -22
+#define YUV_GV -46
+#define YUV_BU 113
+
+static inline uint8_t ClampQ6(int value)
+{
+	value += 32;
+	if (value < 0)
+		return 0;
+	value >>= 6;
+	return static_cast<uint8_t>(value > 255 ? 255 : value);
+}
+
+// converts YUV422_8_UYVY pixel pairs [begin, end) to RGB8
+//    Every pair of pixels is stored as U Y0 V Y1 and shares its chroma.
+static void ConvertUYVYSpan(const uint8_t* pSrc, uint8_t* pDst, size_t begin, size_t end)
+{
+	for (size_t i = begin; i < end; i += 2)
+	{
+		const uint8_t* pPair = pSrc + i * 2;
+		int u = pPair[0] - 128;
+		int v = pPair[2] - 128;
+		int rTerm = YUV_RV * v;
+		int gTerm = YUV_GU * u + YUV_GV * v;
+		int bTerm = YUV_BU * u;
+
+		for (size_t j = 0; j < 2; j++)
+		{
+			int y = pPair[1 + 2 * j] << 6;
+			uint8_t* pPixel = pDst + (i + j) * 3;
+
+			pPixel[0] = ClampQ6(y + rTerm);
+			pPixel[1] = ClampQ6(y + gTerm);
+			pPixel[2] = ClampQ6(y + bTerm);
+		}
+	}
+}
+
+// scalar kernels
+static void BayerRG8ToBGR8Scalar(const uint8_t* pSrc, uint8_t* pDst, size_t width, size_t height)
+{
+	DemosaicBayerRG8(pSrc, pDst, width, height, 2, 0);
+}
+
+static void Mono12pToMono16Scalar(const uint8_t* pSrc, uint8_t* pDst, size_t width, size_t height)
+{
+	UnpackMono12pSpan(pSrc, reinterpret_cast<uint16_t*>(pDst), 0, width * height);
+}
+
+static void YUV422UYVYToRGB8Scalar(const uint8_t* pSrc, uint8_t* pDst, size_t width, size_t height)
+{
+	ConvertUYVYSpan(pSrc, pDst, 0, width * height);
+}
+
+#ifdef HAS_NEON_KERNELS
+
+// rounded average of four vectors
+//    Rounds like BilinearAverage4; two vectors use vrhaddq_u8, which rounds
+//    like BilinearAverage2.
+static inline uint8x16_t Average4(uint8x16_t a, uint8x16_t b, uint8x16_t c, uint8x16_t d)
+{
+	uint16x8_t low = vaddq_u16(vaddl_u8(vget_low_u8(a), vget_low_u8(b)), vaddl_u8(vget_low_u8(c), vget_low_u8(d)));
+	uint16x8_t high = vaddq_u16(vaddl_u8(vget_high_u8(a), vget_high_u8(b)), vaddl_u8(vget_high_u8(c), vget_high_u8(d)));
+
+	return vcombine_u8(vrshrn_n_u16(low, 2), vrshrn_n_u16(high, 2));
+}
+
+// NEON kernels
+//    The demosaic deinterleaves 32 pixels of each row into even and odd
+//    columns (vld2q) at offsets -2, 0 and +2, so every neighbour is a whole
+//    vector. The first two columns and the remainder of each row go through
+//    the scalar span from BayerBilinear.h, which also handles the mirrored
+//    borders and whose rounding the vector averages match.
+static void BayerRG8ToBGR8Neon(const uint8_t* pSrc, uint8_t* pDst, size_t width, size_t height)
+{
+	for (size_t y = 0; y < height; y++)
+	{
+		const uint8_t* pRow = pSrc + y * width;
+		const uint8_t* pUp;
+		const uint8_t* pDown;
+		uint8_t* pDstRow = pDst + y * width * 3;
+		bool redRow = (y % 2) == 0;
+
+		GetBayerRG8Neighbours(pSrc, width, height, y, &pUp, &pDown);
+
+		size_t x = 2;
+		DemosaicBayerRG8Span(pUp, pRow, pDown, redRow, width, 0, x < width ? x : width, 2, 0, pDstRow);
+
+		for (; x + 34 <= width; x += 32)
+		{
+			uint8x16x2_t cm = vld2q_u8(pRow + x - 2);
+			uint8x16x2_t c0 = vld2q_u8(pRow + x);
+			uint8x16x2_t cp = vld2q_u8(pRow + x + 2);
+			uint8x16x2_t um = vld2q_u8(pUp + x - 2);
+			uint8x16x2_t u0 = vld2q_u8(pUp + x);
+			uint8x16x2_t up = vld2q_u8(pUp + x + 2);
+			uint8x16x2_t dm = vld2q_u8(pDown + x - 2);
+			uint8x16x2_t d0 = vld2q_u8(pDown + x);
+			uint8x16x2_t dp = vld2q_u8(pDown + x + 2);
+
+			// even columns are val[0], odd columns val[1]
+			uint8x16_t rEven, gEven, bEven, rOdd, gOdd, bOdd;
+
+			if (redRow)
+			{
+				rEven = c0.val[0];
+				gEven = Average4(cm.val[1], c0.val[1], u0.val[0], d0.val[0]);
+				bEven = Average4(um.val[1], u0.val[1], dm.val[1], d0.val[1]);
+				gOdd = c0.val[1];
+				rOdd = vrhaddq_u8(c0.val[0], cp.val[0]);
+				bOdd = vrhaddq_u8(u0.val[1], d0.val[1]);
+			}
+			else
+			{
+				gEven = c0.val[0];
+				rEven = vrhaddq_u8(u0.val[0], d0.val[0]);
+				bEven = vrhaddq_u8(cm.val[1], c0.val[1]);
+				bOdd = c0.val[1];
+				gOdd = Average4(c0.val[0], cp.val[0], u0.val[1], d0.val[1]);
+				rOdd = Average4(u0.val[0], up.val[0], d0.val[0], dp.val[0]);
+			}
+
+			uint8x16x2_t b = vzipq_u8(bEven, bOdd);
+			uint8x16x2_t g = vzipq_u8(gEven, gOdd);
+			uint8x16x2_t r = vzipq_u8(rEven, rOdd);
+			uint8x16x3_t low = { { b.val[0], g.val[0], r.val[0] } };
+			uint8x16x3_t high = { { b.val[1], g.val[1], r.val[1] } };
+
+			vst3q_u8(pDstRow + x * 3, low);
+			vst3q_u8(pDstRow + (x + 16) * 3, high);
+		}
+
+		if (x < width)
+			DemosaicBayerRG8Span(pUp, pRow, pDown, redRow, width, x, width, 2, 0, pDstRow);
+	}
+}
+
+static void Mono12pToMono16Neon(const uint8_t* pSrc, uint8_t* pDst, size_t width, size_t height)
+{
+	uint16_t* pDst16 = reinterpret_cast<uint16_t*>(pDst);
+	size_t numPixels = width * height;
+	size_t i = 0;
+
+	for (; i + 16 <= numPixels; i += 16)
+	{
+		uint8x8x3_t groups = vld3_u8(pSrc + i / 2 * 3);
+		uint16x8_t b0 = vmovl_u8(groups.val[0]);
+		uint16x8_t b1 = vmovl_u8(groups.val[1]);
+		uint16x8_t b2 = vmovl_u8(groups.val[2]);
+		uint16x8_t p0 = vorrq_u16(b0, vshlq_n_u16(vandq_u16(b1, vdupq_n_u16(0x0F)), 8));
+		uint16x8_t p1 = vorrq_u16(vshrq_n_u16(b1, 4), vshlq_n_u16(b2, 4));
+		uint16x8x2_t pixels = { { vshlq_n_u16(p0, 4), vshlq_n_u16(p1, 4) } };
+
+		vst2q_u16(pDst16 + i, pixels);
+	}
+
+	UnpackMono12pSpan(pSrc, pDst16, i, numPixels);
+}
+
+static void YUV422UYVYToRGB8Neon(const uint8_t* pSrc, uint8_t* pDst, size_t width, size_t height)
+{
+	size_t numPixels = width * height;
+	size_t i = 0;
+
+	for (; i + 16 <= numPixels; i += 16)
+	{
+		uint8x8x4_t uyvy = vld4_u8(pSrc + i * 2);
+		int16x8_t u = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(uyvy.val[0])), vdupq_n_s16(128));
+		int16x8_t v = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(uyvy.val[2])), vdupq_n_s16(128));
+		int16x8_t y0 = vreinterpretq_s16_u16(vshll_n_u8(uyvy.val[1], 6));
+		int16x8_t y1 = vreinterpretq_s16_u16(vshll_n_u8(uyvy.val[3], 6));
+		int16x8_t rTerm = vmulq_n_s16(v, YUV_RV);
+		int16x8_t gTerm = vmlaq_n_s16(vmulq_n_s16(u, YUV_GU), v, YUV_GV);
+		int16x8_t bTerm = vmulq_n_s16(u, YUV_BU);
+
+		uint8x8x2_t r = vzip_u8(vqrshrun_n_s16(vaddq_s16(y0, rTerm), 6), vqrshrun_n_s16(vaddq_s16(y1, rTerm), 6));
+		uint8x8x2_t g = vzip_u8(vqrshrun_n_s16(vaddq_s16(y0, gTerm), 6), vqrshrun_n_s16(vaddq_s16(y1, gTerm), 6));
+		uint8x8x2_t b = vzip_u8(vqrshrun_n_s16(vaddq_s16(y0, bTerm), 6), vqrshrun_n_s16(vaddq_s16(y1, bTerm), 6));
+		uint8x16x3_t rgb = { { vcombine_u8(r.val[0], r.val[1]), vcombine_u8(g.val[0], g.val[1]), vcombine_u8(b.val[0], b.val[1]) } };
+
+		vst3q_u8(pDst + i * 3, rgb);
+	}
+
+	ConvertUYVYSpan(pSrc, pDst, i, numPixels);
+}
+
+#endif // HAS_NEON_KERNELS
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- DISPATCH =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// set of kernels for one instruction set
+struct ConversionPath
+{
+	const char* name;
+	ConversionKernel bayerRG8ToBGR8;
+	ConversionKernel mono12pToMono16;
+	ConversionKernel yuv422UYVYToRGB8;
+};
+
+static const ConversionPath ScalarPath = { "Scalar", BayerRG8ToBGR8Scalar, Mono12pToMono16Scalar, YUV422UYVYToRGB8Scalar };
+
+#ifdef HAS_NEON_KERNELS
+static const ConversionPath NeonPath = { "NEON", BayerRG8ToBGR8Neon, Mono12pToMono16Neon, YUV422UYVYToRGB8Neon };
+#endif
+
+// checks whether the CPU running the example supports NEON
+//    Compiling with NEON enabled is not enough on 32-bit ARM, where the same
+//    binary may run on cores without it. AArch64 always has Advanced SIMD,
+//    but it is checked the same way for consistency.
+bool IsNeonSupported()
+{
+#if defined(HAS_NEON_KERNELS) && defined(__linux__)
+#if defined(__aarch64__)
+	return (getauxval(AT_HWCAP) & HWCAP_ASIMD) != 0;
+#else
+	return (getauxval(AT_HWCAP) & HWCAP_NEON) != 0;
+#endif
+#elif defined(HAS_NEON_KERNELS)
+	return true;
+#else
+	return false;
+#endif
+}
+
+// selects the fastest supported path
+const ConversionPath* SelectConversionPath()
+{
+#ifdef HAS_NEON_KERNELS
+	if (!FORCE_SCALAR && IsNeonSupported())
+		return &NeonPath;
+#endif
+
+	return &ScalarPath;
+}
+
+// gets the conversion path in use
+//    Selected on first use and kept for the lifetime of the process.
+const ConversionPath& ActiveConversionPath()
+{
+	static const ConversionPath* pPath = SelectConversionPath();
+
+	return *pPath;
+}
+
+// looks up the kernel for a conversion
+//    Returns NULL for conversions without a kernel.
+ConversionKernel FindKernel(const ConversionPath& path, uint64_t srcPixelFormat, uint64_t dstPixelFormat)
+{
+	if (srcPixelFormat == BayerRG8 && dstPixelFormat == BGR8)
+		return path.bayerRG8ToBGR8;
+	if (srcPixelFormat == Mono12p && dstPixelFormat == Mono16)
+		return path.mono12pToMono16;
+	if (srcPixelFormat == YUV422_8_UYVY && dstPixelFormat == RGB8)
+		return path.yuv422UYVYToRGB8;
+
+	return NULL;
+}
+
+// runs a kernel on an image
+//    The image factory only creates images by copying from memory it is
+//    given, so one copy into the returned image is unavoidable; keeping the
+//    scratch buffer per thread at least avoids allocating and releasing a
+//    full frame on every call. Conversions into memory the caller owns,
+//    without the copy, are shown in Cpp_ImageFactory_ConvertInto.
+Arena::IImage* ConvertWithKernel(ConversionKernel kernel, Arena::IImage* pImage, uint64_t pixelFormat)
+{
+	size_t width = pImage->GetWidth();
+	size_t height = pImage->GetHeight();
+	static thread_local std::vector<uint8_t> scratch;
+
+	scratch.resize(width * height * Arena::GetBitsPerPixel(pixelFormat) / 8);
+	kernel(pImage->GetData(), scratch.data(), width, height);
+
+	return Arena::ImageFactory::Create(scratch.data(), scratch.size(), width, height, pixelFormat);
+}
+
+// converts an image
+//    Drop-in replacement for Arena::ImageFactory::Convert. Mono12p and
+//    YUV422_8_UYVY conversions with a kernel run on the active path. Bayer
+//    images, images with padding or an unsupported size, and every other
+//    conversion are left to the image factory, so existing calls keep their
+//    Bayer algorithm. Either way, the result must be destroyed with
+//    Arena::ImageFactory::Destroy.
+Arena::IImage* Convert(Arena::IImage* pImage, uint64_t pixelFormat, Arena::EBayerAlgorithm bayerAlgorithm = Arena::DirectionalInterpolation)
+{
+	uint64_t srcPixelFormat = pImage->GetPixelFormat();
+	ConversionKernel kernel = FindKernel(ActiveConversionPath(), srcPixelFormat, pixelFormat);
+	size_t width = pImage->GetWidth();
+	size_t height = pImage->GetHeight();
+
+	if (!kernel || srcPixelFormat == BayerRG8 || pImage->GetPaddingX() != 0 || width < 2 || height < 2 || width % 2 != 0)
+		return Arena::ImageFactory::Convert(pImage, pixelFormat, bayerAlgorithm);
+
+	return ConvertWithKernel(kernel, pImage, pixelFormat);
+}
+
+// demosaics an image by bilinear interpolation
+//    Bilinear interpolation is not one of the image factory's Bayer
+//    algorithms, so it is requested through its own function rather than an
+//    Arena::EBayerAlgorithm value. Limited to unpadded BayerRG8 images of
+//    even width to BGR8; the result must be destroyed with
+//    Arena::ImageFactory::Destroy.
+Arena::IImage* ConvertBilinear(Arena::IImage* pImage)
+{
+	size_t width = pImage->GetWidth();
+	size_t height = pImage->GetHeight();
+
+	if (pImage->GetPixelFormat() != BayerRG8 || pImage->GetPaddingX() != 0 || width < 2 || height < 2 || width % 2 != 0)
+		throw GenICam::GenericException("Bilinear interpolation only converts unpadded BayerRG8 images of even width to BGR8", __FILE__, __LINE__);
+
+	return ConvertWithKernel(ActiveConversionPath().bayerRG8ToBGR8, pImage, BGR8);
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// fills a buffer with reproducible pseudo-random data
+void FillSynthetic(std::vector<uint8_t>& data)
+{
+	uint32_t state = 0x12345678;
+
+	for (size_t i = 0; i < data.size(); i++)
+	{
+		state = state * 1664525 + 1013904223;
+		data[i] = static_cast<uint8_t>(state >> 24);
+	}
+}
+
+// times a kernel
+//    Returns the average milliseconds per conversion.
+double TimeKernel(ConversionKernel kernel, const std::vector<uint8_t>& src, std::vector<uint8_t>& dst)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	for (size_t i = 0; i < NUM_ITERATIONS; i++)
+		kernel(src.data(), dst.data(), WIDTH, HEIGHT);
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / NUM_ITERATIONS;
+}
+
+// times and checks one conversion
+// (1) prepares synthetic source image
+// (2) times scalar kernel
+// (3) times NEON kernel and compares to scalar
+// (4) times Arena::ImageFactory::Convert and compares to active path
+void BenchmarkConversion(uint64_t srcPixelFormat, uint64_t dstPixelFormat)
+{
+	std::cout << TAB1 << GetPixelFormatName(static_cast<PfncFormat>(srcPixelFormat)) << " to "
+			  << GetPixelFormatName(static_cast<PfncFormat>(dstPixelFormat)) << "\n";
+
+	// Prepare synthetic source image
+	//    A 20 MP frame of noise exercises every branch of every kernel and
+	//    does not fit in cache, like a frame fresh off the wire.
+	std::vector<uint8_t> src(static_cast<size_t>(WIDTH) * HEIGHT * Arena::GetBitsPerPixel(srcPixelFormat) / 8);
+	size_t dstSize = static_cast<size_t>(WIDTH) * HEIGHT * Arena::GetBitsPerPixel(dstPixelFormat) / 8;
+	std::vector<uint8_t> scalar(dstSize);
+	FillSynthetic(src);
+
+	// Time scalar kernel
+	double scalarMs = TimeKernel(FindKernel(ScalarPath, srcPixelFormat, dstPixelFormat), src, scalar);
+
+	std::cout << TAB2 << "Scalar:       " << scalarMs << " ms (" << 1000.0 / scalarMs << " fps)\n";
+
+	// Time NEON kernel
+	//    The vector kernel must reproduce the scalar kernel exactly, including
+	//    rounding and borders.
+#ifdef HAS_NEON_KERNELS
+	if (IsNeonSupported())
+	{
+		std::vector<uint8_t> neon(dstSize);
+		double neonMs = TimeKernel(FindKernel(NeonPath, srcPixelFormat, dstPixelFormat), src, neon);
+		bool identical = std::memcmp(scalar.data(), neon.data(), dstSize) == 0;
+
+		std::cout << TAB2 << "NEON:         " << neonMs << " ms (" << 1000.0 / neonMs << " fps, "
+				  << scalarMs / neonMs << "x, " << (identical ? "identical to scalar" : "DIFFERS FROM SCALAR") << ")\n";
+	}
+	else
+#endif
+	{
+		std::cout << TAB2 << "NEON:         not supported\n";
+	}
+
+	// Time Arena::ImageFactory::Convert
+	//    Differences to the image factory come from its own rounding and
+	//    border handling and, for Bayer images, from its own demosaic
+	//    algorithm (DirectionalInterpolation). They are reported for
+	//    reference only.
+	Arena::IImage* pSrcImage = Arena::ImageFactory::Create(src.data(), src.size(), WIDTH, HEIGHT, srcPixelFormat);
+
+	try
+	{
+		Arena::IImage* pConverted = NULL;
+		auto start = std::chrono::steady_clock::now();
+
+		for (size_t i = 0; i < NUM_ITERATIONS; i++)
+		{
+			if (pConverted)
+				Arena::ImageFactory::Destroy(pConverted);
+			pConverted = Arena::ImageFactory::Convert(pSrcImage, dstPixelFormat);
+		}
+
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		double factoryMs = elapsed.count() / NUM_ITERATIONS;
+
+		int maxDifference = 0;
+		const uint8_t* pFactory = pConverted->GetData();
+		for (size_t i = 0; i < dstSize; i++)
+		{
+			int difference = std::abs(static_cast<int>(pFactory[i]) - static_cast<int>(scalar[i]));
+			if (difference > maxDifference)
+				maxDifference = difference;
+		}
+
+		std::cout << TAB2 << "ImageFactory: " << factoryMs << " ms (" << 1000.0 / factoryMs << " fps, max byte difference "
+				  << maxDifference << ")\n";
+
+		Arena::ImageFactory::Destroy(pConverted);
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << TAB2 << "ImageFactory: " << ge.GetDescription() << "\n";
+	}
+
+	Arena::ImageFactory::Destroy(pSrcImage);
+}
+
+// demonstrates runtime kernel selection
+// (1) reports active path
+// (2) benchmarks each conversion
+// (3) converts through the drop-in function
+void ConvertWithNeonKernels()
+{
+	// Report active path
+	std::cout << TAB1 << "Active conversion path: " << ActiveConversionPath().name << "\n\n";
+
+	// Benchmark each conversion
+	BenchmarkConversion(BayerRG8, BGR8);
+	BenchmarkConversion(Mono12p, Mono16);
+	BenchmarkConversion(YUV422_8_UYVY, RGB8);
+
+	// Convert through drop-in function
+	//    Existing calls to Arena::ImageFactory::Convert can be swapped for the
+	//    drop-in function without other changes; they keep their algorithm,
+	//    which for Bayer images means the image factory still demosaics. The
+	//    vectorized bilinear demosaic must be asked for explicitly.
+	std::cout << "\n"
+			  << TAB1 << "Convert BayerRG8 image to BGR8 through drop-in function\n";
+
+	std::vector<uint8_t> src(static_cast<size_t>(WIDTH) * HEIGHT);
+	FillSynthetic(src);
+
+	Arena::IImage* pImage = Arena::ImageFactory::Create(src.data(), src.size(), WIDTH, HEIGHT, BayerRG8);
+	Arena::IImage* pDirectional = Convert(pImage, BGR8);
+	Arena::IImage* pBilinear = ConvertBilinear(pImage);
+
+	std::cout << TAB2 << "Converted " << pDirectional->GetWidth() << "x" << pDirectional->GetHeight() << " "
+			  << GetPixelFormatName(static_cast<PfncFormat>(pDirectional->GetPixelFormat())) << " image (DirectionalInterpolation, image factory)\n";
+	std::cout << TAB2 << "Converted " << pBilinear->GetWidth() << "x" << pBilinear->GetHeight() << " "
+			  << GetPixelFormatName(static_cast<PfncFormat>(pBilinear->GetPixelFormat())) << " image (bilinear, " << ActiveConversionPath().name << ")\n";
+
+	Arena::ImageFactory::Destroy(pBilinear);
+	Arena::ImageFactory::Destroy(pDirectional);
+	Arena::ImageFactory::Destroy(pImage);
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_ImageFactory_NeonKernels\n";
+
+	try
+	{
+		// run example
+		//    Images are synthetic, so no camera is required.
+		std::cout << "Commence example\n\n";
+		ConvertWithNeonKernels();
+		std::cout << "\nExample complete\n";
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
@@ -0,0 +1,363 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+#include "SaveApi.h"
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstring>
+#include <stdexcept>
+
+#define TAB1 "  "
+#define TAB2 "    "
+#define TAB3 "      "
+
+// Image Factory: ROI Views
+//    This example demonstrates working on rectangular regions of an image
+//    without copying them. An ImageView refers to a region of an image by
+//    pointer, size and stride, so cropping a region costs nothing and views of
+//    views are just as cheap. Views share ownership of the image they came
+//    from, which is requeued only once the last view is gone. Inspection code
+//    that honours the stride runs directly on the views. Consumers that need
+//    tightly packed data (Save::ImageWriter::Save, Save::VideoRecorder::AppendImage,
+//    Arena::ImageFactory::Create) are handed the view's own memory when its rows
+//    are contiguous, as for full-width bands, and otherwise a packed copy made
+//    into scratch storage that is reused from image to image.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// pixel format of the inspected images
+#define PIXEL_FORMAT "Mono8"
+
+// Inspection grid
+//    The image is divided into ROI_COLUMNS by ROI_ROWS regions, each inspected
+//    separately, plus a full-width band across the middle of the image.
+#define ROI_COLUMNS 3
+#define ROI_ROWS 2
+
+// number of images to grab
+#define NUM_IMAGES 10
+
+// file names for the regions saved from the first image
+#define BAND_FILE_NAME "Images/Cpp_ImageFactory_RoiViews/band.png"
+#define REGION_FILE_NAME "Images/Cpp_ImageFactory_RoiViews/region.png"
+
+// system timeout
+#define SYSTEM_TIMEOUT 100
+
+// image timeout
+#define IMAGE_TIMEOUT 2000
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- HELPERS =-=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// Image lease
+//    Owns an image from a device for as long as any view refers to it and
+//    requeues it when the last reference is released.
+class ImageLease
+{
+public:
+	ImageLease(Arena::IDevice* pDevice, Arena::IImage* pImage) :
+		m_pDevice(pDevice),
+		m_pImage(pImage)
+	{
+	}
+
+	~ImageLease()
+	{
+		m_pDevice->RequeueBuffer(m_pImage);
+	}
+
+	Arena::IImage* GetImage() const { return m_pImage; }
+
+private:
+	// a lease is shared, never copied
+	ImageLease(const ImageLease&);
+	ImageLease& operator=(const ImageLease&);
+
+	Arena::IDevice* m_pDevice;
+	Arena::IImage* m_pImage;
+};
+
+// Image view
+//    A rectangular region of an image. The view does not own pixel data; it
+//    keeps the image's lease alive instead, so the data stays valid while the
+//    view exists. Regions must start on a whole byte, which holds for every
+//    pixel format of 8 bits or more.
+class ImageView
+{
+public:
+	// views a whole leased image
+	explicit ImageView(const std::shared_ptr<ImageLease>& pLease) :
+		m_pLease(pLease)
+	{
+		Arena::IImage* pImage = pLease->GetImage();
+
+		m_pData = pImage->GetData();
+		m_width = pImage->GetWidth();
+		m_height = pImage->GetHeight();
+		m_bitsPerPixel = pImage->GetBitsPerPixel();
+		m_stride = m_width * m_bitsPerPixel / 8 + pImage->GetPaddingX();
+		m_pixelFormat = pImage->GetPixelFormat();
+	}
+
+	// Sub-region
+	//    Returns a view of a region of this view. Only the pointer and size
+	//    change; the stride stays that of the underlying image.
+	ImageView Sub(size_t x, size_t y, size_t width, size_t height) const
+	{
+		if (x + width > m_width || y + height > m_height || width == 0 || height == 0)
+			throw std::out_of_range("ROI lies outside the view");
+		if ((x * m_bitsPerPixel) % 8 != 0)
+			throw std::invalid_argument("ROI does not start on a byte boundary");
+
+		ImageView view(*this);
+		view.m_pData = m_pData + y * m_stride + x * m_bitsPerPixel / 8;
+		view.m_width = width;
+		view.m_height = height;
+		return view;
+	}
+
+	const uint8_t* GetRow(size_t y) const { return m_pData + y * m_stride; }
+	size_t GetWidth() const { return m_width; }
+	size_t GetHeight() const { return m_height; }
+	size_t GetStride() const { return m_stride; }
+	size_t GetBitsPerPixel() const { return m_bitsPerPixel; }
+	uint64_t GetPixelFormat() const { return m_pixelFormat; }
+	size_t GetPackedSize() const { return m_width * m_bitsPerPixel / 8 * m_height; }
+
+	// rows follow each other without gaps, as for full-width regions of unpadded images
+	bool IsContiguous() const
+	{
+		return m_stride == m_width * m_bitsPerPixel / 8 || m_height == 1;
+	}
+
+	// Packed data
+	//    Returns the view's pixels tightly packed. Contiguous views return
+	//    their own memory; others are packed into scratch, which grows only
+	//    when a larger region needs it.
+	const uint8_t* GetPacked(std::vector<uint8_t>& scratch) const
+	{
+		if (IsContiguous())
+			return m_pData;
+
+		size_t rowSize = m_width * m_bitsPerPixel / 8;
+		if (scratch.size() < GetPackedSize())
+			scratch.resize(GetPackedSize());
+
+		for (size_t y = 0; y < m_height; y++)
+			memcpy(&scratch[y * rowSize], GetRow(y), rowSize);
+
+		return scratch.data();
+	}
+
+	// Image
+	//    Creates an image of the region for functions that take one, such as
+	//    Arena::ImageFactory::Convert. The image factory always allocates, so
+	//    this is one copy; the image must be destroyed.
+	Arena::IImage* CreateImage(std::vector<uint8_t>& scratch) const
+	{
+		return Arena::ImageFactory::Create(GetPacked(scratch), GetPackedSize(), m_width, m_height, m_pixelFormat);
+	}
+
+private:
+	std::shared_ptr<ImageLease> m_pLease;
+	const uint8_t* m_pData;
+	size_t m_width;
+	size_t m_height;
+	size_t m_stride;
+	size_t m_bitsPerPixel;
+	uint64_t m_pixelFormat;
+};
+
+// computes the mean of an 8-bit view, row by row
+double Mean(const ImageView& view)
+{
+	uint64_t sum = 0;
+	for (size_t y = 0; y < view.GetHeight(); y++)
+	{
+		const uint8_t* pRow = view.GetRow(y);
+		for (size_t x = 0; x < view.GetWidth(); x++)
+			sum += pRow[x];
+	}
+	return static_cast<double>(sum) / (view.GetWidth() * view.GetHeight());
+}
+
+// saves a view through the image writer
+void SaveView(const ImageView& view, const char* filename, std::vector<uint8_t>& scratch)
+{
+	Save::ImageParams params(view.GetWidth(), view.GetHeight(), view.GetBitsPerPixel());
+	Save::ImageWriter writer(params, filename);
+
+	writer << view.GetPacked(scratch);
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// demonstrates ROI views
+// (1) sets pixel format and starts stream
+// (2) leases each image and views its regions
+// (3) inspects each region in place
+// (4) saves a band and a region of the first image
+// (5) converts a region through the image factory
+// (6) requeues each image when its last view goes
+// (7) restores pixel format
+void InspectRegions(Arena::IDevice* pDevice)
+{
+	// set pixel format
+	GenICam::gcstring pixelFormatInitial = Arena::GetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "PixelFormat");
+
+	std::cout << TAB1 << "Set pixel format to " << PIXEL_FORMAT << "\n";
+
+	Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "PixelFormat", PIXEL_FORMAT);
+
+	// start stream
+	std::cout << TAB1 << "Start stream\n";
+
+	pDevice->StartStream();
+
+	// Inspect images
+	//    The region views live only inside the loop body; the lease they share
+	//    requeues the image when the last of them goes out of scope. The
+	//    scratch storage outlives the loop and is reused.
+	std::cout << TAB1 << "Inspect " << NUM_IMAGES << " images in " << ROI_COLUMNS * ROI_ROWS << " regions and a band\n";
+
+	std::vector<uint8_t> scratch;
+
+	for (int i = 0; i < NUM_IMAGES; i++)
+	{
+		std::shared_ptr<ImageLease> pLease(new ImageLease(pDevice, pDevice->GetImage(IMAGE_TIMEOUT)));
+		ImageView image(pLease);
+
+		std::cout << TAB2 << "Image " << i << " (" << image.GetWidth() << "x" << image.GetHeight() << ")\n";
+
+		// view regions
+		size_t regionWidth = image.GetWidth() / ROI_COLUMNS;
+		size_t regionHeight = image.GetHeight() / ROI_ROWS;
+
+		std::vector<ImageView> regions;
+		for (size_t row = 0; row < ROI_ROWS; row++)
+		{
+			for (size_t column = 0; column < ROI_COLUMNS; column++)
+				regions.push_back(image.Sub(column * regionWidth, row * regionHeight, regionWidth, regionHeight));
+		}
+
+		ImageView band = image.Sub(0, image.GetHeight() / 2 - regionHeight / 4, image.GetWidth(), regionHeight / 2);
+
+		// inspect in place
+		std::cout << TAB3 << "Means:";
+		for (size_t r = 0; r < regions.size(); r++)
+			std::cout << " " << static_cast<int>(Mean(regions[r]));
+		std::cout << ", band " << static_cast<int>(Mean(band)) << "\n";
+
+		if (i != 0)
+			continue;
+
+		// Save band and region
+		//    The band spans whole rows and goes to the writer without a copy;
+		//    the region is packed into scratch first.
+		std::cout << TAB3 << "Save band (" << (band.IsContiguous() ? "no copy" : "packed") << ") to " << BAND_FILE_NAME << "\n";
+
+		SaveView(band, BAND_FILE_NAME, scratch);
+
+		std::cout << TAB3 << "Save region (" << (regions[0].IsContiguous() ? "no copy" : "packed") << ") to " << REGION_FILE_NAME << "\n";
+
+		SaveView(regions[0], REGION_FILE_NAME, scratch);
+
+		// convert region
+		Arena::IImage* pRegion = regions[0].CreateImage(scratch);
+		Arena::IImage* pConverted = Arena::ImageFactory::Convert(pRegion, BGR8);
+
+		std::cout << TAB3 << "Convert region to " << GetPixelFormatName(static_cast<PfncFormat>(pConverted->GetPixelFormat())) << " ("
+				  << pConverted->GetWidth() << "x" << pConverted->GetHeight() << ")\n";
+
+		Arena::ImageFactory::Destroy(pConverted);
+		Arena::ImageFactory::Destroy(pRegion);
+	}
+
+	// stop stream
+	std::cout << TAB1 << "Stop stream\n";
+
+	pDevice->StopStream();
+
+	// restore pixel format
+	Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "PixelFormat", pixelFormatInitial);
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_ImageFactory_RoiViews\n";
+
+	try
+	{
+		// prepare example
+		Arena::ISystem* pSystem = Arena::OpenSystem();
+		pSystem->UpdateDevices(SYSTEM_TIMEOUT);
+		std::vector<Arena::DeviceInfo> deviceInfos = pSystem->GetDevices();
+		if (deviceInfos.size() == 0)
+		{
+			std::cout << "\nNo camera connected\nPress enter to complete\n";
+			std::getchar();
+			return 0;
+		}
+		Arena::IDevice* pDevice = pSystem->CreateDevice(deviceInfos[0]);
+
+		// run example
+		std::cout << "Commence example\n\n";
+		InspectRegions(pDevice);
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		pSystem->DestroyDevice(pDevice);
+		Arena::CloseSystem(pSystem);
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
@@ -0,0 +1,317 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+#include "SaveApi.h"
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Image Factory: Strided Images
+//    This example demonstrates carrying images whose rows are padded to an
+//    alignment from acquisition to disk. SIMD code and accelerators often need
+//    every row to start on a 64-byte boundary, while the image factory, image
+//    writer and video recorder work on tightly packed rows. A StridedImage
+//    keeps its row stride alongside its size and pixel format and owns
+//    storage with aligned rows. Images from the device are read with their
+//    own stride (Arena::IImage::GetPaddingX), processed straight into aligned
+//    rows, and handed to the writer and recorder without repacking whenever
+//    the stride needs no padding; otherwise rows are packed once into scratch
+//    storage that is reused from frame to frame.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// pixel format of the acquired images
+#define PIXEL_FORMAT "Mono8"
+
+// row alignment in bytes
+#define ROW_ALIGNMENT 64
+
+// Saturation threshold
+//    Pixels at or above this value are marked in red in the processed
+//    output.
+#define SATURATION 250
+
+// number of images to grab
+#define NUM_IMAGES 50
+
+// video frame rate
+#define FRAMES_PER_SECOND 25.0
+
+// file names
+#define IMAGE_FILE_NAME "Images/Cpp_ImageFactory_StridedImages/image.png"
+#define VIDEO_FILE_NAME "Images/Cpp_ImageFactory_StridedImages/video.mp4"
+
+// system timeout
+#define SYSTEM_TIMEOUT 100
+
+// image timeout
+#define IMAGE_TIMEOUT 2000
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- HELPERS =-=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// Strided image
+//    An image whose rows start every stride bytes, with the stride rounded up
+//    to the row alignment. The first row is aligned too, so every row of the
+//    image is.
+class StridedImage
+{
+public:
+	StridedImage(size_t width, size_t height, size_t bitsPerPixel, uint64_t pixelFormat, size_t rowAlignment) :
+		m_width(width),
+		m_height(height),
+		m_bitsPerPixel(bitsPerPixel),
+		m_pixelFormat(pixelFormat)
+	{
+		size_t rowSize = width * bitsPerPixel / 8;
+		m_stride = ((rowSize + rowAlignment - 1) / rowAlignment) * rowAlignment;
+
+#ifdef _WIN32
+		m_pData = static_cast<uint8_t*>(_aligned_malloc(m_stride * height, rowAlignment));
+#else
+		void* pMemory = NULL;
+		m_pData = posix_memalign(&pMemory, rowAlignment, m_stride * height) == 0 ? static_cast<uint8_t*>(pMemory) : NULL;
+#endif
+		if (!m_pData)
+			throw std::bad_alloc();
+	}
+
+	~StridedImage()
+	{
+#ifdef _WIN32
+		_aligned_free(m_pData);
+#else
+		free(m_pData);
+#endif
+	}
+
+	uint8_t* GetRow(size_t y) { return m_pData + y * m_stride; }
+	const uint8_t* GetRow(size_t y) const { return m_pData + y * m_stride; }
+	size_t GetWidth() const { return m_width; }
+	size_t GetHeight() const { return m_height; }
+	size_t GetStride() const { return m_stride; }
+	size_t GetBitsPerPixel() const { return m_bitsPerPixel; }
+	uint64_t GetPixelFormat() const { return m_pixelFormat; }
+	size_t GetRowSize() const { return m_width * m_bitsPerPixel / 8; }
+
+	// rows need no padding to reach the alignment
+	bool IsPacked() const { return m_stride == GetRowSize(); }
+
+	// Packed data
+	//    Returns the pixels with tightly packed rows for the image writer,
+	//    video recorder and image factory. Unpadded images return their own
+	//    memory; others are packed into scratch.
+	const uint8_t* GetPacked(std::vector<uint8_t>& scratch) const
+	{
+		if (IsPacked())
+			return m_pData;
+
+		size_t rowSize = GetRowSize();
+		scratch.resize(rowSize * m_height);
+		for (size_t y = 0; y < m_height; y++)
+			memcpy(&scratch[y * rowSize], GetRow(y), rowSize);
+
+		return scratch.data();
+	}
+
+private:
+	// the image owns its storage and is never copied
+	StridedImage(const StridedImage&);
+	StridedImage& operator=(const StridedImage&);
+
+	uint8_t* m_pData;
+	size_t m_width;
+	size_t m_height;
+	size_t m_stride;
+	size_t m_bitsPerPixel;
+	uint64_t m_pixelFormat;
+};
+
+// Mark saturation
+//    Converts a Mono8 image to BGR8, marking saturated pixels red. Source
+//    rows are stepped by the image's own stride, including any padding the
+//    device or producer added; destination rows are stepped by the strided
+//    image's aligned stride.
+void MarkSaturation(Arena::IImage* pSrc, StridedImage& dst)
+{
+	const uint8_t* pSrcData = pSrc->GetData();
+	size_t srcStride = pSrc->GetWidth() + pSrc->GetPaddingX();
+
+	for (size_t y = 0; y < dst.GetHeight(); y++)
+	{
+		const uint8_t* pSrcRow = pSrcData + y * srcStride;
+		uint8_t* pDstRow = dst.GetRow(y);
+
+		for (size_t x = 0; x < dst.GetWidth(); x++)
+		{
+			uint8_t value = pSrcRow[x];
+			bool saturated = value >= SATURATION;
+
+			pDstRow[3 * x + 0] = saturated ? 0 : value;
+			pDstRow[3 * x + 1] = saturated ? 0 : value;
+			pDstRow[3 * x + 2] = saturated ? 255 : value;
+		}
+	}
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// demonstrates strided images
+// (1) sets pixel format and starts stream
+// (2) prepares an aligned output image, writer and recorder
+// (3) processes each image into aligned rows
+// (4) saves the first image and records all of them
+// (5) stops stream and restores pixel format
+void ProcessStridedImages(Arena::IDevice* pDevice)
+{
+	// set pixel format
+	GenICam::gcstring pixelFormatInitial = Arena::GetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "PixelFormat");
+
+	std::cout << TAB1 << "Set pixel format to " << PIXEL_FORMAT << "\n";
+
+	Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "PixelFormat", PIXEL_FORMAT);
+
+	// start stream
+	std::cout << TAB1 << "Start stream\n";
+
+	pDevice->StartStream();
+
+	// Prepare output
+	//    The first image sets the size. Its padding is reported to show what
+	//    the producer delivers; it is honoured either way.
+	Arena::IImage* pImage = pDevice->GetImage(IMAGE_TIMEOUT);
+
+	StridedImage output(pImage->GetWidth(), pImage->GetHeight(), 24, BGR8, ROW_ALIGNMENT);
+
+	std::cout << TAB1 << "Input " << pImage->GetWidth() << "x" << pImage->GetHeight() << ", " << pImage->GetPaddingX() << " bytes row padding\n";
+	std::cout << TAB1 << "Output stride " << output.GetStride() << " bytes for " << output.GetRowSize() << "-byte rows ("
+			  << (output.IsPacked() ? "no repacking needed" : "packed once per frame for saving") << ")\n";
+
+	Save::ImageWriter writer(Save::ImageParams(output.GetWidth(), output.GetHeight(), output.GetBitsPerPixel()), IMAGE_FILE_NAME);
+
+	Save::VideoRecorder recorder(Save::VideoParams(output.GetWidth(), output.GetHeight(), FRAMES_PER_SECOND), VIDEO_FILE_NAME);
+	recorder.SetH264Mp4BGR8();
+	recorder.Open();
+
+	// process and record images
+	std::cout << TAB1 << "Process and record " << NUM_IMAGES << " images\n";
+
+	std::vector<uint8_t> scratch;
+
+	for (int i = 0; i < NUM_IMAGES; i++)
+	{
+		if (i != 0)
+			pImage = pDevice->GetImage(IMAGE_TIMEOUT);
+
+		MarkSaturation(pImage, output);
+		pDevice->RequeueBuffer(pImage);
+
+		const uint8_t* pPacked = output.GetPacked(scratch);
+
+		if (i == 0)
+		{
+			std::cout << TAB2 << "Save " << IMAGE_FILE_NAME << "\n";
+			writer << pPacked;
+		}
+
+		recorder.AppendImage(pPacked);
+	}
+
+	std::cout << TAB2 << "Close " << VIDEO_FILE_NAME << "\n";
+
+	recorder.Close();
+
+	// stop stream
+	std::cout << TAB1 << "Stop stream\n";
+
+	pDevice->StopStream();
+
+	// restore pixel format
+	Arena::SetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "PixelFormat", pixelFormatInitial);
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_ImageFactory_StridedImages\n";
+
+	try
+	{
+		// prepare example
+		Arena::ISystem* pSystem = Arena::OpenSystem();
+		pSystem->UpdateDevices(SYSTEM_TIMEOUT);
+		std::vector<Arena::DeviceInfo> deviceInfos = pSystem->GetDevices();
+		if (deviceInfos.size() == 0)
+		{
+			std::cout << "\nNo camera connected\nPress enter to complete\n";
+			std::getchar();
+			return 0;
+		}
+		Arena::IDevice* pDevice = pSystem->CreateDevice(deviceInfos[0]);
+
+		// run example
+		std::cout << "Commence example\n\n";
+		ProcessStridedImages(pDevice);
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		pSystem->DestroyDevice(pDevice);
+		Arena::CloseSystem(pSystem);
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
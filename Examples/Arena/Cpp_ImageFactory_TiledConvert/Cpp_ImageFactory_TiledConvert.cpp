@@ -0,0 +1,448 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <algorithm>
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Image Factory: Tiled Conversion
+//    This example demonstrates converting a single large image on several
+//    threads at once. Arena::ImageFactory::Convert runs on the calling thread,
+//    so on 24 MP and larger sensors a demosaic with AdaptiveHomogeneityDirected
+//    can take longer than a frame period. Here, the image is split into
+//    horizontal bands that are converted in parallel by a persistent pool of
+//    threads. Each band is extended by a few halo rows above and below so that
+//    the demosaic sees the same neighbourhood it would in the full image, and
+//    only the band's own rows are copied into the result. Bands always start
+//    on an even row so that every band keeps the Bayer pattern of the full
+//    image. The example compares the latency of a tiled conversion to that of
+//    a single call and checks that both produce the same pixels.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// image width
+#define WIDTH 5328
+
+// image height
+#define HEIGHT 4608
+
+// source pixel format
+#define SRC_PIXEL_FORMAT BayerRG12p
+
+// destination pixel format
+#define DST_PIXEL_FORMAT RGB8
+
+// Bayer algorithm
+#define BAYER_ALGORITHM AdaptiveHomogeneityDirected
+
+// number of threads
+//    0 uses one thread per hardware thread.
+#define NUM_THREADS 0
+
+// halo rows
+//    Rows added above and below every band. They must cover the reach of the
+//    demosaic neighbourhood, including the homogeneity map of
+//    AdaptiveHomogeneityDirected. Rounded up to an even number.
+#define HALO_ROWS 8
+
+// number of conversions to time
+#define NUM_ITERATIONS 5
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// tiled converter
+//    Owns a pool of threads that stay alive between conversions, so that a
+//    conversion costs a wake-up rather than a thread start. One conversion
+//    runs at a time; the calling thread converts a band too.
+class TiledConverter
+{
+public:
+	TiledConverter(size_t numThreads, size_t haloRows) :
+		m_haloRows((haloRows + 1) / 2 * 2),
+		m_stop(false),
+		m_generation(0),
+		m_pJob(NULL)
+	{
+		if (numThreads == 0)
+			numThreads = std::thread::hardware_concurrency();
+		if (numThreads == 0)
+			numThreads = 1;
+
+		m_numThreads = numThreads;
+
+		for (size_t i = 1; i < numThreads; i++)
+			m_threads.push_back(std::thread(&TiledConverter::WorkerThread, this));
+	}
+
+	~TiledConverter()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_startCondition.notify_all();
+
+		for (size_t i = 0; i < m_threads.size(); i++)
+			m_threads[i].join();
+	}
+
+	size_t GetNumThreads() const
+	{
+		return m_numThreads;
+	}
+
+	// converts an image
+	//    Same contract as Arena::ImageFactory::Convert: the result must be
+	//    destroyed with Arena::ImageFactory::Destroy. Images that cannot be
+	//    split on byte boundaries, or are too small to be worth splitting, are
+	//    converted with a single call.
+	Arena::IImage* Convert(Arena::IImage* pImage, uint64_t pixelFormat, Arena::EBayerAlgorithm bayerAlgorithm)
+	{
+		size_t width = pImage->GetWidth();
+		size_t height = pImage->GetHeight();
+		size_t srcBitsPerRow = width * pImage->GetBitsPerPixel();
+		size_t dstBitsPerRow = width * Arena::GetBitsPerPixel(pixelFormat);
+
+		size_t numBands = m_numThreads;
+		size_t bandRows = (height + numBands - 1) / numBands;
+		bandRows = (bandRows + 1) / 2 * 2;
+
+		if (numBands == 1 || bandRows < m_haloRows || srcBitsPerRow % 8 != 0 || dstBitsPerRow % 8 != 0 || pImage->GetPaddingX() != 0)
+			return Arena::ImageFactory::Convert(pImage, pixelFormat, bayerAlgorithm);
+
+		Job job;
+		job.pSrc = pImage->GetData();
+		job.srcPixelFormat = pImage->GetPixelFormat();
+		job.dstPixelFormat = pixelFormat;
+		job.bayerAlgorithm = bayerAlgorithm;
+		job.width = width;
+		job.height = height;
+		job.srcRowSize = srcBitsPerRow / 8;
+		job.dstRowSize = dstBitsPerRow / 8;
+		job.bandRows = bandRows;
+		job.numBands = (height + bandRows - 1) / bandRows;
+		job.nextBand = 0;
+		job.numDone = 0;
+		job.numActive = 0;
+		job.dst.resize(job.dstRowSize * height);
+
+		// start workers and convert on this thread too
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_pJob = &job;
+			m_generation++;
+		}
+		m_startCondition.notify_all();
+
+		RunBands(job);
+
+		// wait for the last band
+		//    Also waits for every worker to let go of the job, since it lives on
+		//    this thread's stack.
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_pJob = NULL;
+			m_doneCondition.wait(lock, [&job]() { return job.numDone == job.numBands && job.numActive == 0; });
+		}
+
+		if (!job.error.empty())
+			throw GenICam::GenericException(job.error.c_str(), __FILE__, __LINE__);
+
+		return Arena::ImageFactory::Create(job.dst.data(), job.dst.size(), width, height, pixelFormat);
+	}
+
+private:
+	struct Job
+	{
+		const uint8_t* pSrc;
+		uint64_t srcPixelFormat;
+		uint64_t dstPixelFormat;
+		Arena::EBayerAlgorithm bayerAlgorithm;
+		size_t width;
+		size_t height;
+		size_t srcRowSize;
+		size_t dstRowSize;
+		size_t bandRows;
+		size_t numBands;
+		size_t nextBand;
+		size_t numDone;
+		size_t numActive;
+		std::vector<uint8_t> dst;
+		std::string error;
+	};
+
+	// converts one band
+	// (1) extends band by halo rows, clamped to the image
+	// (2) converts extended band
+	// (3) copies band's own rows into result
+	void ConvertBand(Job& job, size_t band)
+	{
+		size_t firstRow = band * job.bandRows;
+		size_t lastRow = std::min(firstRow + job.bandRows, job.height);
+
+		// Extend band
+		//    Halo rows are even in number, so the extended band still starts
+		//    on an even row and on the same colour as the full image.
+		size_t haloFirst = firstRow > m_haloRows ? firstRow - m_haloRows : 0;
+		size_t haloLast = std::min(lastRow + m_haloRows, job.height);
+
+		// Convert extended band
+		Arena::IImage* pBand = Arena::ImageFactory::Create(
+			job.pSrc + haloFirst * job.srcRowSize,
+			(haloLast - haloFirst) * job.srcRowSize,
+			job.width,
+			haloLast - haloFirst,
+			job.srcPixelFormat);
+
+		Arena::IImage* pConverted = NULL;
+		try
+		{
+			pConverted = Arena::ImageFactory::Convert(pBand, job.dstPixelFormat, job.bayerAlgorithm);
+		}
+		catch (...)
+		{
+			Arena::ImageFactory::Destroy(pBand);
+			throw;
+		}
+
+		// Copy own rows
+		memcpy(
+			job.dst.data() + firstRow * job.dstRowSize,
+			pConverted->GetData() + (firstRow - haloFirst) * job.dstRowSize,
+			(lastRow - firstRow) * job.dstRowSize);
+
+		Arena::ImageFactory::Destroy(pConverted);
+		Arena::ImageFactory::Destroy(pBand);
+	}
+
+	// takes bands until none are left
+	void RunBands(Job& job)
+	{
+		while (true)
+		{
+			size_t band;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (job.nextBand == job.numBands)
+					return;
+				band = job.nextBand++;
+			}
+
+			std::string error;
+			try
+			{
+				ConvertBand(job, band);
+			}
+			catch (GenICam::GenericException& ge)
+			{
+				error = ge.GetDescription();
+			}
+			catch (std::exception& ex)
+			{
+				error = ex.what();
+			}
+
+			bool last;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (!error.empty() && job.error.empty())
+					job.error = error;
+				last = ++job.numDone == job.numBands;
+			}
+
+			if (last)
+				m_doneCondition.notify_all();
+		}
+	}
+
+	void WorkerThread()
+	{
+		uint64_t seen = 0;
+
+		while (true)
+		{
+			Job* pJob;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_startCondition.wait(lock, [this, seen]() { return m_stop || m_generation != seen; });
+				if (m_stop)
+					return;
+				seen = m_generation;
+				pJob = m_pJob;
+				if (!pJob)
+					continue;
+				pJob->numActive++;
+			}
+
+			RunBands(*pJob);
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				pJob->numActive--;
+			}
+			m_doneCondition.notify_all();
+		}
+	}
+
+	size_t m_numThreads;
+	size_t m_haloRows;
+	std::vector<std::thread> m_threads;
+
+	std::mutex m_mutex;
+	std::condition_variable m_startCondition;
+	std::condition_variable m_doneCondition;
+	bool m_stop;
+	uint64_t m_generation;
+	Job* m_pJob;
+};
+
+// times a conversion
+//    Returns the average milliseconds per conversion and keeps the last
+//    result for comparison.
+template <typename ConvertFunction>
+double TimeConversion(ConvertFunction convert, Arena::IImage** ppResult)
+{
+	*ppResult = NULL;
+	auto start = std::chrono::steady_clock::now();
+
+	for (size_t i = 0; i < NUM_ITERATIONS; i++)
+	{
+		if (*ppResult)
+			Arena::ImageFactory::Destroy(*ppResult);
+		*ppResult = convert();
+	}
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / NUM_ITERATIONS;
+}
+
+// demonstrates tiled conversion
+// (1) prepares synthetic source image
+// (2) times single-threaded conversion
+// (3) times tiled conversion
+// (4) compares results
+void ConvertTiled()
+{
+	// Prepare synthetic source image
+	//    Noise rather than a flat image, so that the demosaic has edges to
+	//    follow and band seams would show up in the comparison.
+	std::cout << TAB1 << "Prepare " << WIDTH << "x" << HEIGHT << " " << GetPixelFormatName(SRC_PIXEL_FORMAT) << " image\n";
+
+	std::vector<uint8_t> src(static_cast<size_t>(WIDTH) * HEIGHT * Arena::GetBitsPerPixel(SRC_PIXEL_FORMAT) / 8);
+	uint32_t state = 0x12345678;
+	for (size_t i = 0; i < src.size(); i++)
+	{
+		state = state * 1664525 + 1013904223;
+		src[i] = static_cast<uint8_t>(state >> 24);
+	}
+
+	Arena::IImage* pImage = Arena::ImageFactory::Create(src.data(), src.size(), WIDTH, HEIGHT, SRC_PIXEL_FORMAT);
+
+	// Time single-threaded conversion
+	std::cout << TAB1 << "Convert to " << GetPixelFormatName(DST_PIXEL_FORMAT) << " on 1 thread\n";
+
+	Arena::IImage* pSingle = NULL;
+	double singleMs = TimeConversion([pImage]() { return Arena::ImageFactory::Convert(pImage, DST_PIXEL_FORMAT, Arena::BAYER_ALGORITHM); }, &pSingle);
+
+	std::cout << TAB2 << singleMs << " ms per image\n";
+
+	// Time tiled conversion
+	TiledConverter converter(NUM_THREADS, HALO_ROWS);
+
+	std::cout << TAB1 << "Convert to " << GetPixelFormatName(DST_PIXEL_FORMAT) << " on " << converter.GetNumThreads() << " threads\n";
+
+	Arena::IImage* pTiled = NULL;
+	double tiledMs = TimeConversion([pImage, &converter]() { return converter.Convert(pImage, DST_PIXEL_FORMAT, Arena::BAYER_ALGORITHM); }, &pTiled);
+
+	std::cout << TAB2 << tiledMs << " ms per image (" << singleMs / tiledMs << "x)\n";
+
+	// Compare results
+	//    Any difference means the halo is too small for the algorithm.
+	size_t size = pSingle->GetSizeFilled();
+	size_t numDifferent = 0;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		if (pSingle->GetData()[i] != pTiled->GetData()[i])
+			numDifferent++;
+	}
+
+	if (numDifferent == 0)
+		std::cout << TAB1 << "Tiled result identical to single-threaded result\n";
+	else
+		std::cout << TAB1 << "Tiled result differs in " << numDifferent << " of " << size << " bytes; increase HALO_ROWS\n";
+
+	Arena::ImageFactory::Destroy(pTiled);
+	Arena::ImageFactory::Destroy(pSingle);
+	Arena::ImageFactory::Destroy(pImage);
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_ImageFactory_TiledConvert\n";
+
+	try
+	{
+		// run example
+		//    Images are synthetic, so no camera is required.
+		std::cout << "Commence example\n\n";
+		ConvertTiled();
+		std::cout << "\nExample complete\n";
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
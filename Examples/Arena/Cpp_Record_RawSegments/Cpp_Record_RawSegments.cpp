@@ -0,0 +1,785 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <thread>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <direct.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Record: Raw Segments
+//    This example demonstrates recording raw frames at full rate into a small
+//    number of large files. Saving each frame as its own raw file (see
+//    Save::ImageWriter::SetRaw) creates one file per frame, and at hundreds of
+//    frames per second the file system metadata becomes the bottleneck. Here,
+//    frames are appended to segment files that are preallocated up front and
+//    memory-mapped, so recording a frame is a single copy from the stream
+//    buffer into the page cache with no system call. Every frame is preceded by
+//    a header holding its frame ID, timestamp, pixel format, geometry and the
+//    size of any chunk data that follows the image. When a segment is full,
+//    recording rolls over to the next one, and the full segment is flushed
+//    and closed on a background thread so that the acquisition thread never
+//    waits for the disk. A reader then maps the segments and provides random
+//    access to any frame by index.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// directory and file name prefix of segment files
+//    Segments are named <prefix>_0000.seg, <prefix>_0001.seg, and so on.
+#define SEGMENT_DIRECTORY "Images/Cpp_Record_RawSegments"
+#define SEGMENT_PREFIX "recording"
+
+// segment size
+//    Space reserved on disk for each segment. Unused space is released when a
+//    segment is closed.
+#define SEGMENT_SIZE (256ULL * 1024 * 1024)
+
+// number of images to record
+#define NUM_IMAGES 1000
+
+// number of buffers
+#define NUM_BUFFERS 50
+
+// system timeout
+#define SYSTEM_TIMEOUT 100
+
+// image timeout
+#define IMAGE_TIMEOUT 2000
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- FORMAT -=-=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// Segment header
+//    Written at the start of every segment. A frame only counts once numFrames
+//    and dataEnd include it. If the application dies while recording, the
+//    page cache still holds everything written, so the recording reads back
+//    up to the last complete frame. Power loss is different: the system
+//    writes mapped pages back in no particular order, so only segments that
+//    were closed (and therefore flushed) are known to be on disk; the
+//    segment being written may be missing frames or hold stale data, which
+//    the reader stops at.
+struct SegmentHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t headerSize;
+	uint64_t segmentIndex;
+	uint64_t numFrames;
+	uint64_t dataEnd;
+	uint64_t reserved[3];
+};
+
+// frame header
+//    Written before every frame. The image data follows directly, then chunk
+//    data if any, then padding up to the next record.
+struct FrameHeader
+{
+	uint32_t magic;
+	uint32_t headerSize;
+	uint64_t frameId;
+	uint64_t timestampNs;
+	uint64_t pixelFormat;
+	uint32_t width;
+	uint32_t height;
+	uint32_t offsetX;
+	uint32_t offsetY;
+	uint32_t paddingX;
+	uint32_t flags;
+	uint64_t imageSize;
+	uint64_t chunkSize;
+};
+
+static const char SEGMENT_MAGIC[8] = { 'A', 'R', 'E', 'N', 'A', 'S', 'E', 'G' };
+static const uint32_t SEGMENT_VERSION = 1;
+static const uint32_t FRAME_MAGIC = 0x454D5246; // "FRME"
+static const uint32_t FRAME_FLAG_INCOMPLETE = 0x1;
+
+// record alignment
+//    Keeps every header and image on a cache line boundary.
+static const uint64_t RECORD_ALIGNMENT = 64;
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+// gets the file name of a segment
+std::string GetSegmentFileName(const std::string& directory, const std::string& prefix, size_t segmentIndex)
+{
+	char suffix[16];
+	snprintf(suffix, sizeof(suffix), "_%04u.seg", static_cast<unsigned int>(segmentIndex));
+	return directory + "/" + prefix + suffix;
+}
+
+// creates a directory and its parents
+void CreateDirectories(const std::string& path)
+{
+	for (size_t pos = path.find('/'); ; pos = path.find('/', pos + 1))
+	{
+		std::string partial = path.substr(0, pos);
+		if (!partial.empty())
+		{
+#if defined(_WIN32)
+			_mkdir(partial.c_str());
+#else
+			mkdir(partial.c_str(), 0755);
+#endif
+		}
+		if (pos == std::string::npos)
+			break;
+	}
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- MAPPING -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// memory-mapped file
+//    Maps a whole file, optionally creating and preallocating it first.
+class MappedFile
+{
+public:
+	MappedFile() :
+		m_pData(NULL),
+		m_size(0),
+		m_writable(false)
+#if defined(_WIN32)
+		,
+		m_hFile(INVALID_HANDLE_VALUE),
+		m_hMapping(NULL)
+#else
+		,
+		m_fd(-1)
+#endif
+	{
+	}
+
+	~MappedFile()
+	{
+		Close(m_size);
+	}
+
+	// creates, preallocates and maps a file for writing
+	//    Preallocating means a full disk is reported here rather than as a
+	//    crash when a page is first written.
+	void Create(const std::string& fileName, uint64_t size)
+	{
+		m_writable = true;
+		m_size = size;
+#if defined(_WIN32)
+		m_hFile = CreateFileA(fileName.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (m_hFile == INVALID_HANDLE_VALUE)
+			throw GenICam::GenericException(("Failed to create " + fileName).c_str(), __FILE__, __LINE__);
+
+		m_hMapping = CreateFileMappingA(m_hFile, NULL, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), NULL);
+		if (m_hMapping)
+			m_pData = static_cast<uint8_t*>(MapViewOfFile(m_hMapping, FILE_MAP_WRITE, 0, 0, 0));
+#else
+		m_fd = open(fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (m_fd < 0)
+			throw GenICam::GenericException(("Failed to create " + fileName).c_str(), __FILE__, __LINE__);
+
+		if (posix_fallocate(m_fd, 0, static_cast<off_t>(size)) != 0)
+		{
+			Close(0);
+			throw GenICam::GenericException(("Failed to reserve space for " + fileName).c_str(), __FILE__, __LINE__);
+		}
+
+		void* pData = mmap(NULL, static_cast<size_t>(size), PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+		if (pData != MAP_FAILED)
+		{
+			m_pData = static_cast<uint8_t*>(pData);
+			madvise(pData, static_cast<size_t>(size), MADV_SEQUENTIAL);
+		}
+#endif
+		if (!m_pData)
+		{
+			Close(0);
+			throw GenICam::GenericException(("Failed to map " + fileName).c_str(), __FILE__, __LINE__);
+		}
+	}
+
+	// maps an existing file for reading
+	//    Returns false if the file does not exist.
+	bool Open(const std::string& fileName)
+	{
+		m_writable = false;
+#if defined(_WIN32)
+		m_hFile = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (m_hFile == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size;
+		GetFileSizeEx(m_hFile, &size);
+		m_size = static_cast<uint64_t>(size.QuadPart);
+
+		m_hMapping = CreateFileMappingA(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (m_hMapping)
+			m_pData = static_cast<uint8_t*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+#else
+		m_fd = open(fileName.c_str(), O_RDONLY);
+		if (m_fd < 0)
+			return false;
+
+		struct stat info;
+		fstat(m_fd, &info);
+		m_size = static_cast<uint64_t>(info.st_size);
+
+		void* pData = m_size > 0 ? mmap(NULL, static_cast<size_t>(m_size), PROT_READ, MAP_SHARED, m_fd, 0) : MAP_FAILED;
+		if (pData != MAP_FAILED)
+			m_pData = static_cast<uint8_t*>(pData);
+#endif
+		if (!m_pData)
+		{
+			Close(0);
+			throw GenICam::GenericException(("Failed to map " + fileName).c_str(), __FILE__, __LINE__);
+		}
+		return true;
+	}
+
+	// unmaps and closes the file
+	//    A file opened for writing is flushed and cut down to finalSize.
+	void Close(uint64_t finalSize)
+	{
+#if defined(_WIN32)
+		if (m_pData)
+		{
+			if (m_writable)
+				FlushViewOfFile(m_pData, 0);
+			UnmapViewOfFile(m_pData);
+		}
+		if (m_hMapping)
+			CloseHandle(m_hMapping);
+		if (m_hFile != INVALID_HANDLE_VALUE)
+		{
+			if (m_writable)
+			{
+				LARGE_INTEGER position;
+				position.QuadPart = static_cast<LONGLONG>(finalSize);
+				SetFilePointerEx(m_hFile, position, NULL, FILE_BEGIN);
+				SetEndOfFile(m_hFile);
+			}
+			CloseHandle(m_hFile);
+		}
+		m_hMapping = NULL;
+		m_hFile = INVALID_HANDLE_VALUE;
+#else
+		if (m_pData)
+		{
+			if (m_writable)
+				msync(m_pData, static_cast<size_t>(m_size), MS_SYNC);
+			munmap(m_pData, static_cast<size_t>(m_size));
+		}
+		if (m_fd >= 0)
+		{
+			if (m_writable && ftruncate(m_fd, static_cast<off_t>(finalSize)) != 0)
+				std::cout << TAB2 << "Failed to release unused space\n";
+			close(m_fd);
+		}
+		m_fd = -1;
+#endif
+		m_pData = NULL;
+		m_size = 0;
+	}
+
+	uint8_t* GetData() const { return m_pData; }
+	uint64_t GetSize() const { return m_size; }
+
+private:
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+	uint8_t* m_pData;
+	uint64_t m_size;
+	bool m_writable;
+#if defined(_WIN32)
+	HANDLE m_hFile;
+	HANDLE m_hMapping;
+#else
+	int m_fd;
+#endif
+};
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- RECORDER -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// raw segment writer
+//    Appends frames to the current segment, rolling over to a new segment
+//    when the next frame does not fit. A full segment is finalized (flushed,
+//    unmapped and cut down to its data) on a background thread while
+//    recording continues in the next one.
+class RawSegmentWriter
+{
+public:
+	RawSegmentWriter(const std::string& directory, const std::string& prefix, uint64_t segmentSize) :
+		m_directory(directory),
+		m_prefix(prefix),
+		m_segmentSize(segmentSize),
+		m_numSegments(0),
+		m_numFrames(0),
+		m_numBytes(0),
+		m_pSegment(NULL),
+		m_pHeader(NULL)
+	{
+		CreateDirectories(directory);
+
+		// remove segments of an earlier recording with the same prefix, which
+		// the reader would otherwise take as part of this one
+		for (size_t i = 0; std::remove(GetSegmentFileName(directory, prefix, i).c_str()) == 0; i++)
+		{
+		}
+	}
+
+	~RawSegmentWriter()
+	{
+		Close();
+	}
+
+	// appends a frame
+	// (1) measures record
+	// (2) rolls over to new segment if needed
+	// (3) writes header, image and chunk data
+	// (4) commits frame in segment header
+	//    Returns the frame's index in the recording.
+	uint64_t Append(Arena::IImage* pImage)
+	{
+		// Measure record
+		//    Chunk data, if any, is whatever the buffer holds beyond the
+		//    image itself.
+		uint64_t sizeFilled = pImage->GetSizeFilled();
+		uint64_t imageSize = (pImage->GetWidth() * pImage->GetBitsPerPixel() / 8 + pImage->GetPaddingX()) * pImage->GetHeight();
+		if (imageSize > sizeFilled || !pImage->HasChunkData())
+			imageSize = sizeFilled;
+		uint64_t chunkSize = sizeFilled - imageSize;
+		uint64_t recordSize = AlignUp(sizeof(FrameHeader) + sizeFilled, RECORD_ALIGNMENT);
+
+		if (recordSize > m_segmentSize - AlignUp(sizeof(SegmentHeader), RECORD_ALIGNMENT))
+			throw GenICam::GenericException("Frame larger than segment", __FILE__, __LINE__);
+
+		// Roll over
+		if (!m_pHeader || m_pHeader->dataEnd + recordSize > m_segmentSize)
+			OpenNextSegment();
+
+		// Write record
+		//    The one and only copy: from the stream buffer into the mapping.
+		uint8_t* pRecord = m_pSegment->GetData() + m_pHeader->dataEnd;
+		FrameHeader* pFrameHeader = reinterpret_cast<FrameHeader*>(pRecord);
+
+		pFrameHeader->magic = FRAME_MAGIC;
+		pFrameHeader->headerSize = sizeof(FrameHeader);
+		pFrameHeader->frameId = pImage->GetFrameId();
+		pFrameHeader->timestampNs = pImage->GetTimestampNs();
+		pFrameHeader->pixelFormat = pImage->GetPixelFormat();
+		pFrameHeader->width = static_cast<uint32_t>(pImage->GetWidth());
+		pFrameHeader->height = static_cast<uint32_t>(pImage->GetHeight());
+		pFrameHeader->offsetX = static_cast<uint32_t>(pImage->GetOffsetX());
+		pFrameHeader->offsetY = static_cast<uint32_t>(pImage->GetOffsetY());
+		pFrameHeader->paddingX = static_cast<uint32_t>(pImage->GetPaddingX());
+		pFrameHeader->flags = pImage->IsIncomplete() ? FRAME_FLAG_INCOMPLETE : 0;
+		pFrameHeader->imageSize = imageSize;
+		pFrameHeader->chunkSize = chunkSize;
+
+		memcpy(pRecord + sizeof(FrameHeader), pImage->GetData(), static_cast<size_t>(sizeFilled));
+
+		// Commit frame
+		m_pHeader->dataEnd += recordSize;
+		m_pHeader->numFrames++;
+		m_numBytes += recordSize;
+
+		return m_numFrames++;
+	}
+
+	// Closes the recording
+	//    Finalizes the current segment and waits for any segment still being
+	//    finalized in the background.
+	void Close()
+	{
+		if (m_pSegment)
+		{
+			m_pSegment->Close(m_pHeader->dataEnd);
+			delete m_pSegment;
+			m_pSegment = NULL;
+			m_pHeader = NULL;
+		}
+
+		WaitForFinalizer();
+	}
+
+	uint64_t GetNumFrames() const { return m_numFrames; }
+	uint64_t GetNumBytes() const { return m_numBytes; }
+	size_t GetNumSegments() const { return m_numSegments; }
+
+private:
+	void OpenNextSegment()
+	{
+		FinalizeInBackground();
+
+		MappedFile* pSegment = new MappedFile();
+		try
+		{
+			pSegment->Create(GetSegmentFileName(m_directory, m_prefix, m_numSegments), m_segmentSize);
+		}
+		catch (...)
+		{
+			delete pSegment;
+			throw;
+		}
+		m_pSegment = pSegment;
+
+		m_pHeader = reinterpret_cast<SegmentHeader*>(m_pSegment->GetData());
+		memset(m_pHeader, 0, sizeof(SegmentHeader));
+		memcpy(m_pHeader->magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+		m_pHeader->version = SEGMENT_VERSION;
+		m_pHeader->headerSize = sizeof(SegmentHeader);
+		m_pHeader->segmentIndex = m_numSegments;
+		m_pHeader->numFrames = 0;
+		m_pHeader->dataEnd = AlignUp(sizeof(SegmentHeader), RECORD_ALIGNMENT);
+
+		m_numSegments++;
+	}
+
+	// Finalizes the current segment in the background
+	//    Flushing a full segment (msync) and releasing its unused space
+	//    (ftruncate) can take hundreds of milliseconds. The previous
+	//    finalization has had a whole segment's worth of frames to finish,
+	//    so waiting for it here rarely blocks.
+	void FinalizeInBackground()
+	{
+		if (!m_pSegment)
+			return;
+
+		MappedFile* pSegment = m_pSegment;
+		uint64_t dataEnd = m_pHeader->dataEnd;
+		m_pSegment = NULL;
+		m_pHeader = NULL;
+
+		WaitForFinalizer();
+
+		try
+		{
+			m_finalizer = std::thread([pSegment, dataEnd]() {
+				pSegment->Close(dataEnd);
+				delete pSegment;
+			});
+		}
+		catch (...)
+		{
+			pSegment->Close(dataEnd);
+			delete pSegment;
+			throw;
+		}
+	}
+
+	void WaitForFinalizer()
+	{
+		if (m_finalizer.joinable())
+			m_finalizer.join();
+	}
+
+	std::string m_directory;
+	std::string m_prefix;
+	uint64_t m_segmentSize;
+	size_t m_numSegments;
+	uint64_t m_numFrames;
+	uint64_t m_numBytes;
+	MappedFile* m_pSegment;
+	SegmentHeader* m_pHeader;
+	std::thread m_finalizer;
+};
+
+// recorded frame
+//    Points into a mapped segment and stays valid while the reader is open.
+struct RecordedFrame
+{
+	const FrameHeader* pHeader;
+	const uint8_t* pImageData;
+	const uint8_t* pChunkData;
+};
+
+// raw segment reader
+//    Maps every segment of a recording and indexes its frames by walking the
+//    frame headers once.
+class RawSegmentReader
+{
+public:
+	RawSegmentReader(const std::string& directory, const std::string& prefix)
+	{
+		// Map and index segments
+		//    The destructor does not run if the constructor throws, so
+		//    segments mapped so far are released here.
+		try
+		{
+			for (size_t i = 0;; i++)
+			{
+				m_segments.push_back(new MappedFile());
+				if (!m_segments.back()->Open(GetSegmentFileName(directory, prefix, i)))
+				{
+					delete m_segments.back();
+					m_segments.pop_back();
+					break;
+				}
+				IndexSegment(*m_segments.back());
+			}
+		}
+		catch (...)
+		{
+			Clear();
+			throw;
+		}
+	}
+
+	~RawSegmentReader()
+	{
+		Clear();
+	}
+
+	size_t GetNumFrames() const { return m_index.size(); }
+	size_t GetNumSegments() const { return m_segments.size(); }
+
+	// gets a frame by index
+	RecordedFrame GetFrame(size_t index) const
+	{
+		if (index >= m_index.size())
+			throw GenICam::GenericException("Frame index out of range", __FILE__, __LINE__);
+
+		const uint8_t* pRecord = m_index[index];
+		RecordedFrame frame;
+		frame.pHeader = reinterpret_cast<const FrameHeader*>(pRecord);
+		frame.pImageData = pRecord + frame.pHeader->headerSize;
+		frame.pChunkData = frame.pHeader->chunkSize > 0 ? frame.pImageData + frame.pHeader->imageSize : NULL;
+		return frame;
+	}
+
+	// creates an image from a frame
+	//    Allows a recorded frame to be converted or saved like any other
+	//    image. Destroy with Arena::ImageFactory::Destroy.
+	Arena::IImage* CreateImage(size_t index) const
+	{
+		RecordedFrame frame = GetFrame(index);
+
+		if (static_cast<uint64_t>(frame.pHeader->width) * frame.pHeader->height * Arena::GetBitsPerPixel(frame.pHeader->pixelFormat) / 8 > frame.pHeader->imageSize)
+			throw GenICam::GenericException("Recorded image smaller than its geometry", __FILE__, __LINE__);
+
+		return Arena::ImageFactory::Create(
+			frame.pImageData,
+			static_cast<size_t>(frame.pHeader->imageSize),
+			frame.pHeader->width,
+			frame.pHeader->height,
+			frame.pHeader->pixelFormat);
+	}
+
+private:
+	// Indexes the frames of a segment
+	//    Every record must lie wholly inside the segment's data. A record
+	//    that does not ends the segment: the frames before it are intact,
+	//    but nothing after it can be trusted (e.g. after power loss).
+	void IndexSegment(const MappedFile& segment)
+	{
+		const uint8_t* pData = segment.GetData();
+		const SegmentHeader* pHeader = reinterpret_cast<const SegmentHeader*>(pData);
+
+		if (segment.GetSize() < sizeof(SegmentHeader) || memcmp(pHeader->magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0 || pHeader->version != SEGMENT_VERSION ||
+			pHeader->headerSize < sizeof(SegmentHeader) || pHeader->headerSize > segment.GetSize())
+			throw GenICam::GenericException("Not a raw segment file", __FILE__, __LINE__);
+
+		uint64_t offset = AlignUp(pHeader->headerSize, RECORD_ALIGNMENT);
+		uint64_t end = pHeader->dataEnd < segment.GetSize() ? pHeader->dataEnd : segment.GetSize();
+
+		for (uint64_t i = 0; i < pHeader->numFrames && offset < end && end - offset >= sizeof(FrameHeader); i++)
+		{
+			const FrameHeader* pFrameHeader = reinterpret_cast<const FrameHeader*>(pData + offset);
+			uint64_t available = end - offset;
+
+			if (pFrameHeader->magic != FRAME_MAGIC || pFrameHeader->headerSize < sizeof(FrameHeader) || pFrameHeader->headerSize > available ||
+				pFrameHeader->imageSize > available - pFrameHeader->headerSize ||
+				pFrameHeader->chunkSize > available - pFrameHeader->headerSize - pFrameHeader->imageSize)
+				break;
+
+			m_index.push_back(pData + offset);
+			offset += AlignUp(pFrameHeader->headerSize + pFrameHeader->imageSize + pFrameHeader->chunkSize, RECORD_ALIGNMENT);
+		}
+	}
+
+	void Clear()
+	{
+		for (size_t i = 0; i < m_segments.size(); i++)
+			delete m_segments[i];
+		m_segments.clear();
+		m_index.clear();
+	}
+
+	std::vector<MappedFile*> m_segments;
+	std::vector<const uint8_t*> m_index;
+};
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// demonstrates recording raw segments
+// (1) starts stream
+// (2) appends each image to segments
+// (3) stops stream and closes recording
+// (4) opens recording and reads frames by index
+void RecordRawSegments(Arena::IDevice* pDevice)
+{
+	// start stream
+	std::cout << TAB1 << "Start stream with " << NUM_BUFFERS << " buffers\n";
+
+	pDevice->StartStream(NUM_BUFFERS);
+
+	// Record images
+	//    Buffers are requeued as soon as they are copied, so recording holds
+	//    on to none of them.
+	std::cout << TAB1 << "Record " << NUM_IMAGES << " images to " << SEGMENT_DIRECTORY << "/" << SEGMENT_PREFIX << "_*.seg\n";
+
+	{
+		RawSegmentWriter writer(SEGMENT_DIRECTORY, SEGMENT_PREFIX, SEGMENT_SIZE);
+		std::chrono::duration<double> appendTime(0);
+
+		for (size_t i = 0; i < NUM_IMAGES; i++)
+		{
+			Arena::IImage* pImage = pDevice->GetImage(IMAGE_TIMEOUT);
+
+			auto start = std::chrono::steady_clock::now();
+			writer.Append(pImage);
+			appendTime += std::chrono::steady_clock::now() - start;
+
+			pDevice->RequeueBuffer(pImage);
+		}
+
+		writer.Close();
+
+		std::cout << TAB2 << writer.GetNumFrames() << " frames, " << writer.GetNumBytes() / (1024 * 1024) << " MiB in "
+				  << writer.GetNumSegments() << " segment(s) (" << writer.GetNumBytes() / appendTime.count() / (1024 * 1024)
+				  << " MiB/s while appending)\n";
+	}
+
+	// stop stream
+	std::cout << TAB1 << "Stop stream\n";
+
+	pDevice->StopStream();
+
+	// Read recording
+	//    Frames are found through the index, so any frame can be read without
+	//    touching the others.
+	std::cout << TAB1 << "Read recording\n";
+
+	RawSegmentReader reader(SEGMENT_DIRECTORY, SEGMENT_PREFIX);
+
+	std::cout << TAB2 << reader.GetNumFrames() << " frames in " << reader.GetNumSegments() << " segment(s)\n";
+
+	if (reader.GetNumFrames() == 0)
+		return;
+
+	size_t indices[] = { 0, reader.GetNumFrames() / 2, reader.GetNumFrames() - 1 };
+
+	for (size_t i = 0; i < sizeof(indices) / sizeof(indices[0]); i++)
+	{
+		RecordedFrame frame = reader.GetFrame(indices[i]);
+
+		std::cout << TAB2 << "Frame " << indices[i] << ": ID " << frame.pHeader->frameId << ", timestamp "
+				  << frame.pHeader->timestampNs << " ns, " << frame.pHeader->width << "x" << frame.pHeader->height << " "
+				  << GetPixelFormatName(static_cast<PfncFormat>(frame.pHeader->pixelFormat)) << ", "
+				  << frame.pHeader->chunkSize << " bytes of chunk data\n";
+	}
+
+	// Create image from frame
+	Arena::IImage* pLast = reader.CreateImage(reader.GetNumFrames() - 1);
+
+	std::cout << TAB2 << "Created " << pLast->GetWidth() << "x" << pLast->GetHeight() << " image from last frame\n";
+
+	Arena::ImageFactory::Destroy(pLast);
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_Record_RawSegments\n";
+
+	try
+	{
+		// prepare example
+		Arena::ISystem* pSystem = Arena::OpenSystem();
+		pSystem->UpdateDevices(SYSTEM_TIMEOUT);
+		std::vector<Arena::DeviceInfo> deviceInfos = pSystem->GetDevices();
+		if (deviceInfos.size() == 0)
+		{
+			std::cout << "\nNo camera connected\nPress enter to complete\n";
+			std::getchar();
+			return 0;
+		}
+		Arena::IDevice* pDevice = pSystem->CreateDevice(deviceInfos[0]);
+
+		// run example
+		std::cout << "Commence example\n\n";
+		RecordRawSegments(pDevice);
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		pSystem->DestroyDevice(pDevice);
+		Arena::CloseSystem(pSystem);
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
@@ -0,0 +1,458 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaApi.h"
+#include "SaveApi.h"
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstring>
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Save: Asynchronous
+//    This example demonstrates saving images without blocking acquisition.
+//    Save::ImageWriter encodes and writes each image on the calling thread,
+//    so saving PNG or JPEG from the acquisition loop stalls it long enough to
+//    drop frames. AsyncImageWriter copies each image into a bounded queue and
+//    returns immediately; a configurable number of encoder threads, each with
+//    its own image writer, drain the queue. File names are resolved when an
+//    image is queued, so tags such as <count>, <datetime> and <serial> reflect
+//    the moment of acquisition rather than the moment of encoding. When the
+//    queue is full, the writer either waits for room, drops the oldest queued
+//    image, or drops the new image. Flush waits until everything queued so far
+//    is on disk.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// File name pattern
+//    Tags are resolved when an image is queued. The image writer chooses the
+//    file format by the pattern's extension.
+#define FILE_NAME_PATTERN "Images/Cpp_Save_Async/<serial>_image<count>-<datetime:yyMMdd_hhmmss_fff>.png"
+
+// pixel format
+#define PIXEL_FORMAT BGR8
+
+// number of images to acquire and save
+#define NUM_IMAGES 100
+
+// number of encoder threads
+#define NUM_ENCODERS 4
+
+// queue capacity
+//    Number of images that may wait for an encoder. Each queued image holds a
+//    copy of its data.
+#define QUEUE_CAPACITY 16
+
+// backpressure policy when queue is full
+//    Block: wait for room (no image lost, acquisition may stall)
+//    DropOldest: discard oldest queued image (keeps newest images)
+//    DropNewest: discard image being queued (keeps oldest images)
+#define BACKPRESSURE_POLICY DropOldest
+
+// system timeout
+#define SYSTEM_TIMEOUT 100
+
+// image timeout
+#define IMAGE_TIMEOUT 2000
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// backpressure policy
+enum EBackpressure
+{
+	Block,
+	DropOldest,
+	DropNewest
+};
+
+// asynchronous image writer
+//    Built from a configured Save::ImageWriter (parameters, file name pattern,
+//    format settings and tags). One copy of it names images on the calling
+//    thread; every encoder thread encodes with a copy of its own.
+class AsyncImageWriter
+{
+public:
+	AsyncImageWriter(const Save::ImageWriter& prototype, size_t numEncoders, size_t capacity, EBackpressure policy) :
+		m_namer(prototype),
+		m_capacity(capacity > 0 ? capacity : 1),
+		m_policy(policy),
+		m_stop(false),
+		m_numEncoding(0),
+		m_numSaved(0),
+		m_numDropped(0),
+		m_numErrors(0)
+	{
+		Save::ImageParams params = m_namer.GetParams();
+		m_imageSize = params.GetWidth() * params.GetHeight() * params.GetBitsPerPixel() / 8;
+
+		for (size_t i = 0; i < numEncoders; i++)
+			m_encoders.push_back(std::thread(&AsyncImageWriter::EncoderThread, this, prototype));
+	}
+
+	~AsyncImageWriter()
+	{
+		Flush();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_notEmpty.notify_all();
+
+		for (size_t i = 0; i < m_encoders.size(); i++)
+			m_encoders[i].join();
+	}
+
+	// updates a tag
+	//    Affects images queued from now on.
+	void UpdateTag(const char* pTag, const char* pValue)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_namer.UpdateTag(pTag, pValue);
+	}
+
+	// queues an image
+	// (1) resolves file name
+	// (2) makes room according to policy
+	// (3) copies image into a recycled buffer
+	//    Returns false if the image was dropped.
+	bool Save(const uint8_t* pData)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		// Make room
+		if (m_queue.size() >= m_capacity)
+		{
+			if (m_policy == Block)
+			{
+				m_notFull.wait(lock, [this]() { return m_queue.size() < m_capacity; });
+			}
+			else if (m_policy == DropOldest)
+			{
+				m_free.push_back(std::move(m_queue.front().data));
+				m_queue.pop_front();
+				m_numDropped++;
+			}
+			else
+			{
+				m_numDropped++;
+				return false;
+			}
+		}
+
+		// Resolve file name
+		//    Peeking resolves every tag with its current value; the counters
+		//    are then advanced by hand since the namer never saves.
+		Job job;
+		job.fileName = m_namer.PeekFileName(true, true);
+		m_namer.SetCount(m_namer.PeekCount(Save::Local) + 1, Save::Local);
+		m_namer.SetCount(m_namer.PeekCount(Save::Path) + 1, Save::Path);
+
+		// Copy image
+		//    Buffers of dropped and saved images are reused, so a steady
+		//    stream does not allocate.
+		if (!m_free.empty())
+		{
+			job.data = std::move(m_free.back());
+			m_free.pop_back();
+		}
+		job.data.resize(m_imageSize);
+		memcpy(job.data.data(), pData, m_imageSize);
+
+		m_lastFileName = job.fileName;
+		m_queue.push_back(std::move(job));
+		lock.unlock();
+
+		m_notEmpty.notify_one();
+		return true;
+	}
+
+	// waits until every queued image is saved
+	void Flush()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_idle.wait(lock, [this]() { return m_queue.empty() && m_numEncoding == 0; });
+	}
+
+	std::string GetLastFileName()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_lastFileName;
+	}
+
+	size_t GetNumQueued()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_queue.size() + m_numEncoding;
+	}
+
+	size_t GetNumSaved()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_numSaved;
+	}
+
+	size_t GetNumDropped()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_numDropped;
+	}
+
+	size_t GetNumErrors()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_numErrors;
+	}
+
+	std::string GetLastError()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_lastError;
+	}
+
+private:
+	struct Job
+	{
+		std::string fileName;
+		std::vector<uint8_t> data;
+	};
+
+	void EncoderThread(Save::ImageWriter writer)
+	{
+		while (true)
+		{
+			// wait for job
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_notEmpty.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+				if (m_queue.empty())
+					return;
+
+				job = std::move(m_queue.front());
+				m_queue.pop_front();
+				m_numEncoding++;
+			}
+			m_notFull.notify_one();
+
+			// Encode and write
+			//    The resolved file name contains no tags, so it is used as the
+			//    pattern as is.
+			std::string error;
+			try
+			{
+				writer.SetFileNamePattern(job.fileName.c_str());
+				writer.Save(job.data.data());
+			}
+			catch (GenICam::GenericException& ge)
+			{
+				error = ge.GetDescription();
+			}
+			catch (std::exception& ex)
+			{
+				error = ex.what();
+			}
+
+			// recycle buffer
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (error.empty())
+				{
+					m_numSaved++;
+				}
+				else
+				{
+					m_numErrors++;
+					m_lastError = job.fileName + ": " + error;
+				}
+				m_free.push_back(std::move(job.data));
+				m_numEncoding--;
+			}
+			m_idle.notify_all();
+		}
+	}
+
+	Save::ImageWriter m_namer;
+	size_t m_imageSize;
+	size_t m_capacity;
+	EBackpressure m_policy;
+	std::vector<std::thread> m_encoders;
+
+	std::mutex m_mutex;
+	std::condition_variable m_notEmpty;
+	std::condition_variable m_notFull;
+	std::condition_variable m_idle;
+	std::deque<Job> m_queue;
+	std::vector<std::vector<uint8_t>> m_free;
+	bool m_stop;
+	size_t m_numEncoding;
+	size_t m_numSaved;
+	size_t m_numDropped;
+	size_t m_numErrors;
+	std::string m_lastFileName;
+	std::string m_lastError;
+};
+
+// demonstrates asynchronous saving
+// (1) prepares image writer with parameters, pattern and tags
+// (2) starts encoder threads
+// (3) starts stream and queues each image
+// (4) stops stream
+// (5) flushes queue
+void AcquireAndSaveImagesAsync(Arena::IDevice* pDevice)
+{
+	// Prepare image writer
+	//    Width and height come from the device; bits per pixel come from the
+	//    pixel format images are converted to.
+	std::cout << TAB1 << "Prepare image writer\n";
+
+	Save::ImageParams params(
+		static_cast<size_t>(Arena::GetNodeValue<int64_t>(pDevice->GetNodeMap(), "Width")),
+		static_cast<size_t>(Arena::GetNodeValue<int64_t>(pDevice->GetNodeMap(), "Height")),
+		Arena::GetBitsPerPixel(PIXEL_FORMAT));
+
+	Save::ImageWriter prototype(params, FILE_NAME_PATTERN);
+
+	GenICam::gcstring serial = Arena::GetNodeValue<GenICam::gcstring>(pDevice->GetNodeMap(), "DeviceSerialNumber");
+	prototype << "<serial>" << serial;
+
+	// Start encoder threads
+	std::cout << TAB1 << "Start " << NUM_ENCODERS << " encoder threads (queue of " << QUEUE_CAPACITY << ")\n";
+
+	AsyncImageWriter writer(prototype, NUM_ENCODERS, QUEUE_CAPACITY, BACKPRESSURE_POLICY);
+
+	// start stream
+	std::cout << TAB1 << "Start stream\n";
+
+	pDevice->StartStream();
+
+	// Queue images
+	//    Queuing costs a copy, so the acquisition loop keeps pace with the
+	//    camera however long encoding takes.
+	std::cout << TAB1 << "Get and queue " << NUM_IMAGES << " images\n";
+
+	std::chrono::duration<double, std::milli> queueTime(0);
+
+	for (size_t i = 0; i < NUM_IMAGES; i++)
+	{
+		Arena::IImage* pImage = pDevice->GetImage(IMAGE_TIMEOUT);
+		Arena::IImage* pConverted = Arena::ImageFactory::Convert(pImage, PIXEL_FORMAT);
+
+		auto start = std::chrono::steady_clock::now();
+		bool queued = writer.Save(pConverted->GetData());
+		queueTime += std::chrono::steady_clock::now() - start;
+
+		if (queued)
+			std::cout << TAB2 << "Queue image " << i << " as " << writer.GetLastFileName() << "\n";
+		else
+			std::cout << TAB2 << "Drop image " << i << "\n";
+
+		Arena::ImageFactory::Destroy(pConverted);
+		pDevice->RequeueBuffer(pImage);
+	}
+
+	std::cout << TAB2 << queueTime.count() / NUM_IMAGES << " ms per image spent queuing, "
+			  << writer.GetNumQueued() << " images still queued\n";
+
+	// stop stream
+	std::cout << TAB1 << "Stop stream\n";
+
+	pDevice->StopStream();
+
+	// Flush queue
+	//    Waits for the encoders to catch up before the writer goes out of
+	//    scope.
+	std::cout << TAB1 << "Flush queue\n";
+
+	auto start = std::chrono::steady_clock::now();
+	writer.Flush();
+	std::chrono::duration<double, std::milli> flushTime = std::chrono::steady_clock::now() - start;
+
+	std::cout << TAB2 << writer.GetNumSaved() << " saved, " << writer.GetNumDropped() << " dropped, "
+			  << writer.GetNumErrors() << " failed (flush took " << flushTime.count() << " ms)\n";
+
+	if (writer.GetNumErrors() > 0)
+		std::cout << TAB2 << "Last error: " << writer.GetLastError() << "\n";
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_Save_Async\n";
+
+	try
+	{
+		// prepare example
+		Arena::ISystem* pSystem = Arena::OpenSystem();
+		pSystem->UpdateDevices(SYSTEM_TIMEOUT);
+		std::vector<Arena::DeviceInfo> deviceInfos = pSystem->GetDevices();
+		if (deviceInfos.size() == 0)
+		{
+			std::cout << "\nNo camera connected\nPress enter to complete\n";
+			std::getchar();
+			return 0;
+		}
+		Arena::IDevice* pDevice = pSystem->CreateDevice(deviceInfos[0]);
+
+		// run example
+		std::cout << "Commence example\n\n";
+		AcquireAndSaveImagesAsync(pDevice);
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		pSystem->DestroyDevice(pDevice);
+		Arena::CloseSystem(pSystem);
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
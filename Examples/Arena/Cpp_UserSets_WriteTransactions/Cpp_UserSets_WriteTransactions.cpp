@@ -0,0 +1,554 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "../GenTLHelpers.h"
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <utility>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// User Sets: Write Transactions
+//    This example demonstrates composing a camera mode switch as one
+//    transaction instead of a string of independent feature writes. Features
+//    are set through GenApi as usual, but inside a transaction the port
+//    records register writes instead of sending them. Nothing is written to
+//    the device until the transaction commits, so a switch that fails while
+//    it is being composed leaves the camera as it was, and a write that
+//    directly follows a write to the same register replaces it. Range and
+//    access checks see the pending values only of registers written in the
+//    transaction; limits the device computes from them, such as an
+//    'ExposureTime' maximum that depends on a pending 'AcquisitionFrameRate',
+//    are read from the device and stay stale until the transaction commits.
+//    The grouping happens in software only: on commit, the recorded writes
+//    are sent in order, one register per request, because the GenTL producer
+//    underneath Arena does not implement stacked writes
+//    (GenTL::GCWritePortStacked). A commit therefore costs about as many
+//    round trips as the writes it holds. The example switches between two
+//    recipes feature by feature and in transactions, and counts the requests
+//    each way.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// number of recipe switches to time each way
+#define NUM_SWITCHES 20
+
+// discovery timeout
+#define DISCOVERY_TIMEOUT 100
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// port to the remote device, with transactions
+//    GenApi reads and writes device registers through a port. Outside a
+//    transaction, this forwards each access to the GenTL producer straight
+//    away. Inside one, writes are recorded and sent together on commit.
+//    Reads still reach the device, but see the recorded writes laid over
+//    what the device returns: GenApi reads registers back to check ranges
+//    and access modes that depend on features set earlier in the same
+//    transaction (e.g. 'ExposureTime' becomes writable once 'ExposureAuto'
+//    is off), and those checks must see the pending values. Only registers
+//    written in the transaction are overlaid; a register the device derives
+//    from pending values still holds the value it had before.
+class TransactionPort : public GenApi::IPort
+{
+public:
+	TransactionPort(GenTL::PORT_HANDLE hPort) :
+		m_hPort(hPort),
+		m_recording(false),
+		m_reads(0),
+		m_writes(0),
+		m_requests(0)
+	{
+	}
+
+	virtual ~TransactionPort() {};
+
+	virtual GenApi::EAccessMode GetAccessMode() const
+	{
+		return GenApi::RW;
+	}
+
+	virtual void Read(void* pBuffer, int64_t address, int64_t length)
+	{
+		// a register fully covered by a pending write need not be read
+		if (!IsCovered(address, length))
+		{
+			size_t size = static_cast<size_t>(length);
+			CheckGC(GenTL::GCReadPort(m_hPort, static_cast<uint64_t>(address), pBuffer, &size), "GCReadPort");
+			m_reads++;
+			m_requests++;
+		}
+
+		Overlay(static_cast<uint8_t*>(pBuffer), address, length);
+	}
+
+	virtual void Write(const void* pBuffer, int64_t address, int64_t length)
+	{
+		if (!m_recording)
+		{
+			size_t size = static_cast<size_t>(length);
+			CheckGC(GenTL::GCWritePort(m_hPort, static_cast<uint64_t>(address), pBuffer, &size), "GCWritePort");
+			m_writes++;
+			m_requests++;
+			return;
+		}
+
+		// Record write
+		//    A write that directly follows a write to the same register
+		//    replaces it. Writes are otherwise kept in order, even repeated
+		//    ones: between two writes to a selected feature's register, a
+		//    selector may have moved on to another instance of the feature.
+		const uint8_t* pBytes = static_cast<const uint8_t*>(pBuffer);
+		if (!m_pending.empty() && m_pending.back().address == address && m_pending.back().data.size() == static_cast<size_t>(length))
+		{
+			m_pending.back().data.assign(pBytes, pBytes + length);
+			return;
+		}
+
+		PendingWrite write;
+		write.address = address;
+		write.data.assign(pBytes, pBytes + length);
+		m_pending.push_back(write);
+	}
+
+	void Begin()
+	{
+		m_pending.clear();
+		m_recording = true;
+	}
+
+	// Commit
+	// (1) stops recording
+	// (2) sends recorded writes, in order, one register per request
+	size_t Commit()
+	{
+		m_recording = false;
+
+		std::vector<PendingWrite> pending;
+		pending.swap(m_pending);
+
+		for (size_t i = 0; i < pending.size(); i++)
+		{
+			size_t size = pending[i].data.size();
+			CheckGC(GenTL::GCWritePort(m_hPort, static_cast<uint64_t>(pending[i].address), pending[i].data.data(), &size), "GCWritePort");
+			m_writes++;
+			m_requests++;
+		}
+
+		return pending.size();
+	}
+
+	void Discard()
+	{
+		m_pending.clear();
+		m_recording = false;
+	}
+
+	// Access counts
+	//    Reads and writes count registers; requests count calls into the
+	//    producer, each of which waits for the device at least once.
+	uint64_t GetReads() const { return m_reads; }
+	uint64_t GetWrites() const { return m_writes; }
+	uint64_t GetRequests() const { return m_requests; }
+
+	void ResetCounts()
+	{
+		m_reads = 0;
+		m_writes = 0;
+		m_requests = 0;
+	}
+
+private:
+	struct PendingWrite
+	{
+		int64_t address;
+		std::vector<uint8_t> data;
+	};
+
+	bool IsCovered(int64_t address, int64_t length) const
+	{
+		for (size_t i = 0; i < m_pending.size(); i++)
+		{
+			int64_t end = m_pending[i].address + static_cast<int64_t>(m_pending[i].data.size());
+			if (m_pending[i].address <= address && address + length <= end)
+				return true;
+		}
+		return false;
+	}
+
+	// lays pending writes over read data, later writes over earlier ones
+	void Overlay(uint8_t* pBuffer, int64_t address, int64_t length) const
+	{
+		for (size_t i = 0; i < m_pending.size(); i++)
+		{
+			int64_t begin = std::max(address, m_pending[i].address);
+			int64_t end = std::min(address + length, m_pending[i].address + static_cast<int64_t>(m_pending[i].data.size()));
+			if (begin < end)
+				memcpy(pBuffer + (begin - address), m_pending[i].data.data() + (begin - m_pending[i].address), static_cast<size_t>(end - begin));
+		}
+	}
+
+	GenTL::PORT_HANDLE m_hPort;
+	bool m_recording;
+	std::vector<PendingWrite> m_pending;
+	uint64_t m_reads;
+	uint64_t m_writes;
+	uint64_t m_requests;
+};
+
+// Write transaction
+//    Records the feature writes made while it is open and sends them on
+//    commit. GenApi caches the values it writes, so a transaction that is
+//    dropped without committing, or whose commit fails, invalidates the
+//    node map; values are then read from the device again.
+//
+//    Commands executed inside a transaction only run on commit, and the
+//    node map does not see side effects of a write (e.g. a new payload size)
+//    until then.
+class WriteTransaction
+{
+public:
+	WriteTransaction(TransactionPort& port, GenApi::CNodeMapRef& nodeMap) :
+		m_port(port),
+		m_nodeMap(nodeMap),
+		m_open(true)
+	{
+		m_port.Begin();
+	}
+
+	~WriteTransaction()
+	{
+		if (m_open)
+		{
+			m_port.Discard();
+			m_nodeMap._InvalidateNodes();
+		}
+	}
+
+	size_t Commit()
+	{
+		m_open = false;
+		try
+		{
+			return m_port.Commit();
+		}
+		catch (...)
+		{
+			m_nodeMap._InvalidateNodes();
+			throw;
+		}
+	}
+
+private:
+	WriteTransaction(const WriteTransaction&) = delete;
+	WriteTransaction& operator=(const WriteTransaction&) = delete;
+
+	TransactionPort& m_port;
+	GenApi::CNodeMapRef& m_nodeMap;
+	bool m_open;
+};
+
+// Recipe
+//    A camera mode as an ordered list of feature settings. Order matters in
+//    the same way as when setting features one at a time: selectors come
+//    before the features they select, and automatic modes are turned off
+//    before the values they would otherwise control.
+typedef std::vector<std::pair<std::string, std::string>> Recipe;
+
+const Recipe RECIPE_A = {
+	{ "TriggerSelector", "FrameStart" },
+	{ "TriggerMode", "Off" },
+	{ "ExposureAuto", "Off" },
+	{ "ExposureTime", "5000" },
+	{ "GainAuto", "Off" },
+	{ "Gain", "0" },
+	{ "AcquisitionFrameRateEnable", "1" },
+	{ "AcquisitionFrameRate", "20" },
+	{ "PixelFormat", "Mono8" },
+	{ "ReverseX", "0" },
+	{ "ReverseY", "0" },
+};
+
+const Recipe RECIPE_B = {
+	{ "TriggerSelector", "FrameStart" },
+	{ "TriggerMode", "On" },
+	{ "TriggerSource", "Software" },
+	{ "ExposureAuto", "Off" },
+	{ "ExposureTime", "12000" },
+	{ "GainAuto", "Off" },
+	{ "Gain", "6" },
+	{ "AcquisitionFrameRateEnable", "1" },
+	{ "AcquisitionFrameRate", "10" },
+	{ "PixelFormat", "Mono8" },
+	{ "ReverseX", "1" },
+	{ "ReverseY", "1" },
+};
+
+// applies a recipe
+//    Features the device does not have, or cannot write at that point, are
+//    skipped so that one recipe serves several camera models. Returns the
+//    number of features set.
+size_t ApplyRecipe(GenApi::CNodeMapRef& nodeMap, const Recipe& recipe)
+{
+	size_t applied = 0;
+	for (size_t i = 0; i < recipe.size(); i++)
+	{
+		GenApi::CValuePtr pValue = nodeMap._GetNode(recipe[i].first.c_str());
+		if (!pValue || !GenApi::IsWritable(pValue))
+			continue;
+
+		pValue->FromString(recipe[i].second.c_str());
+		applied++;
+	}
+	return applied;
+}
+
+// reads the current values of the features of a recipe
+Recipe ReadRecipe(GenApi::CNodeMapRef& nodeMap, const Recipe& recipe)
+{
+	Recipe values;
+	for (size_t i = 0; i < recipe.size(); i++)
+	{
+		GenApi::CValuePtr pValue = nodeMap._GetNode(recipe[i].first.c_str());
+		if (pValue && GenApi::IsReadable(pValue))
+			values.push_back(std::make_pair(recipe[i].first, std::string(pValue->ToString().c_str())));
+	}
+	return values;
+}
+
+// finds a feature in a recipe
+size_t IndexOf(const Recipe& recipe, const std::string& name)
+{
+	for (size_t i = 0; i < recipe.size(); i++)
+	{
+		if (recipe[i].first == name)
+			return i;
+	}
+	return recipe.size();
+}
+
+// Compare values
+//    Devices round floating point values to their own increments and print
+//    booleans their own way, so numbers match within a small tolerance and
+//    'True' matches '1'.
+bool ToNumber(std::string text, double& number)
+{
+	std::transform(text.begin(), text.end(), text.begin(), ::tolower);
+	if (text == "true" || text == "false")
+	{
+		number = text == "true" ? 1.0 : 0.0;
+		return true;
+	}
+
+	char* pEnd = NULL;
+	number = std::strtod(text.c_str(), &pEnd);
+	return !text.empty() && *pEnd == '\0';
+}
+
+bool Matches(const std::string& expected, const std::string& actual)
+{
+	double expectedNumber = 0.0;
+	double actualNumber = 0.0;
+	if (ToNumber(expected, expectedNumber) && ToNumber(actual, actualNumber))
+		return std::abs(expectedNumber - actualNumber) <= 0.01 * std::max(std::abs(expectedNumber), 1.0);
+
+	return expected == actual;
+}
+
+// Timing
+//    Time and requests per switch, averaged over all switches.
+struct SwitchStatistics
+{
+	double ms;
+	double reads;
+	double writes;
+	double requests;
+};
+
+// switches between the two recipes, feature by feature or in transactions
+SwitchStatistics TimeSwitches(TransactionPort& port, GenApi::CNodeMapRef& nodeMap, bool transactions)
+{
+	port.ResetCounts();
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int i = 0; i < NUM_SWITCHES; i++)
+	{
+		const Recipe& recipe = i % 2 == 0 ? RECIPE_A : RECIPE_B;
+		if (transactions)
+		{
+			WriteTransaction transaction(port, nodeMap);
+			ApplyRecipe(nodeMap, recipe);
+			transaction.Commit();
+		}
+		else
+		{
+			ApplyRecipe(nodeMap, recipe);
+		}
+	}
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	SwitchStatistics statistics;
+	statistics.ms = ms / NUM_SWITCHES;
+	statistics.reads = static_cast<double>(port.GetReads()) / NUM_SWITCHES;
+	statistics.writes = static_cast<double>(port.GetWrites()) / NUM_SWITCHES;
+	statistics.requests = static_cast<double>(port.GetRequests()) / NUM_SWITCHES;
+	return statistics;
+}
+
+void PrintStatistics(const char* mode, const SwitchStatistics& statistics)
+{
+	std::cout << TAB2 << mode << ": " << statistics.ms << " ms per switch, " << statistics.requests << " requests ("
+			  << statistics.reads << " register reads, " << statistics.writes << " register writes)\n";
+}
+
+// demonstrates feature writes grouped in transactions
+// (1) opens first device found through the GenTL producer
+// (2) times switching recipes feature by feature
+// (3) times switching recipes in transactions
+// (4) verifies the last recipe against the device
+// (5) restores initial settings in one transaction
+void CompareRecipeSwitches()
+{
+	// open device
+	std::cout << TAB1 << "Discover devices\n";
+
+	GenTLDevice device;
+	if (!OpenFirstDevice(device, DISCOVERY_TIMEOUT))
+	{
+		std::cout << TAB1 << "No camera connected\n";
+		return;
+	}
+
+	std::cout << TAB2 << "Open " << device.deviceId << "\n";
+
+	TransactionPort remotePort(device.hRemotePort);
+	GenApi::CNodeMapRef nodeMap;
+	LoadRemoteNodeMap(device.hRemotePort, remotePort, nodeMap);
+
+	// Get initial settings
+	//    Recipe B names every feature either recipe touches, in an order that
+	//    also works for restoring them.
+	Recipe initial = ReadRecipe(nodeMap, RECIPE_B);
+
+	// Switch feature by feature
+	//    Every write is sent as soon as its feature is set.
+	std::cout << TAB1 << "Switch recipes " << NUM_SWITCHES << " times feature by feature\n";
+
+	SwitchStatistics serial = TimeSwitches(remotePort, nodeMap, false);
+
+	// Switch in transactions
+	//    Reads that check ranges and access modes still reach the device,
+	//    most of them answered from the node map's cache. The writes of a
+	//    switch are held until it is complete and then sent one by one, so
+	//    the counts differ only by writes and reads the transaction saved.
+	std::cout << TAB1 << "Switch recipes " << NUM_SWITCHES << " times in transactions\n";
+
+	SwitchStatistics transactions = TimeSwitches(remotePort, nodeMap, true);
+
+	PrintStatistics("Feature by feature", serial);
+	PrintStatistics("Transactions      ", transactions);
+
+	// Verify
+	//    Invalidating the node map makes every value come from the device, so
+	//    the comparison checks what was sent, not what GenApi remembers.
+	std::cout << TAB1 << "Verify last recipe on device\n";
+
+	const Recipe& last = NUM_SWITCHES % 2 == 0 ? RECIPE_B : RECIPE_A;
+	nodeMap._InvalidateNodes();
+	Recipe current = ReadRecipe(nodeMap, last);
+
+	size_t mismatches = 0;
+	for (size_t i = 0; i < current.size(); i++)
+	{
+		const std::string& expected = last[IndexOf(last, current[i].first)].second;
+		if (!Matches(expected, current[i].second))
+		{
+			std::cout << TAB2 << current[i].first << " is " << current[i].second << ", expected " << expected << "\n";
+			mismatches++;
+		}
+	}
+
+	std::cout << TAB2 << current.size() - mismatches << " of " << current.size() << " features match\n";
+
+	// restore initial settings
+	{
+		WriteTransaction transaction(remotePort, nodeMap);
+		ApplyRecipe(nodeMap, initial);
+		transaction.Commit();
+	}
+
+	// clean up
+	CloseFirstDevice(device);
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+int main()
+{
+	// flag to track when an exception has been thrown
+	bool exceptionThrown = false;
+
+	std::cout << "Cpp_UserSets_WriteTransactions\n";
+
+	try
+	{
+		// prepare example
+		CheckGC(GenTL::GCInitLib(), "GCInitLib");
+
+		// run example
+		std::cout << "Commence example\n\n";
+		CompareRecipeSwitches();
+		std::cout << "\nExample complete\n";
+
+		// clean up example
+		GenTL::GCCloseLib();
+	}
+	catch (GenICam::GenericException& ge)
+	{
+		std::cout << "\nGenICam exception thrown: " << ge.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "\nStandard exception thrown: " << ex.what() << "\n";
+		exceptionThrown = true;
+	}
+	catch (...)
+	{
+		std::cout << "\nUnexpected exception thrown\n";
+		exceptionThrown = true;
+	}
+
+	std::cout << "Press enter to complete\n";
+	std::getchar();
+
+	if (exceptionThrown)
+		return -1;
+	else
+		return 0;
+}
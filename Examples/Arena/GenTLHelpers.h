@@ -0,0 +1,315 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+#pragma once
+
+#include "GenTL.h"
+
+#ifdef __linux__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-but-set-variable"
+#endif
+
+#include "GenICam.h"
+
+#ifdef __linux__
+#pragma GCC diagnostic pop
+#endif
+
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <algorithm>
+#include <cctype>
+
+// GenTL helpers
+//    Shared by the examples that talk to the GenTL producer underneath Arena
+//    directly: checking return codes, reading info values, loading the device
+//    node map and opening the first device found. Cpp_Acquisition_UserBuffers
+//    shows them in use from opening the device to closing it.
+
+// checks a GenTL return code
+//    GenTL reports errors through return codes. The text of the last error is
+//    retrieved and thrown in the same exception type used by the rest of the
+//    SDK.
+inline void CheckGC(GenTL::GC_ERROR err, const char* function)
+{
+	if (err == GenTL::GC_ERR_SUCCESS)
+		return;
+
+	char errText[1024] = { 0 };
+	size_t errTextSize = sizeof(errText);
+	GenTL::GC_ERROR lastErr = err;
+	GenTL::GCGetLastError(&lastErr, errText, &errTextSize);
+
+	std::string description = std::string(function) + " failed (" + std::to_string(err) + "): " + errText;
+	throw GenICam::GenericException(description.c_str(), __FILE__, __LINE__);
+}
+
+// reads data stream information
+template<typename T>
+T GetStreamInfo(GenTL::DS_HANDLE hDataStream, GenTL::STREAM_INFO_CMD infoCmd)
+{
+	T value = T();
+	GenTL::INFO_DATATYPE type = GenTL::INFO_DATATYPE_UNKNOWN;
+	size_t size = sizeof(value);
+	CheckGC(GenTL::DSGetInfo(hDataStream, infoCmd, &type, &value, &size), "DSGetInfo");
+	return value;
+}
+
+// reads optional data stream information
+template<typename T>
+bool TryGetStreamInfo(GenTL::DS_HANDLE hDataStream, GenTL::STREAM_INFO_CMD infoCmd, T& value)
+{
+	GenTL::INFO_DATATYPE type = GenTL::INFO_DATATYPE_UNKNOWN;
+	size_t size = sizeof(value);
+	return GenTL::DSGetInfo(hDataStream, infoCmd, &type, &value, &size) == GenTL::GC_ERR_SUCCESS;
+}
+
+// reads buffer information
+template<typename T>
+T GetBufferInfo(GenTL::DS_HANDLE hDataStream, GenTL::BUFFER_HANDLE hBuffer, GenTL::BUFFER_INFO_CMD infoCmd)
+{
+	T value = T();
+	GenTL::INFO_DATATYPE type = GenTL::INFO_DATATYPE_UNKNOWN;
+	size_t size = sizeof(value);
+	CheckGC(GenTL::DSGetBufferInfo(hDataStream, hBuffer, infoCmd, &type, &value, &size), "DSGetBufferInfo");
+	return value;
+}
+
+// reads optional buffer information
+//    Not every producer fills every field (e.g. chunk data or timestamps).
+template<typename T>
+bool TryGetBufferInfo(GenTL::DS_HANDLE hDataStream, GenTL::BUFFER_HANDLE hBuffer, GenTL::BUFFER_INFO_CMD infoCmd, T& value)
+{
+	GenTL::INFO_DATATYPE type = GenTL::INFO_DATATYPE_UNKNOWN;
+	size_t size = sizeof(value);
+	return GenTL::DSGetBufferInfo(hDataStream, hBuffer, infoCmd, &type, &value, &size) == GenTL::GC_ERR_SUCCESS;
+}
+
+// port to the remote device
+//    GenApi reads and writes device registers through a port. This forwards
+//    those accesses to the GenTL producer so that features (e.g.
+//    'AcquisitionStart') can be accessed by name.
+class RemotePort : public GenApi::IPort
+{
+public:
+	RemotePort(GenTL::PORT_HANDLE hPort) :
+		m_hPort(hPort)
+	{
+	}
+
+	virtual ~RemotePort() {};
+
+	virtual GenApi::EAccessMode GetAccessMode() const
+	{
+		return GenApi::RW;
+	}
+
+	virtual void Read(void* pBuffer, int64_t address, int64_t length)
+	{
+		size_t size = static_cast<size_t>(length);
+		CheckGC(GenTL::GCReadPort(m_hPort, static_cast<uint64_t>(address), pBuffer, &size), "GCReadPort");
+	}
+
+	virtual void Write(const void* pBuffer, int64_t address, int64_t length)
+	{
+		size_t size = static_cast<size_t>(length);
+		CheckGC(GenTL::GCWritePort(m_hPort, static_cast<uint64_t>(address), pBuffer, &size), "GCWritePort");
+	}
+
+private:
+	GenTL::PORT_HANDLE m_hPort;
+};
+
+// Device file location
+//    Device files stored on the device have the form
+//    'Local:[///]<file name>;<hex address>;<hex length>[?SchemaVersion=...]'
+struct DeviceFileLocation
+{
+	std::string fileName;
+	uint64_t address;
+	size_t length;
+	bool zipped;
+};
+
+inline DeviceFileLocation GetDeviceFileLocation(GenTL::PORT_HANDLE hPort)
+{
+	char url[2048] = { 0 };
+	size_t urlSize = sizeof(url);
+	CheckGC(GenTL::GCGetPortURL(hPort, url, &urlSize), "GCGetPortURL");
+
+	std::string location(url);
+	const std::string scheme = "local:";
+	std::string prefix = location.substr(0, scheme.size());
+	std::transform(prefix.begin(), prefix.end(), prefix.begin(), ::tolower);
+	if (prefix != scheme)
+	{
+		throw GenICam::GenericException(("Unsupported device file location: " + location).c_str(), __FILE__, __LINE__);
+	}
+	location = location.substr(scheme.size());
+	while (!location.empty() && location[0] == '/')
+		location.erase(0, 1);
+
+	size_t firstSeparator = location.find(';');
+	size_t secondSeparator = location.find(';', firstSeparator + 1);
+	if (firstSeparator == std::string::npos || secondSeparator == std::string::npos)
+	{
+		throw GenICam::GenericException(("Malformed device file location: " + std::string(url)).c_str(), __FILE__, __LINE__);
+	}
+
+	DeviceFileLocation result;
+	result.fileName = location.substr(0, firstSeparator);
+	result.address = std::strtoull(location.substr(firstSeparator + 1, secondSeparator - firstSeparator - 1).c_str(), NULL, 16);
+	result.length = static_cast<size_t>(std::strtoull(location.substr(secondSeparator + 1).c_str(), NULL, 16));
+
+	std::string extension = result.fileName.substr(result.fileName.find_last_of('.') + 1);
+	result.zipped = extension == "zip" || extension == "ZIP";
+	return result;
+}
+
+// loads the device node map
+//    The port is any GenApi port to the device; the device file is read and
+//    registers accessed through it.
+// (1) gets XML location from port URL
+// (2) reads XML file from device registers
+// (3) loads XML (zipped or plain)
+// (4) connects port
+inline void LoadRemoteNodeMap(GenTL::PORT_HANDLE hPort, GenApi::IPort& port, GenApi::CNodeMapRef& nodeMap)
+{
+	// get location
+	DeviceFileLocation location = GetDeviceFileLocation(hPort);
+
+	// read file
+	std::vector<uint8_t> file(location.length);
+	port.Read(file.data(), static_cast<int64_t>(location.address), static_cast<int64_t>(location.length));
+
+	// load XML
+	if (location.zipped)
+	{
+		nodeMap._LoadXMLFromZIPData(file.data(), file.size());
+	}
+	else
+	{
+		nodeMap._LoadXMLFromString(GenICam::gcstring(reinterpret_cast<const char*>(file.data()), file.size()));
+	}
+
+	// connect port
+	nodeMap._Connect(&port, "Device");
+}
+
+// Opened device
+//    Handles from the system down to the device's remote port, closed in
+//    reverse order by CloseFirstDevice.
+struct GenTLDevice
+{
+	GenTL::TL_HANDLE hSystem;
+	GenTL::IF_HANDLE hInterface;
+	GenTL::DEV_HANDLE hDevice;
+	GenTL::PORT_HANDLE hRemotePort;
+	std::string deviceId;
+};
+
+// opens the first device found through the GenTL producer
+//    Returns false, with everything closed again, if no device is found.
+inline bool OpenFirstDevice(GenTLDevice& device, uint32_t discoveryTimeout)
+{
+	device.hSystem = NULL;
+	device.hInterface = NULL;
+	device.hDevice = NULL;
+	device.hRemotePort = NULL;
+	device.deviceId.clear();
+
+	CheckGC(GenTL::TLOpen(&device.hSystem), "TLOpen");
+
+	bool8_t changed = 0;
+	CheckGC(GenTL::TLUpdateInterfaceList(device.hSystem, &changed, discoveryTimeout), "TLUpdateInterfaceList");
+
+	uint32_t numInterfaces = 0;
+	CheckGC(GenTL::TLGetNumInterfaces(device.hSystem, &numInterfaces), "TLGetNumInterfaces");
+
+	for (uint32_t i = 0; i < numInterfaces && !device.hDevice; i++)
+	{
+		char interfaceId[512] = { 0 };
+		size_t interfaceIdSize = sizeof(interfaceId);
+		CheckGC(GenTL::TLGetInterfaceID(device.hSystem, i, interfaceId, &interfaceIdSize), "TLGetInterfaceID");
+		CheckGC(GenTL::TLOpenInterface(device.hSystem, interfaceId, &device.hInterface), "TLOpenInterface");
+		CheckGC(GenTL::IFUpdateDeviceList(device.hInterface, &changed, discoveryTimeout), "IFUpdateDeviceList");
+
+		uint32_t numDevices = 0;
+		CheckGC(GenTL::IFGetNumDevices(device.hInterface, &numDevices), "IFGetNumDevices");
+
+		if (numDevices == 0)
+		{
+			CheckGC(GenTL::IFClose(device.hInterface), "IFClose");
+			device.hInterface = NULL;
+			continue;
+		}
+
+		char deviceId[512] = { 0 };
+		size_t deviceIdSize = sizeof(deviceId);
+		CheckGC(GenTL::IFGetDeviceID(device.hInterface, 0, deviceId, &deviceIdSize), "IFGetDeviceID");
+		CheckGC(GenTL::IFOpenDevice(device.hInterface, deviceId, GenTL::DEVICE_ACCESS_CONTROL, &device.hDevice), "IFOpenDevice");
+		device.deviceId = deviceId;
+	}
+
+	if (!device.hDevice)
+	{
+		if (device.hInterface)
+			GenTL::IFClose(device.hInterface);
+		GenTL::TLClose(device.hSystem);
+		device.hInterface = NULL;
+		device.hSystem = NULL;
+		return false;
+	}
+
+	CheckGC(GenTL::DevGetPort(device.hDevice, &device.hRemotePort), "DevGetPort");
+	return true;
+}
+
+// closes a device opened by OpenFirstDevice
+inline void CloseFirstDevice(GenTLDevice& device)
+{
+	CheckGC(GenTL::DevClose(device.hDevice), "DevClose");
+	CheckGC(GenTL::IFClose(device.hInterface), "IFClose");
+	CheckGC(GenTL::TLClose(device.hSystem), "TLClose");
+	device.hDevice = NULL;
+	device.hInterface = NULL;
+	device.hSystem = NULL;
+	device.hRemotePort = NULL;
+}
+
+// opens the first data stream of a device
+inline GenTL::DS_HANDLE OpenFirstDataStream(GenTL::DEV_HANDLE hDevice)
+{
+	char streamId[512] = { 0 };
+	size_t streamIdSize = sizeof(streamId);
+	CheckGC(GenTL::DevGetDataStreamID(hDevice, 0, streamId, &streamIdSize), "DevGetDataStreamID");
+
+	GenTL::DS_HANDLE hDataStream = NULL;
+	CheckGC(GenTL::DevOpenDataStream(hDevice, streamId, &hDataStream), "DevOpenDataStream");
+	return hDataStream;
+}
+
+// Payload size
+//    The producer states the size of a buffer when it knows it; otherwise the
+//    device's 'PayloadSize' feature does.
+inline size_t GetPayloadSize(GenTL::DS_HANDLE hDataStream, GenApi::CNodeMapRef& nodeMap)
+{
+	bool8_t definesPayloadSize = 0;
+	if (TryGetStreamInfo(hDataStream, GenTL::STREAM_INFO_DEFINES_PAYLOADSIZE, definesPayloadSize) && definesPayloadSize)
+		return GetStreamInfo<size_t>(hDataStream, GenTL::STREAM_INFO_PAYLOAD_SIZE);
+
+	GenApi::CIntegerPtr pPayloadSize = nodeMap._GetNode("PayloadSize");
+	return static_cast<size_t>(pPayloadSize->GetValue());
+}
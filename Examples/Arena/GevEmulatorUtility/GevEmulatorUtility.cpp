@@ -0,0 +1,2455 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+ // GevEmulatorUtility.cpp : Defines the entry point for the console application.
+ //
+ // Software GigE Vision device for testing and benchmarking without a camera.
+ // The emulator answers GVCP discovery, register and memory access, force IP
+ // and packet resend requests on UDP port 3956, serves its own GenICam XML
+ // from device memory, and streams synthetic or file-backed frames over GVSP
+ // at the configured frame rate. Packets can be dropped on purpose to exercise
+ // the resend logic of the stream engine.
+ //
+ // The nodemap exposes Width, Height, OffsetX/Y, PixelFormat, PayloadSize,
+ // AcquisitionMode/Start/Stop, AcquisitionFrameRate, ExposureTime, Gain,
+ // chunk data (ExposureTime, Gain, Timestamp), events (Test, ExposureEnd) and
+ // the standard Gev transport layer registers.
+ //
+ // The emulator answers on every local address. Run it on the same machine
+ // with -a 127.0.0.1, or where the loopback adapter is not enumerated by the
+ // transport layer, give it its own link through a network namespace:
+ //
+ //   sudo ip netns add gevemu
+ //   sudo ip link add gevhost type veth peer name gevdev
+ //   sudo ip link set gevdev netns gevemu
+ //   sudo ip addr add 169.254.100.1/16 dev gevhost && sudo ip link set gevhost up
+ //   sudo ip netns exec gevemu ip addr add 169.254.100.2/16 dev gevdev
+ //   sudo ip netns exec gevemu ip link set gevdev up
+ //   sudo ip netns exec gevemu ./GevEmulatorUtility -a 169.254.100.2 -s 255.255.0.0
+
+#include "stdafx.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <winsock2.h>
+#include <Ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#include <sstream>
+#include <cstring>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <deque>
+#include <memory>
+
+#if defined(_WIN32) || defined(_WIN64)
+typedef SOCKET Socket;
+typedef int socklen_t;
+#define CloseSocket closesocket
+#else
+typedef int Socket;
+#define INVALID_SOCKET (-1)
+#define CloseSocket close
+#endif
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// device identity
+//    The MAC address uses a locally administered prefix so that it can never
+//    collide with a real device.
+#define DEFAULT_ADDRESS "127.0.0.1"
+#define DEFAULT_SUBNET "255.0.0.0"
+#define DEFAULT_MAC 0x021C0FAF0001ULL
+#define DEFAULT_SERIAL "EMU000001"
+#define MANUFACTURER_NAME "Lucid Vision Labs"
+#define MODEL_NAME "GigE Vision Emulator"
+#define DEVICE_VERSION "1.0.0"
+
+// default image settings
+#define DEFAULT_WIDTH 1280
+#define DEFAULT_HEIGHT 1024
+#define DEFAULT_PIXEL_FORMAT "Mono8"
+#define DEFAULT_FRAME_RATE 30.0f
+#define MAX_WIDTH 4096
+#define MAX_HEIGHT 4096
+
+// number of frames kept for packet resend
+#define RESEND_HISTORY 32
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- PROTOCOL -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+static const uint16_t GVCP_PORT = 3956;
+static const uint8_t GVCP_KEY = 0x42;
+static const uint8_t GVCP_FLAG_ACK_REQUIRED = 0x01;
+
+// GVCP commands and acknowledges
+static const uint16_t GVCP_DISCOVERY_CMD = 0x0002;
+static const uint16_t GVCP_DISCOVERY_ACK = 0x0003;
+static const uint16_t GVCP_FORCEIP_CMD = 0x0004;
+static const uint16_t GVCP_FORCEIP_ACK = 0x0005;
+static const uint16_t GVCP_PACKETRESEND_CMD = 0x0040;
+static const uint16_t GVCP_READREG_CMD = 0x0080;
+static const uint16_t GVCP_READREG_ACK = 0x0081;
+static const uint16_t GVCP_WRITEREG_CMD = 0x0082;
+static const uint16_t GVCP_WRITEREG_ACK = 0x0083;
+static const uint16_t GVCP_READMEM_CMD = 0x0084;
+static const uint16_t GVCP_READMEM_ACK = 0x0085;
+static const uint16_t GVCP_WRITEMEM_CMD = 0x0086;
+static const uint16_t GVCP_WRITEMEM_ACK = 0x0087;
+static const uint16_t GVCP_EVENT_CMD = 0x00C0;
+
+// GVCP status codes
+static const uint16_t GEV_STATUS_SUCCESS = 0x0000;
+static const uint16_t GEV_STATUS_NOT_IMPLEMENTED = 0x8001;
+static const uint16_t GEV_STATUS_INVALID_PARAMETER = 0x8002;
+static const uint16_t GEV_STATUS_INVALID_ADDRESS = 0x8003;
+static const uint16_t GEV_STATUS_WRITE_PROTECT = 0x8004;
+static const uint16_t GEV_STATUS_BAD_ALIGNMENT = 0x8005;
+static const uint16_t GEV_STATUS_ACCESS_DENIED = 0x8006;
+static const uint16_t GEV_STATUS_PACKET_UNAVAILABLE = 0x800C;
+
+// GVSP packet formats and payload types
+static const uint8_t GVSP_FORMAT_LEADER = 1;
+static const uint8_t GVSP_FORMAT_TRAILER = 2;
+static const uint8_t GVSP_FORMAT_PAYLOAD = 3;
+static const uint16_t GVSP_PAYLOAD_IMAGE = 0x0001;
+static const uint16_t GVSP_PAYLOAD_IMAGE_EXTENDED_CHUNK = 0x4001;
+
+// size of IP, UDP and GVSP headers, which count towards the packet size
+static const uint32_t GVSP_OVERHEAD = 20 + 8 + 8;
+static const uint32_t GVSP_LEADER_SIZE = 36;
+static const uint32_t GVCP_MAX_PACKET = 576;
+
+// bootstrap registers
+static const uint32_t REG_VERSION = 0x0000;
+static const uint32_t REG_DEVICE_MODE = 0x0004;
+static const uint32_t REG_MAC_HIGH = 0x0008;
+static const uint32_t REG_MAC_LOW = 0x000C;
+static const uint32_t REG_NETWORK_CAPABILITY = 0x0010;
+static const uint32_t REG_NETWORK_CONFIGURATION = 0x0014;
+static const uint32_t REG_CURRENT_IP = 0x0024;
+static const uint32_t REG_CURRENT_SUBNET = 0x0034;
+static const uint32_t REG_CURRENT_GATEWAY = 0x0044;
+static const uint32_t REG_MANUFACTURER_NAME = 0x0048;
+static const uint32_t REG_MODEL_NAME = 0x0068;
+static const uint32_t REG_DEVICE_VERSION = 0x0088;
+static const uint32_t REG_MANUFACTURER_INFO = 0x00A8;
+static const uint32_t REG_SERIAL_NUMBER = 0x00D8;
+static const uint32_t REG_USER_NAME = 0x00E8;
+static const uint32_t REG_FIRST_URL = 0x0200;
+static const uint32_t REG_NUM_INTERFACES = 0x0600;
+static const uint32_t REG_PERSISTENT_IP = 0x064C;
+static const uint32_t REG_PERSISTENT_SUBNET = 0x065C;
+static const uint32_t REG_PERSISTENT_GATEWAY = 0x066C;
+static const uint32_t REG_NUM_MESSAGE_CHANNELS = 0x0900;
+static const uint32_t REG_NUM_STREAM_CHANNELS = 0x0904;
+static const uint32_t REG_GVCP_CAPABILITY = 0x0934;
+static const uint32_t REG_HEARTBEAT_TIMEOUT = 0x0938;
+static const uint32_t REG_TICK_FREQUENCY_HIGH = 0x093C;
+static const uint32_t REG_TICK_FREQUENCY_LOW = 0x0940;
+static const uint32_t REG_TIMESTAMP_CONTROL = 0x0944;
+static const uint32_t REG_TIMESTAMP_HIGH = 0x0948;
+static const uint32_t REG_TIMESTAMP_LOW = 0x094C;
+static const uint32_t REG_GVCP_CONFIGURATION = 0x0954;
+static const uint32_t REG_CCP = 0x0A00;
+static const uint32_t REG_MCP = 0x0B00;
+static const uint32_t REG_MCDA = 0x0B10;
+static const uint32_t REG_MCTT = 0x0B14;
+static const uint32_t REG_MCRC = 0x0B18;
+static const uint32_t REG_MCSP = 0x0B1C;
+static const uint32_t REG_SCP = 0x0D00;
+static const uint32_t REG_SCPS = 0x0D04;
+static const uint32_t REG_SCPD = 0x0D08;
+static const uint32_t REG_SCDA = 0x0D18;
+static const uint32_t REG_SCSP = 0x0D1C;
+static const uint32_t REG_SCC = 0x0D20;
+static const uint32_t REG_SCCFG = 0x0D24;
+static const uint32_t BOOTSTRAP_SIZE = 0x1000;
+static const uint32_t DISCOVERY_ACK_SIZE = 0x00F8;
+
+// register bits (GigE Vision numbers bit 0 as the most significant)
+static const uint32_t CCP_EXCLUSIVE = 0x00000001;
+static const uint32_t CCP_CONTROL = 0x00000002;
+static const uint32_t SCPS_FIRE_TEST_PACKET = 0x80000000;
+static const uint32_t SCPS_PACKET_SIZE_MASK = 0x0000FFFF;
+static const uint32_t GVCP_CONFIGURATION_HEARTBEAT_DISABLE = 0x00000001;
+static const uint32_t TIMESTAMP_CONTROL_RESET = 0x00000001;
+static const uint32_t TIMESTAMP_CONTROL_LATCH = 0x00000002;
+
+// device registers, described by the XML below
+static const uint32_t REG_WIDTH = 0x20000;
+static const uint32_t REG_HEIGHT = 0x20004;
+static const uint32_t REG_OFFSET_X = 0x20008;
+static const uint32_t REG_OFFSET_Y = 0x2000C;
+static const uint32_t REG_PIXEL_FORMAT = 0x20010;
+static const uint32_t REG_PAYLOAD_SIZE = 0x20014;
+static const uint32_t REG_ACQUISITION_MODE = 0x20018;
+static const uint32_t REG_ACQUISITION_START = 0x2001C;
+static const uint32_t REG_ACQUISITION_STOP = 0x20020;
+static const uint32_t REG_ACQUISITION_FRAME_RATE = 0x20024;
+static const uint32_t REG_EXPOSURE_TIME = 0x20028;
+static const uint32_t REG_TL_PARAMS_LOCKED = 0x2002C;
+static const uint32_t REG_CHUNK_MODE_ACTIVE = 0x20030;
+static const uint32_t REG_CHUNK_SELECTOR = 0x20034;
+static const uint32_t REG_GAIN = 0x20038;
+static const uint32_t REG_WIDTH_MAX = 0x2003C;
+static const uint32_t REG_HEIGHT_MAX = 0x20040;
+static const uint32_t REG_CHUNK_ENABLE = 0x20044;
+static const uint32_t REG_EVENT_SELECTOR = 0x20050;
+static const uint32_t REG_EVENT_NOTIFICATION = 0x20054;
+static const uint32_t REG_TEST_EVENT_GENERATE = 0x2005C;
+static const uint32_t DEVICE_REGISTERS_BASE = 0x20000;
+static const uint32_t DEVICE_REGISTERS_SIZE = 0x60;
+static const uint32_t XML_ADDRESS = 0x100000;
+
+// chunks, indexed by ChunkSelector
+static const uint32_t NUM_CHUNKS = 3;
+static const uint32_t CHUNK_ID_IMAGE = 0x45000000;
+static const uint32_t CHUNK_IDS[NUM_CHUNKS] = { 0x45000001, 0x45000002, 0x45000003 };
+static const uint32_t CHUNK_SIZE = 8;
+
+// events, indexed by EventSelector
+static const uint32_t NUM_EVENTS = 2;
+static const uint16_t EVENT_ID_TEST = 0x9000;
+static const uint16_t EVENT_ID_EXPOSURE_END = 0x9001;
+
+// supported pixel formats
+struct PixelFormatInfo
+{
+	const char* name;
+	uint32_t value;
+	uint32_t bitsPerPixel;
+};
+
+static const PixelFormatInfo PIXEL_FORMATS[] = {
+	{ "Mono8", 0x01080001, 8 },
+	{ "Mono16", 0x01100007, 16 },
+	{ "BayerRG8", 0x01080009, 8 },
+	{ "RGB8", 0x02180014, 24 },
+};
+
+static const PixelFormatInfo* FindPixelFormat(uint32_t value)
+{
+	for (size_t i = 0; i < sizeof(PIXEL_FORMATS) / sizeof(PIXEL_FORMATS[0]); i++)
+	{
+		if (PIXEL_FORMATS[i].value == value)
+			return &PIXEL_FORMATS[i];
+	}
+	return NULL;
+}
+
+static const PixelFormatInfo* FindPixelFormat(const std::string& name)
+{
+	for (size_t i = 0; i < sizeof(PIXEL_FORMATS) / sizeof(PIXEL_FORMATS[0]); i++)
+	{
+		if (name == PIXEL_FORMATS[i].name)
+			return &PIXEL_FORMATS[i];
+	}
+	return NULL;
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- XML =-=-=-=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// device description
+//    Served from XML_ADDRESS through the "Local:" first URL. Register
+//    addresses must match the REG_ constants above.
+static const char DEVICE_XML[] = R"XML(<?xml version="1.0" encoding="utf-8"?>
+<RegisterDescription ModelName="GigEVisionEmulator" VendorName="LucidVisionLabs" ToolTip="Software GigE Vision device" StandardNameSpace="GEV" SchemaMajorVersion="1" SchemaMinorVersion="1" SchemaSubMinorVersion="0" MajorVersion="1" MinorVersion="0" SubMinorVersion="0" ProductGuid="6F1B2E0A-5A43-4C7E-9F0B-3C1E2D4A5B60" VersionGuid="8C2D3F1B-6B54-4D8F-A01C-4D2F3E5B6C71" xmlns="http://www.genicam.org/GenApi/Version_1_1" xmlns:xsi="http://www.w3.org/2001/XMLSchema-instance" xsi:schemaLocation="http://www.genicam.org/GenApi/Version_1_1 http://www.genicam.org/GenApi/GenApiSchema_Version_1_1.xsd">
+
+  <Category Name="Root" NameSpace="Standard">
+    <pFeature>DeviceControl</pFeature>
+    <pFeature>ImageFormatControl</pFeature>
+    <pFeature>AcquisitionControl</pFeature>
+    <pFeature>ChunkDataControl</pFeature>
+    <pFeature>EventControl</pFeature>
+    <pFeature>TransportLayerControl</pFeature>
+  </Category>
+
+  <Category Name="DeviceControl" NameSpace="Standard">
+    <pFeature>DeviceVendorName</pFeature>
+    <pFeature>DeviceModelName</pFeature>
+    <pFeature>DeviceVersion</pFeature>
+    <pFeature>DeviceSerialNumber</pFeature>
+    <pFeature>DeviceUserID</pFeature>
+  </Category>
+
+  <StringReg Name="DeviceVendorName" NameSpace="Standard">
+    <Address>0x0048</Address>
+    <Length>32</Length>
+    <AccessMode>RO</AccessMode>
+    <pPort>Device</pPort>
+  </StringReg>
+
+  <StringReg Name="DeviceModelName" NameSpace="Standard">
+    <Address>0x0068</Address>
+    <Length>32</Length>
+    <AccessMode>RO</AccessMode>
+    <pPort>Device</pPort>
+  </StringReg>
+
+  <StringReg Name="DeviceVersion" NameSpace="Standard">
+    <Address>0x0088</Address>
+    <Length>32</Length>
+    <AccessMode>RO</AccessMode>
+    <pPort>Device</pPort>
+  </StringReg>
+
+  <StringReg Name="DeviceSerialNumber" NameSpace="Standard">
+    <Address>0x00D8</Address>
+    <Length>16</Length>
+    <AccessMode>RO</AccessMode>
+    <pPort>Device</pPort>
+  </StringReg>
+
+  <StringReg Name="DeviceUserID" NameSpace="Standard">
+    <Address>0x00E8</Address>
+    <Length>16</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+  </StringReg>
+
+  <Category Name="ImageFormatControl" NameSpace="Standard">
+    <pFeature>WidthMax</pFeature>
+    <pFeature>HeightMax</pFeature>
+    <pFeature>Width</pFeature>
+    <pFeature>Height</pFeature>
+    <pFeature>OffsetX</pFeature>
+    <pFeature>OffsetY</pFeature>
+    <pFeature>PixelFormat</pFeature>
+  </Category>
+
+  <IntReg Name="WidthMax" NameSpace="Standard">
+    <Address>0x2003C</Address>
+    <Length>4</Length>
+    <AccessMode>RO</AccessMode>
+    <pPort>Device</pPort>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <IntReg Name="HeightMax" NameSpace="Standard">
+    <Address>0x20040</Address>
+    <Length>4</Length>
+    <AccessMode>RO</AccessMode>
+    <pPort>Device</pPort>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <Integer Name="Width" NameSpace="Standard">
+    <pIsLocked>TLParamsLocked</pIsLocked>
+    <pValue>WidthReg</pValue>
+    <Min>16</Min>
+    <pMax>WidthMaxAvailable</pMax>
+    <Inc>4</Inc>
+  </Integer>
+
+  <IntSwissKnife Name="WidthMaxAvailable">
+    <pVariable Name="MAX">WidthMax</pVariable>
+    <pVariable Name="OFFSET">OffsetXReg</pVariable>
+    <Formula>MAX - OFFSET</Formula>
+  </IntSwissKnife>
+
+  <IntReg Name="WidthReg">
+    <Address>0x20000</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <Integer Name="Height" NameSpace="Standard">
+    <pIsLocked>TLParamsLocked</pIsLocked>
+    <pValue>HeightReg</pValue>
+    <Min>16</Min>
+    <pMax>HeightMaxAvailable</pMax>
+    <Inc>1</Inc>
+  </Integer>
+
+  <IntSwissKnife Name="HeightMaxAvailable">
+    <pVariable Name="MAX">HeightMax</pVariable>
+    <pVariable Name="OFFSET">OffsetYReg</pVariable>
+    <Formula>MAX - OFFSET</Formula>
+  </IntSwissKnife>
+
+  <IntReg Name="HeightReg">
+    <Address>0x20004</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <Integer Name="OffsetX" NameSpace="Standard">
+    <pIsLocked>TLParamsLocked</pIsLocked>
+    <pValue>OffsetXReg</pValue>
+    <Min>0</Min>
+    <pMax>OffsetXMax</pMax>
+    <Inc>4</Inc>
+  </Integer>
+
+  <IntSwissKnife Name="OffsetXMax">
+    <pVariable Name="MAX">WidthMax</pVariable>
+    <pVariable Name="SIZE">WidthReg</pVariable>
+    <Formula>MAX - SIZE</Formula>
+  </IntSwissKnife>
+
+  <IntReg Name="OffsetXReg">
+    <Address>0x20008</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <Integer Name="OffsetY" NameSpace="Standard">
+    <pIsLocked>TLParamsLocked</pIsLocked>
+    <pValue>OffsetYReg</pValue>
+    <Min>0</Min>
+    <pMax>OffsetYMax</pMax>
+    <Inc>1</Inc>
+  </Integer>
+
+  <IntSwissKnife Name="OffsetYMax">
+    <pVariable Name="MAX">HeightMax</pVariable>
+    <pVariable Name="SIZE">HeightReg</pVariable>
+    <Formula>MAX - SIZE</Formula>
+  </IntSwissKnife>
+
+  <IntReg Name="OffsetYReg">
+    <Address>0x2000C</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <Enumeration Name="PixelFormat" NameSpace="Standard">
+    <pIsLocked>TLParamsLocked</pIsLocked>
+    <EnumEntry Name="Mono8" NameSpace="Standard">
+      <Value>0x01080001</Value>
+    </EnumEntry>
+    <EnumEntry Name="Mono16" NameSpace="Standard">
+      <Value>0x01100007</Value>
+    </EnumEntry>
+    <EnumEntry Name="BayerRG8" NameSpace="Standard">
+      <Value>0x01080009</Value>
+    </EnumEntry>
+    <EnumEntry Name="RGB8" NameSpace="Standard">
+      <Value>0x02180014</Value>
+    </EnumEntry>
+    <pValue>PixelFormatReg</pValue>
+  </Enumeration>
+
+  <IntReg Name="PixelFormatReg">
+    <Address>0x20010</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <Category Name="AcquisitionControl" NameSpace="Standard">
+    <pFeature>AcquisitionMode</pFeature>
+    <pFeature>AcquisitionStart</pFeature>
+    <pFeature>AcquisitionStop</pFeature>
+    <pFeature>AcquisitionFrameRate</pFeature>
+    <pFeature>ExposureTime</pFeature>
+    <pFeature>Gain</pFeature>
+  </Category>
+
+  <Enumeration Name="AcquisitionMode" NameSpace="Standard">
+    <pIsLocked>TLParamsLocked</pIsLocked>
+    <EnumEntry Name="Continuous" NameSpace="Standard">
+      <Value>0</Value>
+    </EnumEntry>
+    <EnumEntry Name="SingleFrame" NameSpace="Standard">
+      <Value>1</Value>
+    </EnumEntry>
+    <pValue>AcquisitionModeReg</pValue>
+  </Enumeration>
+
+  <IntReg Name="AcquisitionModeReg">
+    <Address>0x20018</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <Command Name="AcquisitionStart" NameSpace="Standard">
+    <pValue>AcquisitionStartReg</pValue>
+    <CommandValue>1</CommandValue>
+  </Command>
+
+  <IntReg Name="AcquisitionStartReg">
+    <Address>0x2001C</Address>
+    <Length>4</Length>
+    <AccessMode>WO</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>NoCache</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <Command Name="AcquisitionStop" NameSpace="Standard">
+    <pValue>AcquisitionStopReg</pValue>
+    <CommandValue>1</CommandValue>
+  </Command>
+
+  <IntReg Name="AcquisitionStopReg">
+    <Address>0x20020</Address>
+    <Length>4</Length>
+    <AccessMode>WO</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>NoCache</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <Float Name="AcquisitionFrameRate" NameSpace="Standard">
+    <pValue>AcquisitionFrameRateReg</pValue>
+    <Min>0.1</Min>
+    <Max>10000</Max>
+    <Unit>Hz</Unit>
+  </Float>
+
+  <FloatReg Name="AcquisitionFrameRateReg">
+    <Address>0x20024</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Endianess>BigEndian</Endianess>
+  </FloatReg>
+
+  <Float Name="ExposureTime" NameSpace="Standard">
+    <pValue>ExposureTimeReg</pValue>
+    <Min>10</Min>
+    <Max>1000000</Max>
+    <Unit>us</Unit>
+  </Float>
+
+  <FloatReg Name="ExposureTimeReg">
+    <Address>0x20028</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Endianess>BigEndian</Endianess>
+  </FloatReg>
+
+  <Float Name="Gain" NameSpace="Standard">
+    <pValue>GainReg</pValue>
+    <Min>0</Min>
+    <Max>48</Max>
+    <Unit>dB</Unit>
+  </Float>
+
+  <FloatReg Name="GainReg">
+    <Address>0x20038</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Endianess>BigEndian</Endianess>
+  </FloatReg>
+
+  <Category Name="ChunkDataControl" NameSpace="Standard">
+    <pFeature>ChunkModeActive</pFeature>
+    <pFeature>ChunkSelector</pFeature>
+    <pFeature>ChunkEnable</pFeature>
+    <pFeature>ChunkExposureTime</pFeature>
+    <pFeature>ChunkGain</pFeature>
+    <pFeature>ChunkTimestamp</pFeature>
+  </Category>
+
+  <Boolean Name="ChunkModeActive" NameSpace="Standard">
+    <pIsLocked>TLParamsLocked</pIsLocked>
+    <pValue>ChunkModeActiveReg</pValue>
+    <OnValue>1</OnValue>
+    <OffValue>0</OffValue>
+  </Boolean>
+
+  <IntReg Name="ChunkModeActiveReg">
+    <Address>0x20030</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <Enumeration Name="ChunkSelector" NameSpace="Standard">
+    <EnumEntry Name="ExposureTime" NameSpace="Standard">
+      <Value>0</Value>
+    </EnumEntry>
+    <EnumEntry Name="Gain" NameSpace="Standard">
+      <Value>1</Value>
+    </EnumEntry>
+    <EnumEntry Name="Timestamp" NameSpace="Standard">
+      <Value>2</Value>
+    </EnumEntry>
+    <pValue>ChunkSelectorReg</pValue>
+    <pSelected>ChunkEnable</pSelected>
+  </Enumeration>
+
+  <IntReg Name="ChunkSelectorReg">
+    <Address>0x20034</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <Boolean Name="ChunkEnable" NameSpace="Standard">
+    <pIsLocked>TLParamsLocked</pIsLocked>
+    <pValue>ChunkEnableReg</pValue>
+    <OnValue>1</OnValue>
+    <OffValue>0</OffValue>
+  </Boolean>
+
+  <IntReg Name="ChunkEnableReg">
+    <Address>0x20044</Address>
+    <pIndex Offset="4">ChunkSelectorReg</pIndex>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <Port Name="ChunkExposureTimePort">
+    <ChunkID>45000001</ChunkID>
+  </Port>
+
+  <Port Name="ChunkGainPort">
+    <ChunkID>45000002</ChunkID>
+  </Port>
+
+  <Port Name="ChunkTimestampPort">
+    <ChunkID>45000003</ChunkID>
+  </Port>
+
+  <FloatReg Name="ChunkExposureTime" NameSpace="Standard">
+    <Address>0</Address>
+    <Length>8</Length>
+    <AccessMode>RO</AccessMode>
+    <pPort>ChunkExposureTimePort</pPort>
+    <Cachable>NoCache</Cachable>
+    <Endianess>BigEndian</Endianess>
+  </FloatReg>
+
+  <FloatReg Name="ChunkGain" NameSpace="Standard">
+    <Address>0</Address>
+    <Length>8</Length>
+    <AccessMode>RO</AccessMode>
+    <pPort>ChunkGainPort</pPort>
+    <Cachable>NoCache</Cachable>
+    <Endianess>BigEndian</Endianess>
+  </FloatReg>
+
+  <IntReg Name="ChunkTimestamp" NameSpace="Standard">
+    <Address>0</Address>
+    <Length>8</Length>
+    <AccessMode>RO</AccessMode>
+    <pPort>ChunkTimestampPort</pPort>
+    <Cachable>NoCache</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <Category Name="EventControl" NameSpace="Standard">
+    <pFeature>EventSelector</pFeature>
+    <pFeature>EventNotification</pFeature>
+    <pFeature>TestEventGenerate</pFeature>
+    <pFeature>EventTestTimestamp</pFeature>
+    <pFeature>EventExposureEndFrameID</pFeature>
+    <pFeature>EventExposureEndTimestamp</pFeature>
+  </Category>
+
+  <Enumeration Name="EventSelector" NameSpace="Standard">
+    <EnumEntry Name="Test" NameSpace="Standard">
+      <Value>0</Value>
+    </EnumEntry>
+    <EnumEntry Name="ExposureEnd" NameSpace="Standard">
+      <Value>1</Value>
+    </EnumEntry>
+    <pValue>EventSelectorReg</pValue>
+    <pSelected>EventNotification</pSelected>
+  </Enumeration>
+
+  <IntReg Name="EventSelectorReg">
+    <Address>0x20050</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <Enumeration Name="EventNotification" NameSpace="Standard">
+    <EnumEntry Name="Off" NameSpace="Standard">
+      <Value>0</Value>
+    </EnumEntry>
+    <EnumEntry Name="On" NameSpace="Standard">
+      <Value>1</Value>
+    </EnumEntry>
+    <pValue>EventNotificationReg</pValue>
+  </Enumeration>
+
+  <IntReg Name="EventNotificationReg">
+    <Address>0x20054</Address>
+    <pIndex Offset="4">EventSelectorReg</pIndex>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <Command Name="TestEventGenerate" NameSpace="Standard">
+    <pValue>TestEventGenerateReg</pValue>
+    <CommandValue>1</CommandValue>
+  </Command>
+
+  <IntReg Name="TestEventGenerateReg">
+    <Address>0x2005C</Address>
+    <Length>4</Length>
+    <AccessMode>WO</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>NoCache</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <Port Name="EventTestPort">
+    <EventID>9000</EventID>
+  </Port>
+
+  <Port Name="EventExposureEndPort">
+    <EventID>9001</EventID>
+  </Port>
+
+  <IntReg Name="EventTestTimestamp" NameSpace="Standard">
+    <Address>8</Address>
+    <Length>8</Length>
+    <AccessMode>RO</AccessMode>
+    <pPort>EventTestPort</pPort>
+    <Cachable>NoCache</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <IntReg Name="EventExposureEndFrameID" NameSpace="Standard">
+    <Address>6</Address>
+    <Length>2</Length>
+    <AccessMode>RO</AccessMode>
+    <pPort>EventExposureEndPort</pPort>
+    <Cachable>NoCache</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <IntReg Name="EventExposureEndTimestamp" NameSpace="Standard">
+    <Address>8</Address>
+    <Length>8</Length>
+    <AccessMode>RO</AccessMode>
+    <pPort>EventExposureEndPort</pPort>
+    <Cachable>NoCache</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <Category Name="TransportLayerControl" NameSpace="Standard">
+    <pFeature>PayloadSize</pFeature>
+    <pFeature>TLParamsLocked</pFeature>
+    <pFeature>GevMACAddress</pFeature>
+    <pFeature>GevCurrentIPAddress</pFeature>
+    <pFeature>GevCurrentSubnetMask</pFeature>
+    <pFeature>GevCurrentDefaultGateway</pFeature>
+    <pFeature>GevCCP</pFeature>
+    <pFeature>GevHeartbeatTimeout</pFeature>
+    <pFeature>GevTimestampTickFrequency</pFeature>
+    <pFeature>GevTimestampControlLatch</pFeature>
+    <pFeature>GevTimestampControlReset</pFeature>
+    <pFeature>GevTimestampValue</pFeature>
+    <pFeature>GevMCPHostPort</pFeature>
+    <pFeature>GevMCDA</pFeature>
+    <pFeature>GevMCTT</pFeature>
+    <pFeature>GevMCRC</pFeature>
+    <pFeature>GevSCPHostPort</pFeature>
+    <pFeature>GevSCPSPacketSize</pFeature>
+    <pFeature>GevSCPD</pFeature>
+    <pFeature>GevSCDA</pFeature>
+    <pFeature>GevSCSP</pFeature>
+  </Category>
+
+  <IntReg Name="PayloadSize" NameSpace="Standard">
+    <Address>0x20014</Address>
+    <Length>4</Length>
+    <AccessMode>RO</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>NoCache</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <Integer Name="TLParamsLocked" NameSpace="Standard">
+    <Visibility>Invisible</Visibility>
+    <pValue>TLParamsLockedReg</pValue>
+    <Min>0</Min>
+    <Max>1</Max>
+  </Integer>
+
+  <IntReg Name="TLParamsLockedReg">
+    <Address>0x2002C</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <IntReg Name="GevMACAddress" NameSpace="Standard">
+    <Address>0x0008</Address>
+    <Length>8</Length>
+    <AccessMode>RO</AccessMode>
+    <pPort>Device</pPort>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <IntReg Name="GevCurrentIPAddress" NameSpace="Standard">
+    <Address>0x0024</Address>
+    <Length>4</Length>
+    <AccessMode>RO</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>NoCache</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <IntReg Name="GevCurrentSubnetMask" NameSpace="Standard">
+    <Address>0x0034</Address>
+    <Length>4</Length>
+    <AccessMode>RO</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>NoCache</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <IntReg Name="GevCurrentDefaultGateway" NameSpace="Standard">
+    <Address>0x0044</Address>
+    <Length>4</Length>
+    <AccessMode>RO</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>NoCache</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <Enumeration Name="GevCCP" NameSpace="Standard">
+    <EnumEntry Name="OpenAccess" NameSpace="Standard">
+      <Value>0</Value>
+    </EnumEntry>
+    <EnumEntry Name="ExclusiveAccess" NameSpace="Standard">
+      <Value>1</Value>
+    </EnumEntry>
+    <EnumEntry Name="ControlAccess" NameSpace="Standard">
+      <Value>2</Value>
+    </EnumEntry>
+    <pValue>GevCCPReg</pValue>
+  </Enumeration>
+
+  <IntReg Name="GevCCPReg">
+    <Address>0x0A00</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>NoCache</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <IntReg Name="GevHeartbeatTimeout" NameSpace="Standard">
+    <Address>0x0938</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <IntReg Name="GevTimestampTickFrequency" NameSpace="Standard">
+    <Address>0x093C</Address>
+    <Length>8</Length>
+    <AccessMode>RO</AccessMode>
+    <pPort>Device</pPort>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <Command Name="GevTimestampControlLatch" NameSpace="Standard">
+    <pValue>GevTimestampControlReg</pValue>
+    <CommandValue>2</CommandValue>
+  </Command>
+
+  <Command Name="GevTimestampControlReset" NameSpace="Standard">
+    <pValue>GevTimestampControlReg</pValue>
+    <CommandValue>1</CommandValue>
+  </Command>
+
+  <IntReg Name="GevTimestampControlReg">
+    <Address>0x0944</Address>
+    <Length>4</Length>
+    <AccessMode>WO</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>NoCache</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <IntReg Name="GevTimestampValue" NameSpace="Standard">
+    <Address>0x0948</Address>
+    <Length>8</Length>
+    <AccessMode>RO</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>NoCache</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <IntReg Name="GevMCPHostPort" NameSpace="Standard">
+    <Address>0x0B00</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <IntReg Name="GevMCDA" NameSpace="Standard">
+    <Address>0x0B10</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <IntReg Name="GevMCTT" NameSpace="Standard">
+    <Address>0x0B14</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <IntReg Name="GevMCRC" NameSpace="Standard">
+    <Address>0x0B18</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <IntReg Name="GevSCPHostPort" NameSpace="Standard">
+    <Address>0x0D00</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <IntReg Name="GevSCPSPacketSize" NameSpace="Standard">
+    <Address>0x0D04</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <IntReg Name="GevSCPD" NameSpace="Standard">
+    <Address>0x0D08</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <IntReg Name="GevSCDA" NameSpace="Standard">
+    <Address>0x0D18</Address>
+    <Length>4</Length>
+    <AccessMode>RW</AccessMode>
+    <pPort>Device</pPort>
+    <Cachable>WriteThrough</Cachable>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <IntReg Name="GevSCSP" NameSpace="Standard">
+    <Address>0x0D1C</Address>
+    <Length>4</Length>
+    <AccessMode>RO</AccessMode>
+    <pPort>Device</pPort>
+    <Sign>Unsigned</Sign>
+    <Endianess>BigEndian</Endianess>
+  </IntReg>
+
+  <Port Name="Device" NameSpace="Standard">
+  </Port>
+
+</RegisterDescription>
+)XML";
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- HELPERS -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// big endian accessors
+//    All GVCP and GVSP fields are sent in network byte order.
+static void Put16(uint8_t* p, uint16_t value)
+{
+	p[0] = static_cast<uint8_t>(value >> 8);
+	p[1] = static_cast<uint8_t>(value);
+}
+
+static void Put32(uint8_t* p, uint32_t value)
+{
+	p[0] = static_cast<uint8_t>(value >> 24);
+	p[1] = static_cast<uint8_t>(value >> 16);
+	p[2] = static_cast<uint8_t>(value >> 8);
+	p[3] = static_cast<uint8_t>(value);
+}
+
+static void Put64(uint8_t* p, uint64_t value)
+{
+	Put32(p, static_cast<uint32_t>(value >> 32));
+	Put32(p + 4, static_cast<uint32_t>(value));
+}
+
+static uint16_t Get16(const uint8_t* p)
+{
+	return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+static uint32_t Get32(const uint8_t* p)
+{
+	return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+static uint32_t FloatToBits(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static float BitsToFloat(uint32_t bits)
+{
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+static uint32_t AddressStrToUint32(const std::string& address)
+{
+	struct in_addr addr;
+	if (inet_pton(AF_INET, address.c_str(), &addr) > 0)
+	{
+		return ntohl(addr.s_addr);
+	}
+	throw std::logic_error(address + " is not a valid address!");
+}
+
+static std::string Uint32ToAddressStr(uint32_t address)
+{
+	struct in_addr addr;
+	addr.s_addr = htonl(address);
+	char str[INET_ADDRSTRLEN] = { 0 };
+	inet_ntop(AF_INET, &addr, str, sizeof(str));
+	return str;
+}
+
+static struct sockaddr_in MakeSocketAddress(uint32_t address, uint16_t port)
+{
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(address);
+	addr.sin_port = htons(port);
+	return addr;
+}
+
+// creates a UDP socket bound to the given port (0 for any)
+static Socket OpenUdpSocket(uint16_t port)
+{
+	Socket s = socket(AF_INET, SOCK_DGRAM, 0);
+	if (s == INVALID_SOCKET)
+		throw std::runtime_error("Failed to create socket");
+
+	int enable = 1;
+	setsockopt(s, SOL_SOCKET, SO_BROADCAST, reinterpret_cast<const char*>(&enable), sizeof(enable));
+	setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&enable), sizeof(enable));
+
+	int bufferSize = 8 * 1024 * 1024;
+	setsockopt(s, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&bufferSize), sizeof(bufferSize));
+
+	struct sockaddr_in addr = MakeSocketAddress(INADDR_ANY, port);
+	if (bind(s, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0)
+	{
+		CloseSocket(s);
+		throw std::runtime_error("Failed to bind UDP port " + std::to_string(port));
+	}
+	return s;
+}
+
+static uint16_t GetSocketPort(Socket s)
+{
+	struct sockaddr_in addr;
+	socklen_t length = sizeof(addr);
+	getsockname(s, reinterpret_cast<struct sockaddr*>(&addr), &length);
+	return ntohs(addr.sin_port);
+}
+
+//command line input parser
+class CliParser
+{
+
+public:
+
+	CliParser(int& argc, char** argv)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			m_argTokens.push_back(std::string(argv[i]));
+		}
+	}
+
+	//checks if an argument exists
+	bool ArgumentExists(const std::string& arg) const
+	{
+		auto result = std::find(m_argTokens.begin(), m_argTokens.end(), arg);
+		return result != m_argTokens.end();
+	}
+
+	//returns the argument value associated with the arg flag, or the default
+	std::string GetArgument(const std::string& arg, const std::string& defaultValue) const
+	{
+		auto it = std::find(m_argTokens.begin(), m_argTokens.end(), arg);
+
+		if (it != m_argTokens.end() && // if we found a flag token
+			++it != m_argTokens.end()) // if there is a arg value token
+		{
+			return *it;
+		}
+		return defaultValue;
+	}
+
+private:
+
+	std::vector<std::string> m_argTokens;
+};
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EMULATOR -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// emulator settings
+//    Filled in from the command line.
+struct EmulatorSettings
+{
+	uint32_t address;
+	uint32_t subnet;
+	uint32_t gateway;
+	uint64_t macAddress;
+	std::string serialNumber;
+	uint32_t width;
+	uint32_t height;
+	uint32_t pixelFormat;
+	float frameRate;
+
+	// raw file with frames to stream instead of the synthetic pattern
+	//    Frames are read back to back and must match Width, Height and
+	//    PixelFormat at the time acquisition is started.
+	std::string frameFile;
+
+	// packet loss profile
+	//    Each packet is dropped with probability lossRate; a drop then
+	//    continues for lossBurst packets in total. Resent packets are only
+	//    dropped if lossOnResend is set.
+	double lossRate;
+	uint32_t lossBurst;
+	bool lossOnResend;
+	uint32_t seed;
+};
+
+// emulator statistics
+struct EmulatorStats
+{
+	std::atomic<uint64_t> framesSent;
+	std::atomic<uint64_t> packetsSent;
+	std::atomic<uint64_t> packetsDropped;
+	std::atomic<uint64_t> resendRequests;
+	std::atomic<uint64_t> packetsResent;
+	std::atomic<uint64_t> packetsUnavailable;
+	std::atomic<uint64_t> eventsSent;
+
+	EmulatorStats() :
+		framesSent(0),
+		packetsSent(0),
+		packetsDropped(0),
+		resendRequests(0),
+		packetsResent(0),
+		packetsUnavailable(0),
+		eventsSent(0)
+	{
+	}
+};
+
+// software GigE Vision device
+//    A control thread serves GVCP on port 3956 and watches the heartbeat. A
+//    stream thread produces frames while acquisition is running and sends
+//    them to the stream channel destination. Recently sent frames are kept
+//    so that packets can be resent on request.
+class DeviceEmulator
+{
+public:
+	explicit DeviceEmulator(const EmulatorSettings& settings) :
+		m_settings(settings),
+		m_bootstrap(BOOTSTRAP_SIZE, 0),
+		m_device(DEVICE_REGISTERS_SIZE, 0),
+		m_xml(DEVICE_XML),
+		m_gvcpSocket(INVALID_SOCKET),
+		m_streamSocket(INVALID_SOCKET),
+		m_messageSocket(INVALID_SOCKET),
+		m_running(false),
+		m_acquiring(false),
+		m_controllerAddress(0),
+		m_controllerPort(0),
+		m_timestampOffset(0),
+		m_timestampLatch(0),
+		m_eventId(0),
+		m_random(settings.seed),
+		m_lossRemaining(0),
+		m_startTime(std::chrono::steady_clock::now())
+	{
+		InitializeRegisters();
+	}
+
+	~DeviceEmulator()
+	{
+		Stop();
+	}
+
+	void Start()
+	{
+		m_gvcpSocket = OpenUdpSocket(GVCP_PORT);
+		m_streamSocket = OpenUdpSocket(0);
+		m_messageSocket = OpenUdpSocket(0);
+		SetRegister(REG_SCSP, GetSocketPort(m_streamSocket));
+		SetRegister(REG_MCSP, GetSocketPort(m_messageSocket));
+
+		m_running = true;
+		m_controlThread = std::thread(&DeviceEmulator::ControlThread, this);
+		m_streamThread = std::thread(&DeviceEmulator::StreamThread, this);
+	}
+
+	void Stop()
+	{
+		if (!m_running)
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_running = false;
+			m_acquiring = false;
+		}
+		m_acquisitionChanged.notify_all();
+		m_controlThread.join();
+		m_streamThread.join();
+
+		CloseSocket(m_gvcpSocket);
+		CloseSocket(m_streamSocket);
+		CloseSocket(m_messageSocket);
+	}
+
+	const EmulatorStats& GetStats() const
+	{
+		return m_stats;
+	}
+
+private:
+	// frame kept for packet resend
+	struct Frame
+	{
+		uint16_t blockId;
+		uint64_t timestamp;
+		uint16_t payloadType;
+		uint32_t pixelFormat;
+		uint32_t width;
+		uint32_t height;
+		uint32_t offsetX;
+		uint32_t offsetY;
+		uint32_t packetDataSize;
+		uint32_t numDataPackets;
+		std::vector<uint8_t> payload;
+	};
+
+	// stream channel configuration, latched when acquisition starts
+	struct StreamConfig
+	{
+		uint32_t destination;
+		uint16_t port;
+		uint32_t packetSize;
+		uint32_t width;
+		uint32_t height;
+		uint32_t offsetX;
+		uint32_t offsetY;
+		const PixelFormatInfo* pPixelFormat;
+		bool chunkModeActive;
+		bool chunkEnable[NUM_CHUNKS];
+		bool singleFrame;
+	};
+
+	// =-=-=-=-=-=-=-=-=-
+	// =-=- REGISTERS -=-
+	// =-=-=-=-=-=-=-=-=-
+
+	void InitializeRegisters()
+	{
+		SetRegister(REG_VERSION, 0x00010002);
+		SetRegister(REG_DEVICE_MODE, 0x80000001);
+		SetRegister(REG_MAC_HIGH, static_cast<uint32_t>(m_settings.macAddress >> 32) & 0xFFFF);
+		SetRegister(REG_MAC_LOW, static_cast<uint32_t>(m_settings.macAddress));
+		SetRegister(REG_NETWORK_CAPABILITY, 0x00000007);
+		SetRegister(REG_NETWORK_CONFIGURATION, 0x00000005);
+		SetRegister(REG_CURRENT_IP, m_settings.address);
+		SetRegister(REG_CURRENT_SUBNET, m_settings.subnet);
+		SetRegister(REG_CURRENT_GATEWAY, m_settings.gateway);
+		SetString(REG_MANUFACTURER_NAME, 32, MANUFACTURER_NAME);
+		SetString(REG_MODEL_NAME, 32, MODEL_NAME);
+		SetString(REG_DEVICE_VERSION, 32, DEVICE_VERSION);
+		SetString(REG_MANUFACTURER_INFO, 48, "Software device");
+		SetString(REG_SERIAL_NUMBER, 16, m_settings.serialNumber);
+
+		std::ostringstream url;
+		url << "Local:GigEVisionEmulator.xml;" << std::hex << XML_ADDRESS << ";" << m_xml.size();
+		SetString(REG_FIRST_URL, 512, url.str());
+
+		SetRegister(REG_NUM_INTERFACES, 1);
+		SetRegister(REG_PERSISTENT_IP, m_settings.address);
+		SetRegister(REG_PERSISTENT_SUBNET, m_settings.subnet);
+		SetRegister(REG_PERSISTENT_GATEWAY, m_settings.gateway);
+		SetRegister(REG_NUM_MESSAGE_CHANNELS, 1);
+		SetRegister(REG_NUM_STREAM_CHANNELS, 1);
+
+		// user name, serial number, heartbeat disable, event, packet resend, write memory
+		SetRegister(REG_GVCP_CAPABILITY, 0xE000000E);
+		SetRegister(REG_HEARTBEAT_TIMEOUT, 3000);
+		SetRegister(REG_TICK_FREQUENCY_HIGH, 0);
+		SetRegister(REG_TICK_FREQUENCY_LOW, 1000000000);
+		SetRegister(REG_MCTT, 300);
+		SetRegister(REG_MCRC, 2);
+		SetRegister(REG_SCPS, 1500);
+
+		SetRegister(REG_WIDTH, m_settings.width);
+		SetRegister(REG_HEIGHT, m_settings.height);
+		SetRegister(REG_PIXEL_FORMAT, m_settings.pixelFormat);
+		SetRegister(REG_ACQUISITION_FRAME_RATE, FloatToBits(m_settings.frameRate));
+		SetRegister(REG_EXPOSURE_TIME, FloatToBits(1000.0f));
+		SetRegister(REG_GAIN, FloatToBits(0.0f));
+		SetRegister(REG_WIDTH_MAX, MAX_WIDTH);
+		SetRegister(REG_HEIGHT_MAX, MAX_HEIGHT);
+	}
+
+	// locates a register
+	//    Ranges are compared without forming address + length, which could
+	//    wrap around for addresses near the top of the address space.
+	uint8_t* RegisterPointer(uint32_t address, uint32_t length)
+	{
+		if (length <= BOOTSTRAP_SIZE && address <= BOOTSTRAP_SIZE - length)
+			return &m_bootstrap[address];
+		if (address >= DEVICE_REGISTERS_BASE && length <= DEVICE_REGISTERS_SIZE && address - DEVICE_REGISTERS_BASE <= DEVICE_REGISTERS_SIZE - length)
+			return &m_device[address - DEVICE_REGISTERS_BASE];
+		return NULL;
+	}
+
+	void SetRegister(uint32_t address, uint32_t value)
+	{
+		Put32(RegisterPointer(address, 4), value);
+	}
+
+	uint32_t GetRegister(uint32_t address)
+	{
+		return Get32(RegisterPointer(address, 4));
+	}
+
+	void SetString(uint32_t address, uint32_t length, const std::string& value)
+	{
+		uint8_t* p = RegisterPointer(address, length);
+		memset(p, 0, length);
+		memcpy(p, value.c_str(), std::min<size_t>(value.size(), length - 1));
+	}
+
+	uint64_t GetTimestamp()
+	{
+		auto elapsed = std::chrono::steady_clock::now() - m_startTime;
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) - m_timestampOffset;
+	}
+
+	uint32_t GetPayloadSize(const PixelFormatInfo* pPixelFormat, uint32_t width, uint32_t height, bool chunkModeActive, const bool* chunkEnable)
+	{
+		uint32_t size = width * height * pPixelFormat->bitsPerPixel / 8;
+		if (chunkModeActive)
+		{
+			size += 8;
+			for (uint32_t i = 0; i < NUM_CHUNKS; i++)
+			{
+				if (chunkEnable[i])
+					size += CHUNK_SIZE + 8;
+			}
+		}
+		return size;
+	}
+
+	StreamConfig GetStreamConfig()
+	{
+		StreamConfig config;
+		config.destination = GetRegister(REG_SCDA);
+		config.port = static_cast<uint16_t>(GetRegister(REG_SCP));
+		config.packetSize = GetRegister(REG_SCPS) & SCPS_PACKET_SIZE_MASK;
+		config.width = GetRegister(REG_WIDTH);
+		config.height = GetRegister(REG_HEIGHT);
+		config.offsetX = GetRegister(REG_OFFSET_X);
+		config.offsetY = GetRegister(REG_OFFSET_Y);
+		config.pPixelFormat = FindPixelFormat(GetRegister(REG_PIXEL_FORMAT));
+		config.chunkModeActive = GetRegister(REG_CHUNK_MODE_ACTIVE) != 0;
+		for (uint32_t i = 0; i < NUM_CHUNKS; i++)
+			config.chunkEnable[i] = GetRegister(REG_CHUNK_ENABLE + 4 * i) != 0;
+		config.singleFrame = GetRegister(REG_ACQUISITION_MODE) == 1;
+		return config;
+	}
+
+	// reads one register, computing values that change on the device side
+	uint16_t ReadRegister(uint32_t address, uint32_t& value)
+	{
+		if (address % 4 != 0)
+			return GEV_STATUS_BAD_ALIGNMENT;
+
+		if (address == REG_PAYLOAD_SIZE)
+		{
+			StreamConfig config = GetStreamConfig();
+			value = GetPayloadSize(config.pPixelFormat, config.width, config.height, config.chunkModeActive, config.chunkEnable);
+			return GEV_STATUS_SUCCESS;
+		}
+		if (address == REG_TIMESTAMP_HIGH || address == REG_TIMESTAMP_LOW)
+		{
+			value = static_cast<uint32_t>(address == REG_TIMESTAMP_HIGH ? m_timestampLatch >> 32 : m_timestampLatch);
+			return GEV_STATUS_SUCCESS;
+		}
+
+		uint8_t* p = RegisterPointer(address, 4);
+		if (!p)
+			return GEV_STATUS_INVALID_ADDRESS;
+		value = Get32(p);
+		return GEV_STATUS_SUCCESS;
+	}
+
+	// writes one register, validating the value and acting on commands
+	uint16_t WriteRegister(uint32_t address, uint32_t value)
+	{
+		if (address % 4 != 0)
+			return GEV_STATUS_BAD_ALIGNMENT;
+
+		bool locked = GetRegister(REG_TL_PARAMS_LOCKED) != 0;
+
+		switch (address)
+		{
+		case REG_NETWORK_CONFIGURATION:
+		case REG_PERSISTENT_IP:
+		case REG_PERSISTENT_SUBNET:
+		case REG_PERSISTENT_GATEWAY:
+		case REG_GVCP_CONFIGURATION:
+		case REG_MCP:
+		case REG_MCDA:
+		case REG_MCTT:
+		case REG_MCRC:
+		case REG_SCPD:
+		case REG_SCCFG:
+		case REG_ACQUISITION_FRAME_RATE:
+		case REG_EXPOSURE_TIME:
+		case REG_GAIN:
+		case REG_TL_PARAMS_LOCKED:
+		case REG_CHUNK_SELECTOR:
+		case REG_EVENT_SELECTOR:
+			SetRegister(address, value);
+			return GEV_STATUS_SUCCESS;
+
+		case REG_HEARTBEAT_TIMEOUT:
+			SetRegister(address, std::max<uint32_t>(value, 500));
+			return GEV_STATUS_SUCCESS;
+
+		case REG_TIMESTAMP_CONTROL:
+			if (value & TIMESTAMP_CONTROL_RESET)
+				m_timestampOffset += GetTimestamp();
+			if (value & TIMESTAMP_CONTROL_LATCH)
+				m_timestampLatch = GetTimestamp();
+			return GEV_STATUS_SUCCESS;
+
+		case REG_SCP:
+		case REG_SCDA:
+			SetRegister(address, value);
+			return GEV_STATUS_SUCCESS;
+
+		case REG_SCPS:
+		{
+			uint32_t packetSize = value & SCPS_PACKET_SIZE_MASK;
+			if (packetSize < 576 || packetSize > 9000)
+				return GEV_STATUS_INVALID_PARAMETER;
+			SetRegister(address, value & ~SCPS_FIRE_TEST_PACKET);
+			if (value & SCPS_FIRE_TEST_PACKET)
+				SendTestPacket(packetSize);
+			return GEV_STATUS_SUCCESS;
+		}
+
+		case REG_WIDTH:
+		case REG_HEIGHT:
+		case REG_OFFSET_X:
+		case REG_OFFSET_Y:
+		{
+			if (locked)
+				return GEV_STATUS_ACCESS_DENIED;
+			uint32_t width = address == REG_WIDTH ? value : GetRegister(REG_WIDTH);
+			uint32_t height = address == REG_HEIGHT ? value : GetRegister(REG_HEIGHT);
+			uint32_t offsetX = address == REG_OFFSET_X ? value : GetRegister(REG_OFFSET_X);
+			uint32_t offsetY = address == REG_OFFSET_Y ? value : GetRegister(REG_OFFSET_Y);
+			if (width < 16 || height < 16 || width % 4 != 0 || offsetX % 4 != 0 ||
+				offsetX + width > MAX_WIDTH || offsetY + height > MAX_HEIGHT)
+				return GEV_STATUS_INVALID_PARAMETER;
+			SetRegister(address, value);
+			return GEV_STATUS_SUCCESS;
+		}
+
+		case REG_PIXEL_FORMAT:
+			if (locked)
+				return GEV_STATUS_ACCESS_DENIED;
+			if (!FindPixelFormat(value))
+				return GEV_STATUS_INVALID_PARAMETER;
+			SetRegister(address, value);
+			return GEV_STATUS_SUCCESS;
+
+		case REG_ACQUISITION_MODE:
+		case REG_CHUNK_MODE_ACTIVE:
+			if (locked)
+				return GEV_STATUS_ACCESS_DENIED;
+			if (value > 1)
+				return GEV_STATUS_INVALID_PARAMETER;
+			SetRegister(address, value);
+			return GEV_STATUS_SUCCESS;
+
+		case REG_ACQUISITION_START:
+			if (GetRegister(REG_SCDA) == 0 || GetRegister(REG_SCP) == 0)
+				return GEV_STATUS_ACCESS_DENIED;
+			m_acquiring = true;
+			m_acquisitionChanged.notify_all();
+			return GEV_STATUS_SUCCESS;
+
+		case REG_ACQUISITION_STOP:
+			m_acquiring = false;
+			m_acquisitionChanged.notify_all();
+			return GEV_STATUS_SUCCESS;
+
+		case REG_TEST_EVENT_GENERATE:
+			if (GetRegister(REG_EVENT_NOTIFICATION) != 0)
+				SendEvent(EVENT_ID_TEST, 0, GetTimestamp());
+			return GEV_STATUS_SUCCESS;
+
+		default:
+			break;
+		}
+
+		if (address >= REG_CHUNK_ENABLE && address < REG_CHUNK_ENABLE + 4 * NUM_CHUNKS)
+		{
+			if (locked)
+				return GEV_STATUS_ACCESS_DENIED;
+			SetRegister(address, value != 0);
+			return GEV_STATUS_SUCCESS;
+		}
+		if (address >= REG_EVENT_NOTIFICATION && address < REG_EVENT_NOTIFICATION + 4 * NUM_EVENTS)
+		{
+			SetRegister(address, value != 0);
+			return GEV_STATUS_SUCCESS;
+		}
+
+		return RegisterPointer(address, 4) ? GEV_STATUS_WRITE_PROTECT : GEV_STATUS_INVALID_ADDRESS;
+	}
+
+	// checks that a block of memory ends inside the 32-bit address space
+	static bool FitsAddressSpace(uint32_t address, uint32_t count)
+	{
+		return count == 0 || count - 1 <= 0xFFFFFFFF - address;
+	}
+
+	// reads device memory, including the XML
+	uint16_t ReadMemory(uint32_t address, uint32_t count, uint8_t* pData)
+	{
+		if (!FitsAddressSpace(address, count))
+			return GEV_STATUS_INVALID_ADDRESS;
+
+		if (address >= XML_ADDRESS)
+		{
+			uint32_t offset = address - XML_ADDRESS;
+			if (count > AlignedXmlSize() || offset > AlignedXmlSize() - count)
+				return GEV_STATUS_INVALID_ADDRESS;
+			memset(pData, 0, count);
+			if (offset < m_xml.size())
+				memcpy(pData, m_xml.data() + offset, std::min<size_t>(count, m_xml.size() - offset));
+			return GEV_STATUS_SUCCESS;
+		}
+
+		for (uint32_t i = 0; i < count; i += 4)
+		{
+			uint32_t value = 0;
+			uint16_t status = ReadRegister(address + i, value);
+			if (status != GEV_STATUS_SUCCESS)
+				return status;
+			Put32(pData + i, value);
+		}
+		return GEV_STATUS_SUCCESS;
+	}
+
+	// writes device memory
+	//    The user name is the only string that can be written; everything else
+	//    goes through the register checks a word at a time.
+	uint16_t WriteMemory(uint32_t address, const uint8_t* pData, uint32_t count, uint32_t& written)
+	{
+		written = 0;
+		if (!FitsAddressSpace(address, count))
+			return GEV_STATUS_INVALID_ADDRESS;
+
+		if (address >= REG_USER_NAME && count <= 16 && address - REG_USER_NAME <= 16 - count)
+		{
+			memcpy(&m_bootstrap[address], pData, count);
+			m_bootstrap[REG_USER_NAME + 15] = 0;
+			written = count;
+			return GEV_STATUS_SUCCESS;
+		}
+
+		for (uint32_t i = 0; i < count; i += 4)
+		{
+			uint16_t status = WriteRegister(address + i, Get32(pData + i));
+			if (status != GEV_STATUS_SUCCESS)
+				return status;
+			written += 4;
+		}
+		return GEV_STATUS_SUCCESS;
+	}
+
+	uint32_t AlignedXmlSize() const
+	{
+		return static_cast<uint32_t>((m_xml.size() + 3) / 4 * 4);
+	}
+
+	// =-=-=-=-=-=-=-=-=-
+	// =-=- CONTROL -=-=-=-
+	// =-=-=-=-=-=-=-=-=-
+
+	// serves GVCP requests until stopped
+	void ControlThread()
+	{
+		std::vector<uint8_t> request(GVCP_MAX_PACKET * 2);
+		auto lastHeartbeat = std::chrono::steady_clock::now();
+
+		while (m_running)
+		{
+			fd_set readSet;
+			FD_ZERO(&readSet);
+			FD_SET(m_gvcpSocket, &readSet);
+			struct timeval timeout = { 0, 100000 };
+
+			if (select(static_cast<int>(m_gvcpSocket + 1), &readSet, NULL, NULL, &timeout) > 0)
+			{
+				struct sockaddr_in sender;
+				socklen_t senderLength = sizeof(sender);
+				int received = static_cast<int>(recvfrom(m_gvcpSocket, reinterpret_cast<char*>(&request[0]), static_cast<int>(request.size()), 0, reinterpret_cast<struct sockaddr*>(&sender), &senderLength));
+
+				if (received >= 8 && request[0] == GVCP_KEY)
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					HandleCommand(&request[0], static_cast<uint32_t>(received), sender);
+
+					// any command from the controlling application counts as a heartbeat
+					if (ntohl(sender.sin_addr.s_addr) == m_controllerAddress && ntohs(sender.sin_port) == m_controllerPort)
+						lastHeartbeat = std::chrono::steady_clock::now();
+				}
+			}
+
+			// release control once the heartbeat has expired
+			std::lock_guard<std::mutex> lock(m_mutex);
+			bool heartbeatDisabled = (GetRegister(REG_GVCP_CONFIGURATION) & GVCP_CONFIGURATION_HEARTBEAT_DISABLE) != 0;
+			auto heartbeatTimeout = std::chrono::milliseconds(GetRegister(REG_HEARTBEAT_TIMEOUT));
+			if (m_controllerAddress != 0 && !heartbeatDisabled && std::chrono::steady_clock::now() - lastHeartbeat > heartbeatTimeout)
+			{
+				std::cout << TAB1 << "Heartbeat expired; releasing control of " << Uint32ToAddressStr(m_controllerAddress) << "\n";
+				ReleaseControl();
+			}
+		}
+	}
+
+	void ReleaseControl()
+	{
+		m_controllerAddress = 0;
+		m_controllerPort = 0;
+		SetRegister(REG_CCP, 0);
+		SetRegister(REG_TL_PARAMS_LOCKED, 0);
+		SetRegister(REG_SCDA, 0);
+		SetRegister(REG_SCP, 0);
+		SetRegister(REG_MCDA, 0);
+		SetRegister(REG_MCP, 0);
+		m_acquiring = false;
+		m_acquisitionChanged.notify_all();
+	}
+
+	// handles one GVCP command; called with the register mutex held
+	void HandleCommand(const uint8_t* pRequest, uint32_t size, const struct sockaddr_in& sender)
+	{
+		uint8_t flags = pRequest[1];
+		uint16_t command = Get16(pRequest + 2);
+		uint32_t length = std::min<uint32_t>(Get16(pRequest + 4), size - 8);
+		uint16_t reqId = Get16(pRequest + 6);
+		const uint8_t* pPayload = pRequest + 8;
+
+		uint32_t senderAddress = ntohl(sender.sin_addr.s_addr);
+		uint16_t senderPort = ntohs(sender.sin_port);
+		bool isController = m_controllerAddress == senderAddress && m_controllerPort == senderPort;
+		bool exclusive = (GetRegister(REG_CCP) & CCP_EXCLUSIVE) != 0;
+
+		uint8_t ack[GVCP_MAX_PACKET];
+		uint8_t* pAck = ack + 8;
+		uint32_t ackLength = 0;
+		uint16_t ackCommand = 0;
+		uint16_t status = GEV_STATUS_SUCCESS;
+
+		switch (command)
+		{
+		case GVCP_DISCOVERY_CMD:
+			ackCommand = GVCP_DISCOVERY_ACK;
+			memcpy(pAck, &m_bootstrap[0], DISCOVERY_ACK_SIZE);
+			ackLength = DISCOVERY_ACK_SIZE;
+			flags |= GVCP_FLAG_ACK_REQUIRED;
+			break;
+
+		case GVCP_FORCEIP_CMD:
+			if (length < 56)
+				return;
+			if (Get16(pPayload + 2) != GetRegister(REG_MAC_HIGH) || Get32(pPayload + 4) != GetRegister(REG_MAC_LOW))
+				return;
+			ackCommand = GVCP_FORCEIP_ACK;
+			SetRegister(REG_CURRENT_IP, Get32(pPayload + 20));
+			SetRegister(REG_CURRENT_SUBNET, Get32(pPayload + 36));
+			SetRegister(REG_CURRENT_GATEWAY, Get32(pPayload + 52));
+			std::cout << TAB1 << "Forced IP to " << Uint32ToAddressStr(GetRegister(REG_CURRENT_IP)) << "\n";
+			break;
+
+		case GVCP_READREG_CMD:
+			ackCommand = GVCP_READREG_ACK;
+			if (exclusive && !isController)
+			{
+				status = GEV_STATUS_ACCESS_DENIED;
+				break;
+			}
+			for (uint32_t i = 0; i + 4 <= length && ackLength + 4 <= GVCP_MAX_PACKET - 8; i += 4)
+			{
+				uint32_t value = 0;
+				status = ReadRegister(Get32(pPayload + i), value);
+				if (status != GEV_STATUS_SUCCESS)
+					break;
+				Put32(pAck + ackLength, value);
+				ackLength += 4;
+			}
+			break;
+
+		case GVCP_WRITEREG_CMD:
+		{
+			ackCommand = GVCP_WRITEREG_ACK;
+			uint16_t index = 0;
+			for (uint32_t i = 0; i + 8 <= length; i += 8)
+			{
+				uint32_t address = Get32(pPayload + i);
+				uint32_t value = Get32(pPayload + i + 4);
+				if (address == REG_CCP)
+					status = WriteControlPrivilege(value, senderAddress, senderPort);
+				else if (!isController)
+					status = GEV_STATUS_ACCESS_DENIED;
+				else
+					status = WriteRegister(address, value);
+				if (status != GEV_STATUS_SUCCESS)
+					break;
+				index++;
+			}
+			Put16(pAck, 0);
+			Put16(pAck + 2, index);
+			ackLength = 4;
+			break;
+		}
+
+		case GVCP_READMEM_CMD:
+		{
+			ackCommand = GVCP_READMEM_ACK;
+			uint32_t address = Get32(pPayload);
+			uint32_t count = length >= 8 ? Get16(pPayload + 6) : 0;
+			Put32(pAck, address);
+			ackLength = 4;
+			if (exclusive && !isController)
+				status = GEV_STATUS_ACCESS_DENIED;
+			else if (count == 0 || count % 4 != 0 || address % 4 != 0 || count > GVCP_MAX_PACKET - 12)
+				status = GEV_STATUS_INVALID_PARAMETER;
+			else if ((status = ReadMemory(address, count, pAck + 4)) == GEV_STATUS_SUCCESS)
+				ackLength += count;
+			break;
+		}
+
+		case GVCP_WRITEMEM_CMD:
+		{
+			ackCommand = GVCP_WRITEMEM_ACK;
+			uint32_t written = 0;
+			if (length < 8 || (length - 4) % 4 != 0)
+				status = GEV_STATUS_INVALID_PARAMETER;
+			else if (Get32(pPayload) % 4 != 0)
+				status = GEV_STATUS_BAD_ALIGNMENT;
+			else if (!isController)
+				status = GEV_STATUS_ACCESS_DENIED;
+			else
+				status = WriteMemory(Get32(pPayload), pPayload + 4, length - 4, written);
+			Put16(pAck, 0);
+			Put16(pAck + 2, static_cast<uint16_t>(written));
+			ackLength = 4;
+			break;
+		}
+
+		case GVCP_PACKETRESEND_CMD:
+			// resend has no acknowledge
+			if (length >= 12)
+				ResendPackets(Get16(pPayload + 2), Get32(pPayload + 4) & 0xFFFFFF, Get32(pPayload + 8) & 0xFFFFFF);
+			return;
+
+		default:
+			ackCommand = static_cast<uint16_t>(command + 1);
+			status = GEV_STATUS_NOT_IMPLEMENTED;
+			break;
+		}
+
+		if (!(flags & GVCP_FLAG_ACK_REQUIRED))
+			return;
+
+		Put16(ack, status);
+		Put16(ack + 2, ackCommand);
+		Put16(ack + 4, static_cast<uint16_t>(ackLength));
+		Put16(ack + 6, reqId);
+		sendto(m_gvcpSocket, reinterpret_cast<const char*>(ack), 8 + ackLength, 0, reinterpret_cast<const struct sockaddr*>(&sender), sizeof(sender));
+	}
+
+	// grants or releases control of the device
+	uint16_t WriteControlPrivilege(uint32_t value, uint32_t senderAddress, uint16_t senderPort)
+	{
+		bool isController = m_controllerAddress == senderAddress && m_controllerPort == senderPort;
+
+		if (m_controllerAddress != 0 && !isController)
+			return GEV_STATUS_ACCESS_DENIED;
+
+		if (value & (CCP_CONTROL | CCP_EXCLUSIVE))
+		{
+			if (!isController)
+				std::cout << TAB1 << "Control granted to " << Uint32ToAddressStr(senderAddress) << ":" << senderPort << "\n";
+			m_controllerAddress = senderAddress;
+			m_controllerPort = senderPort;
+			SetRegister(REG_CCP, value & (CCP_CONTROL | CCP_EXCLUSIVE));
+		}
+		else if (isController)
+		{
+			std::cout << TAB1 << "Control released by " << Uint32ToAddressStr(senderAddress) << "\n";
+			ReleaseControl();
+		}
+		return GEV_STATUS_SUCCESS;
+	}
+
+	// sends an event on the message channel
+	//    Events are sent once; acknowledges from the host are not waited for.
+	void SendEvent(uint16_t eventId, uint16_t blockId, uint64_t timestamp)
+	{
+		uint32_t destination = GetRegister(REG_MCDA);
+		uint16_t port = static_cast<uint16_t>(GetRegister(REG_MCP));
+		if (destination == 0 || port == 0)
+			return;
+
+		uint8_t packet[8 + 16];
+		packet[0] = GVCP_KEY;
+		packet[1] = 0;
+		Put16(packet + 2, GVCP_EVENT_CMD);
+		Put16(packet + 4, 16);
+		if (++m_eventId == 0)
+			m_eventId = 1;
+		Put16(packet + 6, m_eventId);
+		Put16(packet + 8, 0);
+		Put16(packet + 10, eventId);
+		Put16(packet + 12, 0);
+		Put16(packet + 14, blockId);
+		Put64(packet + 16, timestamp);
+
+		struct sockaddr_in addr = MakeSocketAddress(destination, port);
+		sendto(m_messageSocket, reinterpret_cast<const char*>(packet), sizeof(packet), 0, reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr));
+		m_stats.eventsSent++;
+	}
+
+	// =-=-=-=-=-=-=-=-=-
+	// =-=- STREAM -=-=-=-
+	// =-=-=-=-=-=-=-=-=-
+
+	// produces frames while acquisition is running
+	void StreamThread()
+	{
+		std::vector<char> fileData;
+		uint64_t frameCounter = 0;
+		uint16_t blockId = 0;
+
+		while (true)
+		{
+			StreamConfig config;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_acquisitionChanged.wait(lock, [this]() { return m_acquiring || !m_running; });
+				if (!m_running)
+					return;
+				config = GetStreamConfig();
+			}
+
+			uint32_t imageSize = config.width * config.height * config.pPixelFormat->bitsPerPixel / 8;
+			LoadFrameFile(imageSize, fileData);
+			std::cout << TAB1 << "Acquisition started: " << config.width << "x" << config.height << " " << config.pPixelFormat->name
+					  << " to " << Uint32ToAddressStr(config.destination) << ":" << config.port << "\n";
+
+			auto nextFrame = std::chrono::steady_clock::now();
+			while (true)
+			{
+				float frameRate;
+				float exposureTime;
+				float gain;
+				uint32_t packetDelay;
+				bool exposureEndEvent;
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_acquisitionChanged.wait_until(lock, nextFrame, [this]() { return !m_acquiring; });
+					if (!m_acquiring)
+						break;
+					frameRate = std::max(BitsToFloat(GetRegister(REG_ACQUISITION_FRAME_RATE)), 0.1f);
+					exposureTime = BitsToFloat(GetRegister(REG_EXPOSURE_TIME));
+					gain = BitsToFloat(GetRegister(REG_GAIN));
+					packetDelay = GetRegister(REG_SCPD);
+					exposureEndEvent = GetRegister(REG_EVENT_NOTIFICATION + 4) != 0;
+				}
+				nextFrame += std::chrono::nanoseconds(static_cast<int64_t>(1e9 / frameRate));
+
+				// frame IDs run from 1 to 65535 and skip 0
+				blockId = static_cast<uint16_t>(blockId == 0xFFFF ? 1 : blockId + 1);
+
+				std::shared_ptr<Frame> pFrame = AcquireFrame();
+				BuildFrame(*pFrame, config, blockId, frameCounter++, fileData, exposureTime, gain);
+				SendFrame(*pFrame, config, packetDelay);
+
+				if (exposureEndEvent)
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					SendEvent(EVENT_ID_EXPOSURE_END, pFrame->blockId, pFrame->timestamp);
+				}
+
+				{
+					std::lock_guard<std::mutex> lock(m_historyMutex);
+					m_history.push_back(pFrame);
+					if (m_history.size() > RESEND_HISTORY)
+						m_history.pop_front();
+				}
+				m_stats.framesSent++;
+
+				if (config.singleFrame)
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_acquiring = false;
+					break;
+				}
+			}
+
+			std::cout << TAB1 << "Acquisition stopped\n";
+		}
+	}
+
+	// reuses the oldest frame buffer once the history is full
+	std::shared_ptr<Frame> AcquireFrame()
+	{
+		std::lock_guard<std::mutex> lock(m_historyMutex);
+		if (m_history.size() == RESEND_HISTORY && m_history.front().use_count() == 1)
+		{
+			std::shared_ptr<Frame> pFrame = m_history.front();
+			m_history.pop_front();
+			return pFrame;
+		}
+		return std::make_shared<Frame>();
+	}
+
+	// loads the frame file, if any, for the current image size
+	void LoadFrameFile(uint32_t imageSize, std::vector<char>& fileData)
+	{
+		fileData.clear();
+		if (m_settings.frameFile.empty())
+			return;
+
+		std::ifstream file(m_settings.frameFile.c_str(), std::ios::binary);
+		fileData.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		if (fileData.size() < imageSize || fileData.size() % imageSize != 0)
+		{
+			std::cout << TAB1 << "Frame file " << m_settings.frameFile << " does not hold whole frames of " << imageSize
+					  << " bytes; streaming synthetic frames instead\n";
+			fileData.clear();
+		}
+	}
+
+	// fills in the payload of a frame
+	//    Without a frame file, the image is a diagonal ramp that moves by one
+	//    pixel per frame, so dropped or repeated frames are easy to spot.
+	void BuildFrame(Frame& frame, const StreamConfig& config, uint16_t blockId, uint64_t frameCounter, const std::vector<char>& fileData, float exposureTime, float gain)
+	{
+		const PixelFormatInfo* pPixelFormat = config.pPixelFormat;
+		uint32_t imageSize = config.width * config.height * pPixelFormat->bitsPerPixel / 8;
+		uint32_t payloadSize = GetPayloadSize(pPixelFormat, config.width, config.height, config.chunkModeActive, config.chunkEnable);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			frame.timestamp = GetTimestamp();
+		}
+		frame.blockId = blockId;
+		frame.payloadType = config.chunkModeActive ? GVSP_PAYLOAD_IMAGE_EXTENDED_CHUNK : GVSP_PAYLOAD_IMAGE;
+		frame.pixelFormat = pPixelFormat->value;
+		frame.width = config.width;
+		frame.height = config.height;
+		frame.offsetX = config.offsetX;
+		frame.offsetY = config.offsetY;
+		frame.payload.resize(payloadSize);
+		uint8_t* pData = &frame.payload[0];
+
+		if (!fileData.empty())
+		{
+			size_t numFrames = fileData.size() / imageSize;
+			memcpy(pData, &fileData[(frameCounter % numFrames) * imageSize], imageSize);
+		}
+		else
+		{
+			uint32_t bytesPerPixel = pPixelFormat->bitsPerPixel / 8;
+			for (uint32_t y = 0; y < config.height; y++)
+			{
+				uint8_t* pRow = pData + static_cast<size_t>(y) * config.width * bytesPerPixel;
+				for (uint32_t x = 0; x < config.width; x++)
+				{
+					uint8_t value = static_cast<uint8_t>(x + y + frameCounter);
+					for (uint32_t b = 0; b < bytesPerPixel; b++)
+						pRow[x * bytesPerPixel + b] = value;
+				}
+			}
+		}
+
+		// chunks follow the image, each closed by its ID and length
+		if (config.chunkModeActive)
+		{
+			uint8_t* p = pData + imageSize;
+			Put32(p, CHUNK_ID_IMAGE);
+			Put32(p + 4, imageSize);
+			p += 8;
+
+			for (uint32_t i = 0; i < NUM_CHUNKS; i++)
+			{
+				if (!config.chunkEnable[i])
+					continue;
+
+				uint64_t bits = frame.timestamp;
+				if (i != 2)
+				{
+					double value = i == 0 ? exposureTime : gain;
+					memcpy(&bits, &value, sizeof(bits));
+				}
+				Put64(p, bits);
+				Put32(p + CHUNK_SIZE, CHUNK_IDS[i]);
+				Put32(p + CHUNK_SIZE + 4, CHUNK_SIZE);
+				p += CHUNK_SIZE + 8;
+			}
+		}
+
+		frame.packetDataSize = config.packetSize - GVSP_OVERHEAD;
+		frame.numDataPackets = (payloadSize + frame.packetDataSize - 1) / frame.packetDataSize;
+	}
+
+	// sends the leader, payload and trailer packets of a frame
+	void SendFrame(const Frame& frame, const StreamConfig& config, uint32_t packetDelay)
+	{
+		struct sockaddr_in addr = MakeSocketAddress(config.destination, config.port);
+		std::vector<uint8_t> packet(config.packetSize);
+
+		for (uint32_t packetId = 0; packetId <= frame.numDataPackets + 1; packetId++)
+		{
+			if (DropPacket())
+			{
+				m_stats.packetsDropped++;
+				continue;
+			}
+
+			uint32_t size = BuildPacket(frame, packetId, &packet[0]);
+			sendto(m_streamSocket, reinterpret_cast<const char*>(&packet[0]), size, 0, reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr));
+			m_stats.packetsSent++;
+
+			// packet delay is given in timestamp ticks, which are nanoseconds
+			if (packetDelay != 0)
+				std::this_thread::sleep_for(std::chrono::nanoseconds(packetDelay));
+		}
+	}
+
+	// builds one GVSP packet; returns its size
+	uint32_t BuildPacket(const Frame& frame, uint32_t packetId, uint8_t* pPacket)
+	{
+		uint8_t format;
+		uint32_t size = 8;
+		uint8_t* p = pPacket + 8;
+
+		if (packetId == 0)
+		{
+			format = GVSP_FORMAT_LEADER;
+			Put16(p, 0);
+			Put16(p + 2, frame.payloadType);
+			Put64(p + 4, frame.timestamp);
+			Put32(p + 12, frame.pixelFormat);
+			Put32(p + 16, frame.width);
+			Put32(p + 20, frame.height);
+			Put32(p + 24, frame.offsetX);
+			Put32(p + 28, frame.offsetY);
+			Put16(p + 32, 0);
+			Put16(p + 34, 0);
+			size += GVSP_LEADER_SIZE;
+		}
+		else if (packetId == frame.numDataPackets + 1)
+		{
+			format = GVSP_FORMAT_TRAILER;
+			Put16(p, 0);
+			Put16(p + 2, frame.payloadType);
+			Put32(p + 4, frame.height);
+			size += 8;
+			if (frame.payloadType == GVSP_PAYLOAD_IMAGE_EXTENDED_CHUNK)
+			{
+				Put32(p + 8, 0);
+				size += 4;
+			}
+		}
+		else
+		{
+			format = GVSP_FORMAT_PAYLOAD;
+			size_t offset = static_cast<size_t>(packetId - 1) * frame.packetDataSize;
+			uint32_t dataSize = static_cast<uint32_t>(std::min<size_t>(frame.packetDataSize, frame.payload.size() - offset));
+			memcpy(p, &frame.payload[offset], dataSize);
+			size += dataSize;
+		}
+
+		Put16(pPacket, GEV_STATUS_SUCCESS);
+		Put16(pPacket + 2, frame.blockId);
+		Put32(pPacket + 4, (static_cast<uint32_t>(format) << 24) | (packetId & 0xFFFFFF));
+		return size;
+	}
+
+	// resends packets of a recent frame; called with the register mutex held
+	void ResendPackets(uint16_t blockId, uint32_t firstPacketId, uint32_t lastPacketId)
+	{
+		m_stats.resendRequests++;
+
+		struct sockaddr_in addr = MakeSocketAddress(GetRegister(REG_SCDA), static_cast<uint16_t>(GetRegister(REG_SCP)));
+		std::shared_ptr<Frame> pFrame;
+		{
+			std::lock_guard<std::mutex> lock(m_historyMutex);
+			for (auto it = m_history.rbegin(); it != m_history.rend(); ++it)
+			{
+				if ((*it)->blockId == blockId)
+				{
+					pFrame = *it;
+					break;
+				}
+			}
+		}
+
+		// report the whole range as unavailable if the frame is gone
+		if (!pFrame || firstPacketId > lastPacketId || lastPacketId > pFrame->numDataPackets + 1)
+		{
+			for (uint32_t packetId = firstPacketId; packetId <= lastPacketId && packetId - firstPacketId < 1024; packetId++)
+			{
+				uint8_t packet[8];
+				Put16(packet, GEV_STATUS_PACKET_UNAVAILABLE);
+				Put16(packet + 2, blockId);
+				Put32(packet + 4, (static_cast<uint32_t>(GVSP_FORMAT_PAYLOAD) << 24) | packetId);
+				sendto(m_streamSocket, reinterpret_cast<const char*>(packet), sizeof(packet), 0, reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr));
+				m_stats.packetsUnavailable++;
+			}
+			return;
+		}
+
+		std::vector<uint8_t> packet(pFrame->packetDataSize + GVSP_OVERHEAD);
+		for (uint32_t packetId = firstPacketId; packetId <= lastPacketId; packetId++)
+		{
+			if (m_settings.lossOnResend && DropPacket())
+			{
+				m_stats.packetsDropped++;
+				continue;
+			}
+
+			uint32_t size = BuildPacket(*pFrame, packetId, &packet[0]);
+			sendto(m_streamSocket, reinterpret_cast<const char*>(&packet[0]), size, 0, reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr));
+			m_stats.packetsResent++;
+		}
+	}
+
+	// sends a test packet of the given size to the stream channel
+	void SendTestPacket(uint32_t packetSize)
+	{
+		uint32_t destination = GetRegister(REG_SCDA);
+		uint16_t port = static_cast<uint16_t>(GetRegister(REG_SCP));
+		if (destination == 0 || port == 0)
+			return;
+
+		std::vector<uint8_t> packet(packetSize - GVSP_OVERHEAD + 8, 0);
+		struct sockaddr_in addr = MakeSocketAddress(destination, port);
+		sendto(m_streamSocket, reinterpret_cast<const char*>(&packet[0]), static_cast<int>(packet.size()), 0, reinterpret_cast<const struct sockaddr*>(&addr), sizeof(addr));
+	}
+
+	// decides whether to drop the next packet
+	bool DropPacket()
+	{
+		std::lock_guard<std::mutex> lock(m_lossMutex);
+		if (m_lossRemaining > 0)
+		{
+			m_lossRemaining--;
+			return true;
+		}
+		if (m_settings.lossRate > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(m_random) < m_settings.lossRate)
+		{
+			m_lossRemaining = m_settings.lossBurst > 0 ? m_settings.lossBurst - 1 : 0;
+			return true;
+		}
+		return false;
+	}
+
+	EmulatorSettings m_settings;
+	EmulatorStats m_stats;
+
+	// registers and device memory, guarded by m_mutex
+	std::mutex m_mutex;
+	std::vector<uint8_t> m_bootstrap;
+	std::vector<uint8_t> m_device;
+	std::string m_xml;
+
+	Socket m_gvcpSocket;
+	Socket m_streamSocket;
+	Socket m_messageSocket;
+	std::thread m_controlThread;
+	std::thread m_streamThread;
+	std::condition_variable m_acquisitionChanged;
+	std::atomic<bool> m_running;
+	bool m_acquiring;
+
+	uint32_t m_controllerAddress;
+	uint16_t m_controllerPort;
+	uint64_t m_timestampOffset;
+	uint64_t m_timestampLatch;
+	uint16_t m_eventId;
+
+	// frames kept for resend, guarded by m_historyMutex
+	std::mutex m_historyMutex;
+	std::deque<std::shared_ptr<Frame>> m_history;
+
+	// packet loss state, guarded by m_lossMutex
+	std::mutex m_lossMutex;
+	std::mt19937 m_random;
+	uint32_t m_lossRemaining;
+
+	std::chrono::steady_clock::time_point m_startTime;
+};
+
+void PrintUsage()
+{
+	std::cout << std::endl;
+	std::cout << "Usage: GevEmulatorUtility -<arg> <arg_value>" << std::endl
+			  << std::endl;
+
+	std::cout << " \t -a: The IP address the device reports (default \"" << DEFAULT_ADDRESS << "\")" << std::endl;
+	std::cout << " \t -s: The subnet the device reports (default \"" << DEFAULT_SUBNET << "\")" << std::endl;
+	std::cout << " \t -g: The gateway the device reports (default \"0.0.0.0\")" << std::endl;
+	std::cout << " \t -m: The MAC address of the device (eg. \"0x021C0FAF0001\")" << std::endl;
+	std::cout << " \t -n: The serial number of the device (eg. \"" << DEFAULT_SERIAL << "\")" << std::endl;
+	std::cout << " \t -w: Initial width (default " << DEFAULT_WIDTH << ")" << std::endl;
+	std::cout << " \t -h: Initial height (default " << DEFAULT_HEIGHT << ")" << std::endl;
+	std::cout << " \t -x: Initial pixel format: Mono8, Mono16, BayerRG8 or RGB8 (default " << DEFAULT_PIXEL_FORMAT << ")" << std::endl;
+	std::cout << " \t -r: Initial frame rate in Hz (default " << DEFAULT_FRAME_RATE << ")" << std::endl;
+	std::cout << " \t -f: Raw file of frames to stream instead of the synthetic pattern" << std::endl;
+	std::cout << " \t -l: Packet loss rate between 0 and 1 (default 0)" << std::endl;
+	std::cout << " \t -b: Number of packets dropped in a row per loss (default 1)" << std::endl;
+	std::cout << " \t -t: Also drop resent packets (eg. \"true\")" << std::endl;
+	std::cout << " \t -e: Seed for the packet loss generator (default 1)" << std::endl;
+	std::cout << " \t For example $> GevEmulatorUtility -a 127.0.0.1 -w 2048 -h 1536 -r 120 -l 0.001 -b 4" << std::endl;
+	std::cout << std::endl;
+}
+
+bool ToBool(std::string boolStr)
+{
+	bool bOut = false;
+	std::istringstream(boolStr) >> std::boolalpha >> bOut;
+	return bOut;
+}
+
+int main(int argc, char** argv)
+{
+	int ret = 0;
+
+#if defined(_WIN32) || defined(_WIN64)
+	WSADATA wsaData;
+	WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+	try
+	{
+		CliParser parser(argc, argv);
+
+		if (parser.ArgumentExists("/help") || parser.ArgumentExists("-?"))
+		{
+			PrintUsage();
+			return 0;
+		}
+
+		EmulatorSettings settings;
+		settings.address = AddressStrToUint32(parser.GetArgument("-a", DEFAULT_ADDRESS));
+		settings.subnet = AddressStrToUint32(parser.GetArgument("-s", DEFAULT_SUBNET));
+		settings.gateway = AddressStrToUint32(parser.GetArgument("-g", "0.0.0.0"));
+		settings.macAddress = std::stoull(parser.GetArgument("-m", std::to_string(DEFAULT_MAC)), nullptr, 0);
+		settings.serialNumber = parser.GetArgument("-n", DEFAULT_SERIAL);
+		settings.width = std::stoul(parser.GetArgument("-w", std::to_string(DEFAULT_WIDTH)));
+		settings.height = std::stoul(parser.GetArgument("-h", std::to_string(DEFAULT_HEIGHT)));
+		settings.frameRate = std::stof(parser.GetArgument("-r", std::to_string(DEFAULT_FRAME_RATE)));
+		settings.frameFile = parser.GetArgument("-f", "");
+		settings.lossRate = std::stod(parser.GetArgument("-l", "0"));
+		settings.lossBurst = std::stoul(parser.GetArgument("-b", "1"));
+		settings.lossOnResend = ToBool(parser.GetArgument("-t", "false"));
+		settings.seed = std::stoul(parser.GetArgument("-e", "1"));
+
+		const PixelFormatInfo* pPixelFormat = FindPixelFormat(parser.GetArgument("-x", DEFAULT_PIXEL_FORMAT));
+		if (!pPixelFormat)
+			throw std::logic_error("Unsupported pixel format " + parser.GetArgument("-x", DEFAULT_PIXEL_FORMAT));
+		settings.pixelFormat = pPixelFormat->value;
+
+		if (settings.width < 16 || settings.width > MAX_WIDTH || settings.width % 4 != 0 || settings.height < 16 || settings.height > MAX_HEIGHT)
+			throw std::logic_error("Width must be a multiple of 4 from 16 to 4096 and height from 16 to 4096");
+
+		std::cout << "GigE Vision Emulator\n";
+		std::cout << TAB1 << "Address " << Uint32ToAddressStr(settings.address) << ", serial " << settings.serialNumber << "\n";
+		std::cout << TAB1 << settings.width << "x" << settings.height << " " << pPixelFormat->name << " at " << settings.frameRate << " Hz";
+		if (settings.lossRate > 0.0)
+			std::cout << ", packet loss " << settings.lossRate << " in bursts of " << settings.lossBurst;
+		std::cout << "\n";
+
+		DeviceEmulator emulator(settings);
+		emulator.Start();
+
+		std::cout << "Press enter to stop the emulator\n";
+		std::getchar();
+
+		emulator.Stop();
+
+		const EmulatorStats& stats = emulator.GetStats();
+		std::cout << TAB1 << "Frames sent " << stats.framesSent << "\n";
+		std::cout << TAB1 << "Packets sent " << stats.packetsSent << ", dropped " << stats.packetsDropped << "\n";
+		std::cout << TAB1 << "Resend requests " << stats.resendRequests << ", packets resent " << stats.packetsResent
+				  << ", unavailable " << stats.packetsUnavailable << "\n";
+		std::cout << TAB1 << "Events sent " << stats.eventsSent << "\n";
+	}
+	catch (std::exception& e)
+	{
+		std::cout << "Std Error: " << e.what() << std::endl;
+		PrintUsage();
+		ret = -1;
+	}
+
+#if defined(_WIN32) || defined(_WIN64)
+	WSACleanup();
+#endif
+
+	return ret;
+}
@@ -0,0 +1,1568 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+ // GvspReceiverUtility.cpp : Defines the entry point for the console application.
+ //
+ // Benchmark for GVSP receive strategies on Linux. A receive thread
+ // reassembles GVSP blocks (leader, payload packets, trailer) into frame
+ // buffers using one of several socket receive modes, and reports throughput,
+ // system calls per packet and the CPU time the receive thread spends per
+ // packet:
+ //
+ //   recv  one recv call per packet, payload copied into the frame buffer
+ //   mmsg  recvmmsg batches; each batch is scattered so that payloads land
+ //         directly at their predicted offset in the frame buffer, and only
+ //         mispredicted packets (loss, reordering, frame boundaries) are copied
+ //   gro   recvmmsg batches of UDP GRO super-packets; one receive returns many
+ //         packets of the same size, which are then copied into place
+ //   ring  an AF_PACKET TPACKET_V3 ring on one interface; the kernel fills
+ //         memory shared with the receiver, which walks whole blocks of
+ //         packets per poll and copies payloads into place. Needs
+ //         CAP_NET_RAW; without it, or if the ring cannot be set up, the
+ //         receiver falls back to the mmsg mode
+ //
+ // By default a built-in loopback source streams a synthetic pattern to the
+ // receiver as fast as it can, or at a fixed frame rate with -r. The source
+ // can coalesce payload packets with UDP GSO (-G), which is what lets the gro
+ // mode see super-packets on the loopback interface; on a real interface the
+ // driver's GRO does this instead. With -x the internal source is disabled and
+ // the utility only listens on the given port; with -S it is only a source,
+ // streaming to the address given with -a.
+ //
+ // To test the ring mode on a real link rather than loopback, put the source
+ // in its own network namespace behind a veth pair:
+ //
+ //   sudo ip netns add gvspsrc
+ //   sudo ip link add gvsphost type veth peer name gvspsrc
+ //   sudo ip link set gvspsrc netns gvspsrc
+ //   sudo ip addr add 169.254.200.1/16 dev gvsphost && sudo ip link set gvsphost up
+ //   sudo ip netns exec gvspsrc ip addr add 169.254.200.2/16 dev gvspsrc
+ //   sudo ip netns exec gvspsrc ip link set gvspsrc up
+ //   sudo ./GvspReceiverUtility -m ring -i gvsphost -x -s 1500 -v &
+ //   sudo ip netns exec gvspsrc ./GvspReceiverUtility -S -a 169.254.200.1 -s 1500
+
+#include "stdafx.h"
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+#include <sstream>
+#include <cstring>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// default stream settings
+//    The packet size is the GevSCPSPacketSize value, including IP, UDP and
+//    GVSP headers. Loopback allows packets far larger than any NIC; 9000 is
+//    the common jumbo frame size.
+#define DEFAULT_PORT 50010
+#define DEFAULT_WIDTH 1280
+#define DEFAULT_HEIGHT 1024
+#define DEFAULT_BYTES_PER_PIXEL 1
+#define DEFAULT_PACKET_SIZE 9000
+#define DEFAULT_MODE "mmsg"
+#define DEFAULT_BATCH 64
+#define DEFAULT_DURATION 10
+#define DEFAULT_INTERFACE "lo"
+#define DEFAULT_DESTINATION "127.0.0.1"
+
+// number of frame buffers in the reassembly ring
+#define NUM_FRAME_BUFFERS 4
+
+// socket buffer size requested for both ends
+#define SOCKET_BUFFER_SIZE (64 * 1024 * 1024)
+
+// receive timeout, so that the receive thread notices when to stop
+#define RECEIVE_TIMEOUT_MS 100
+
+// largest UDP datagram, and so largest GRO super-packet
+#define MAX_DATAGRAM 65536
+
+// Packet ring layout
+//    The ring is PACKET_RING_BLOCKS blocks of PACKET_RING_BLOCK_SIZE bytes.
+//    The kernel packs packets into the current block and hands it over when
+//    it is full or PACKET_RING_TIMEOUT_MS after its first packet, which
+//    bounds the latency added at low packet rates. The frame size only has
+//    to hold the largest packet, which may be a GSO super-packet of up to
+//    64 KB; TPACKET_V3 packs packets back to back.
+#define PACKET_RING_BLOCK_SIZE (1 << 22)
+#define PACKET_RING_BLOCKS 64
+#define PACKET_RING_FRAME_SIZE (1 << 17)
+#define PACKET_RING_TIMEOUT_MS 2
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- PROTOCOL -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+static const uint16_t GEV_STATUS_SUCCESS = 0x0000;
+static const uint8_t GVSP_FORMAT_LEADER = 1;
+static const uint8_t GVSP_FORMAT_TRAILER = 2;
+static const uint8_t GVSP_FORMAT_PAYLOAD = 3;
+static const uint16_t GVSP_PAYLOAD_IMAGE = 0x0001;
+static const uint32_t GVSP_PIXEL_MONO8 = 0x01080001;
+
+// GVSP header, and IP + UDP + GVSP overhead per packet
+static const uint32_t GVSP_HEADER_SIZE = 8;
+static const uint32_t GVSP_OVERHEAD = 20 + 8 + 8;
+static const uint32_t GVSP_LEADER_SIZE = 36;
+static const uint32_t GVSP_TRAILER_SIZE = 8;
+
+#if defined(__linux__)
+
+// UDP segmentation offload options, missing from older C library headers
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- HELPERS -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// big endian accessors
+//    All GVSP fields are sent in network byte order.
+static void Put16(uint8_t* p, uint16_t value)
+{
+	p[0] = static_cast<uint8_t>(value >> 8);
+	p[1] = static_cast<uint8_t>(value);
+}
+
+static void Put32(uint8_t* p, uint32_t value)
+{
+	p[0] = static_cast<uint8_t>(value >> 24);
+	p[1] = static_cast<uint8_t>(value >> 16);
+	p[2] = static_cast<uint8_t>(value >> 8);
+	p[3] = static_cast<uint8_t>(value);
+}
+
+static uint16_t Get16(const uint8_t* p)
+{
+	return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+static uint32_t Get32(const uint8_t* p)
+{
+	return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+// writes a GVSP header
+static void PutGvspHeader(uint8_t* p, uint16_t blockId, uint8_t format, uint32_t packetId)
+{
+	Put16(p, GEV_STATUS_SUCCESS);
+	Put16(p + 2, blockId);
+	Put32(p + 4, (static_cast<uint32_t>(format) << 24) | (packetId & 0xFFFFFF));
+}
+
+// block IDs are 16 bits and skip 0, which GVSP reserves
+static uint16_t NextBlockId(uint16_t blockId)
+{
+	return blockId == 0xFFFF ? 1 : static_cast<uint16_t>(blockId + 1);
+}
+
+// synthetic payload byte for a given block and offset
+static uint8_t PatternByte(uint16_t blockId, size_t offset)
+{
+	return static_cast<uint8_t>(offset + blockId * 13);
+}
+
+// CPU time consumed on a CPU-time clock, in nanoseconds
+static uint64_t CpuClockNs(clockid_t clock)
+{
+	struct timespec ts;
+	clock_gettime(clock, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static uint32_t AddressStrToUint32(const std::string& address)
+{
+	struct in_addr addr;
+	if (inet_pton(AF_INET, address.c_str(), &addr) > 0)
+	{
+		return ntohl(addr.s_addr);
+	}
+	throw std::logic_error(address + " is not a valid address!");
+}
+
+// sets a socket buffer size, forcing it past the system limit where permitted
+static int SetSocketBuffer(int s, int option, int forceOption, int size)
+{
+	if (setsockopt(s, SOL_SOCKET, forceOption, &size, sizeof(size)) != 0)
+		setsockopt(s, SOL_SOCKET, option, &size, sizeof(size));
+
+	int actual = 0;
+	socklen_t length = sizeof(actual);
+	getsockopt(s, SOL_SOCKET, option, &actual, &length);
+	return actual;
+}
+
+//command line input parser
+class CliParser
+{
+
+public:
+
+	CliParser(int& argc, char** argv)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			m_argTokens.push_back(std::string(argv[i]));
+		}
+	}
+
+	//checks if an argument exists
+	bool ArgumentExists(const std::string& arg) const
+	{
+		auto result = std::find(m_argTokens.begin(), m_argTokens.end(), arg);
+		return result != m_argTokens.end();
+	}
+
+	//returns the argument value associated with the arg flag, or the default
+	std::string GetArgument(const std::string& arg, const std::string& defaultValue) const
+	{
+		auto it = std::find(m_argTokens.begin(), m_argTokens.end(), arg);
+
+		if (it != m_argTokens.end() && // if we found a flag token
+			++it != m_argTokens.end()) // if there is a arg value token
+		{
+			return *it;
+		}
+		return defaultValue;
+	}
+
+private:
+
+	std::vector<std::string> m_argTokens;
+};
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- RECEIVER -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// receive modes
+enum ReceiveMode
+{
+	ReceiveSingle,
+	ReceiveBatched,
+	ReceiveGro,
+	ReceivePacketRing
+};
+
+static const char* ReceiveModeName(ReceiveMode mode)
+{
+	switch (mode)
+	{
+	case ReceiveSingle:
+		return "recv";
+	case ReceiveBatched:
+		return "mmsg";
+	case ReceiveGro:
+		return "gro";
+	case ReceivePacketRing:
+		return "ring";
+	}
+	return "";
+}
+
+// receiver settings
+//    Filled in from the command line.
+struct ReceiverSettings
+{
+	ReceiveMode mode;
+	uint16_t port;
+	uint32_t batch;
+	uint32_t packetDataSize;
+	size_t payloadSize;
+	bool validate;
+	std::string interfaceName;
+};
+
+// receiver statistics
+//    Written by the receive thread only and read by the main thread once a
+//    second. The CPU time is stored when the receive thread ends; while it
+//    runs, it is read from the thread's CPU-time clock instead.
+struct ReceiverStats
+{
+	std::atomic<uint64_t> packets;
+	std::atomic<uint64_t> payloadBytes;
+	std::atomic<uint64_t> bytesPlaced;
+	std::atomic<uint64_t> bytesCopied;
+	std::atomic<uint64_t> syscalls;
+	std::atomic<uint64_t> truncated;
+	std::atomic<uint64_t> framesComplete;
+	std::atomic<uint64_t> framesIncomplete;
+	std::atomic<uint64_t> framesMissed;
+	std::atomic<uint64_t> validationErrors;
+	std::atomic<uint64_t> ringDrops;
+	std::atomic<uint64_t> cpuNs;
+
+	ReceiverStats() :
+		packets(0),
+		payloadBytes(0),
+		bytesPlaced(0),
+		bytesCopied(0),
+		syscalls(0),
+		truncated(0),
+		framesComplete(0),
+		framesIncomplete(0),
+		framesMissed(0),
+		validationErrors(0),
+		ringDrops(0),
+		cpuNs(0)
+	{
+	}
+};
+
+// frame assembler
+//    Reassembles GVSP blocks into a ring of frame buffers. The ring slot of a
+//    block is fixed by its block ID, so that a receive mode can compute where
+//    a payload packet belongs before the packet has arrived. A frame is
+//    complete once its trailer and all payload packets are in; a frame whose
+//    slot is reused before then is counted as incomplete.
+class FrameAssembler
+{
+public:
+	FrameAssembler(const ReceiverSettings& settings, ReceiverStats& stats) :
+		m_settings(settings),
+		m_stats(stats),
+		m_frames(NUM_FRAME_BUFFERS),
+		m_newestBlockId(0)
+	{
+		for (size_t i = 0; i < m_frames.size(); i++)
+		{
+			m_frames[i].buffer.resize(settings.payloadSize + settings.packetDataSize);
+			m_frames[i].received.resize(settings.payloadSize / settings.packetDataSize + 1);
+			m_frames[i].active = false;
+		}
+	}
+
+	// returns where the payload of a packet goes, or null if it has no place
+	uint8_t* PayloadSlot(uint16_t blockId, uint32_t packetId)
+	{
+		if (packetId == 0)
+			return NULL;
+
+		// buffers have a packet of slack so that a receive mode can offer
+		// a full packet's room at the last offset
+		size_t offset = static_cast<size_t>(packetId - 1) * m_settings.packetDataSize;
+		if (offset >= m_settings.payloadSize)
+			return NULL;
+
+		return &m_frames[blockId % NUM_FRAME_BUFFERS].buffer[offset];
+	}
+
+	// handles one packet; placed is set if its payload is already in its slot
+	// (1) parses header
+	// (2) begins frame on a new block ID
+	// (3) copies payload unless already placed
+	// (4) finishes frame when complete
+	void HandlePacket(const uint8_t* pHeader, const uint8_t* pData, size_t dataSize, bool placed)
+	{
+		m_stats.packets.fetch_add(1, std::memory_order_relaxed);
+
+		uint16_t status = Get16(pHeader);
+		uint16_t blockId = Get16(pHeader + 2);
+		uint32_t word = Get32(pHeader + 4);
+		uint8_t format = static_cast<uint8_t>(word >> 24);
+		uint32_t packetId = word & 0xFFFFFF;
+
+		if (status != GEV_STATUS_SUCCESS || blockId == 0)
+			return;
+
+		Frame& frame = m_frames[blockId % NUM_FRAME_BUFFERS];
+		if (!frame.active || frame.blockId != blockId)
+		{
+			if (frame.active)
+				Finish(frame);
+			Begin(frame, blockId);
+		}
+
+		if (format == GVSP_FORMAT_PAYLOAD)
+		{
+			uint8_t* pSlot = PayloadSlot(blockId, packetId);
+			if (!pSlot || dataSize > m_settings.packetDataSize)
+				return;
+
+			if (placed)
+			{
+				m_stats.bytesPlaced.fetch_add(dataSize, std::memory_order_relaxed);
+			}
+			else
+			{
+				memcpy(pSlot, pData, dataSize);
+				m_stats.bytesCopied.fetch_add(dataSize, std::memory_order_relaxed);
+			}
+
+			// duplicates, such as a resent packet that was only late, are
+			// placed again but counted once
+			m_stats.payloadBytes.fetch_add(dataSize, std::memory_order_relaxed);
+			if (!frame.received[packetId - 1])
+			{
+				frame.received[packetId - 1] = 1;
+				frame.payloadPackets++;
+				frame.payloadBytes += dataSize;
+			}
+		}
+		else if (format == GVSP_FORMAT_TRAILER)
+		{
+			frame.trailerPacketId = packetId;
+		}
+
+		if (frame.trailerPacketId != 0 && frame.payloadPackets + 1 == frame.trailerPacketId)
+			Finish(frame);
+	}
+
+	// finishes all frames still being assembled
+	void Flush()
+	{
+		for (size_t i = 0; i < m_frames.size(); i++)
+		{
+			if (m_frames[i].active)
+				Finish(m_frames[i]);
+		}
+	}
+
+private:
+	struct Frame
+	{
+		bool active;
+		uint16_t blockId;
+		uint32_t payloadPackets;
+		uint32_t trailerPacketId;
+		size_t payloadBytes;
+		std::vector<uint8_t> buffer;
+		std::vector<uint8_t> received;
+	};
+
+	void Begin(Frame& frame, uint16_t blockId)
+	{
+		// blocks skipped over entirely never get a frame of their own
+		if (m_newestBlockId == 0)
+		{
+			m_newestBlockId = blockId;
+		}
+		else
+		{
+			uint16_t gap = static_cast<uint16_t>(blockId - m_newestBlockId);
+			if (gap != 0 && gap < 0x8000)
+			{
+				if (blockId < m_newestBlockId)
+					gap--; // wrapped past reserved block ID 0
+				m_stats.framesMissed.fetch_add(gap - 1, std::memory_order_relaxed);
+				m_newestBlockId = blockId;
+			}
+		}
+
+		frame.active = true;
+		frame.blockId = blockId;
+		frame.payloadPackets = 0;
+		frame.trailerPacketId = 0;
+		frame.payloadBytes = 0;
+		std::fill(frame.received.begin(), frame.received.end(), 0);
+	}
+
+	void Finish(Frame& frame)
+	{
+		frame.active = false;
+
+		if (frame.trailerPacketId == 0 || frame.payloadPackets + 1 != frame.trailerPacketId)
+		{
+			m_stats.framesIncomplete.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		m_stats.framesComplete.fetch_add(1, std::memory_order_relaxed);
+
+		if (m_settings.validate)
+		{
+			for (size_t i = 0; i < frame.payloadBytes; i++)
+			{
+				if (frame.buffer[i] != PatternByte(frame.blockId, i))
+				{
+					m_stats.validationErrors.fetch_add(1, std::memory_order_relaxed);
+					break;
+				}
+			}
+		}
+	}
+
+	const ReceiverSettings& m_settings;
+	ReceiverStats& m_stats;
+	std::vector<Frame> m_frames;
+	uint16_t m_newestBlockId;
+};
+
+// GVSP receiver
+//    Owns the stream socket and runs the receive thread in the selected mode.
+//    The UDP socket is bound in every mode: in the ring mode it keeps the
+//    port open, so that the host does not answer the stream with ICMP port
+//    unreachable messages, and is the fallback if the ring is unavailable.
+class GvspReceiver
+{
+public:
+	explicit GvspReceiver(const ReceiverSettings& settings) :
+		m_settings(settings),
+		m_mode(settings.mode),
+		m_assembler(settings, m_stats),
+		m_socket(-1),
+		m_receiveBufferSize(0),
+		m_packetSocket(-1),
+		m_pRing(NULL),
+		m_running(false)
+	{
+	}
+
+	~GvspReceiver()
+	{
+		Stop();
+	}
+
+	// opens the socket and starts the receive thread
+	// (1) binds to the stream port
+	// (2) enlarges the receive buffer
+	// (3) enables UDP GRO for the gro mode
+	// (4) sets up the packet ring for the ring mode, or falls back
+	// (5) starts the receive thread
+	void Start()
+	{
+		m_socket = socket(AF_INET, SOCK_DGRAM, 0);
+		if (m_socket < 0)
+			throw std::runtime_error("Failed to create socket");
+
+		struct sockaddr_in addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_ANY);
+		addr.sin_port = htons(m_settings.port);
+		if (bind(m_socket, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0)
+			throw std::runtime_error("Failed to bind UDP port " + std::to_string(m_settings.port));
+
+		m_receiveBufferSize = SetSocketBuffer(m_socket, SO_RCVBUF, SO_RCVBUFFORCE, SOCKET_BUFFER_SIZE);
+
+		struct timeval timeout;
+		timeout.tv_sec = 0;
+		timeout.tv_usec = RECEIVE_TIMEOUT_MS * 1000;
+		setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+		// Enable UDP GRO
+		//    With UDP_GRO set, the kernel may hand a run of same-sized
+		//    datagrams from one flow to the socket as a single super-packet,
+		//    with the segment size in a control message. Kernels before 5.0
+		//    reject the option.
+		if (m_settings.mode == ReceiveGro)
+		{
+			int enable = 1;
+			if (setsockopt(m_socket, SOL_UDP, UDP_GRO, &enable, sizeof(enable)) != 0)
+				throw std::runtime_error("UDP GRO is not supported by this kernel");
+		}
+
+		if (m_mode == ReceivePacketRing)
+		{
+			std::string reason;
+			if (!OpenPacketRing(reason))
+			{
+				std::cout << TAB1 << "Packet ring unavailable (" << reason << "), falling back to mmsg\n";
+				ClosePacketRing();
+				m_mode = ReceiveBatched;
+			}
+		}
+
+		m_running = true;
+		m_thread = std::thread(&GvspReceiver::ReceiveThread, this);
+
+		if (pthread_getcpuclockid(m_thread.native_handle(), &m_cpuClock) != 0)
+			m_cpuClock = CLOCK_THREAD_CPUTIME_ID;
+	}
+
+	void Stop()
+	{
+		if (!m_running.exchange(false))
+			return;
+
+		if (m_thread.joinable())
+			m_thread.join();
+
+		ClosePacketRing();
+		close(m_socket);
+		m_socket = -1;
+	}
+
+	// mode in use, after any fallback
+	ReceiveMode GetMode() const
+	{
+		return m_mode;
+	}
+
+	const ReceiverStats& GetStats() const
+	{
+		return m_stats;
+	}
+
+	int GetReceiveBufferSize() const
+	{
+		return m_receiveBufferSize;
+	}
+
+	// CPU time of the receive thread so far
+	uint64_t GetCpuNs() const
+	{
+		if (m_running.load() && m_cpuClock != CLOCK_THREAD_CPUTIME_ID)
+			return CpuClockNs(m_cpuClock);
+		return m_stats.cpuNs.load();
+	}
+
+private:
+	void ReceiveThread()
+	{
+		switch (m_mode)
+		{
+		case ReceiveSingle:
+			ReceiveSinglePackets();
+			break;
+		case ReceiveBatched:
+			ReceiveBatchedPackets();
+			break;
+		case ReceiveGro:
+			ReceiveGroPackets();
+			break;
+		case ReceivePacketRing:
+			ReceiveRingPackets();
+			break;
+		}
+
+		m_assembler.Flush();
+		m_stats.cpuNs.store(CpuClockNs(CLOCK_THREAD_CPUTIME_ID), std::memory_order_relaxed);
+	}
+
+	// Receive one packet at a time
+	//    The baseline: one system call and one payload copy per packet.
+	void ReceiveSinglePackets()
+	{
+		std::vector<uint8_t> packet(MAX_DATAGRAM);
+
+		while (m_running.load(std::memory_order_relaxed))
+		{
+			ssize_t size = recv(m_socket, &packet[0], packet.size(), 0);
+			m_stats.syscalls.fetch_add(1, std::memory_order_relaxed);
+
+			if (size >= static_cast<ssize_t>(GVSP_HEADER_SIZE))
+				m_assembler.HandlePacket(&packet[0], &packet[GVSP_HEADER_SIZE], size - GVSP_HEADER_SIZE, false);
+		}
+	}
+
+	// Receive batches, scattering payloads into place
+	//    Each message of a recvmmsg batch has two buffers: its 8 byte GVSP
+	//    header goes to a header array and its payload goes to the frame
+	//    buffer offset of the packet expected at that position, which is the
+	//    packet after the newest one seen so far. In a steady stream every
+	//    prediction holds and no payload byte is copied after the kernel.
+	//    Positions that cannot be predicted (leaders, offsets past the frame
+	//    buffer, before the first packet) receive into a scratch buffer.
+	//
+	//    A misprediction puts the payload in another packet's slot. Those
+	//    slots are all ahead of the newest packet seen and so hold nothing
+	//    yet, but a mispredicted payload may itself land in the slot that a
+	//    later message in the same batch must be copied to. All mispredicted
+	//    payloads are therefore first moved to their message's scratch buffer
+	//    before any of them is copied to its real slot.
+	void ReceiveBatchedPackets()
+	{
+		const uint32_t batch = m_settings.batch;
+		const size_t dataSize = m_settings.packetDataSize;
+
+		std::vector<uint8_t> headers(batch * GVSP_HEADER_SIZE);
+		std::vector<uint8_t> scratch(batch * dataSize);
+		std::vector<struct iovec> iovecs(batch * 2);
+		std::vector<struct mmsghdr> messages(batch);
+		std::vector<uint8_t*> landing(batch);
+		std::vector<const uint8_t*> source(batch);
+		std::vector<char> predicted(batch);
+
+		bool predicting = false;
+		uint16_t nextBlockId = 0;
+		uint32_t nextPacketId = 0;
+
+		while (m_running.load(std::memory_order_relaxed))
+		{
+			// point each message's payload buffer at its predicted slot
+			for (uint32_t i = 0; i < batch; i++)
+			{
+				uint8_t* pSlot = predicting ? m_assembler.PayloadSlot(nextBlockId, nextPacketId + i) : NULL;
+				landing[i] = pSlot ? pSlot : &scratch[i * dataSize];
+
+				iovecs[i * 2].iov_base = &headers[i * GVSP_HEADER_SIZE];
+				iovecs[i * 2].iov_len = GVSP_HEADER_SIZE;
+				iovecs[i * 2 + 1].iov_base = landing[i];
+				iovecs[i * 2 + 1].iov_len = dataSize;
+
+				memset(&messages[i], 0, sizeof(messages[i]));
+				messages[i].msg_hdr.msg_iov = &iovecs[i * 2];
+				messages[i].msg_hdr.msg_iovlen = 2;
+			}
+
+			int count = recvmmsg(m_socket, &messages[0], batch, MSG_WAITFORONE, NULL);
+			m_stats.syscalls.fetch_add(1, std::memory_order_relaxed);
+
+			if (count <= 0)
+				continue;
+
+			// check predictions and move mispredicted payloads out of the way
+			for (int i = 0; i < count; i++)
+			{
+				const uint8_t* pHeader = &headers[i * GVSP_HEADER_SIZE];
+				bool inPlace = landing[i] != &scratch[i * dataSize];
+
+				predicted[i] = inPlace &&
+					Get16(pHeader) == GEV_STATUS_SUCCESS &&
+					Get16(pHeader + 2) == nextBlockId &&
+					Get32(pHeader + 4) == ((static_cast<uint32_t>(GVSP_FORMAT_PAYLOAD) << 24) | (nextPacketId + i));
+
+				source[i] = landing[i];
+				if (inPlace && !predicted[i])
+				{
+					size_t size = messages[i].msg_len > GVSP_HEADER_SIZE ? messages[i].msg_len - GVSP_HEADER_SIZE : 0;
+					memcpy(&scratch[i * dataSize], landing[i], size);
+					source[i] = &scratch[i * dataSize];
+				}
+			}
+
+			// hand packets over in arrival order and advance the prediction
+			for (int i = 0; i < count; i++)
+			{
+				if (messages[i].msg_hdr.msg_flags & MSG_TRUNC)
+				{
+					m_stats.truncated.fetch_add(1, std::memory_order_relaxed);
+					continue;
+				}
+				if (messages[i].msg_len < GVSP_HEADER_SIZE)
+					continue;
+
+				const uint8_t* pHeader = &headers[i * GVSP_HEADER_SIZE];
+				m_assembler.HandlePacket(pHeader, source[i], messages[i].msg_len - GVSP_HEADER_SIZE, predicted[i] != 0);
+
+				if (Get16(pHeader) != GEV_STATUS_SUCCESS)
+					continue;
+
+				uint16_t blockId = Get16(pHeader + 2);
+				uint8_t format = static_cast<uint8_t>(Get32(pHeader + 4) >> 24);
+				uint32_t packetId = Get32(pHeader + 4) & 0xFFFFFF;
+
+				if (format == GVSP_FORMAT_TRAILER)
+				{
+					if (!predicting || blockId == nextBlockId)
+					{
+						nextBlockId = NextBlockId(blockId);
+						nextPacketId = 0;
+						predicting = true;
+					}
+				}
+				else if (!predicting || (blockId != nextBlockId && static_cast<uint16_t>(blockId - nextBlockId) < 0x8000))
+				{
+					// first packet, or a newer block than expected
+					nextBlockId = blockId;
+					nextPacketId = packetId + 1;
+					predicting = true;
+				}
+				else if (blockId == nextBlockId && packetId >= nextPacketId)
+				{
+					nextPacketId = packetId + 1;
+				}
+			}
+		}
+	}
+
+	// Receive GRO super-packets
+	//    Each message may hold several GVSP packets back to back, all of the
+	//    segment size given in the UDP_GRO control message except possibly the
+	//    last. Headers sit between payloads, so payloads are copied into place.
+	void ReceiveGroPackets()
+	{
+		const uint32_t batch = m_settings.batch;
+		const size_t controlSize = CMSG_SPACE(sizeof(int));
+
+		std::vector<uint8_t> buffers(static_cast<size_t>(batch) * MAX_DATAGRAM);
+		std::vector<uint8_t> control(batch * controlSize);
+		std::vector<struct iovec> iovecs(batch);
+		std::vector<struct mmsghdr> messages(batch);
+
+		while (m_running.load(std::memory_order_relaxed))
+		{
+			for (uint32_t i = 0; i < batch; i++)
+			{
+				iovecs[i].iov_base = &buffers[static_cast<size_t>(i) * MAX_DATAGRAM];
+				iovecs[i].iov_len = MAX_DATAGRAM;
+
+				memset(&messages[i], 0, sizeof(messages[i]));
+				messages[i].msg_hdr.msg_iov = &iovecs[i];
+				messages[i].msg_hdr.msg_iovlen = 1;
+				messages[i].msg_hdr.msg_control = &control[i * controlSize];
+				messages[i].msg_hdr.msg_controllen = controlSize;
+			}
+
+			int count = recvmmsg(m_socket, &messages[0], batch, MSG_WAITFORONE, NULL);
+			m_stats.syscalls.fetch_add(1, std::memory_order_relaxed);
+
+			for (int i = 0; i < count; i++)
+			{
+				const uint8_t* pData = &buffers[static_cast<size_t>(i) * MAX_DATAGRAM];
+				size_t size = messages[i].msg_len;
+				size_t segmentSize = size;
+
+				for (struct cmsghdr* pCmsg = CMSG_FIRSTHDR(&messages[i].msg_hdr); pCmsg; pCmsg = CMSG_NXTHDR(&messages[i].msg_hdr, pCmsg))
+				{
+					if (pCmsg->cmsg_level == SOL_UDP && pCmsg->cmsg_type == UDP_GRO)
+					{
+						int gsoSize = 0;
+						memcpy(&gsoSize, CMSG_DATA(pCmsg), sizeof(gsoSize));
+						segmentSize = static_cast<size_t>(gsoSize);
+					}
+				}
+
+				for (size_t offset = 0; segmentSize != 0 && offset < size; offset += segmentSize)
+				{
+					size_t packetSize = std::min(segmentSize, size - offset);
+					if (packetSize >= GVSP_HEADER_SIZE)
+						m_assembler.HandlePacket(pData + offset, pData + offset + GVSP_HEADER_SIZE, packetSize - GVSP_HEADER_SIZE, false);
+				}
+			}
+		}
+	}
+
+	// Set up the packet ring
+	//    (1) opens a cooked AF_PACKET socket, so packets start at the IP header
+	//    (2) attaches a filter passing only unfragmented UDP to the stream port
+	//    (3) selects TPACKET_V3 and requests the ring
+	//    (4) maps the ring into the process
+	//    (5) binds to the interface
+	//    (6) stops the UDP socket from queueing the packets a second time
+	bool OpenPacketRing(std::string& reason)
+	{
+		m_packetSocket = socket(AF_PACKET, SOCK_DGRAM, htons(ETH_P_IP));
+		if (m_packetSocket < 0)
+		{
+			reason = std::string("AF_PACKET socket: ") + strerror(errno);
+			return false;
+		}
+
+		// Filter in the kernel
+		//    A packet socket sees every IP packet on the interface. Classic BPF
+		//    drops everything but the stream before it is copied to the ring:
+		//    protocol UDP, fragment offset 0, destination port the stream port.
+		struct sock_filter code[] = {
+			{ BPF_LD | BPF_B | BPF_ABS, 0, 0, 9 },
+			{ BPF_JMP | BPF_JEQ | BPF_K, 0, 6, IPPROTO_UDP },
+			{ BPF_LD | BPF_H | BPF_ABS, 0, 0, 6 },
+			{ BPF_JMP | BPF_JSET | BPF_K, 4, 0, 0x1FFF },
+			{ BPF_LDX | BPF_B | BPF_MSH, 0, 0, 0 },
+			{ BPF_LD | BPF_H | BPF_IND, 0, 0, 2 },
+			{ BPF_JMP | BPF_JEQ | BPF_K, 0, 1, m_settings.port },
+			{ BPF_RET | BPF_K, 0, 0, PACKET_RING_FRAME_SIZE },
+			{ BPF_RET | BPF_K, 0, 0, 0 },
+		};
+		struct sock_fprog filter;
+		filter.len = sizeof(code) / sizeof(code[0]);
+		filter.filter = code;
+		if (setsockopt(m_packetSocket, SOL_SOCKET, SO_ATTACH_FILTER, &filter, sizeof(filter)) != 0)
+		{
+			reason = std::string("filter: ") + strerror(errno);
+			return false;
+		}
+
+		int version = TPACKET_V3;
+		if (setsockopt(m_packetSocket, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) != 0)
+		{
+			reason = std::string("TPACKET_V3: ") + strerror(errno);
+			return false;
+		}
+
+		struct tpacket_req3 request;
+		memset(&request, 0, sizeof(request));
+		request.tp_block_size = PACKET_RING_BLOCK_SIZE;
+		request.tp_block_nr = PACKET_RING_BLOCKS;
+		request.tp_frame_size = PACKET_RING_FRAME_SIZE;
+		request.tp_frame_nr = (PACKET_RING_BLOCK_SIZE / PACKET_RING_FRAME_SIZE) * PACKET_RING_BLOCKS;
+		request.tp_retire_blk_tov = PACKET_RING_TIMEOUT_MS;
+		if (setsockopt(m_packetSocket, SOL_PACKET, PACKET_RX_RING, &request, sizeof(request)) != 0)
+		{
+			reason = std::string("ring: ") + strerror(errno);
+			return false;
+		}
+
+		void* pRing = mmap(NULL, static_cast<size_t>(PACKET_RING_BLOCK_SIZE) * PACKET_RING_BLOCKS, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_packetSocket, 0);
+		if (pRing == MAP_FAILED)
+		{
+			reason = std::string("mmap: ") + strerror(errno);
+			return false;
+		}
+		m_pRing = static_cast<uint8_t*>(pRing);
+
+		struct sockaddr_ll addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sll_family = AF_PACKET;
+		addr.sll_protocol = htons(ETH_P_IP);
+		addr.sll_ifindex = static_cast<int>(if_nametoindex(m_settings.interfaceName.c_str()));
+		if (addr.sll_ifindex == 0)
+		{
+			reason = "no interface " + m_settings.interfaceName;
+			return false;
+		}
+		if (bind(m_packetSocket, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0)
+		{
+			reason = std::string("bind: ") + strerror(errno);
+			return false;
+		}
+
+		// the UDP socket stays bound but drops everything on arrival
+		struct sock_filter dropAll[] = {
+			{ BPF_RET | BPF_K, 0, 0, 0 },
+		};
+		struct sock_fprog dropFilter;
+		dropFilter.len = 1;
+		dropFilter.filter = dropAll;
+		setsockopt(m_socket, SOL_SOCKET, SO_ATTACH_FILTER, &dropFilter, sizeof(dropFilter));
+
+		return true;
+	}
+
+	void ClosePacketRing()
+	{
+		if (m_pRing)
+		{
+			munmap(m_pRing, static_cast<size_t>(PACKET_RING_BLOCK_SIZE) * PACKET_RING_BLOCKS);
+			m_pRing = NULL;
+		}
+		if (m_packetSocket >= 0)
+		{
+			close(m_packetSocket);
+			m_packetSocket = -1;
+		}
+	}
+
+	// Receive from the packet ring
+	//    Blocks are handed between kernel and receiver through their status
+	//    word. The receiver only makes a system call, poll, when the next
+	//    block is still the kernel's; otherwise it walks every packet of the
+	//    block in place, strips IP and UDP headers, and returns the block.
+	//    Packets the host sent itself show up on loopback as well and are
+	//    skipped.
+	void ReceiveRingPackets()
+	{
+		uint32_t current = 0;
+
+		struct pollfd pfd;
+		pfd.fd = m_packetSocket;
+		pfd.events = POLLIN | POLLERR;
+		pfd.revents = 0;
+
+		while (m_running.load(std::memory_order_relaxed))
+		{
+			struct tpacket_block_desc* pBlock = reinterpret_cast<struct tpacket_block_desc*>(m_pRing + static_cast<size_t>(current) * PACKET_RING_BLOCK_SIZE);
+
+			if ((pBlock->hdr.bh1.block_status & TP_STATUS_USER) == 0)
+			{
+				poll(&pfd, 1, RECEIVE_TIMEOUT_MS);
+				m_stats.syscalls.fetch_add(1, std::memory_order_relaxed);
+				continue;
+			}
+
+			// read the block only after seeing that it is ours
+			__sync_synchronize();
+
+			uint8_t* pPacket = reinterpret_cast<uint8_t*>(pBlock) + pBlock->hdr.bh1.offset_to_first_pkt;
+			for (uint32_t i = 0; i < pBlock->hdr.bh1.num_pkts; i++)
+			{
+				const struct tpacket3_hdr* pHeader = reinterpret_cast<const struct tpacket3_hdr*>(pPacket);
+				const struct sockaddr_ll* pLink = reinterpret_cast<const struct sockaddr_ll*>(pPacket + TPACKET_ALIGN(sizeof(struct tpacket3_hdr)));
+
+				if (pLink->sll_pkttype != PACKET_OUTGOING)
+					HandleIpPacket(pPacket + pHeader->tp_net, pHeader->tp_snaplen);
+
+				pPacket += pHeader->tp_next_offset;
+			}
+
+			__sync_synchronize();
+			pBlock->hdr.bh1.block_status = TP_STATUS_KERNEL;
+			current = (current + 1) % PACKET_RING_BLOCKS;
+		}
+
+		struct tpacket_stats_v3 ringStats;
+		socklen_t length = sizeof(ringStats);
+		if (getsockopt(m_packetSocket, SOL_PACKET, PACKET_STATISTICS, &ringStats, &length) == 0)
+			m_stats.ringDrops.fetch_add(ringStats.tp_drops, std::memory_order_relaxed);
+	}
+
+	// Strip IP and UDP headers from a packet of the ring
+	//    Locally sent GSO super-packets reach the ring before segmentation,
+	//    as one datagram holding several GVSP packets. Every segment but the
+	//    last is a full packet, so they are split at the stream's packet size.
+	void HandleIpPacket(const uint8_t* pIp, size_t size)
+	{
+		if (size < 20 || (pIp[0] >> 4) != 4)
+			return;
+
+		size_t ipHeaderSize = static_cast<size_t>(pIp[0] & 0x0F) * 4;
+		if (size < ipHeaderSize + 8 + GVSP_HEADER_SIZE)
+			return;
+
+		const uint8_t* pUdp = pIp + ipHeaderSize;
+		if (Get16(pUdp + 2) != m_settings.port)
+			return;
+
+		size_t udpSize = std::min<size_t>(Get16(pUdp + 4), size - ipHeaderSize);
+		if (udpSize < 8 + GVSP_HEADER_SIZE)
+			return;
+
+		const uint8_t* pGvsp = pUdp + 8;
+		const size_t gvspSize = udpSize - 8;
+		const size_t segmentSize = GVSP_HEADER_SIZE + m_settings.packetDataSize;
+
+		for (size_t offset = 0; offset + GVSP_HEADER_SIZE <= gvspSize; offset += segmentSize)
+		{
+			size_t packetSize = std::min(segmentSize, gvspSize - offset);
+			m_assembler.HandlePacket(pGvsp + offset, pGvsp + offset + GVSP_HEADER_SIZE, packetSize - GVSP_HEADER_SIZE, false);
+		}
+	}
+
+	const ReceiverSettings& m_settings;
+	ReceiveMode m_mode;
+	ReceiverStats m_stats;
+	FrameAssembler m_assembler;
+	int m_socket;
+	int m_receiveBufferSize;
+	int m_packetSocket;
+	uint8_t* m_pRing;
+	std::atomic<bool> m_running;
+	std::thread m_thread;
+	clockid_t m_cpuClock;
+};
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SOURCE -=-=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// stream source settings
+struct SourceSettings
+{
+	uint32_t address;
+	uint16_t port;
+	uint32_t packetDataSize;
+	size_t payloadSize;
+	uint32_t width;
+	uint32_t height;
+	double frameRate;
+	bool gso;
+};
+
+// stream source
+//    Streams GVSP blocks of a synthetic pattern with sendmmsg, or with UDP
+//    GSO so that payload packets travel through the loopback interface as
+//    super-packets.
+class StreamSource
+{
+public:
+	explicit StreamSource(const SourceSettings& settings) :
+		m_settings(settings),
+		m_socket(-1),
+		m_running(false),
+		m_framesSent(0),
+		m_packetsSent(0)
+	{
+	}
+
+	~StreamSource()
+	{
+		Stop();
+	}
+
+	void Start()
+	{
+		m_socket = socket(AF_INET, SOCK_DGRAM, 0);
+		if (m_socket < 0)
+			throw std::runtime_error("Failed to create socket");
+
+		SetSocketBuffer(m_socket, SO_SNDBUF, SO_SNDBUFFORCE, SOCKET_BUFFER_SIZE);
+
+		struct sockaddr_in addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(m_settings.address);
+		addr.sin_port = htons(m_settings.port);
+		if (connect(m_socket, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0)
+			throw std::runtime_error("Failed to connect source socket");
+
+		m_running = true;
+		m_thread = std::thread(&StreamSource::SendThread, this);
+	}
+
+	void Stop()
+	{
+		if (!m_running.exchange(false))
+			return;
+
+		if (m_thread.joinable())
+			m_thread.join();
+
+		close(m_socket);
+		m_socket = -1;
+	}
+
+	uint64_t GetFramesSent() const
+	{
+		return m_framesSent.load();
+	}
+
+	uint64_t GetPacketsSent() const
+	{
+		return m_packetsSent.load();
+	}
+
+private:
+	// sends frames until stopped
+	// (1) fills payload with the pattern of the block
+	// (2) sends leader
+	// (3) sends payload packets in batches
+	// (4) sends trailer
+	// (5) waits for the next frame time if a rate is set
+	void SendThread()
+	{
+		const size_t dataSize = m_settings.packetDataSize;
+		const uint32_t numDataPackets = static_cast<uint32_t>((m_settings.payloadSize + dataSize - 1) / dataSize);
+
+		std::vector<uint8_t> payload(m_settings.payloadSize);
+		std::vector<uint8_t> headers(static_cast<size_t>(numDataPackets) * GVSP_HEADER_SIZE);
+		std::vector<uint8_t> segments;
+		std::vector<struct iovec> iovecs(static_cast<size_t>(numDataPackets) * 2);
+		std::vector<struct mmsghdr> messages(numDataPackets);
+
+		uint16_t blockId = 1;
+		auto nextFrame = std::chrono::steady_clock::now();
+
+		while (m_running.load(std::memory_order_relaxed))
+		{
+			for (size_t i = 0; i < payload.size(); i++)
+				payload[i] = PatternByte(blockId, i);
+
+			uint8_t leader[GVSP_HEADER_SIZE + GVSP_LEADER_SIZE];
+			memset(leader, 0, sizeof(leader));
+			PutGvspHeader(leader, blockId, GVSP_FORMAT_LEADER, 0);
+			Put16(leader + GVSP_HEADER_SIZE + 2, GVSP_PAYLOAD_IMAGE);
+			Put32(leader + GVSP_HEADER_SIZE + 12, GVSP_PIXEL_MONO8);
+			Put32(leader + GVSP_HEADER_SIZE + 16, m_settings.width);
+			Put32(leader + GVSP_HEADER_SIZE + 20, m_settings.height);
+			Send(leader, sizeof(leader));
+
+			if (m_settings.gso)
+				SendPayloadGso(blockId, payload, numDataPackets, segments);
+			else
+				SendPayloadBatched(blockId, payload, numDataPackets, headers, iovecs, messages);
+
+			uint8_t trailer[GVSP_HEADER_SIZE + GVSP_TRAILER_SIZE];
+			memset(trailer, 0, sizeof(trailer));
+			PutGvspHeader(trailer, blockId, GVSP_FORMAT_TRAILER, numDataPackets + 1);
+			Put16(trailer + GVSP_HEADER_SIZE + 2, GVSP_PAYLOAD_IMAGE);
+			Put32(trailer + GVSP_HEADER_SIZE + 4, m_settings.height);
+			Send(trailer, sizeof(trailer));
+
+			m_framesSent.fetch_add(1, std::memory_order_relaxed);
+			blockId = NextBlockId(blockId);
+
+			if (m_settings.frameRate > 0.0)
+			{
+				nextFrame += std::chrono::nanoseconds(static_cast<int64_t>(1e9 / m_settings.frameRate));
+				std::this_thread::sleep_until(nextFrame);
+			}
+		}
+	}
+
+	void Send(const uint8_t* pPacket, size_t size)
+	{
+		if (send(m_socket, pPacket, size, 0) > 0)
+			m_packetsSent.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// sends payload packets as sendmmsg batches of header and payload pairs
+	void SendPayloadBatched(uint16_t blockId, const std::vector<uint8_t>& payload, uint32_t numDataPackets, std::vector<uint8_t>& headers, std::vector<struct iovec>& iovecs, std::vector<struct mmsghdr>& messages)
+	{
+		const size_t dataSize = m_settings.packetDataSize;
+
+		for (uint32_t i = 0; i < numDataPackets; i++)
+		{
+			size_t offset = static_cast<size_t>(i) * dataSize;
+
+			PutGvspHeader(&headers[i * GVSP_HEADER_SIZE], blockId, GVSP_FORMAT_PAYLOAD, i + 1);
+			iovecs[i * 2].iov_base = &headers[i * GVSP_HEADER_SIZE];
+			iovecs[i * 2].iov_len = GVSP_HEADER_SIZE;
+			iovecs[i * 2 + 1].iov_base = const_cast<uint8_t*>(&payload[offset]);
+			iovecs[i * 2 + 1].iov_len = std::min(dataSize, payload.size() - offset);
+
+			memset(&messages[i], 0, sizeof(messages[i]));
+			messages[i].msg_hdr.msg_iov = &iovecs[i * 2];
+			messages[i].msg_hdr.msg_iovlen = 2;
+		}
+
+		uint32_t sent = 0;
+		while (sent < numDataPackets && m_running.load(std::memory_order_relaxed))
+		{
+			int count = sendmmsg(m_socket, &messages[sent], std::min<uint32_t>(numDataPackets - sent, 1024), 0);
+			if (count <= 0)
+			{
+				if (errno == ENOBUFS || errno == EAGAIN)
+					continue;
+				break;
+			}
+			sent += count;
+			m_packetsSent.fetch_add(count, std::memory_order_relaxed);
+		}
+	}
+
+	// Send payload packets with UDP GSO
+	//    Packets are laid out back to back, header and payload, and handed to
+	//    the kernel as up to 64 KB at a time with the packet size as the GSO
+	//    segment size. Only the last segment of a frame may be shorter.
+	void SendPayloadGso(uint16_t blockId, const std::vector<uint8_t>& payload, uint32_t numDataPackets, std::vector<uint8_t>& segments)
+	{
+		const size_t dataSize = m_settings.packetDataSize;
+		const size_t segmentSize = GVSP_HEADER_SIZE + dataSize;
+		const uint32_t segmentsPerSend = std::max<uint32_t>(1, std::min<uint32_t>(64, static_cast<uint32_t>((MAX_DATAGRAM - 1024) / segmentSize)));
+
+		segments.resize(segmentsPerSend * segmentSize);
+
+		for (uint32_t first = 0; first < numDataPackets && m_running.load(std::memory_order_relaxed); first += segmentsPerSend)
+		{
+			uint32_t count = std::min(segmentsPerSend, numDataPackets - first);
+			size_t size = 0;
+
+			for (uint32_t i = 0; i < count; i++)
+			{
+				size_t offset = static_cast<size_t>(first + i) * dataSize;
+				size_t length = std::min(dataSize, payload.size() - offset);
+
+				PutGvspHeader(&segments[size], blockId, GVSP_FORMAT_PAYLOAD, first + i + 1);
+				memcpy(&segments[size + GVSP_HEADER_SIZE], &payload[offset], length);
+				size += GVSP_HEADER_SIZE + length;
+			}
+
+			struct iovec iov;
+			iov.iov_base = &segments[0];
+			iov.iov_len = size;
+
+			char control[CMSG_SPACE(sizeof(uint16_t))];
+			memset(control, 0, sizeof(control));
+
+			struct msghdr message;
+			memset(&message, 0, sizeof(message));
+			message.msg_iov = &iov;
+			message.msg_iovlen = 1;
+			message.msg_control = control;
+			message.msg_controllen = sizeof(control);
+
+			struct cmsghdr* pCmsg = CMSG_FIRSTHDR(&message);
+			pCmsg->cmsg_level = SOL_UDP;
+			pCmsg->cmsg_type = UDP_SEGMENT;
+			pCmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+			uint16_t gsoSize = static_cast<uint16_t>(segmentSize);
+			memcpy(CMSG_DATA(pCmsg), &gsoSize, sizeof(gsoSize));
+
+			while (sendmsg(m_socket, &message, 0) < 0)
+			{
+				if ((errno != ENOBUFS && errno != EAGAIN) || !m_running.load(std::memory_order_relaxed))
+					return;
+			}
+			m_packetsSent.fetch_add(count, std::memory_order_relaxed);
+		}
+	}
+
+	const SourceSettings& m_settings;
+	int m_socket;
+	std::atomic<bool> m_running;
+	std::atomic<uint64_t> m_framesSent;
+	std::atomic<uint64_t> m_packetsSent;
+	std::thread m_thread;
+};
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- REPORT -=-=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// counters at one point in time, for per-interval rates
+struct Sample
+{
+	uint64_t packets;
+	uint64_t payloadBytes;
+	uint64_t syscalls;
+	uint64_t cpuNs;
+
+	static Sample Take(const GvspReceiver& receiver)
+	{
+		const ReceiverStats& stats = receiver.GetStats();
+
+		Sample sample;
+		sample.packets = stats.packets.load();
+		sample.payloadBytes = stats.payloadBytes.load();
+		sample.syscalls = stats.syscalls.load();
+		sample.cpuNs = receiver.GetCpuNs();
+		return sample;
+	}
+};
+
+// prints rates between two samples
+void PrintRates(const Sample& from, const Sample& to, double seconds)
+{
+	uint64_t packets = to.packets - from.packets;
+	uint64_t cpuNs = to.cpuNs - from.cpuNs;
+
+	std::cout << std::fixed << std::setprecision(2)
+			  << (to.payloadBytes - from.payloadBytes) * 8.0 / seconds / 1e9 << " Gbit/s, "
+			  << packets / seconds / 1e3 << " kpps, "
+			  << (to.syscalls - from.syscalls ? static_cast<double>(packets) / (to.syscalls - from.syscalls) : 0.0) << " packets/syscall, "
+			  << std::setprecision(1) << cpuNs / seconds / 1e7 << "% CPU, "
+			  << (packets ? static_cast<double>(cpuNs) / packets : 0.0) << " ns/packet\n";
+}
+
+void PrintUsage()
+{
+	std::cout << std::endl;
+	std::cout << "Usage: GvspReceiverUtility -<arg> <arg_value>" << std::endl
+			  << std::endl;
+
+	std::cout << " \t -m: Receive mode: recv, mmsg, gro or ring (default " << DEFAULT_MODE << ")" << std::endl;
+	std::cout << " \t -i: Interface for the ring mode (default " << DEFAULT_INTERFACE << ")" << std::endl;
+	std::cout << " \t -p: UDP port to receive on (default " << DEFAULT_PORT << ")" << std::endl;
+	std::cout << " \t -n: Messages per recvmmsg batch (default " << DEFAULT_BATCH << ")" << std::endl;
+	std::cout << " \t -w: Width (default " << DEFAULT_WIDTH << ")" << std::endl;
+	std::cout << " \t -h: Height (default " << DEFAULT_HEIGHT << ")" << std::endl;
+	std::cout << " \t -b: Bytes per pixel (default " << DEFAULT_BYTES_PER_PIXEL << ")" << std::endl;
+	std::cout << " \t -s: Packet size including IP, UDP and GVSP headers (default " << DEFAULT_PACKET_SIZE << ")" << std::endl;
+	std::cout << " \t -d: Duration in seconds (default " << DEFAULT_DURATION << ")" << std::endl;
+	std::cout << " \t -r: Source frame rate in Hz, 0 for as fast as possible (default 0)" << std::endl;
+	std::cout << " \t -G: Source sends payload packets with UDP GSO" << std::endl;
+	std::cout << " \t -x: No internal source; only listen on the port" << std::endl;
+	std::cout << " \t -S: Source only; stream to the destination address" << std::endl;
+	std::cout << " \t -a: Destination address of the source (default " << DEFAULT_DESTINATION << ")" << std::endl;
+	std::cout << " \t -v: Validate the pattern of every complete frame" << std::endl;
+	std::cout << " \t For example $> GvspReceiverUtility -m gro -G -s 1500 -d 5" << std::endl;
+	std::cout << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	int ret = 0;
+
+	try
+	{
+		CliParser parser(argc, argv);
+
+		if (parser.ArgumentExists("/help") || parser.ArgumentExists("-?"))
+		{
+			PrintUsage();
+			return 0;
+		}
+
+		std::string mode = parser.GetArgument("-m", DEFAULT_MODE);
+		uint32_t width = std::stoul(parser.GetArgument("-w", std::to_string(DEFAULT_WIDTH)));
+		uint32_t height = std::stoul(parser.GetArgument("-h", std::to_string(DEFAULT_HEIGHT)));
+		uint32_t bytesPerPixel = std::stoul(parser.GetArgument("-b", std::to_string(DEFAULT_BYTES_PER_PIXEL)));
+		uint32_t packetSize = std::stoul(parser.GetArgument("-s", std::to_string(DEFAULT_PACKET_SIZE)));
+		double duration = std::stod(parser.GetArgument("-d", std::to_string(DEFAULT_DURATION)));
+
+		ReceiverSettings settings;
+		settings.port = static_cast<uint16_t>(std::stoul(parser.GetArgument("-p", std::to_string(DEFAULT_PORT))));
+		settings.batch = std::stoul(parser.GetArgument("-n", std::to_string(DEFAULT_BATCH)));
+		settings.payloadSize = static_cast<size_t>(width) * height * bytesPerPixel;
+		settings.validate = parser.ArgumentExists("-v");
+		settings.interfaceName = parser.GetArgument("-i", DEFAULT_INTERFACE);
+
+		if (mode == "recv")
+			settings.mode = ReceiveSingle;
+		else if (mode == "mmsg")
+			settings.mode = ReceiveBatched;
+		else if (mode == "gro")
+			settings.mode = ReceiveGro;
+		else if (mode == "ring")
+			settings.mode = ReceivePacketRing;
+		else
+			throw std::logic_error("Unknown receive mode " + mode);
+
+		if (packetSize <= GVSP_OVERHEAD + GVSP_LEADER_SIZE || packetSize > MAX_DATAGRAM)
+			throw std::logic_error("Packet size must be between " + std::to_string(GVSP_OVERHEAD + GVSP_LEADER_SIZE + 1) + " and " + std::to_string(MAX_DATAGRAM));
+		if (settings.batch == 0 || settings.batch > 1024)
+			throw std::logic_error("Batch size must be from 1 to 1024");
+		if (settings.payloadSize == 0)
+			throw std::logic_error("Width, height and bytes per pixel must not be 0");
+
+		settings.packetDataSize = packetSize - GVSP_OVERHEAD;
+
+		SourceSettings sourceSettings;
+		sourceSettings.address = AddressStrToUint32(parser.GetArgument("-a", DEFAULT_DESTINATION));
+		sourceSettings.port = settings.port;
+		sourceSettings.packetDataSize = settings.packetDataSize;
+		sourceSettings.payloadSize = settings.payloadSize;
+		sourceSettings.width = width;
+		sourceSettings.height = height;
+		sourceSettings.frameRate = std::stod(parser.GetArgument("-r", "0"));
+		sourceSettings.gso = parser.ArgumentExists("-G");
+
+		bool internalSource = !parser.ArgumentExists("-x");
+		bool sourceOnly = parser.ArgumentExists("-S");
+
+		std::cout << (sourceOnly ? "GVSP Source\n" : "GVSP Receiver\n");
+		std::cout << TAB1 << width << "x" << height << "x" << bytesPerPixel << " in " << packetSize << " byte packets ("
+				  << settings.packetDataSize << " bytes of payload each)\n";
+
+		StreamSource source(sourceSettings);
+
+		// Source only
+		//    Streams for the given duration and exits, for a receiver on the
+		//    other end of a link.
+		if (sourceOnly)
+		{
+			source.Start();
+			std::cout << TAB1 << "Streaming to " << parser.GetArgument("-a", DEFAULT_DESTINATION) << ":" << settings.port << " for " << duration << " s\n";
+			std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int64_t>(duration * 1000)));
+			source.Stop();
+			std::cout << TAB1 << "Frames sent " << source.GetFramesSent() << ", packets sent " << source.GetPacketsSent() << "\n";
+			return 0;
+		}
+
+		GvspReceiver receiver(settings);
+		receiver.Start();
+		std::cout << TAB1 << "Mode " << ReceiveModeName(receiver.GetMode());
+		if (receiver.GetMode() == ReceivePacketRing)
+			std::cout << " on " << settings.interfaceName;
+		else if (receiver.GetMode() != ReceiveSingle)
+			std::cout << ", batch " << settings.batch;
+		std::cout << ", port " << settings.port << "\n";
+		std::cout << TAB1 << "Receive buffer " << receiver.GetReceiveBufferSize() << " bytes\n";
+
+		if (internalSource)
+		{
+			source.Start();
+			std::cout << TAB1 << "Source " << (sourceSettings.gso ? "with UDP GSO" : "with sendmmsg") << " to " << parser.GetArgument("-a", DEFAULT_DESTINATION) << ", ";
+			if (sourceSettings.frameRate > 0.0)
+				std::cout << sourceSettings.frameRate << " Hz\n";
+			else
+				std::cout << "unthrottled\n";
+		}
+
+		// report once a second
+		const ReceiverStats& stats = receiver.GetStats();
+		Sample first = Sample::Take(receiver);
+		Sample last = first;
+		auto start = std::chrono::steady_clock::now();
+
+		for (int second = 1; second <= static_cast<int>(duration + 0.5); second++)
+		{
+			std::this_thread::sleep_until(start + std::chrono::seconds(second));
+
+			Sample now = Sample::Take(receiver);
+			std::cout << TAB2 << std::setw(3) << second << " s: ";
+			PrintRates(last, now, 1.0);
+			last = now;
+		}
+
+		// let the receiver drain what the source left in the socket buffer
+		if (internalSource)
+		{
+			source.Stop();
+
+			uint64_t packets;
+			do
+			{
+				packets = stats.packets.load();
+				std::this_thread::sleep_for(std::chrono::milliseconds(RECEIVE_TIMEOUT_MS));
+			} while (stats.packets.load() != packets);
+		}
+		receiver.Stop();
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		Sample total = Sample::Take(receiver);
+
+		std::cout << TAB1 << "Average: ";
+		PrintRates(first, total, seconds);
+
+		if (internalSource)
+			std::cout << TAB1 << "Frames sent " << source.GetFramesSent() << ", packets sent " << source.GetPacketsSent() << "\n";
+
+		std::cout << TAB1 << "Frames complete " << stats.framesComplete << ", incomplete " << stats.framesIncomplete << ", missed " << stats.framesMissed;
+		if (settings.validate)
+			std::cout << ", failed validation " << stats.validationErrors;
+		std::cout << "\n";
+
+		uint64_t placed = stats.bytesPlaced;
+		uint64_t copied = stats.bytesCopied;
+		std::cout << TAB1 << "Payload placed by the kernel " << placed << " bytes, copied " << copied << " bytes";
+		if (placed + copied != 0)
+			std::cout << " (" << std::setprecision(1) << 100.0 * placed / (placed + copied) << "% zero-copy)";
+		std::cout << "\n";
+
+		if (stats.ringDrops != 0)
+			std::cout << TAB1 << "Packets dropped by a full ring " << stats.ringDrops << "\n";
+
+		if (stats.truncated != 0)
+			std::cout << TAB1 << "Truncated packets " << stats.truncated << " (packet size smaller than the source's)\n";
+
+		if (settings.validate && stats.validationErrors != 0)
+			ret = -1;
+	}
+	catch (std::exception& e)
+	{
+		std::cout << "Std Error: " << e.what() << std::endl;
+		PrintUsage();
+		ret = -1;
+	}
+
+	return ret;
+}
+
+#else
+
+int main()
+{
+	std::cout << "GvspReceiverUtility requires Linux\n";
+	return -1;
+}
+
+#endif
@@ -0,0 +1,282 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaCApi.h"
+#include <inttypes.h> // defines macros for printf functions
+#include <stdbool.h>  // defines boolean type and values
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Acquisition: Batch Retrieval
+//    This example demonstrates retrieving and requeuing buffers in batches. At
+//    small regions of interest and high frame rates, many buffers complete
+//    between two calls to acDeviceGetBuffer. Rather than waiting once per
+//    buffer, the example waits for the first buffer only and then drains every
+//    buffer already sitting in the output queue. The number of waiting buffers
+//    is read from the stream node map ('StreamOutputBufferCount') through a
+//    node handle retrieved once, so draining never waits and never times out.
+//    Buffers are requeued together once the batch has been processed. Note
+//    that the batch helper is a convenience wrapper: each buffer is still
+//    retrieved and requeued by its own call, so it saves neither locks nor
+//    system calls, only the bookkeeping of processing whatever has already
+//    arrived as one group.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// number of images to grab
+#define NUM_IMAGES 500
+
+// number of buffers
+//    Batching only helps if buffers are free to complete while a batch is being
+//    processed, so use several times the batch size.
+#define NUM_BUFFERS 100
+
+// maximum number of buffers per batch
+#define MAX_BATCH_SIZE 16
+
+// system timeout
+#define SYSTEM_TIMEOUT 100
+
+// image timeout
+#define IMAGE_TIMEOUT 2000
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- HELPER =-=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// requeues a batch of buffers
+AC_ERROR RequeueBuffers(acDevice hDevice, acBuffer* phBuffers, size_t numBuffers)
+{
+	AC_ERROR err = AC_ERR_SUCCESS;
+
+	for (size_t i = 0; i < numBuffers; i++)
+	{
+		err = acDeviceRequeueBuffer(hDevice, phBuffers[i]);
+		if (err != AC_ERR_SUCCESS)
+			return err;
+	}
+
+	return AC_ERR_SUCCESS;
+}
+
+// gets up to maxCount buffers
+// (1) waits for first buffer
+// (2) checks how many more are already complete
+// (3) retrieves them without waiting
+AC_ERROR GetBuffers(acDevice hDevice, acNode hStreamOutputBufferCountNode, size_t maxCount, uint64_t timeout, acBuffer* phBuffers, size_t* pNumBuffers)
+{
+	AC_ERROR err = AC_ERR_SUCCESS;
+
+	*pNumBuffers = 0;
+
+	if (maxCount == 0)
+		return AC_ERR_SUCCESS;
+
+	// Wait for first buffer
+	//    This is the only call that blocks. It returns AC_ERR_TIMEOUT if
+	//    nothing arrives in time, just like acDeviceGetBuffer.
+	err = acDeviceGetBuffer(hDevice, timeout, &phBuffers[0]);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	*pNumBuffers = 1;
+
+	// Drain output queue
+	//    Every buffer counted here is already in the output queue, so the zero
+	//    timeout is never reached. Should a call fail anyway, the buffers
+	//    already taken are requeued before returning the error, so that none
+	//    are lost to the stream.
+	int64_t waiting = 0;
+
+	err = acIntegerGetValue(hStreamOutputBufferCountNode, &waiting);
+
+	while (err == AC_ERR_SUCCESS && waiting-- > 0 && *pNumBuffers < maxCount)
+	{
+		err = acDeviceGetBuffer(hDevice, 0, &phBuffers[*pNumBuffers]);
+		if (err == AC_ERR_SUCCESS)
+			(*pNumBuffers)++;
+	}
+
+	if (err != AC_ERR_SUCCESS)
+	{
+		RequeueBuffers(hDevice, phBuffers, *pNumBuffers);
+		*pNumBuffers = 0;
+		return err;
+	}
+
+	return AC_ERR_SUCCESS;
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// demonstrates batch retrieval
+// (1) starts stream
+// (2) gets buffers in batches
+// (3) processes each batch
+// (4) requeues each batch
+// (5) stops stream
+AC_ERROR AcquireImagesInBatches(acDevice hDevice)
+{
+	AC_ERROR err = AC_ERR_SUCCESS;
+
+	// get output queue counter once
+	acNodeMap hTLStreamNodeMap = NULL;
+	acNode hStreamOutputBufferCountNode = NULL;
+
+	err = acDeviceGetTLStreamNodeMap(hDevice, &hTLStreamNodeMap);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	err = acNodeMapGetNode(hTLStreamNodeMap, "StreamOutputBufferCount", &hStreamOutputBufferCountNode);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	// start stream
+	printf("%sStart stream with %d buffers\n", TAB1, NUM_BUFFERS);
+
+	err = acDeviceStartStreamNumBuffersAndFlags(hDevice, NUM_BUFFERS);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	// get buffers in batches
+	printf("%sGet %d images in batches of up to %d\n", TAB1, NUM_IMAGES, MAX_BATCH_SIZE);
+
+	acBuffer batch[MAX_BATCH_SIZE];
+	size_t numInBatch = 0;
+	size_t numRetrieved = 0;
+	size_t numBatches = 0;
+	size_t numIncomplete = 0;
+
+	while (numRetrieved < NUM_IMAGES)
+	{
+		size_t remaining = NUM_IMAGES - numRetrieved;
+
+		err = GetBuffers(hDevice, hStreamOutputBufferCountNode, remaining < MAX_BATCH_SIZE ? remaining : MAX_BATCH_SIZE, IMAGE_TIMEOUT, batch, &numInBatch);
+		if (err != AC_ERR_SUCCESS)
+		{
+			RequeueBuffers(hDevice, batch, numInBatch);
+			acDeviceStopStream(hDevice);
+			return err;
+		}
+
+		// process batch
+		for (size_t i = 0; i < numInBatch; i++)
+		{
+			bool8_t isIncomplete = false;
+
+			err = acBufferIsIncomplete(batch[i], &isIncomplete);
+			if (err != AC_ERR_SUCCESS)
+				return err;
+
+			if (isIncomplete)
+				numIncomplete++;
+		}
+
+		uint64_t firstFrameId = 0;
+		uint64_t lastFrameId = 0;
+
+		err = acBufferGetFrameId(batch[0], &firstFrameId) |
+			  acBufferGetFrameId(batch[numInBatch - 1], &lastFrameId);
+		if (err != AC_ERR_SUCCESS)
+			return err;
+
+		printf("%sBatch %zu: %zu buffers (frame IDs %" PRIu64 " to %" PRIu64 ")\n", TAB2, numBatches, numInBatch, firstFrameId, lastFrameId);
+
+		// requeue batch
+		err = RequeueBuffers(hDevice, batch, numInBatch);
+		if (err != AC_ERR_SUCCESS)
+			return err;
+
+		numRetrieved += numInBatch;
+		numBatches++;
+	}
+
+	printf("%sRetrieved %zu buffers in %zu batches (%.2f per batch, %zu incomplete)\n", TAB1, numRetrieved, numBatches, (double)numRetrieved / numBatches, numIncomplete);
+
+	// stop stream
+	printf("%sStop stream\n", TAB1);
+
+	err = acDeviceStopStream(hDevice);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	return err;
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// error buffer length
+#define ERR_BUF 512
+
+#define CHECK_RETURN                                  \
+	if (err != AC_ERR_SUCCESS)                        \
+	{                                                 \
+		char pMessageBuf[ERR_BUF];                    \
+		size_t pBufLen = ERR_BUF;                     \
+		acGetLastErrorMessage(pMessageBuf, &pBufLen); \
+		printf("\nError: %s", pMessageBuf);           \
+		printf("\n\nPress enter to complete\n");      \
+		getchar();                                    \
+		return -1;                                    \
+	}
+
+int main()
+{
+	printf("C_Acquisition_BatchRetrieval\n");
+	AC_ERROR err = AC_ERR_SUCCESS;
+
+	// prepare example
+	acSystem hSystem = NULL;
+	err = acOpenSystem(&hSystem);
+	CHECK_RETURN;
+	err = acSystemUpdateDevices(hSystem, SYSTEM_TIMEOUT);
+	CHECK_RETURN;
+	size_t numDevices = 0;
+	err = acSystemGetNumDevices(hSystem, &numDevices);
+	CHECK_RETURN;
+	if (numDevices == 0)
+	{
+		printf("\nNo camera connected\nPress enter to complete\n");
+		getchar();
+		return -1;
+	}
+	acDevice hDevice = NULL;
+	err = acSystemCreateDevice(hSystem, 0, &hDevice);
+	CHECK_RETURN;
+
+	// run example
+	printf("Commence example\n\n");
+	err = AcquireImagesInBatches(hDevice);
+	CHECK_RETURN;
+	printf("\nExample complete\n");
+
+	// clean up example
+	err = acSystemDestroyDevice(hSystem, hDevice);
+	CHECK_RETURN;
+	err = acCloseSystem(hSystem);
+	CHECK_RETURN;
+
+	printf("Press enter to complete\n");
+	getchar();
+	return -1;
+}
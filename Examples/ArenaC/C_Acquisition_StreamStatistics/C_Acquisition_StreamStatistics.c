@@ -0,0 +1,420 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaCApi.h"
+#include <inttypes.h> // defines macros for printf functions
+#include <stdbool.h>  // defines boolean type and values
+#include <string.h>	  // defines memset
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Acquisition: Stream Statistics
+//    This example demonstrates collecting per-stream runtime statistics while
+//    acquiring images. Stream nodes are resolved to handles once before the
+//    stream starts, so sampling them reads values without looking nodes up by
+//    name. Host-side counters (images, bytes, incomplete images and buffers
+//    held by the application) are kept alongside, and both are copied into a
+//    plain snapshot structure for reporting. The C++ version of this example
+//    additionally shows the counters being read from a separate 1 kHz
+//    telemetry thread.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// number of images to grab
+#define NUM_IMAGES 500
+
+// Sample every
+//    Number of images between stream node samples. Sampling reads every
+//    resolved node, so it is done periodically rather than per image.
+#define SAMPLE_EVERY 50
+
+// image timeout
+#define IMAGE_TIMEOUT 2000
+
+// maximum buffer length
+#define MAX_BUF 256
+
+// timeout for detecting camera devices (in milliseconds).
+#define SYSTEM_TIMEOUT 100
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- HELPER =-=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// number of stream nodes sampled
+#define NUM_STREAM_NODES 8
+
+// names of stream nodes sampled, in snapshot order
+static const char* const STREAM_NODE_NAMES[NUM_STREAM_NODES] = {
+	"StreamDeliveredFrameCount",
+	"StreamLostFrameCount",
+	"StreamMissedImageCount",
+	"StreamMissedPacketCount",
+	"StreamCumulativeMissedImageCount",
+	"StreamCumulativeIncompleteImageCount",
+	"StreamInputBufferCount",
+	"StreamOutputBufferCount"};
+
+// stream statistics snapshot
+typedef struct StreamStatisticsSnapshot
+{
+	// host-side counters
+	uint64_t images;
+	uint64_t bytes;
+	uint64_t incompleteImages;
+	uint64_t heldBuffers;
+	uint64_t heldBuffersHighWater;
+
+	// stream node counters, as of the last sample
+	uint64_t deliveredFrames;
+	uint64_t lostFrames;
+	uint64_t missedImages;
+	uint64_t missedPackets;
+	uint64_t cumulativeMissedImages;
+	uint64_t cumulativeIncompleteImages;
+	uint64_t inputQueue;
+	uint64_t outputQueue;
+
+	// Output queue high-water mark
+	//    Deepest output queue seen when sampling. Buffers are queued inside
+	//    the acquisition engine, where they cannot be counted, so this is
+	//    sampled every SAMPLE_EVERY images and misses peaks in between.
+	uint64_t outputQueueHighWater;
+} StreamStatisticsSnapshot;
+
+// stream statistics: resolved node handles and current counters
+typedef struct StreamStatistics
+{
+	acNode hNodes[NUM_STREAM_NODES];
+	StreamStatisticsSnapshot counters;
+} StreamStatistics;
+
+// resolves stream nodes
+// (1) clears counters
+// (2) gets each node handle once
+// (3) leaves handles of unavailable nodes null
+AC_ERROR InitStreamStatistics(acDevice hDevice, StreamStatistics* pStatistics)
+{
+	AC_ERROR err = AC_ERR_SUCCESS;
+
+	memset(pStatistics, 0, sizeof(*pStatistics));
+
+	// get stream node map
+	acNodeMap hTLStreamNodeMap = NULL;
+
+	err = acDeviceGetTLStreamNodeMap(hDevice, &hTLStreamNodeMap);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	// Resolve nodes once
+	//    Looking a node up by name is the most expensive part of reading a
+	//    counter. Holding on to the handles leaves only the value read on the
+	//    sample path. Nodes a transport layer does not provide are skipped.
+	size_t i = 0;
+	for (i = 0; i < NUM_STREAM_NODES; i++)
+	{
+		acNode hNode = NULL;
+		AC_ACCESS_MODE accessMode = 0;
+
+		err = acNodeMapGetNodeAndAccessMode(hTLStreamNodeMap, STREAM_NODE_NAMES[i], &hNode, &accessMode);
+		if (err == AC_ERR_SUCCESS && (accessMode == AC_ACCESS_MODE_RO || accessMode == AC_ACCESS_MODE_RW))
+			pStatistics->hNodes[i] = hNode;
+	}
+
+	return AC_ERR_SUCCESS;
+}
+
+// records a retrieved image
+// (1) counts image, bytes and incomplete images
+// (2) tracks buffers held by the application
+AC_ERROR RecordImage(StreamStatistics* pStatistics, acBuffer hBuffer)
+{
+	AC_ERROR err = AC_ERR_SUCCESS;
+	StreamStatisticsSnapshot* pCounters = &pStatistics->counters;
+
+	size_t sizeFilled = 0;
+
+	err = acBufferGetSizeFilled(hBuffer, &sizeFilled);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	bool8_t isIncomplete = false;
+
+	err = acBufferIsIncomplete(hBuffer, &isIncomplete);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	pCounters->images++;
+	pCounters->bytes += sizeFilled;
+	if (isIncomplete)
+		pCounters->incompleteImages++;
+
+	pCounters->heldBuffers++;
+	if (pCounters->heldBuffers > pCounters->heldBuffersHighWater)
+		pCounters->heldBuffersHighWater = pCounters->heldBuffers;
+
+	return err;
+}
+
+// records a requeued buffer
+void RecordRequeue(StreamStatistics* pStatistics)
+{
+	pStatistics->counters.heldBuffers--;
+}
+
+// samples stream nodes
+// (1) reads each resolved node
+// (2) stores values in snapshot order
+// (3) raises sampled output queue high-water mark
+AC_ERROR SampleStreamStatistics(StreamStatistics* pStatistics)
+{
+	AC_ERROR err = AC_ERR_SUCCESS;
+	StreamStatisticsSnapshot* pCounters = &pStatistics->counters;
+
+	uint64_t* pValues[NUM_STREAM_NODES] = {
+		&pCounters->deliveredFrames,
+		&pCounters->lostFrames,
+		&pCounters->missedImages,
+		&pCounters->missedPackets,
+		&pCounters->cumulativeMissedImages,
+		&pCounters->cumulativeIncompleteImages,
+		&pCounters->inputQueue,
+		&pCounters->outputQueue};
+
+	size_t i = 0;
+	for (i = 0; i < NUM_STREAM_NODES; i++)
+	{
+		if (!pStatistics->hNodes[i])
+			continue;
+
+		int64_t value = 0;
+
+		err = acIntegerGetValue(pStatistics->hNodes[i], &value);
+		if (err != AC_ERR_SUCCESS)
+			return err;
+
+		*pValues[i] = (uint64_t)value;
+	}
+
+	if (pCounters->outputQueue > pCounters->outputQueueHighWater)
+		pCounters->outputQueueHighWater = pCounters->outputQueue;
+
+	return err;
+}
+
+// takes a snapshot of every counter
+void GetStreamStatistics(const StreamStatistics* pStatistics, StreamStatisticsSnapshot* pSnapshot)
+{
+	*pSnapshot = pStatistics->counters;
+}
+
+// prints a snapshot
+void PrintSnapshot(const StreamStatisticsSnapshot* s)
+{
+	printf("%simages %" PRIu64 " (%" PRIu64 " incomplete), %" PRIu64 " bytes\n", TAB2, s->images, s->incompleteImages, s->bytes);
+	printf("%sdelivered %" PRIu64 ", lost %" PRIu64 ", missed images %" PRIu64 " (cumulative %" PRIu64 "), missed packets %" PRIu64 ", cumulative incomplete %" PRIu64 "\n", TAB2, s->deliveredFrames, s->lostFrames, s->missedImages, s->cumulativeMissedImages, s->missedPackets, s->cumulativeIncompleteImages);
+	printf("%squeues: input %" PRIu64 ", output %" PRIu64 " (sampled high-water %" PRIu64 "), held by application %" PRIu64 " (high-water %" PRIu64 ")\n", TAB2, s->inputQueue, s->outputQueue, s->outputQueueHighWater, s->heldBuffers, s->heldBuffersHighWater);
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// demonstrates stream statistics
+// (1) prepares acquisition and stream settings
+// (2) resolves statistics nodes
+// (3) starts the stream
+// (4) acquires images, recording each one and sampling periodically
+// (5) stops the stream and prints final statistics
+AC_ERROR AcquireImagesWithStatistics(acDevice hDevice)
+{
+	AC_ERROR err = AC_ERR_SUCCESS;
+
+	// get node maps
+	acNodeMap hNodeMap = NULL;
+	acNodeMap hTLStreamNodeMap = NULL;
+
+	err = acDeviceGetNodeMap(hDevice, &hNodeMap);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	err = acDeviceGetTLStreamNodeMap(hDevice, &hTLStreamNodeMap);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	// get node values that will be changed in order to return their values at
+	// the end of the example
+	char pAcquisitionModeInitial[MAX_BUF];
+	size_t len = MAX_BUF;
+
+	err = acNodeMapGetEnumerationValue(hNodeMap, "AcquisitionMode", pAcquisitionModeInitial, &len);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	// prepare acquisition and stream settings
+	printf("%sPrepare acquisition and stream settings\n", TAB1);
+
+	err = acNodeMapSetEnumerationValue(hNodeMap, "AcquisitionMode", "Continuous");
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	err = acNodeMapSetBooleanValue(hTLStreamNodeMap, "StreamAutoNegotiatePacketSize", true);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	err = acNodeMapSetBooleanValue(hTLStreamNodeMap, "StreamPacketResendEnable", true);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	// resolve statistics nodes
+	printf("%sResolve statistics nodes\n", TAB1);
+
+	StreamStatistics statistics;
+
+	err = InitStreamStatistics(hDevice, &statistics);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	// start stream
+	printf("%sStart stream\n", TAB1);
+
+	err = acDeviceStartStream(hDevice);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	// acquire images
+	printf("%sAcquire %d images\n", TAB1, NUM_IMAGES);
+
+	int i = 0;
+	for (i = 0; i < NUM_IMAGES; i++)
+	{
+		acBuffer hBuffer = NULL;
+
+		err = acDeviceGetBuffer(hDevice, IMAGE_TIMEOUT, &hBuffer);
+		if (err != AC_ERR_SUCCESS)
+			return err;
+
+		err = RecordImage(&statistics, hBuffer);
+		if (err != AC_ERR_SUCCESS)
+			return err;
+
+		err = acDeviceRequeueBuffer(hDevice, hBuffer);
+		if (err != AC_ERR_SUCCESS)
+			return err;
+
+		RecordRequeue(&statistics);
+
+		// sample and report periodically
+		if ((i + 1) % SAMPLE_EVERY == 0)
+		{
+			err = SampleStreamStatistics(&statistics);
+			if (err != AC_ERR_SUCCESS)
+				return err;
+
+			StreamStatisticsSnapshot snapshot;
+			GetStreamStatistics(&statistics, &snapshot);
+
+			printf("%sAfter %d images\n", TAB1, i + 1);
+			PrintSnapshot(&snapshot);
+		}
+	}
+
+	// stop stream
+	printf("%sStop stream\n", TAB1);
+
+	err = acDeviceStopStream(hDevice);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	// take one last sample so node counters reflect the whole run
+	err = SampleStreamStatistics(&statistics);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	StreamStatisticsSnapshot snapshot;
+	GetStreamStatistics(&statistics, &snapshot);
+
+	printf("%sFinal statistics\n", TAB1);
+	PrintSnapshot(&snapshot);
+
+	// return nodes to their initial values
+	err = acNodeMapSetEnumerationValue(hNodeMap, "AcquisitionMode", pAcquisitionModeInitial);
+
+	return err;
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// error buffer length
+#define ERR_BUF 512
+
+#define CHECK_RETURN                                  \
+	if (err != AC_ERR_SUCCESS)                        \
+	{                                                 \
+		char pMessageBuf[ERR_BUF];                    \
+		size_t pBufLen = ERR_BUF;                     \
+		acGetLastErrorMessage(pMessageBuf, &pBufLen); \
+		printf("\nError: %s", pMessageBuf);           \
+		printf("\n\nPress enter to complete\n");      \
+		getchar();                                    \
+		return -1;                                    \
+	}
+
+int main()
+{
+	printf("C_Acquisition_StreamStatistics\n");
+	AC_ERROR err = AC_ERR_SUCCESS;
+
+	// prepare example
+	acSystem hSystem = NULL;
+	err = acOpenSystem(&hSystem);
+	CHECK_RETURN;
+	err = acSystemUpdateDevices(hSystem, SYSTEM_TIMEOUT);
+	CHECK_RETURN;
+	size_t numDevices = 0;
+	err = acSystemGetNumDevices(hSystem, &numDevices);
+	CHECK_RETURN;
+	if (numDevices == 0)
+	{
+		printf("\nNo camera connected\nPress enter to complete\n");
+		getchar();
+		return -1;
+	}
+	acDevice hDevice = NULL;
+	err = acSystemCreateDevice(hSystem, 0, &hDevice);
+	CHECK_RETURN;
+
+	// run example
+	printf("Commence example\n\n");
+	err = AcquireImagesWithStatistics(hDevice);
+	CHECK_RETURN;
+	printf("\nExample complete\n");
+
+	// clean up example
+	err = acSystemDestroyDevice(hSystem, hDevice);
+	CHECK_RETURN;
+	err = acCloseSystem(hSystem);
+	CHECK_RETURN;
+
+	printf("Press enter to complete\n");
+	getchar();
+	return 0;
+}
@@ -0,0 +1,394 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaCApi.h"
+#include <inttypes.h> // defines macros for printf functions
+#include <stdbool.h>  // defines boolean type and values
+#include <math.h>	  // defines pow, log10
+#include <time.h>	  // defines clock
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Exposure: Closed Loop
+//    This example demonstrates changing exposure time and gain on every frame
+//    through node handles. Getting and setting nodes by name
+//    (acNodeMapGetFloatValue, acNodeMapSetFloatValue) searches the node map on
+//    every call. Getting a node's handle once (acNodeMapGetNode) and then
+//    using the handle (acFloatGetValue, acFloatSetValue) leaves a control loop
+//    that adjusts features per frame paying only for the access itself. The
+//    example first times both ways of reading a node, then runs a simple
+//    exposure loop that drives the image mean towards a target, raising gain
+//    only once exposure time has reached its limit.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// pixel format of the controlled images
+#define PIXEL_FORMAT "Mono8"
+
+// image mean the loop steers towards
+#define TARGET_MEAN 100.0
+
+// Loop gain
+//    Fraction of the error corrected on each frame. Lower values settle more
+//    slowly but do not overshoot when the scene changes.
+#define LOOP_GAIN 0.5
+
+// longest exposure time the loop may use (in microseconds)
+#define MAX_EXPOSURE_TIME 20000.0
+
+// number of reads to time each way
+#define NUM_READS 10000
+
+// number of images to grab
+#define NUM_IMAGES 100
+
+// system timeout
+#define SYSTEM_TIMEOUT 100
+
+// image timeout
+#define IMAGE_TIMEOUT 2000
+
+// maximum buffer length
+#define MAX_BUF 256
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// computes the mean of a Mono8 image, sampling every fourth pixel
+AC_ERROR GetMean(acBuffer hBuffer, double* pMean)
+{
+	AC_ERROR err = AC_ERR_SUCCESS;
+
+	uint8_t* pData = NULL;
+	size_t width = 0;
+	size_t height = 0;
+	size_t paddingX = 0;
+
+	err = acImageGetData(hBuffer, &pData);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	err = acImageGetWidth(hBuffer, &width);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	err = acImageGetHeight(hBuffer, &height);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	err = acImageGetPaddingX(hBuffer, &paddingX);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	uint64_t sum = 0;
+	uint64_t count = 0;
+
+	for (size_t y = 0; y < height; y += 4)
+	{
+		for (size_t x = 0; x < width; x += 4, count++)
+			sum += pData[y * (width + paddingX) + x];
+	}
+
+	*pMean = count ? (double)sum / (double)count : 0.0;
+	return err;
+}
+
+// demonstrates node handles in a control loop
+// (1) times reading a node by name and by handle
+// (2) disables automatic exposure and gain
+// (3) gets exposure time and gain handles once
+// (4) adjusts both on every frame
+// (5) restores initial settings
+AC_ERROR RunClosedLoop(acDevice hDevice)
+{
+	AC_ERROR err = AC_ERR_SUCCESS;
+
+	// get node map
+	acNodeMap hNodeMap = NULL;
+
+	err = acDeviceGetNodeMap(hDevice, &hNodeMap);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	// Time reads
+	//    Reads of a cached value never reach the device, so the difference
+	//    between the two is the lookup alone.
+	printf("%sRead ExposureTime %d times\n", TAB1, NUM_READS);
+
+	acNode hExposureTimeNode = NULL;
+	double value = 0.0;
+	double sum = 0.0;
+
+	clock_t start = clock();
+	for (int i = 0; i < NUM_READS; i++)
+	{
+		err = acNodeMapGetFloatValue(hNodeMap, "ExposureTime", &value);
+		if (err != AC_ERR_SUCCESS)
+			return err;
+		sum += value;
+	}
+	double byNameNs = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / NUM_READS;
+
+	err = acNodeMapGetNode(hNodeMap, "ExposureTime", &hExposureTimeNode);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	start = clock();
+	for (int i = 0; i < NUM_READS; i++)
+	{
+		err = acFloatGetValue(hExposureTimeNode, &value);
+		if (err != AC_ERR_SUCCESS)
+			return err;
+		sum += value;
+	}
+	double byHandleNs = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / NUM_READS;
+
+	printf("%sBy name:   %d ns per read\n", TAB2, (int)byNameNs);
+	printf("%sBy handle: %d ns per read (checksum %.0f)\n", TAB2, (int)byHandleNs, sum);
+
+	// Prepare control
+	//    Automatic exposure and gain would fight the loop, so both are turned
+	//    off. Ranges are read once, outside the loop.
+	printf("%sDisable automatic exposure and gain\n", TAB1);
+
+	char pixelFormatInitial[MAX_BUF];
+	size_t pixelFormatBufLen = MAX_BUF;
+	char exposureAutoInitial[MAX_BUF];
+	size_t exposureAutoBufLen = MAX_BUF;
+	char gainAutoInitial[MAX_BUF];
+	size_t gainAutoBufLen = MAX_BUF;
+
+	err = acNodeMapGetEnumerationValue(hNodeMap, "PixelFormat", pixelFormatInitial, &pixelFormatBufLen);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	err = acNodeMapGetEnumerationValue(hNodeMap, "ExposureAuto", exposureAutoInitial, &exposureAutoBufLen);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	err = acNodeMapGetEnumerationValue(hNodeMap, "GainAuto", gainAutoInitial, &gainAutoBufLen);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	err = acNodeMapSetEnumerationValue(hNodeMap, "PixelFormat", PIXEL_FORMAT);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	err = acNodeMapSetEnumerationValue(hNodeMap, "ExposureAuto", "Off");
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	err = acNodeMapSetEnumerationValue(hNodeMap, "GainAuto", "Off");
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	acNode hGainNode = NULL;
+
+	err = acNodeMapGetNode(hNodeMap, "Gain", &hGainNode);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	double exposureTimeInitial = 0.0;
+	double gainInitial = 0.0;
+	double exposureMin = 0.0;
+	double exposureMax = 0.0;
+	double gainMin = 0.0;
+	double gainMax = 0.0;
+
+	err = acFloatGetValue(hExposureTimeNode, &exposureTimeInitial);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	err = acFloatGetValue(hGainNode, &gainInitial);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	err = acFloatGetMin(hExposureTimeNode, &exposureMin);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	err = acFloatGetMax(hExposureTimeNode, &exposureMax);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+	if (exposureMax > MAX_EXPOSURE_TIME)
+		exposureMax = MAX_EXPOSURE_TIME;
+
+	err = acFloatGetMin(hGainNode, &gainMin);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	err = acFloatGetMax(hGainNode, &gainMax);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	// start stream
+	printf("%sStart stream\n", TAB1);
+
+	err = acDeviceStartStream(hDevice);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	// Run loop
+	//    The loop works on total exposure, the product of exposure time and
+	//    linear gain. Exposure time takes as much of it as its limit allows,
+	//    keeping noise down; gain covers the rest.
+	printf("%sSteer image mean towards %.0f over %d images\n", TAB1, TARGET_MEAN, NUM_IMAGES);
+
+	double exposureTime = exposureTimeInitial;
+	double gain = gainInitial;
+
+	for (int i = 0; i < NUM_IMAGES; i++)
+	{
+		acBuffer hBuffer = NULL;
+		double mean = 0.0;
+
+		err = acDeviceGetBuffer(hDevice, IMAGE_TIMEOUT, &hBuffer);
+		if (err != AC_ERR_SUCCESS)
+			return err;
+
+		err = GetMean(hBuffer, &mean);
+		if (err != AC_ERR_SUCCESS)
+			return err;
+
+		err = acDeviceRequeueBuffer(hDevice, hBuffer);
+		if (err != AC_ERR_SUCCESS)
+			return err;
+
+		// compute next exposure time and gain
+		double total = exposureTime * pow(10.0, gain / 20.0);
+		double ratio = TARGET_MEAN / (mean > 1.0 ? mean : 1.0);
+		double wanted = total * (1.0 + LOOP_GAIN * (ratio - 1.0));
+
+		exposureTime = wanted < exposureMin ? exposureMin : (wanted > exposureMax ? exposureMax : wanted);
+		gain = 20.0 * log10(wanted / exposureTime);
+		gain = gain < gainMin ? gainMin : (gain > gainMax ? gainMax : gain);
+
+		// set through handles
+		err = acFloatSetValue(hExposureTimeNode, exposureTime);
+		if (err != AC_ERR_SUCCESS)
+			return err;
+
+		err = acFloatSetValue(hGainNode, gain);
+		if (err != AC_ERR_SUCCESS)
+			return err;
+
+		// read back what the device accepted
+		err = acFloatGetValue(hExposureTimeNode, &exposureTime);
+		if (err != AC_ERR_SUCCESS)
+			return err;
+
+		err = acFloatGetValue(hGainNode, &gain);
+		if (err != AC_ERR_SUCCESS)
+			return err;
+
+		if (i % 10 == 0 || i == NUM_IMAGES - 1)
+			printf("%sImage %d: mean %d, exposure %d us, gain %.2f dB\n", TAB2, i, (int)mean, (int)exposureTime, gain);
+	}
+
+	// stop stream
+	printf("%sStop stream\n", TAB1);
+
+	err = acDeviceStopStream(hDevice);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	// restore initial settings
+	err = acFloatSetValue(hExposureTimeNode, exposureTimeInitial);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	err = acFloatSetValue(hGainNode, gainInitial);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	err = acNodeMapSetEnumerationValue(hNodeMap, "GainAuto", gainAutoInitial);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	err = acNodeMapSetEnumerationValue(hNodeMap, "ExposureAuto", exposureAutoInitial);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	err = acNodeMapSetEnumerationValue(hNodeMap, "PixelFormat", pixelFormatInitial);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	return err;
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// error buffer length
+#define ERR_BUF 512
+
+#define CHECK_RETURN                                  \
+	if (err != AC_ERR_SUCCESS)                        \
+	{                                                 \
+		char pMessageBuf[ERR_BUF];                    \
+		size_t pBufLen = ERR_BUF;                     \
+		acGetLastErrorMessage(pMessageBuf, &pBufLen); \
+		printf("\nError: %s", pMessageBuf);           \
+		printf("\n\nPress enter to complete\n");      \
+		getchar();                                    \
+		return -1;                                    \
+	}
+
+int main()
+{
+	printf("C_Exposure_ClosedLoop\n");
+	AC_ERROR err = AC_ERR_SUCCESS;
+
+	// prepare example
+	acSystem hSystem = NULL;
+	err = acOpenSystem(&hSystem);
+	CHECK_RETURN;
+	err = acSystemUpdateDevices(hSystem, SYSTEM_TIMEOUT);
+	CHECK_RETURN;
+	size_t numDevices = 0;
+	err = acSystemGetNumDevices(hSystem, &numDevices);
+	CHECK_RETURN;
+	if (numDevices == 0)
+	{
+		printf("\nNo camera connected\nPress enter to complete\n");
+		getchar();
+		return -1;
+	}
+	acDevice hDevice = NULL;
+	err = acSystemCreateDevice(hSystem, 0, &hDevice);
+	CHECK_RETURN;
+
+	// run example
+	printf("Commence example\n\n");
+	err = RunClosedLoop(hDevice);
+	CHECK_RETURN;
+	printf("\nExample complete\n");
+
+	// clean up example
+	err = acSystemDestroyDevice(hSystem, hDevice);
+	CHECK_RETURN;
+	err = acCloseSystem(hSystem);
+	CHECK_RETURN;
+
+	printf("Press enter to complete\n");
+	getchar();
+	return 0;
+}
@@ -0,0 +1,447 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+
+#include "stdafx.h"
+#include "ArenaCApi.h"
+#include "../../BayerBilinear.h"
+#include <stdlib.h>	 // defines malloc and free
+#include <string.h>	 // defines memcpy and memcmp
+#include <stdbool.h> // defines boolean type and values
+
+#define TAB1 "  "
+#define TAB2 "    "
+
+// Image Factory: Convert Into
+//    This example demonstrates converting images into storage owned by the
+//    caller. Every call to acImageFactoryConvert allocates a new image that must
+//    later be destroyed; at hundreds of frames per second this allocation shows
+//    up in profiles and fragments memory over long runs. ConvertInto writes the
+//    converted pixels to a caller-provided buffer instead, so a single buffer
+//    allocated up front serves the whole stream. Common conversions are written
+//    straight into the destination; any other conversion falls back to
+//    acImageFactoryConvertBayerAlgorithm followed by a copy, which still
+//    allocates a temporary image on every call. That includes Bayer images
+//    demosaiced with the image factory's algorithms, the default
+//    AC_BAYER_ALGORITHM_DIRECTIONAL_INTERPOLATION among them: they have no
+//    direct path, so the default Bayer path is not allocation-free. Only the
+//    bilinear demosaic from BayerBilinear.h, which must be selected explicitly
+//    and gives different pixels, writes Bayer images straight into the
+//    destination.
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- SETTINGS =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// pixel format to convert to
+#define PIXEL_FORMAT PFNC_BGR8 // BGR8
+
+// Bayer demosaic
+//    Set to BAYER_DEMOSAIC_BILINEAR to demosaic BayerRG8 directly into the
+//    destination. BAYER_DEMOSAIC_FACTORY leaves Bayer images to the image
+//    factory, which falls back and allocates on every image.
+#define BAYER_DEMOSAIC BAYER_DEMOSAIC_FACTORY
+
+// Bayer algorithm
+//    Used by the image factory, both for BAYER_DEMOSAIC_FACTORY and for
+//    reference.
+#define BAYER_ALGORITHM AC_BAYER_ALGORITHM_DIRECTIONAL_INTERPOLATION
+
+// number of images to grab
+#define NUM_IMAGES 100
+
+// system timeout
+#define SYSTEM_TIMEOUT 100
+
+// image timeout
+#define IMAGE_TIMEOUT 2000
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- HELPER =-=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// conversion kernel
+//    Converts a tightly packed source image into a tightly packed destination.
+typedef void (*ConversionKernel)(const uint8_t* pSrc, uint8_t* pDst, size_t width, size_t height);
+
+// Bayer demosaic
+//    Bilinear interpolation is not one of the image factory's Bayer
+//    algorithms, so it is selected with its own value rather than an
+//    AC_BAYER_ALGORITHM.
+typedef enum BAYER_DEMOSAIC_LIST
+{
+	BAYER_DEMOSAIC_FACTORY,
+	BAYER_DEMOSAIC_BILINEAR
+} BAYER_DEMOSAIC_LIST;
+
+// demosaics BayerRG8 with the shared bilinear kernel
+static void BayerRG8ToBGR8(const uint8_t* pSrc, uint8_t* pDst, size_t width, size_t height)
+{
+	DemosaicBayerRG8(pSrc, pDst, width, height, 2, 0);
+}
+
+static void BayerRG8ToRGB8(const uint8_t* pSrc, uint8_t* pDst, size_t width, size_t height)
+{
+	DemosaicBayerRG8(pSrc, pDst, width, height, 0, 2);
+}
+
+// replicates Mono8 into all three channels
+static void Mono8ToColor8(const uint8_t* pSrc, uint8_t* pDst, size_t width, size_t height)
+{
+	for (size_t i = 0; i < width * height; i++, pDst += 3)
+	{
+		pDst[0] = pSrc[i];
+		pDst[1] = pSrc[i];
+		pDst[2] = pSrc[i];
+	}
+}
+
+// stores a little-endian Mono16 pixel
+//    Written byte by byte, so the caller's destination needs no particular
+//    alignment.
+static void StoreMono16(uint8_t* pDst, unsigned int value)
+{
+	pDst[0] = (uint8_t)value;
+	pDst[1] = (uint8_t)(value >> 8);
+}
+
+// unpacks Mono12p to MSB-aligned Mono16
+//    Mono12p packs two pixels into three bytes, least significant bits first.
+static void Mono12pToMono16(const uint8_t* pSrc, uint8_t* pDst, size_t width, size_t height)
+{
+	size_t numPixels = width * height;
+
+	for (size_t i = 0; i < numPixels; i += 2)
+	{
+		const uint8_t* pGroup = pSrc + i / 2 * 3;
+
+		StoreMono16(pDst + i * 2, (pGroup[0] | (pGroup[1] & 0x0F) << 8) << 4);
+		if (i + 1 < numPixels)
+			StoreMono16(pDst + i * 2 + 2, ((pGroup[1] >> 4) | pGroup[2] << 4) << 4);
+	}
+}
+
+// Conversions written straight into the destination
+//    Demosaicing conversions are bilinear and only used with
+//    BAYER_DEMOSAIC_BILINEAR.
+typedef struct DirectConversion
+{
+	uint64_t srcPixelFormat;
+	uint64_t dstPixelFormat;
+	bool bilinear;
+	ConversionKernel kernel;
+} DirectConversion;
+
+static const DirectConversion DirectConversions[] = {
+	{ PFNC_BayerRG8, PFNC_BGR8, true, BayerRG8ToBGR8 },
+	{ PFNC_BayerRG8, PFNC_RGB8, true, BayerRG8ToRGB8 },
+	{ PFNC_Mono8, PFNC_BGR8, false, Mono8ToColor8 },
+	{ PFNC_Mono8, PFNC_RGB8, false, Mono8ToColor8 },
+	{ PFNC_Mono12p, PFNC_Mono16, false, Mono12pToMono16 },
+};
+
+// gets the size of an image once converted
+AC_ERROR GetConvertedSize(acBuffer hImage, uint64_t pixelFormat, size_t* pSize)
+{
+	AC_ERROR err = AC_ERR_SUCCESS;
+	size_t width = 0;
+	size_t height = 0;
+	size_t bitsPerPixel = 0;
+
+	err = acImageGetWidth(hImage, &width) |
+		  acImageGetHeight(hImage, &height) |
+		  acGetBitsPerPixel(pixelFormat, &bitsPerPixel);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	*pSize = width * height * bitsPerPixel / 8;
+	return AC_ERR_SUCCESS;
+}
+
+// finds the kernel for a conversion
+//    Sets the kernel to NULL if the conversion falls back to
+//    acImageFactoryConvertBayerAlgorithm. Converting to the same pixel format
+//    is a plain copy and needs no kernel.
+AC_ERROR FindDirectConversion(acBuffer hImage, uint64_t pixelFormat, BAYER_DEMOSAIC_LIST demosaic, ConversionKernel* pKernel)
+{
+	AC_ERROR err = AC_ERR_SUCCESS;
+	size_t width = 0;
+	size_t height = 0;
+	size_t paddingX = 0;
+	uint64_t srcPixelFormat = 0;
+
+	*pKernel = NULL;
+
+	err = acImageGetWidth(hImage, &width) |
+		  acImageGetHeight(hImage, &height) |
+		  acImageGetPaddingX(hImage, &paddingX) |
+		  acImageGetPixelFormat(hImage, &srcPixelFormat);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	if (paddingX != 0 || width < 2 || height < 2)
+		return AC_ERR_SUCCESS;
+
+	for (size_t i = 0; i < sizeof(DirectConversions) / sizeof(DirectConversions[0]); i++)
+	{
+		if (DirectConversions[i].srcPixelFormat == srcPixelFormat && DirectConversions[i].dstPixelFormat == pixelFormat &&
+			(!DirectConversions[i].bilinear || demosaic == BAYER_DEMOSAIC_BILINEAR))
+		{
+			*pKernel = DirectConversions[i].kernel;
+			break;
+		}
+	}
+
+	return AC_ERR_SUCCESS;
+}
+
+// converts an image into caller-managed storage
+//    The destination must hold at least GetConvertedSize bytes, otherwise
+//    AC_ERR_BUFFER_TOO_SMALL is returned. Direct conversions allocate nothing;
+//    the fallback allocates and destroys a temporary image inside the call,
+//    using the given Bayer algorithm. BAYER_DEMOSAIC_BILINEAR has no fallback
+//    and returns AC_ERR_NOT_IMPLEMENTED for conversions without a direct
+//    path. pIsDirect is optional.
+AC_ERROR ConvertInto(acBuffer hSrc, uint64_t pixelFormat, BAYER_DEMOSAIC_LIST demosaic, AC_BAYER_ALGORITHM bayerAlgo, uint8_t* pDst, size_t dstSize, bool8_t* pIsDirect)
+{
+	AC_ERROR err = AC_ERR_SUCCESS;
+	size_t size = 0;
+	size_t width = 0;
+	size_t height = 0;
+	size_t paddingX = 0;
+	uint64_t srcPixelFormat = 0;
+	uint8_t* pSrcData = NULL;
+	ConversionKernel kernel = NULL;
+
+	err = GetConvertedSize(hSrc, pixelFormat, &size);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	if (!pDst)
+		return AC_ERR_INVALID_PARAMETER;
+	if (dstSize < size)
+		return AC_ERR_BUFFER_TOO_SMALL;
+
+	err = acImageGetWidth(hSrc, &width) |
+		  acImageGetHeight(hSrc, &height) |
+		  acImageGetPaddingX(hSrc, &paddingX) |
+		  acImageGetPixelFormat(hSrc, &srcPixelFormat) |
+		  acImageGetData(hSrc, &pSrcData);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	// same pixel format
+	if (srcPixelFormat == pixelFormat && paddingX == 0)
+	{
+		memcpy(pDst, pSrcData, size);
+		if (pIsDirect)
+			*pIsDirect = true;
+		return AC_ERR_SUCCESS;
+	}
+
+	// direct conversion
+	err = FindDirectConversion(hSrc, pixelFormat, demosaic, &kernel);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	if (kernel)
+	{
+		kernel(pSrcData, pDst, width, height);
+		if (pIsDirect)
+			*pIsDirect = true;
+		return AC_ERR_SUCCESS;
+	}
+
+	// fallback
+	acBuffer hConverted = NULL;
+	uint8_t* pConvertedData = NULL;
+
+	if (demosaic == BAYER_DEMOSAIC_BILINEAR)
+		return AC_ERR_NOT_IMPLEMENTED;
+
+	err = acImageFactoryConvertBayerAlgorithm(hSrc, pixelFormat, bayerAlgo, &hConverted);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	err = acImageGetData(hConverted, &pConvertedData);
+	if (err == AC_ERR_SUCCESS)
+		memcpy(pDst, pConvertedData, size);
+
+	acImageFactoryDestroy(hConverted);
+
+	if (pIsDirect)
+		*pIsDirect = false;
+	return err;
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =-=- EXAMPLE -=-=-
+// =-=-=-=-=-=-=-=-=-
+
+// demonstrates converting into caller storage
+// (1) starts stream
+// (2) allocates destination once, from first image
+// (3) converts each image into destination
+// (4) compares to acImageFactoryConvertBayerAlgorithm
+// (5) stops stream
+AC_ERROR ConvertIntoCallerStorage(acDevice hDevice)
+{
+	AC_ERROR err = AC_ERR_SUCCESS;
+
+	// start stream
+	printf("%sStart stream\n", TAB1);
+
+	err = acDeviceStartStream(hDevice);
+	if (err != AC_ERR_SUCCESS)
+		return err;
+
+	printf("%sConvert %d images\n", TAB1, NUM_IMAGES);
+
+	uint8_t* pDst = NULL;
+	size_t dstSize = 0;
+	size_t numDirect = 0;
+	size_t numDifferent = 0;
+
+	for (size_t i = 0; i < NUM_IMAGES && err == AC_ERR_SUCCESS; i++)
+	{
+		acBuffer hImage = NULL;
+
+		err = acDeviceGetBuffer(hDevice, IMAGE_TIMEOUT, &hImage);
+		if (err != AC_ERR_SUCCESS)
+			break;
+
+		// allocate destination
+		//    Only grows if an image needs more room than any before it, so a
+		//    stream of same-sized images allocates once.
+		size_t size = 0;
+
+		err = GetConvertedSize(hImage, PIXEL_FORMAT, &size);
+		if (err == AC_ERR_SUCCESS && size > dstSize)
+		{
+			free(pDst);
+			pDst = (uint8_t*)malloc(size);
+			dstSize = pDst ? size : 0;
+			if (!pDst)
+				err = AC_ERR_OUT_OF_MEMORY;
+		}
+
+		// convert into destination
+		bool8_t isDirect = false;
+
+		if (err == AC_ERR_SUCCESS)
+			err = ConvertInto(hImage, PIXEL_FORMAT, BAYER_DEMOSAIC, BAYER_ALGORITHM, pDst, dstSize, &isDirect);
+
+		if (isDirect)
+			numDirect++;
+
+		// Compare to acImageFactoryConvertBayerAlgorithm
+		//    With BAYER_DEMOSAIC_FACTORY the results should match; the bilinear
+		//    demosaic is expected to differ from the reference.
+		acBuffer hConverted = NULL;
+		uint8_t* pConvertedData = NULL;
+
+		if (err == AC_ERR_SUCCESS)
+			err = acImageFactoryConvertBayerAlgorithm(hImage, PIXEL_FORMAT, BAYER_ALGORITHM, &hConverted);
+		if (err == AC_ERR_SUCCESS)
+		{
+			err = acImageGetData(hConverted, &pConvertedData);
+			if (err == AC_ERR_SUCCESS && memcmp(pConvertedData, pDst, size) != 0)
+				numDifferent++;
+
+			acImageFactoryDestroy(hConverted);
+		}
+
+		AC_ERROR requeueErr = acDeviceRequeueBuffer(hDevice, hImage);
+		if (err == AC_ERR_SUCCESS)
+			err = requeueErr;
+	}
+
+	free(pDst);
+
+	if (err == AC_ERR_SUCCESS)
+	{
+		printf("%s%zu of %d images converted directly into a %zu byte buffer\n", TAB2, numDirect, NUM_IMAGES, dstSize);
+		printf("%s%zu of %d images fell back and allocated a temporary image in acImageFactoryConvertBayerAlgorithm\n", TAB2, NUM_IMAGES - numDirect, NUM_IMAGES);
+		printf("%s%zu of %d images differ from acImageFactoryConvertBayerAlgorithm\n", TAB2, numDifferent, NUM_IMAGES);
+	}
+
+	// stop stream
+	printf("%sStop stream\n", TAB1);
+
+	AC_ERROR stopErr = acDeviceStopStream(hDevice);
+	if (err == AC_ERR_SUCCESS)
+		err = stopErr;
+
+	return err;
+}
+
+// =-=-=-=-=-=-=-=-=-
+// =- PREPARATION -=-
+// =- & CLEAN UP =-=-
+// =-=-=-=-=-=-=-=-=-
+
+// error buffer length
+#define ERR_BUF 512
+
+#define CHECK_RETURN                                  \
+	if (err != AC_ERR_SUCCESS)                        \
+	{                                                 \
+		char pMessageBuf[ERR_BUF];                    \
+		size_t pBufLen = ERR_BUF;                     \
+		acGetLastErrorMessage(pMessageBuf, &pBufLen); \
+		printf("\nError: %s", pMessageBuf);           \
+		printf("\n\nPress enter to complete\n");      \
+		getchar();                                    \
+		return -1;                                    \
+	}
+
+int main()
+{
+	printf("C_ImageFactory_ConvertInto\n");
+	AC_ERROR err = AC_ERR_SUCCESS;
+
+	// prepare example
+	acSystem hSystem = NULL;
+	err = acOpenSystem(&hSystem);
+	CHECK_RETURN;
+	err = acSystemUpdateDevices(hSystem, SYSTEM_TIMEOUT);
+	CHECK_RETURN;
+	size_t numDevices = 0;
+	err = acSystemGetNumDevices(hSystem, &numDevices);
+	CHECK_RETURN;
+	if (numDevices == 0)
+	{
+		printf("\nNo camera connected\nPress enter to complete\n");
+		getchar();
+		return -1;
+	}
+	acDevice hDevice = NULL;
+	err = acSystemCreateDevice(hSystem, 0, &hDevice);
+	CHECK_RETURN;
+
+	// run example
+	printf("Commence example\n\n");
+	err = ConvertIntoCallerStorage(hDevice);
+	CHECK_RETURN;
+	printf("\nExample complete\n");
+
+	// clean up example
+	err = acSystemDestroyDevice(hSystem, hDevice);
+	CHECK_RETURN;
+	err = acCloseSystem(hSystem);
+	CHECK_RETURN;
+
+	printf("Press enter to complete\n");
+	getchar();
+	return -1;
+}
@@ -0,0 +1,107 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Bilinear demosaic
+//    Shared by the image factory examples that demosaic BayerRG8 themselves:
+//    Cpp_ImageFactory_NeonKernels vectorizes it, and Cpp_ImageFactory_ConvertInto
+//    and C_ImageFactory_ConvertInto write it straight into caller storage.
+//    Written in C so that both languages include the same kernel. Bilinear
+//    interpolation is not one of the image factory's Bayer algorithms, so its
+//    output differs from Arena::ImageFactory::Convert.
+
+// rounded averages
+//    NEON computes these with vrhadd (2 values) and vrshrn (4 values), so the
+//    scalar kernel rounds the same way to stay bit-identical.
+static inline uint8_t BilinearAverage2(uint8_t a, uint8_t b)
+{
+	return (uint8_t)((a + b + 1) >> 1);
+}
+
+static inline uint8_t BilinearAverage4(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+{
+	return (uint8_t)((a + b + c + d + 2) >> 2);
+}
+
+// demosaics columns [xBegin, xEnd) of a BayerRG8 row
+//    Borders are mirrored (index -1 reads 1, index width reads width - 2),
+//    which keeps every neighbour on the correct colour of the filter array.
+//    redIndex and blueIndex select BGR (2, 0) or RGB (0, 2) order.
+static inline void DemosaicBayerRG8Span(const uint8_t* pUp, const uint8_t* pRow, const uint8_t* pDown, int redRow, size_t width, size_t xBegin, size_t xEnd, size_t redIndex, size_t blueIndex, uint8_t* pDstRow)
+{
+	size_t x;
+
+	for (x = xBegin; x < xEnd; x++)
+	{
+		size_t xl = x == 0 ? 1 : x - 1;
+		size_t xr = x == width - 1 ? width - 2 : x + 1;
+		int evenColumn = (x % 2) == 0;
+		uint8_t r, g, b;
+
+		if (redRow && evenColumn)
+		{
+			r = pRow[x];
+			g = BilinearAverage4(pRow[xl], pRow[xr], pUp[x], pDown[x]);
+			b = BilinearAverage4(pUp[xl], pUp[xr], pDown[xl], pDown[xr]);
+		}
+		else if (redRow)
+		{
+			g = pRow[x];
+			r = BilinearAverage2(pRow[xl], pRow[xr]);
+			b = BilinearAverage2(pUp[x], pDown[x]);
+		}
+		else if (evenColumn)
+		{
+			g = pRow[x];
+			r = BilinearAverage2(pUp[x], pDown[x]);
+			b = BilinearAverage2(pRow[xl], pRow[xr]);
+		}
+		else
+		{
+			b = pRow[x];
+			g = BilinearAverage4(pRow[xl], pRow[xr], pUp[x], pDown[x]);
+			r = BilinearAverage4(pUp[xl], pUp[xr], pDown[xl], pDown[xr]);
+		}
+
+		pDstRow[3 * x + redIndex] = r;
+		pDstRow[3 * x + 1] = g;
+		pDstRow[3 * x + blueIndex] = b;
+	}
+}
+
+// returns the rows above and below a BayerRG8 row, mirrored at the borders
+static inline void GetBayerRG8Neighbours(const uint8_t* pSrc, size_t width, size_t height, size_t y, const uint8_t** ppUp, const uint8_t** ppDown)
+{
+	*ppUp = pSrc + (y == 0 ? 1 : y - 1) * width;
+	*ppDown = pSrc + (y == height - 1 ? height - 2 : y + 1) * width;
+}
+
+// demosaics a tightly packed BayerRG8 image
+//    Width and height must be at least 2.
+static inline void DemosaicBayerRG8(const uint8_t* pSrc, uint8_t* pDst, size_t width, size_t height, size_t redIndex, size_t blueIndex)
+{
+	size_t y;
+
+	for (y = 0; y < height; y++)
+	{
+		const uint8_t* pUp;
+		const uint8_t* pDown;
+
+		GetBayerRG8Neighbours(pSrc, width, height, y, &pUp, &pDown);
+		DemosaicBayerRG8Span(pUp, pSrc + y * width, pDown, (y % 2) == 0, width, 0, width, redIndex, blueIndex, pDst + y * width * 3);
+	}
+}
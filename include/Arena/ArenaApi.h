@@ -46,5 +46,6 @@
 #include "IImage.h"
 #include "ImageFactory.h"
 #include "ISystem.h"
+#include "NodeRef.h"
 #include "PFNC.h"
 #include "PFNCCustom.h"
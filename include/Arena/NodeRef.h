@@ -0,0 +1,273 @@
+/***************************************************************************************
+ ***                                                                                 ***
+ ***  Copyright (c) 2019, Lucid Vision Labs, Inc.                                    ***
+ ***                                                                                 ***
+ ***  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     ***
+ ***  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       ***
+ ***  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    ***
+ ***  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         ***
+ ***  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  ***
+ ***  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  ***
+ ***  SOFTWARE.                                                                      ***
+ ***                                                                                 ***
+ ***************************************************************************************/
+#pragma once
+
+namespace Arena
+{
+	/**
+	 * @struct NodeRefTraits
+	 *
+	 * <B> NodeRefTraits </B> maps the value type of a node reference
+	 * (Arena::NodeRef) to the GenApi interface that holds it, and decides
+	 * which nodes a reference of that type accepts. Strings are held through
+	 * the value interface, which every node with a value implements, so only
+	 * string and enumeration nodes are accepted for them. It is used by
+	 * Arena::NodeRef and is not meant to be used on its own.
+	 *
+	 * @see
+	 *  - Arena::NodeRef
+	 */
+	template<typename T>
+	struct NodeRefTraits;
+
+	template<>
+	struct NodeRefTraits<int64_t>
+	{
+		typedef GenApi::CIntegerPtr Pointer;
+		static bool Accepts(GenApi::INode* pNode) { return Pointer(pNode).IsValid(); }
+		static int64_t Get(const Pointer& pNode) { return pNode->GetValue(); }
+		static void Set(const Pointer& pNode, const int64_t& value) { pNode->SetValue(value); }
+	};
+
+	template<>
+	struct NodeRefTraits<double>
+	{
+		typedef GenApi::CFloatPtr Pointer;
+		static bool Accepts(GenApi::INode* pNode) { return Pointer(pNode).IsValid(); }
+		static double Get(const Pointer& pNode) { return pNode->GetValue(); }
+		static void Set(const Pointer& pNode, const double& value) { pNode->SetValue(value); }
+	};
+
+	template<>
+	struct NodeRefTraits<bool>
+	{
+		typedef GenApi::CBooleanPtr Pointer;
+		static bool Accepts(GenApi::INode* pNode) { return Pointer(pNode).IsValid(); }
+		static bool Get(const Pointer& pNode) { return pNode->GetValue(); }
+		static void Set(const Pointer& pNode, const bool& value) { pNode->SetValue(value); }
+	};
+
+	template<>
+	struct NodeRefTraits<GenICam::gcstring>
+	{
+		typedef GenApi::CValuePtr Pointer;
+		static bool Accepts(GenApi::INode* pNode) { return GenApi::CStringPtr(pNode).IsValid() || GenApi::CEnumerationPtr(pNode).IsValid(); }
+		static GenICam::gcstring Get(const Pointer& pNode) { return pNode->ToString(); }
+		static void Set(const Pointer& pNode, const GenICam::gcstring& value) { pNode->FromString(value); }
+	};
+
+	/**
+	 * @class NodeRef
+	 *
+	 * A <B> NodeRef </B> is a typed reference to a node, resolved by name once
+	 * and then read or written without looking the node up again. Getting and
+	 * setting node values by name (Arena::GetNodeValue, Arena::SetNodeValue)
+	 * searches the node map and builds a name string on every call; in loops
+	 * that change features every frame, such as exposure time, gain or offsets
+	 * in closed-loop control, a node reference removes that cost.
+	 *
+	 * \code{.cpp}
+	 * 	// resolving once, then setting every frame
+	 * 	{
+	 * 		Arena::NodeRef<double> exposureTime(pDevice->GetNodeMap(), "ExposureTime");
+	 * 		Arena::NodeRef<int64_t> offsetX(pDevice->GetNodeMap(), "OffsetX");
+	 *
+	 * 		for (size_t i = 0; i < numImages; i++)
+	 * 		{
+	 * 			// ...
+	 * 			exposureTime.Set(nextExposureTime);
+	 * 			offsetX.Set(nextOffsetX);
+	 * 		}
+	 * 	}
+	 * \endcode
+	 *
+	 * The template type selects the node type in the same way as
+	 * Arena::GetNodeValue and Arena::SetNodeValue:
+	 *  - Integer nodes use int64_t
+	 *  - Float nodes use double
+	 *  - Boolean nodes use bool
+	 *  - String, enumeration nodes use GenICam::gcstring
+	 *
+	 * The full GenApi interface of the node (range, increment, access mode)
+	 * is available through the arrow operator.
+	 *
+	 * @warning
+	 *  - A node reference is only valid as long as its node map; it must not
+	 *    outlive the device or system it came from
+	 *  - Resolving a missing node or a node of another type throws
+	 *
+	 * @see
+	 *  - Arena::GetNodeValue
+	 *  - Arena::SetNodeValue
+	 */
+	template<typename T>
+	class NodeRef
+	{
+	public:
+		typedef typename NodeRefTraits<T>::Pointer Pointer;
+
+		/**
+		 * @fn NodeRef()
+		 *
+		 * An empty constructor creates an unresolved node reference, to be
+		 * resolved later (Arena::NodeRef::Resolve).
+		 */
+		NodeRef()
+		{
+		}
+
+		/**
+		 * @fn NodeRef(GenApi::INodeMap* pNodeMap, const GenICam::gcstring& name)
+		 *
+		 * @param pNodeMap
+		 *  - Type: GenApi::INodeMap*
+		 *  - A node map
+		 *
+		 * @param name
+		 *  - Type: const GenICam::gcstring&
+		 *  - Node name
+		 *
+		 * A constructor with a node map and name resolves the node reference
+		 * straight away (Arena::NodeRef::Resolve).
+		 */
+		NodeRef(GenApi::INodeMap* pNodeMap, const GenICam::gcstring& name)
+		{
+			Resolve(pNodeMap, name);
+		}
+
+		/**
+		 * @fn void Resolve(GenApi::INodeMap* pNodeMap, const GenICam::gcstring& name)
+		 *
+		 * @param pNodeMap
+		 *  - Type: GenApi::INodeMap*
+		 *  - A node map
+		 *
+		 * @param name
+		 *  - Type: const GenICam::gcstring&
+		 *  - Node name
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Resolve </B> looks up a node by name and keeps a typed pointer to
+		 * it. This is the only call that searches the node map.
+		 *
+		 * @warning
+		 *  - Throws if the node does not exist or is of another type
+		 */
+		void Resolve(GenApi::INodeMap* pNodeMap, const GenICam::gcstring& name)
+		{
+			if (!pNodeMap)
+				throw INVALID_ARGUMENT_EXCEPTION("Node map is null");
+
+			GenApi::INode* pNode = pNodeMap->GetNode(name);
+			if (!pNode)
+				throw INVALID_ARGUMENT_EXCEPTION("Node '%s' not found", name.c_str());
+
+			if (!NodeRefTraits<T>::Accepts(pNode))
+				throw INVALID_ARGUMENT_EXCEPTION("Node '%s' is not of the requested type", name.c_str());
+
+			m_pNode = Pointer(pNode);
+		}
+
+		/**
+		 * @fn T Get() const
+		 *
+		 * @return
+		 *  - Type: T
+		 *  - Value of the node
+		 *
+		 * <B> Get </B> gets the value of the node.
+		 */
+		T Get() const
+		{
+			return NodeRefTraits<T>::Get(m_pNode);
+		}
+
+		/**
+		 * @fn void Set(const T& value)
+		 *
+		 * @param value
+		 *  - Type: const T&
+		 *  - Value to set
+		 *
+		 * @return
+		 *  - none
+		 *
+		 * <B> Set </B> sets the value of the node.
+		 */
+		void Set(const T& value)
+		{
+			NodeRefTraits<T>::Set(m_pNode, value);
+		}
+
+		/**
+		 * @fn bool IsValid() const
+		 *
+		 * @return
+		 *  - Type: bool
+		 *  - True if the node reference has been resolved
+		 *  - Otherwise, false
+		 */
+		bool IsValid() const
+		{
+			return m_pNode.IsValid();
+		}
+
+		/**
+		 * @fn bool IsReadable() const
+		 *
+		 * @return
+		 *  - Type: bool
+		 *  - True if the node is resolved and currently readable
+		 *  - Otherwise, false
+		 */
+		bool IsReadable() const
+		{
+			return m_pNode.IsValid() && GenApi::IsReadable(m_pNode->GetAccessMode());
+		}
+
+		/**
+		 * @fn bool IsWritable() const
+		 *
+		 * @return
+		 *  - Type: bool
+		 *  - True if the node is resolved and currently writable
+		 *  - Otherwise, false
+		 */
+		bool IsWritable() const
+		{
+			return m_pNode.IsValid() && GenApi::IsWritable(m_pNode->GetAccessMode());
+		}
+
+		/**
+		 * @fn const Pointer& operator->() const
+		 *
+		 * @return
+		 *  - Type: const Pointer&
+		 *  - The typed GenApi pointer to the node
+		 *
+		 * The <B> arrow operator </B> gives access to the node's GenApi
+		 * interface, for example its range (GenApi::IFloat::GetMin,
+		 * GenApi::IFloat::GetMax).
+		 */
+		const Pointer& operator->() const
+		{
+			return m_pNode;
+		}
+
+	private:
+		Pointer m_pNode;
+	};
+} // namespace Arena